@@ -0,0 +1,61 @@
+"""Compares two JMH JSON result files, such as the jmh-result.json of runs
+on two commits, and prints the change of each benchmark's score.
+
+usage: python compare.py baseline.json current.json [threshold_percent]
+
+Exits with 1 if any benchmark got worse by more than the threshold,
+default 10 percent, so it can fail a build.
+"""
+
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        results = json.load(f)
+    scores = {}
+    for r in results:
+        name = r['benchmark']
+        params = r.get('params')
+        if params:
+            name += '(' + ', '.join('%s=%s' % (k, params[k])
+                                    for k in sorted(params)) + ')'
+        metric = r['primaryMetric']
+        scores[name] = (r['mode'], metric['score'], metric['scoreError'],
+                        metric['scoreUnit'])
+    return scores
+
+
+def main(args):
+    if len(args) < 2:
+        print(__doc__)
+        return 2
+    baseline = load(args[0])
+    current = load(args[1])
+    threshold = float(args[2]) if len(args) > 2 else 10.0
+
+    worse = 0
+    print('%-70s %14s %14s %8s' % ('benchmark', 'baseline', 'current',
+                                   'change'))
+    for name in sorted(set(baseline) | set(current)):
+        if name not in baseline or name not in current:
+            print('%-70s %s' % (name, 'only in ' +
+                                (args[0] if name in baseline else args[1])))
+            continue
+        mode, old, olderr, unit = baseline[name]
+        mode, new, newerr, unit = current[name]
+        change = (new - old) / old * 100.0 if old else 0.0
+        # throughput is better higher, everything else lower
+        regression = -change if mode == 'thrpt' else change
+        flag = ''
+        if regression > threshold and abs(new - old) > olderr + newerr:
+            flag = ' WORSE'
+            worse += 1
+        print('%-70s %14.3f %14.3f %+7.1f%%%s %s' % (name, old, new, change,
+                                                    flag, unit))
+    return 1 if worse else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
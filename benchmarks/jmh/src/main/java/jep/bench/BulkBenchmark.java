@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.bench;
+
+import java.util.LinkedHashMap;
+import java.util.Map;
+import java.util.concurrent.TimeUnit;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Setting some variables and getting them back with one call each against
+ * Jep.setAll and Jep.getValues.
+ * 
+ * @version $Id$
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 5)
+@Measurement(iterations = 10)
+@Fork(1)
+public class BulkBenchmark {
+
+    @Param({ "10", "100" })
+    public int count;
+
+    private Jep jep;
+
+    private Map<String, Object> values;
+
+    private String[] names;
+
+    // setup runs on the benchmark thread, which must own the Jep
+    @Setup(Level.Trial)
+    public void setup() throws JepException {
+        jep = new Jep(new JepConfig());
+        values = new LinkedHashMap<String, Object>();
+        names = new String[count];
+        for (int i = 0; i < count; i++) {
+            names[i] = "v" + i;
+            values.put(names[i], Double.valueOf(i));
+        }
+    }
+
+    @TearDown(Level.Trial)
+    public void tearDown() {
+        jep.close();
+    }
+
+    @Benchmark
+    public Object separate() throws JepException {
+        for (Map.Entry<String, Object> entry : values.entrySet())
+            jep.set(entry.getKey(), entry.getValue());
+        Object last = null;
+        for (String name : names)
+            last = jep.getValue(name);
+        return last;
+    }
+
+    @Benchmark
+    public Object[] bulk() throws JepException {
+        jep.setAll(values);
+        return jep.getValues(names);
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.bench;
+
+import java.util.concurrent.TimeUnit;
+
+import jep.ClassList;
+import jep.JepException;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * ClassList loading and answering lookups. firstLookup runs once in each of
+ * several JVMs since ClassList loads only once per process, add
+ * <code>-jvmArgs -Djep.classlist.cache=dir</code> to see the jar cache at
+ * work.
+ * 
+ * @version $Id$
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 5)
+@Measurement(iterations = 10)
+@Fork(1)
+public class ClassListBenchmark {
+
+    @Param({ "java.util" })
+    public String pkg;
+
+    @Benchmark
+    @BenchmarkMode(Mode.SingleShotTime)
+    @OutputTimeUnit(TimeUnit.MILLISECONDS)
+    @Warmup(iterations = 0)
+    @Measurement(iterations = 1)
+    @Fork(10)
+    public boolean firstLookup() throws JepException {
+        return ClassList.getInstance().contains(pkg);
+    }
+
+    @Benchmark
+    public boolean contains() throws JepException {
+        return ClassList.getInstance().contains(pkg);
+    }
+
+    @Benchmark
+    public String[] getClassNames() throws JepException {
+        return ClassList.getInstance().getClassNames(pkg);
+    }
+}
@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.bench;
+
+import java.io.File;
+import java.io.FileWriter;
+import java.io.IOException;
+import java.util.concurrent.TimeUnit;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Jep.eval of small statements, Jep.exec and Jep.runScript of a small
+ * script.
+ * 
+ * @version $Id$
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 5)
+@Measurement(iterations = 10)
+@Fork(1)
+public class EvalBenchmark {
+
+    private Jep jep;
+
+    private File script;
+
+    @Setup(Level.Trial)
+    public void setup() throws JepException, IOException {
+        jep = new Jep(new JepConfig());
+        jep.eval("x = 0");
+
+        script = File.createTempFile("jepbench", ".py");
+        script.deleteOnExit();
+        FileWriter out = new FileWriter(script);
+        try {
+            out.write("total = 0\n" //
+                    + "for i in range(10):\n" //
+                    + "    total += i\n");
+        } finally {
+            out.close();
+        }
+    }
+
+    @TearDown(Level.Trial)
+    public void tearDown() {
+        jep.close();
+        script.delete();
+    }
+
+    @Benchmark
+    public boolean evalAssign() throws JepException {
+        return jep.eval("y = 1");
+    }
+
+    @Benchmark
+    public boolean evalArithmetic() throws JepException {
+        return jep.eval("x = x + 1");
+    }
+
+    @Benchmark
+    public boolean evalCall() throws JepException {
+        return jep.eval("y = len('forty two')");
+    }
+
+    @Benchmark
+    public void exec() throws JepException {
+        jep.exec("y = 1\nz = y + 1\n");
+    }
+
+    @Benchmark
+    public void runScript() throws JepException {
+        jep.runScript(script.getPath());
+    }
+}
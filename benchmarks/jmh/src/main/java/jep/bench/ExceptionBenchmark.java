@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.bench;
+
+import java.util.concurrent.TimeUnit;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Exceptions crossing between Java and Python: a Java exception caught in
+ * Python by type or looked at, against the same call without an exception,
+ * and a Python exception caught in Java with and without its message.
+ * 
+ * @version $Id$
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 5)
+@Measurement(iterations = 10)
+@Fork(1)
+public class ExceptionBenchmark {
+
+    private Jep jep;
+
+    // setup runs on the benchmark thread, which must own the Jep
+    @Setup(Level.Trial)
+    public void setup() throws JepException {
+        jep = new Jep(new JepConfig());
+        jep.eval("from java.lang import Integer");
+        jep.eval("def ok():\n" //
+                + "    Integer.parseInt('1')\n");
+        jep.eval("def caught():\n" //
+                + "    try:\n" //
+                + "        Integer.parseInt('x')\n" //
+                + "    except ValueError:\n" //
+                + "        pass\n");
+        jep.eval("def inspected():\n" //
+                + "    try:\n" //
+                + "        Integer.parseInt('x')\n" //
+                + "    except ValueError as e:\n" //
+                + "        e.args[0].getStackTrace()\n");
+        jep.eval("def fail():\n" //
+                + "    raise ValueError('expected')\n");
+    }
+
+    @TearDown(Level.Trial)
+    public void tearDown() {
+        jep.close();
+    }
+
+    @Benchmark
+    public Object noException() throws JepException {
+        return jep.invoke("ok");
+    }
+
+    @Benchmark
+    public Object caughtInPython() throws JepException {
+        return jep.invoke("caught");
+    }
+
+    @Benchmark
+    public Object inspectedInPython() throws JepException {
+        return jep.invoke("inspected");
+    }
+
+    @Benchmark
+    public Object caughtInJava() {
+        try {
+            return jep.invoke("fail");
+        } catch (JepException e) {
+            return e;
+        }
+    }
+
+    @Benchmark
+    public String messageInJava() {
+        try {
+            jep.invoke("fail");
+            return null;
+        } catch (JepException e) {
+            return e.getMessage();
+        }
+    }
+}
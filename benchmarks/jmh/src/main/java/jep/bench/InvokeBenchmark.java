@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.bench;
+
+import java.util.concurrent.TimeUnit;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Jep.invoke of Python functions taking 0, 1 and 8 arguments.
+ * 
+ * @version $Id$
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 5)
+@Measurement(iterations = 10)
+@Fork(1)
+public class InvokeBenchmark {
+
+    private Jep jep;
+
+    @Setup(Level.Trial)
+    public void setup() throws JepException {
+        jep = new Jep(new JepConfig());
+        jep.eval("def f0():\n    return None\n");
+        jep.eval("def f1(a):\n    return a\n");
+        jep.eval("def f8(a, b, c, d, e, f, g, h):\n    return a\n");
+        jep.eval("class C(object):\n    def m(self, a):\n        return a\n");
+        jep.eval("c = C()");
+    }
+
+    @TearDown(Level.Trial)
+    public void tearDown() {
+        jep.close();
+    }
+
+    @Benchmark
+    public Object invoke0() throws JepException {
+        return jep.invoke("f0");
+    }
+
+    @Benchmark
+    public Object invoke1() throws JepException {
+        return jep.invoke("f1", 1);
+    }
+
+    @Benchmark
+    public Object invoke1String() throws JepException {
+        return jep.invoke("f1", "one");
+    }
+
+    @Benchmark
+    public Object invoke8() throws JepException {
+        return jep.invoke("f8", 1, 2L, 3.0, 4.0f, "five", true, (short) 7,
+                (byte) 8);
+    }
+
+    @Benchmark
+    public Object invokeMethod() throws JepException {
+        return jep.invoke("c.m", 1);
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.bench;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * Runs the JMH benchmarks, writing the results as JSON to jmh-result.json
+ * unless the arguments say otherwise so runs of different commits can be
+ * compared with compare.py. Any JMH arguments may be given, e.g. a regex of
+ * the benchmarks to run or <code>-lp</code> to list their parameters.
+ * 
+ * @version $Id$
+ */
+public class Main {
+
+    /**
+     * @param args
+     *            JMH command line arguments
+     * @throws Exception
+     */
+    public static void main(String[] args) throws Exception {
+        List<String> jmhArgs = new ArrayList<String>(Arrays.asList(args));
+        if (!jmhArgs.contains("-rf")) {
+            jmhArgs.add("-rf");
+            jmhArgs.add("json");
+        }
+        if (!jmhArgs.contains("-rff")) {
+            jmhArgs.add("-rff");
+            jmhArgs.add("jmh-result.json");
+        }
+        org.openjdk.jmh.Main.main(jmhArgs.toArray(new String[jmhArgs.size()]));
+    }
+}
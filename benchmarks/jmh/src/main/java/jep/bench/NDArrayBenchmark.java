@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.bench;
+
+import java.util.concurrent.TimeUnit;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+import jep.NDArray;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Round trips of float and byte NDArrays through numpy, from 1 KB to 256 MB.
+ * Needs numpy, and a heap of over a gigabyte for the largest size.
+ * 
+ * @version $Id$
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 3)
+@Measurement(iterations = 5)
+@Fork(value = 1, jvmArgsAppend = "-Xmx2g")
+public class NDArrayBenchmark {
+
+    @Param({ "1024", "65536", "1048576", "16777216", "268435456" })
+    public int bytes;
+
+    private Jep jep;
+
+    private NDArray<float[]> floats;
+
+    private NDArray<byte[]> bytesArray;
+
+    @Setup(Level.Trial)
+    public void setup() throws JepException {
+        jep = new Jep(new JepConfig().addSharedModules("numpy"));
+        jep.eval("import numpy");
+        floats = new NDArray<float[]>(new float[bytes / 4]);
+        bytesArray = new NDArray<byte[]>(new byte[bytes]);
+    }
+
+    @TearDown(Level.Trial)
+    public void tearDown() {
+        jep.close();
+    }
+
+    @Benchmark
+    public Object floatRoundTrip() throws JepException {
+        jep.set("a", floats);
+        return jep.getValue("a");
+    }
+
+    @Benchmark
+    public Object byteRoundTrip() throws JepException {
+        jep.set("a", bytesArray);
+        return jep.getValue("a");
+    }
+
+    @Benchmark
+    public void floatToPython() throws JepException {
+        jep.set("a", floats);
+    }
+}
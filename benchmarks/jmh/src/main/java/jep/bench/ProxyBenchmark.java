@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.bench;
+
+import java.util.Comparator;
+import java.util.concurrent.Callable;
+import java.util.concurrent.TimeUnit;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Java calling back into Python objects that implement Java interfaces
+ * through jep.jproxy.
+ * 
+ * @version $Id$
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 5)
+@Measurement(iterations = 10)
+@Fork(1)
+public class ProxyBenchmark {
+
+    private Jep jep;
+
+    private Comparator<Object> comparator;
+
+    private Callable<Object> callable;
+
+    private CharSequence sequence;
+
+    @SuppressWarnings("unchecked")
+    @Setup(Level.Trial)
+    public void setup() throws JepException {
+        jep = new Jep(new JepConfig());
+        jep.eval("class Compare(object):\n" //
+                + "    def compare(self, a, b):\n" //
+                + "        return a - b\n");
+        jep.eval("class Call(object):\n" //
+                + "    def call(self):\n" //
+                + "        return None\n");
+        jep.eval("class Letters(object):\n" //
+                + "    def length(self):\n" //
+                + "        return 3\n" //
+                + "    def charAt(self, i):\n" //
+                + "        return 'abc'[i]\n" //
+                + "    def subSequence(self, start, end):\n" //
+                + "        return 'abc'[start:end]\n" //
+                + "    def toString(self):\n" //
+                + "        return 'abc'\n");
+        comparator = (Comparator<Object>) jep.getValue(
+                "jep.jproxy(Compare(), ['java.util.Comparator'])");
+        callable = (Callable<Object>) jep.getValue(
+                "jep.jproxy(Call(), ['java.util.concurrent.Callable'])");
+        sequence = (CharSequence) jep.getValue(
+                "jep.jproxy(Letters(), ['java.lang.CharSequence'])");
+    }
+
+    @TearDown(Level.Trial)
+    public void tearDown() {
+        jep.close();
+    }
+
+    @Benchmark
+    public Object callNoArgs() throws Exception {
+        return callable.call();
+    }
+
+    @Benchmark
+    public int compareBoxed() {
+        return comparator.compare(Integer.valueOf(1), Integer.valueOf(2));
+    }
+
+    @Benchmark
+    public char charAtPrimitive() {
+        return sequence.charAt(1);
+    }
+
+    @Benchmark
+    public int lengthPrimitive() {
+        return sequence.length();
+    }
+}
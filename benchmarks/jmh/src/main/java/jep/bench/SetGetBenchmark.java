@@ -0,0 +1,254 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.bench;
+
+import java.util.concurrent.TimeUnit;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Every overload of Jep.set and the ways of getting a value back. The
+ * arrays are small so these measure the per call overhead, see
+ * NDArrayBenchmark for large data.
+ * 
+ * @version $Id$
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 5)
+@Measurement(iterations = 10)
+@Fork(1)
+public class SetGetBenchmark {
+
+    private Jep jep;
+
+    private final Object object = new Object();
+
+    private final boolean[] booleans = new boolean[16];
+
+    private final int[] ints = new int[16];
+
+    private final short[] shorts = new short[16];
+
+    private final byte[] bytes = new byte[16];
+
+    private final long[] longs = new long[16];
+
+    private final double[] doubles = new double[16];
+
+    private final float[] floats = new float[16];
+
+    private final char[] chars = "sixteen chars...".toCharArray();
+
+    // setup runs on the benchmark thread, which must own the Jep
+    @Setup(Level.Trial)
+    public void setup() throws JepException {
+        jep = new Jep(new JepConfig());
+        jep.eval("i = 42");
+        jep.eval("f = 4.2");
+        jep.eval("b = True");
+        jep.eval("s = 'forty two'");
+        jep.eval("l = [1, 2, 3]");
+        jep.eval("ba = bytearray(16)");
+        jep.eval("from java.util import ArrayList");
+        jep.eval("jo = ArrayList()");
+    }
+
+    @TearDown(Level.Trial)
+    public void tearDown() {
+        jep.close();
+    }
+
+    @Benchmark
+    public void setString() throws JepException {
+        jep.set("x", "forty two");
+    }
+
+    @Benchmark
+    public void setObject() throws JepException {
+        jep.set("x", object);
+    }
+
+    @Benchmark
+    public void setClass() throws JepException {
+        jep.set("x", (Object) String.class);
+    }
+
+    @Benchmark
+    public void setBoolean() throws JepException {
+        jep.set("x", true);
+    }
+
+    @Benchmark
+    public void setInt() throws JepException {
+        jep.set("x", 42);
+    }
+
+    @Benchmark
+    public void setShort() throws JepException {
+        jep.set("x", (short) 42);
+    }
+
+    @Benchmark
+    public void setByte() throws JepException {
+        jep.set("x", (byte) 42);
+    }
+
+    @Benchmark
+    public void setChar() throws JepException {
+        jep.set("x", 'x');
+    }
+
+    @Benchmark
+    public void setLong() throws JepException {
+        jep.set("x", 42L);
+    }
+
+    @Benchmark
+    public void setDouble() throws JepException {
+        jep.set("x", 4.2);
+    }
+
+    @Benchmark
+    public void setFloat() throws JepException {
+        jep.set("x", 4.2f);
+    }
+
+    @Benchmark
+    public void setBooleanArray() throws JepException {
+        jep.set("x", booleans);
+    }
+
+    @Benchmark
+    public void setIntArray() throws JepException {
+        jep.set("x", ints);
+    }
+
+    @Benchmark
+    public void setShortArray() throws JepException {
+        jep.set("x", shorts);
+    }
+
+    @Benchmark
+    public void setByteArray() throws JepException {
+        jep.set("x", bytes);
+    }
+
+    @Benchmark
+    public void setLongArray() throws JepException {
+        jep.set("x", longs);
+    }
+
+    @Benchmark
+    public void setDoubleArray() throws JepException {
+        jep.set("x", doubles);
+    }
+
+    @Benchmark
+    public void setFloatArray() throws JepException {
+        jep.set("x", floats);
+    }
+
+    @Benchmark
+    public void setCharArray() throws JepException {
+        jep.set("x", chars);
+    }
+
+    @Benchmark
+    public Object getInt() throws JepException {
+        return jep.getValue("i");
+    }
+
+    @Benchmark
+    public Object getFloat() throws JepException {
+        return jep.getValue("f");
+    }
+
+    @Benchmark
+    public Object getString() throws JepException {
+        return jep.getValue("s");
+    }
+
+    @Benchmark
+    public Object getList() throws JepException {
+        return jep.getValue("l");
+    }
+
+    @Benchmark
+    public Object getJavaObject() throws JepException {
+        return jep.getValue("jo");
+    }
+
+    @Benchmark
+    public Object getExpression() throws JepException {
+        return jep.getValue("i + 1");
+    }
+
+    @Benchmark
+    public Integer getValueAs() throws JepException {
+        return jep.getValue("i", Integer.class);
+    }
+
+    @Benchmark
+    public long getLong() throws JepException {
+        return jep.getLong("i");
+    }
+
+    @Benchmark
+    public double getDouble() throws JepException {
+        return jep.getDouble("f");
+    }
+
+    @Benchmark
+    public boolean getBoolean() throws JepException {
+        return jep.getBoolean("b");
+    }
+
+    @Benchmark
+    public Object[] getValues() throws JepException {
+        return jep.getValues("i", "f", "s");
+    }
+
+    @Benchmark
+    public byte[] getByteArray() throws JepException {
+        return jep.getValue_bytearray("ba");
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.bench;
+
+import java.util.concurrent.TimeUnit;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Level;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Creating a Jep that imports a module, with and without sharing the module,
+ * compared to resetting one Jep and importing the module again. Modules that
+ * can only be imported once per process, like numpy, only work with
+ * sharedCreateImportClose and resetImport.
+ * 
+ * @version $Id$
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 5)
+@Measurement(iterations = 10)
+@Fork(1)
+public class SharedModulesBenchmark {
+
+    @Param({ "json" })
+    public String module;
+
+    private JepConfig shared;
+
+    @Setup(Level.Trial)
+    public void setup() {
+        shared = new JepConfig().addSharedModules(module);
+    }
+
+    /**
+     * A Jep to reset, only made for resetImport so the other benchmarks'
+     * threads don't own a Jep while creating more.
+     */
+    @State(Scope.Thread)
+    public static class Reused {
+
+        private Jep jep;
+
+        // setup runs on the benchmark thread, which must own the Jep
+        @Setup(Level.Trial)
+        public void setup(SharedModulesBenchmark bench) throws JepException {
+            jep = new Jep(new JepConfig());
+            jep.eval("import " + bench.module);
+            jep.snapshot();
+        }
+
+        @TearDown(Level.Trial)
+        public void tearDown() {
+            jep.close();
+        }
+    }
+
+    @Benchmark
+    public void createImportClose() throws JepException {
+        Jep jep = new Jep(new JepConfig());
+        try {
+            jep.eval("import " + module);
+        } finally {
+            jep.close();
+        }
+    }
+
+    @Benchmark
+    public void sharedCreateImportClose() throws JepException {
+        Jep jep = new Jep(shared);
+        try {
+            jep.eval("import " + module);
+        } finally {
+            jep.close();
+        }
+    }
+
+    @Benchmark
+    public boolean resetImport(Reused reused) throws JepException {
+        reused.jep.reset();
+        return reused.jep.eval("import " + module);
+    }
+}
@@ -0,0 +1,420 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.bench;
+
+import java.io.BufferedReader;
+import java.io.FileReader;
+import java.io.FileWriter;
+import java.io.IOException;
+import java.lang.management.ManagementFactory;
+import java.lang.management.ThreadMXBean;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CyclicBarrier;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+import jep.JepStats;
+
+/**
+ * <p>
+ * Measures how throughput scales with the number of threads each owning a
+ * Jep, and soaks a fixed number of them to watch memory. Every thread runs
+ * the same workload: pure Python compute, many small Java calls, numpy, or
+ * blocking Java calls that release the GIL, or all but numpy in turn. For
+ * each thread count it prints the operations per second, the speedup over
+ * one thread and percentiles of the time each operation waited for the GIL,
+ * taken from the stats of each Jep. The share of the run the GIL was busy is
+ * estimated from the CPU time of the workers, since time in the interpreter
+ * also counts GIL waits and blocking Java calls.
+ * </p>
+ * 
+ * <pre>
+ * java jep.bench.ThreadScaling [-threads 1,2,4,8,16,32,64]
+ *     [-workload python|java|numpy|io|mixed] [-seconds 5]
+ *     [-soak minutes] [-json file]
+ * </pre>
+ * 
+ * <p>
+ * This isn't a JMH benchmark since JMH can't vary the thread count within a
+ * run or report GIL waits, it is only built into the same jar.
+ * </p>
+ * 
+ * @version $Id$
+ */
+public class ThreadScaling {
+
+    private static final String WORKLOADS = "from java.lang import StringBuilder, Thread\n"
+            + "def work_python():\n"
+            + "    return sum(i * i for i in range(2000))\n"
+            + "def work_java():\n"
+            + "    sb = StringBuilder()\n"
+            + "    for i in range(100):\n"
+            + "        sb.append(i)\n"
+            + "    return sb.length()\n"
+            + "def work_numpy():\n"
+            + "    import numpy\n"
+            + "    a = numpy.arange(20000, dtype='float64')\n"
+            + "    return float((a * a).sum())\n"
+            + "def work_io():\n"
+            + "    Thread.sleep(1)\n"
+            + "_mixed = [work_python, work_java, work_io]\n"
+            + "_next = [0]\n"
+            + "def work_mixed():\n"
+            + "    _next[0] = (_next[0] + 1) % len(_mixed)\n"
+            + "    return _mixed[_next[0]]()\n";
+
+    /**
+     * Counts of nanoseconds in buckets a power of two wide, enough for
+     * percentiles of GIL waits that range from nothing to seconds.
+     */
+    static class Histogram {
+
+        private final long[] counts = new long[64];
+
+        private long total = 0;
+
+        void record(long nanos) {
+            int bucket = 64 - Long.numberOfLeadingZeros(Math.max(nanos, 0));
+            counts[bucket]++;
+            total++;
+        }
+
+        void add(Histogram other) {
+            for (int i = 0; i < counts.length; i++)
+                counts[i] += other.counts[i];
+            total += other.total;
+        }
+
+        // the upper end of the bucket holding the fraction of values
+        long percentile(double fraction) {
+            long seen = 0;
+            for (int i = 0; i < counts.length; i++) {
+                seen += counts[i];
+                if (total > 0 && seen >= total * fraction)
+                    return i == 0 ? 0 : 1L << i;
+            }
+            return 0;
+        }
+    }
+
+    /**
+     * A thread with its own Jep running the workload until stopped.
+     */
+    static class Worker extends Thread {
+
+        private final String workload;
+
+        private final CyclicBarrier start;
+
+        private volatile boolean running = true;
+
+        final Histogram gilWaits = new Histogram();
+
+        long ops = 0;
+
+        long gilWaitNanos = 0;
+
+        long cpuNanos = 0;
+
+        Throwable error = null;
+
+        Worker(String workload, CyclicBarrier start) {
+            super("jep-worker");
+            this.workload = workload;
+            this.start = start;
+        }
+
+        void finish() {
+            running = false;
+        }
+
+        @Override
+        public void run() {
+            Jep jep = null;
+            ThreadMXBean threads = ManagementFactory.getThreadMXBean();
+            try {
+                JepConfig config = new JepConfig();
+                // numpy can only be imported once per process
+                if ("numpy".equals(workload))
+                    config.addSharedModules("numpy");
+                jep = new Jep(config);
+                jep.eval(WORKLOADS);
+                jep.setStatsEnabled(true);
+                JepStats stats = jep.getStats();
+                String function = "work_" + workload;
+                for (int i = 0; i < 10; i++)
+                    jep.invoke(function);
+
+                boolean cpu = threads.isCurrentThreadCpuTimeSupported();
+                long startWait = stats.getGilWaitNanos();
+                start.await();
+                long startCpu = cpu ? threads.getCurrentThreadCpuTime() : 0;
+                while (running) {
+                    long before = stats.getGilWaitNanos();
+                    jep.invoke(function);
+                    gilWaits.record(stats.getGilWaitNanos() - before);
+                    ops++;
+                }
+                gilWaitNanos = stats.getGilWaitNanos() - startWait;
+                // waiting for the GIL or in Thread.sleep uses no CPU
+                cpuNanos = cpu ? threads.getCurrentThreadCpuTime() - startCpu
+                        : -1;
+            } catch (Throwable t) {
+                error = t;
+                // don't leave the others waiting on the barrier
+                start.reset();
+            } finally {
+                if (jep != null)
+                    jep.close();
+            }
+        }
+    }
+
+    /**
+     * The totals of one run of some number of threads.
+     */
+    static class Result {
+
+        int threads;
+
+        double seconds;
+
+        long ops;
+
+        long gilWaitNanos;
+
+        // -1 if thread CPU time isn't supported
+        long cpuNanos;
+
+        long globalRefs;
+
+        final Histogram gilWaits = new Histogram();
+
+        double opsPerSecond() {
+            return ops / seconds;
+        }
+    }
+
+    /**
+     * Runs threads for some seconds, calling sample every sampleSeconds if
+     * it isn't null.
+     */
+    static Result run(int threads, String workload, double seconds,
+            Runnable sample, double sampleSeconds) throws Exception {
+        CyclicBarrier start = new CyclicBarrier(threads + 1);
+        List<Worker> workers = new ArrayList<Worker>();
+        for (int i = 0; i < threads; i++) {
+            Worker w = new Worker(workload, start);
+            workers.add(w);
+            w.start();
+        }
+
+        start.await();
+        long begin = System.nanoTime();
+        long end = begin + (long) (seconds * 1e9);
+        long nextSample = begin + (long) (sampleSeconds * 1e9);
+        long now;
+        while ((now = System.nanoTime()) < end) {
+            if (sample != null && now >= nextSample) {
+                sample.run();
+                nextSample += (long) (sampleSeconds * 1e9);
+            }
+            Thread.sleep(Math.max(1, Math.min(100, (end - now) / 1000000)));
+        }
+        for (Worker w : workers)
+            w.finish();
+
+        Result result = new Result();
+        result.threads = threads;
+        result.seconds = (System.nanoTime() - begin) / 1e9;
+        for (Worker w : workers) {
+            w.join();
+            if (w.error != null)
+                throw new JepException("Worker failed: " + w.error, w.error);
+            result.ops += w.ops;
+            result.gilWaitNanos += w.gilWaitNanos;
+            if (w.cpuNanos < 0 || result.cpuNanos < 0)
+                result.cpuNanos = -1;
+            else
+                result.cpuNanos += w.cpuNanos;
+            result.gilWaits.add(w.gilWaits);
+        }
+        // process wide, the workers' interpreters are closed by now
+        result.globalRefs = Jep.getLiveCounts().getGlobalRefs();
+        return result;
+    }
+
+    // resident set size in kilobytes from /proc, -1 where there is none
+    static long rssKb() {
+        BufferedReader in = null;
+        try {
+            in = new BufferedReader(new FileReader("/proc/self/status"));
+            String line;
+            while ((line = in.readLine()) != null) {
+                if (line.startsWith("VmRSS:"))
+                    return Long.parseLong(line.replaceAll("[^0-9]", ""));
+            }
+        } catch (IOException e) {
+            // not linux
+        } finally {
+            if (in != null) {
+                try {
+                    in.close();
+                } catch (IOException e) {
+                    // ignore
+                }
+            }
+        }
+        return -1;
+    }
+
+    static long heapKb() {
+        Runtime rt = Runtime.getRuntime();
+        return (rt.totalMemory() - rt.freeMemory()) / 1024;
+    }
+
+    /**
+     * @param args
+     *            see the class description
+     * @throws Exception
+     */
+    public static void main(String[] args) throws Exception {
+        String threadList = "1,2,4,8,16,32,64";
+        String workload = "mixed";
+        double seconds = 5;
+        double soakMinutes = 0;
+        String jsonFile = null;
+        for (int i = 0; i + 1 < args.length; i += 2) {
+            if ("-threads".equals(args[i]))
+                threadList = args[i + 1];
+            else if ("-workload".equals(args[i]))
+                workload = args[i + 1];
+            else if ("-seconds".equals(args[i]))
+                seconds = Double.parseDouble(args[i + 1]);
+            else if ("-soak".equals(args[i]))
+                soakMinutes = Double.parseDouble(args[i + 1]);
+            else if ("-json".equals(args[i]))
+                jsonFile = args[i + 1];
+            else
+                throw new IllegalArgumentException("Unknown option " + args[i]);
+        }
+
+        StringBuilder json = new StringBuilder("{\"workload\": \"")
+                .append(workload).append("\", \"scaling\": [");
+        System.out.println("workload: " + workload);
+        System.out.println(String.format(
+                "%8s %12s %8s %10s %10s %10s %10s %10s", "threads", "ops/s",
+                "speedup", "wait p50", "wait p99", "wait p999", "gil wait%",
+                "gil busy%"));
+        double base = 0;
+        int maxThreads = 1;
+        String[] counts = threadList.split(",");
+        for (int i = 0; i < counts.length; i++) {
+            int threads = Integer.parseInt(counts[i].trim());
+            maxThreads = Math.max(maxThreads, threads);
+            Result r = run(threads, workload, seconds, null, 0);
+            if (base == 0)
+                base = r.opsPerSecond() / threads;
+            double speedup = r.opsPerSecond() / base;
+            // share of the threads' time spent waiting for the GIL
+            double waitShare = 100.0 * r.gilWaitNanos
+                    / (r.seconds * 1e9 * threads);
+            /*
+             * share of the run some thread held the GIL, by the CPU the
+             * workers used. Java code run without the GIL, like the java
+             * workload's appends, is counted as well.
+             */
+            double busyShare = r.cpuNanos < 0 ? -1 : 100.0
+                    * r.cpuNanos / (r.seconds * 1e9);
+            System.out.println(String.format(
+                    "%8d %12.1f %8.2f %10d %10d %10d %9.1f%% %9.1f%%",
+                    threads, r.opsPerSecond(), speedup,
+                    r.gilWaits.percentile(0.5), r.gilWaits.percentile(0.99),
+                    r.gilWaits.percentile(0.999), waitShare, busyShare));
+            json.append(i == 0 ? "" : ", ").append(String.format(
+                    "{\"threads\": %d, \"opsPerSecond\": %.1f, "
+                            + "\"speedup\": %.3f, \"gilWaitP50\": %d, "
+                            + "\"gilWaitP99\": %d, \"gilWaitP999\": %d, "
+                            + "\"gilWaitShare\": %.2f, \"gilBusyShare\": %.2f}",
+                    threads, r.opsPerSecond(), speedup,
+                    r.gilWaits.percentile(0.5), r.gilWaits.percentile(0.99),
+                    r.gilWaits.percentile(0.999), waitShare, busyShare));
+        }
+        json.append("]");
+
+        if (soakMinutes > 0) {
+            System.out.println("soaking " + maxThreads + " threads for "
+                    + soakMinutes + " minutes");
+            System.out.println(String.format("%10s %12s %12s", "seconds",
+                    "rss KB", "heap KB"));
+            final long soakStart = System.nanoTime();
+            final List<long[]> samples = new ArrayList<long[]>();
+            Runnable sample = new Runnable() {
+                @Override
+                public void run() {
+                    System.gc();
+                    long[] s = { (System.nanoTime() - soakStart) / 1000000000,
+                            rssKb(), heapKb() };
+                    samples.add(s);
+                    System.out.println(String.format("%10d %12d %12d", s[0],
+                            s[1], s[2]));
+                }
+            };
+            sample.run();
+            Result r = run(maxThreads, workload, soakMinutes * 60, sample, 10);
+            sample.run();
+
+            long[] first = samples.get(0);
+            long[] last = samples.get(samples.size() - 1);
+            System.out.println(String.format(
+                    "soak: %d ops, %.1f ops/s, rss %+d KB, heap %+d KB, "
+                            + "global refs left %d", r.ops,
+                    r.opsPerSecond(), last[1] - first[1], last[2] - first[2],
+                    r.globalRefs));
+            json.append(", \"soak\": {\"threads\": ").append(maxThreads)
+                    .append(", \"ops\": ").append(r.ops)
+                    .append(", \"samples\": [");
+            for (int i = 0; i < samples.size(); i++) {
+                long[] s = samples.get(i);
+                json.append(i == 0 ? "" : ", ").append("[").append(s[0])
+                        .append(", ").append(s[1]).append(", ").append(s[2])
+                        .append("]");
+            }
+            json.append("]}");
+        }
+        json.append("}");
+
+        if (jsonFile != null) {
+            FileWriter out = new FileWriter(jsonFile);
+            try {
+                out.write(json.toString());
+            } finally {
+                out.close();
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+from distutils.cmd import Command
+from distutils.spawn import spawn
+from commands.util import is_windows
+from commands.util import configure_error
+import os
+import shlex
+
+class benchmark(Command):
+    description = "run the python to java microbenchmarks"
+
+    user_options = [
+        ('args=', 'a', "arguments for tests/benchmark.py, e.g. a name filter or --json file"),
+        ]
+
+    def initialize_options(self):
+        self.args = ''
+
+    def finalize_options(self):
+        pass
+
+    def run(self):
+        os.environ['CLASSPATH'] = 'build/java/jep.test-{0}.jar{1}tests/lib/sqlitejdbc-v056.jar'.format(self.distribution.metadata.get_version(), os.pathsep)
+        args = shlex.split(self.args)
+        if is_windows():
+            # Use full path as spawn will only search the system PATH for *.exe on Windows
+            if 'VIRTUAL_ENV' in os.environ:
+                py_loc = os.environ['VIRTUAL_ENV']
+            else:
+                if 'PYTHONHOME' in os.environ:
+                    py_loc = os.environ['PYTHONHOME']
+                else:
+                    configure_error('Please set the environment variable PYTHONHOME for running the benchmarks on Windows without a virtualenv.')
+            spawn(['{0}\Scripts\jep.bat'.format(py_loc), 'tests/benchmark.py'] + args, search_path=0)
+        else:
+            spawn(['jep', 'tests/benchmark.py'] + args)
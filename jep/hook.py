@@ -23,6 +23,29 @@ class module(ModuleType):
             setattr(self, name, clazz)
             return clazz
 
+    def __dir__(self):
+        # include the classes that haven't been loaded yet
+        names = set(self.__dict__)
+        names.update(self.__dict__.get('_classnames', ()))
+        return sorted(names)
+
+    @property
+    def __all__(self):
+        # for "from package import *", only the classes that load
+        names = self.__dict__.get('_classnames')
+        if names is None:
+            return [n for n in self.__dict__ if not n.startswith('_')]
+        if '_loadable' not in self.__dict__:
+            loadable = []
+            for name in names:
+                try:
+                    getattr(self, name)
+                except Exception:
+                    continue
+                loadable.append(name)
+            self.__dict__['_loadable'] = loadable
+        return self.__dict__['_loadable']
+
 
 class JepImporter(object):
     def __init__(self, classlist=None):
@@ -52,15 +75,12 @@ class JepImporter(object):
             sys.modules[fullname] = mod
 
             if self.classlist.supportsPackageImport():
-                # get the list of classes in package and add them as attributes
-                # to the module
+                # get the list of classes in package, they're loaded by
+                # __getattr__ the first time they're used
                 classlist = self.classlist.getClassNames(fullname)
                 if classlist:
-                    for name in classlist:
-                        try:
-                            setattr(mod, name.split('.')[-1], forName(name))
-                        except Exception:
-                            pass
+                    mod._classnames = [name.split('.')[-1]
+                                       for name in classlist]
         else:
             # It's a Java class, in general we will only reach here if
             # self.classlist.supportsPackageImport() is False (ie the class
@@ -0,0 +1,90 @@
+"""Reports on the calls to Java profiled by Jep.
+
+Start profiling with jep.setProfiling(True) from Python or
+Jep.setProfilingEnabled(true) from Java.  Every call to a Java method or
+constructor is then timed in three phases: args, converting the Python
+arguments to Java; java, the Java call itself; and result, converting what
+Java returned to Python.  dump() reports on them as a table, as JSON or in
+the folded format read by flame graph tools.
+"""
+
+import json
+
+from _jep import profileData
+
+PHASES = ('args', 'java', 'result')
+
+
+def percentile(histogram, fraction):
+    """The nanoseconds below which fraction of the calls in a histogram
+    of (low, high, count) buckets took, as the high end of the bucket."""
+    total = sum(count for low, high, count in histogram)
+    if not total:
+        return 0
+    seen = 0
+    for low, high, count in histogram:
+        seen += count
+        if seen >= total * fraction:
+            return high
+    return histogram[-1][1]
+
+
+def summary():
+    """A list of a dict per profiled method, slowest total first, with the
+    calls, errors and per phase the total, mean, p50, p99 and max
+    nanoseconds."""
+    methods = []
+    for data in profileData():
+        calls = data['calls']
+        entry = {'method': data['method'],
+                 'calls': calls,
+                 'errors': data['errors'],
+                 'total': 0}
+        for name in PHASES:
+            phase = data[name]
+            entry[name] = {'total': phase['total'],
+                           'mean': phase['total'] // calls if calls else 0,
+                           'p50': percentile(phase['histogram'], 0.50),
+                           'p99': percentile(phase['histogram'], 0.99),
+                           'max': phase['max'],
+                           'histogram': phase['histogram']}
+            entry['total'] += phase['total']
+        methods.append(entry)
+    methods.sort(key=lambda m: m['total'], reverse=True)
+    return methods
+
+
+def table(methods):
+    lines = ['%-60s %10s %7s %12s %10s %10s %10s %10s' %
+             ('method', 'calls', 'errors', 'total ns',
+              'args p50', 'java p50', 'java p99', 'result p50')]
+    for m in methods:
+        lines.append('%-60s %10d %7d %12d %10d %10d %10d %10d' %
+                     (m['method'], m['calls'], m['errors'], m['total'],
+                      m['args']['p50'], m['java']['p50'], m['java']['p99'],
+                      m['result']['p50']))
+    return '\n'.join(lines)
+
+
+def folded(methods):
+    # one line per method and phase, nanoseconds as the sample count
+    lines = []
+    for m in methods:
+        for name in PHASES:
+            if m[name]['total']:
+                lines.append('%s;%s %d' % (m['method'], name,
+                                           m[name]['total']))
+    return '\n'.join(lines)
+
+
+def dump(format='table'):
+    """The profiled calls as a string, format is 'table', 'json' or
+    'folded'."""
+    methods = summary()
+    if format == 'table':
+        return table(methods)
+    if format == 'json':
+        return json.dumps(methods, indent=2)
+    if format == 'folded':
+        return folded(methods)
+    raise ValueError('Unknown profile format: ' + str(format))
@@ -0,0 +1,90 @@
+from _jep import sharedImport
+import sys
+
+try:
+    from importlib.machinery import ModuleSpec
+except ImportError:
+    # before python 3.4 find_module and load_module are used
+    ModuleSpec = None
+
+
+class SharedImporter(object):
+    """Import shared modules from the top interpreter.
+
+    Modules named in sharedModules, and their submodules, are imported
+    once in the top Python interpreter and every sub-interpreter that
+    imports them gets the same module objects.  This avoids importing
+    large libraries such as numpy in each sub-interpreter, and some
+    CPython extensions only work correctly if initialized once.
+    """
+
+    def __init__(self, sharedModules):
+        self.sharedModules = set(str(m) for m in sharedModules)
+        # the specs of shared modules while they're being imported here
+        self.topSpecs = {}
+
+    def isShared(self, fullname):
+        return fullname.split('.')[0] in self.sharedModules
+
+    def find_spec(self, fullname, path=None, target=None):
+        if self.isShared(fullname):
+            return ModuleSpec(fullname, self)
+        return None
+
+    def create_module(self, spec):
+        module = self.sharedImport(spec.name)
+        # the import system sets __spec__ to ours, which must not stay on
+        # a module the top interpreter owns
+        self.topSpecs[spec.name] = getattr(module, '__spec__', None)
+        return module
+
+    def exec_module(self, module):
+        # already run in the top interpreter
+        name = module.__name__
+        if name in self.topSpecs:
+            module.__spec__ = self.topSpecs.pop(name)
+
+    def find_module(self, fullname, path=None):
+        if self.isShared(fullname):
+            return self
+        return None
+
+    def load_module(self, fullname):
+        if fullname in sys.modules:
+            return sys.modules[fullname]
+        return self.sharedImport(fullname)
+
+    def sharedImport(self, fullname):
+        # includes any submodules loaded along the way, a package
+        # can't work without them
+        modules = sharedImport(fullname)
+        for name, mod in modules.items():
+            if name not in sys.modules:
+                sys.modules[name] = mod
+        return modules[fullname]
+
+
+def setupImporter(sharedModules):
+    for importer in sys.meta_path:
+        if isinstance(importer, SharedImporter):
+            importer.sharedModules.update(str(m) for m in sharedModules)
+            return
+    # ahead of the path importers so they don't load a private copy
+    sys.meta_path.insert(0, SharedImporter(sharedModules))
+
+
+def teardownImporter():
+    """Remove the shared modules from this interpreter's sys.modules.
+
+    Ending a sub-interpreter clears the dict of every module in its
+    sys.modules, which would break the shared modules for the top
+    interpreter and every other Jep still using them.  Called when a Jep
+    closes.
+    """
+    for importer in sys.meta_path:
+        if isinstance(importer, SharedImporter):
+            for name in list(sys.modules):
+                if importer.isShared(name):
+                    del sys.modules[name]
+            sys.meta_path.remove(importer)
+            return
@@ -20,6 +20,7 @@ from commands.java import build_java, build_javah, get_java_home, get_java_inclu
 from commands.python import get_python_libs, get_python_linker_args
 from commands.scripts import build_scripts
 from commands.test import test
+from commands.benchmark import benchmark
 from commands.util import is_windows
 from commands.build_ext import build_ext
 
@@ -114,7 +115,9 @@ if __name__ == '__main__':
           javah_files=[   # tuple containing class and the header file to output
               ('jep.Jep', 'jep.h'),
               ('jep.python.PyObject', 'jep_object.h'),
+              ('jep.python.PySlot', 'jep_slot.h'),
               ('jep.InvocationHandler', 'invocationhandler.h'),
+              ('jep.GeneratedProxy', 'generatedproxy.h'),
           ],
           distclass=JepDistribution,
           cmdclass={
@@ -128,6 +131,7 @@ if __name__ == '__main__':
               'install_lib': jep_install,
               'clean': really_clean,
               'test': test,
+              'benchmark': benchmark,
           },
     )
 
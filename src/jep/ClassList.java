@@ -25,50 +25,113 @@
 package jep;
 
 import java.io.BufferedReader;
+import java.io.BufferedWriter;
 import java.io.File;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
 import java.io.IOException;
-import java.io.InputStream;
 import java.io.InputStreamReader;
+import java.io.OutputStreamWriter;
+import java.io.Writer;
 import java.net.URL;
 import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.Enumeration;
-import java.util.HashMap;
-import java.util.Set;
+import java.util.List;
+import java.util.Map;
 import java.util.StringTokenizer;
+import java.util.concurrent.ConcurrentHashMap;
 import java.util.jar.JarEntry;
 import java.util.jar.JarFile;
 
 /**
+ * <p>
  * A singleton that searches for loaded classes from the JRE and the Java
  * classpath. This is the default ClassEnquirer that is used if no ClassEnquirer
  * is specified when constructing Jep instances. ClassList is also used by the
  * command line <code>jep</code> script.
+ * </p>
+ * 
+ * <p>
+ * Nothing is loaded until the first lookup, which reads all class names into
+ * one sorted array, so a package is a binary search away. The class names of
+ * each package are only gathered the first time that package is asked for. If the <code>jep.classlist.cache</code>
+ * system property names a directory, the class names found in each jar on the
+ * classpath are cached there and reused until the jar changes. There is no
+ * cache by default.
+ * </p>
  * 
  * @author [mrjohnson0 at sourceforge.net] Mike Johnson
  * @version $Id$
  */
 public class ClassList implements ClassEnquirer {
 
+    private static final String CACHE_PROPERTY = "jep.classlist.cache";
+
+    // written at the top of jar cache files, bump if the format changes
+    private static final String CACHE_VERSION = "jep-classlist-1";
+
+    private static final String[] EMPTY = new String[0];
+
     private static ClassList inst;
 
-    // storage for package, members
-    private static HashMap<String, ArrayList<String>> packages = new HashMap<String, ArrayList<String>>();
+    // the bundled list of JRE classes, found by getInstance()
+    private final URL classListResource;
+
+    // fully qualified class names, sorted
+    private String[] classes = null;
+
+    // classes that aren't in a package
+    private String[] defaultClasses = null;
+
+    // package name to class names, filled in as packages are asked for
+    private final Map<String, String[]> packages = new ConcurrentHashMap<String, String[]>();
+
+    private ClassList(URL classListResource) {
+        this.classListResource = classListResource;
+    }
+
+    // load everything, once, on the first lookup
+    private synchronized String[] getClasses() {
+        if (this.classes == null) {
+            List<String> names = new ArrayList<String>(8192);
+            loadClassPath(names);
+            loadPackages(names);
+            loadClassList(names);
+
+            String[] sorted = names.toArray(new String[names.size()]);
+            Arrays.sort(sorted);
+
+            // dedupe in place, split off the default package
+            List<String> defaults = new ArrayList<String>();
+            int count = 0;
+            for (int i = 0; i < sorted.length; i++) {
+                if (i > 0 && sorted[i].equals(sorted[i - 1]))
+                    continue;
+                if (sorted[i].indexOf('.') < 0) {
+                    defaults.add(sorted[i]);
+                    continue;
+                }
+                sorted[count++] = sorted[i];
+            }
 
-    private ClassList() throws JepException {
-        loadClassPath();
-        loadPackages();
-        loadClassList();
+            this.defaultClasses = defaults.toArray(new String[defaults.size()]);
+            this.classes = Arrays.copyOf(sorted, count);
+        }
+        return this.classes;
     }
 
     /**
      * load jar files from class path
      * 
      */
-    private void loadClassPath() {
+    private void loadClassPath(List<String> names) {
         StringTokenizer tok = new StringTokenizer(
                 System.getProperty("java.class.path"),
                 System.getProperty("path.separator"));
 
+        File cacheDir = getCacheDir();
+
         while (tok.hasMoreTokens()) {
             String el = tok.nextToken();
 
@@ -80,7 +143,16 @@ public class ClassList implements ClassEnquirer {
             if (!file.exists() || !file.canRead())
                 continue;
 
+            File cacheFile = null;
+            if (cacheDir != null) {
+                cacheFile = new File(cacheDir, Integer.toHexString(file
+                        .getAbsolutePath().hashCode()) + ".txt");
+                if (readJarCache(file, cacheFile, names))
+                    continue;
+            }
+
             try {
+                List<String> jarNames = new ArrayList<String>();
                 JarFile jfile = new JarFile(el, false);
                 Enumeration<JarEntry> entries = jfile.entries();
                 while (entries.hasMoreElements()) {
@@ -92,20 +164,15 @@ public class ClassList implements ClassEnquirer {
                     // ent.getName() looks like:
                     // blah.class
                     // jep/ClassList.class
-                    int end = ent.getName().lastIndexOf('/');
-                    String pname = "default";
-                    if (end > 0) {
-                        pname = ent.getName().substring(0, end)
-                                .replace('/', '.');
-                    }
-
-                    String cname = stripClassExt(ent.getName().substring(
-                            end + 1));
-
-                    addClass(pname, cname);
+                    jarNames.add(stripClassExt(ent.getName()).replace('/',
+                            '.'));
                 }
 
                 jfile.close();
+                names.addAll(jarNames);
+
+                if (cacheFile != null)
+                    writeJarCache(file, cacheFile, jarNames);
             } catch (IOException e) {
                 // debugging only
                 e.printStackTrace();
@@ -113,13 +180,95 @@ public class ClassList implements ClassEnquirer {
         }
     }
 
+    // null if the cache isn't turned on or is unusable
+    private static File getCacheDir() {
+        String dir = System.getProperty(CACHE_PROPERTY);
+        if (dir == null || dir.length() == 0)
+            return null;
+
+        File file = new File(dir);
+        if (!file.isDirectory())
+            file.mkdirs();
+        if (!file.isDirectory() || !file.canWrite())
+            return null;
+        return file;
+    }
+
+    // the header identifies the jar, so a stale or colliding file is ignored
+    private static String jarCacheHeader(File jar) {
+        return CACHE_VERSION + " " + jar.lastModified() + " " + jar.length()
+                + " " + jar.getAbsolutePath();
+    }
+
+    // returns true if the cache was valid and its names were added
+    private static boolean readJarCache(File jar, File cacheFile,
+            List<String> names) {
+        if (!cacheFile.isFile())
+            return false;
+
+        BufferedReader reader = null;
+        try {
+            reader = new BufferedReader(new InputStreamReader(
+                    new FileInputStream(cacheFile), "UTF-8"));
+            if (!jarCacheHeader(jar).equals(reader.readLine()))
+                return false;
+
+            List<String> jarNames = new ArrayList<String>();
+            String line;
+            while ((line = reader.readLine()) != null)
+                jarNames.add(line);
+            names.addAll(jarNames);
+            return true;
+        } catch (IOException e) {
+            return false;
+        } finally {
+            try {
+                if (reader != null)
+                    reader.close();
+            } catch (IOException ee) {
+                // ignore
+            }
+        }
+    }
+
+    // best effort, a failure just means scanning the jar next time
+    private static void writeJarCache(File jar, File cacheFile,
+            List<String> jarNames) {
+        File temp = new File(cacheFile.getPath() + ".tmp");
+        Writer writer = null;
+        try {
+            writer = new BufferedWriter(new OutputStreamWriter(
+                    new FileOutputStream(temp), "UTF-8"));
+            writer.write(jarCacheHeader(jar));
+            writer.write('\n');
+            for (String name : jarNames) {
+                writer.write(name);
+                writer.write('\n');
+            }
+            writer.close();
+            writer = null;
+
+            cacheFile.delete();
+            temp.renameTo(cacheFile);
+        } catch (IOException e) {
+            temp.delete();
+        } finally {
+            try {
+                if (writer != null)
+                    writer.close();
+            } catch (IOException ee) {
+                // ignore
+            }
+        }
+    }
+
     /**
      * the jre will tell us about what jar files it has open. use that facility
      * to get a list of packages. then read the files ourselves since java won't
      * share.
      * 
      */
-    private void loadPackages() throws JepException {
+    private void loadPackages(List<String> names) {
         ClassLoader cl = this.getClass().getClassLoader();
 
         Package[] ps = Package.getPackages();
@@ -134,17 +283,20 @@ public class ClassList implements ClassEnquirer {
             try {
                 dir = new File(url.toURI());
             } catch (java.net.URISyntaxException e) {
-                throw new JepException(e);
+                // debugging only
+                e.printStackTrace();
+                continue;
             }
 
             for (File classfile : dir.listFiles(new ClassFilenameFilter()))
-                addClass(p.getName(), stripClassExt(classfile.getName()));
+                names.add(p.getName() + "."
+                        + stripClassExt(classfile.getName()));
         }
     }
 
     // don't pass me nulls.
     // strips .class from a file name.
-    private String stripClassExt(String name) {
+    private static String stripClassExt(String name) {
         return name.substring(0, name.length() - 6);
     }
 
@@ -153,7 +305,7 @@ public class ClassList implements ClassEnquirer {
      * way to figure out what's in the java package, so this is my little hack.
      * 
      */
-    private void loadClassList() throws JepException {
+    private static URL findClassList() throws JepException {
         String version = System.getProperty("java.version");
 
         /*
@@ -175,23 +327,19 @@ public class ClassList implements ClassEnquirer {
         }
         rsc += ".txt";
 
-        InputStream in = null;
+        for (ClassLoader cl : classloadersToTry) {
+            URL url = cl == null ? null : cl.getResource(rsc);
+            if (url != null)
+                return url;
+        }
+        throw new JepException("ClassList couldn't find resource " + rsc);
+    }
+
+    private void loadClassList(List<String> names) {
         BufferedReader reader = null;
-        ClassLoader cl = null;
-        int i = 0;
         try {
-            while (in == null && i < classloadersToTry.length) {
-                cl = classloadersToTry[i];
-                in = cl.getResourceAsStream(rsc);
-                i++;
-            }
-
-            if (in == null) {
-                throw new JepException("ClassList couldn't find resource "
-                        + rsc);
-            }
-
-            reader = new BufferedReader(new InputStreamReader(in));
+            reader = new BufferedReader(new InputStreamReader(
+                    this.classListResource.openStream()));
 
             String line = "";
             while ((line = reader.readLine()) != null) {
@@ -200,21 +348,11 @@ public class ClassList implements ClassEnquirer {
                     continue;
 
                 // lines in the file look like: java/lang/String
-                // split on /
-                String[] parts = line.split("\\/");
-                StringBuilder pname = new StringBuilder();
-                String cname = parts[parts.length - 1];
-
-                for (i = 0; i < parts.length - 1; i++) {
-                    pname.append(parts[i]);
-                    if (i < parts.length - 2)
-                        pname.append(".");
-                }
-
-                addClass(pname.toString(), cname);
+                names.add(line.replace('/', '.'));
             }
         } catch (IOException e) {
-            throw new JepException(e);
+            // debugging only
+            e.printStackTrace();
         } finally {
             try {
                 if (reader != null)
@@ -225,45 +363,39 @@ public class ClassList implements ClassEnquirer {
         }
     }
 
-    // add a class with given package name
-    private void addClass(String pname, String cname) {
-        ArrayList<String> el = packages.get(pname.toString());
-        if (el == null)
-            el = new ArrayList<String>();
-
-        // convert to style we need in C code
-        if (pname.equals("default")) {
-            // don't use this package name, just the class
-            ;
-        } else
-            cname = pname + "." + cname;
-
-        // unlikely, but don't add a class twice.
-        if (el.indexOf(cname) > -1)
-            return;
-
-        el.add(cname);
-        packages.put(pname.toString(), el);
+    // index of the first class name >= key
+    private static int lowerBound(String[] sorted, String key) {
+        int idx = Arrays.binarySearch(sorted, key);
+        return idx < 0 ? -(idx + 1) : idx;
     }
 
     private String[] _get(String p) {
-        ArrayList<String> el = packages.get(p);
-        if (el == null) {
+        String[] ret = this.packages.get(p);
+        if (ret != null)
+            return ret;
 
-            // before we error out, find out if it really is a
-            // package. maybe it just doesn't have any classes in it.
+        String[] all = getClasses();
 
-            Set<String> keys = packages.keySet();
-            for (String key : keys) {
-                if (key.startsWith(p))
-                    return new String[0];
+        if (p.equals("default")) {
+            ret = this.defaultClasses;
+        } else {
+            // everything in the package or its subpackages sorts together
+            String prefix = p + ".";
+            int start = lowerBound(all, prefix);
+            if (start == all.length || !all[start].startsWith(prefix))
+                return null;
+
+            List<String> names = new ArrayList<String>();
+            for (int i = start; i < all.length && all[i].startsWith(prefix); i++) {
+                // skip subpackages, they may be the only thing in it
+                if (all[i].indexOf('.', prefix.length()) < 0)
+                    names.add(all[i]);
             }
-
-            return null;
+            ret = names.isEmpty() ? EMPTY : names.toArray(new String[names
+                    .size()]);
         }
 
-        String[] ret = new String[el.size()];
-        el.toArray(ret);
+        this.packages.put(p, ret);
         return ret;
     }
 
@@ -276,7 +408,8 @@ public class ClassList implements ClassEnquirer {
      */
     @Override
     public String[] getClassNames(String p) {
-        return _get(p);
+        String[] ret = _get(p);
+        return ret == null ? null : ret.clone();
     }
 
     /**
@@ -304,8 +437,10 @@ public class ClassList implements ClassEnquirer {
      *                if an error occurs
      */
     public static synchronized ClassList getInstance() throws JepException {
-        if (ClassList.inst == null)
-            ClassList.inst = new ClassList();
+        if (ClassList.inst == null) {
+            // the only failure that matters, lookups can't throw
+            ClassList.inst = new ClassList(findClassList());
+        }
         return ClassList.inst;
     }
 
@@ -0,0 +1,344 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep;
+
+import java.lang.reflect.Method;
+import java.lang.reflect.UndeclaredThrowableException;
+import java.util.Arrays;
+
+import jep.python.PyObject;
+
+/**
+ * Base class of the proxy classes generated by {@link ProxyGenerator}.
+ * 
+ * Each generated method stores its arguments with the arg methods, then
+ * calls the call method for its return type with its index. Primitives are
+ * passed to Python without boxing them and the result comes back unboxed.
+ * 
+ * <b>Internal use only.</b>
+ * 
+ * @version $Id: $
+ */
+public abstract class GeneratedProxy {
+
+    private final long tstate;
+
+    private final long target;
+
+    private final Jep jep;
+
+    // the interface methods, by the index the generated code passes
+    private final Method[] methods;
+
+    private final Dispatch[] dispatch;
+
+    /*
+     * arguments for the next call. doubles and floats are stored as their
+     * raw bits. only used from the jep's thread and read before python runs,
+     * so a callback calling back into the proxy can't clobber them.
+     */
+    private final long[] prims;
+
+    private final Object[] objs;
+
+    // if the target is a callable for a functional interface's method
+    private boolean functional = false;
+
+    // keeps ProxyGenerator's weakly cached entry for this class alive
+    Object generated;
+
+    /**
+     * The Python callable and conversions for a method, worked out on its
+     * first invocation.
+     */
+    private static final class Dispatch {
+
+        /*
+         * the bound python method, released once this proxy is collected.
+         * assigning a new method to the target afterwards isn't seen.
+         */
+        final long callable;
+
+        // type ids, boxed arguments are JDYNAMIC_ID
+        final int[] types;
+
+        final int returnTypeId;
+
+        // null to box the result like Jep.getValue(String)
+        final Class<?> returnType;
+
+        // if a JepException may be thrown as is
+        final boolean declaresJepException;
+
+        // how many objs to clear after the call
+        final int objects;
+
+        Dispatch(long callable, int[] types, int returnTypeId,
+                Class<?> returnType, boolean declaresJepException,
+                int objects) {
+            this.callable = callable;
+            this.types = types;
+            this.returnTypeId = returnTypeId;
+            this.returnType = returnType;
+            this.declaresJepException = declaresJepException;
+            this.objects = objects;
+        }
+    }
+
+    /**
+     * Creates a new <code>GeneratedProxy</code> instance.
+     * 
+     * @param tstate
+     *            the thread state id
+     * @param target
+     *            the python object's id
+     * @param jep
+     *            the jep interpreter
+     * @param methods
+     *            the methods the generated class implements
+     * @exception JepException
+     *                if an error occurs
+     */
+    protected GeneratedProxy(long tstate, long target, Jep jep,
+            Method[] methods) throws JepException {
+        this.tstate = tstate;
+        this.target = target;
+        this.jep = jep;
+        this.methods = methods;
+        this.dispatch = new Dispatch[methods.length];
+
+        int max = 0;
+        for (Method method : methods)
+            max = Math.max(max, method.getParameterTypes().length);
+        this.prims = new long[max];
+        this.objs = new Object[max];
+    }
+
+    /**
+     * Calls the target itself instead of its method of the same name, used
+     * for a Python callable passed as a functional interface.
+     */
+    void dispatchToTarget() {
+        this.functional = true;
+    }
+
+    protected final void checkThread() {
+        try {
+            this.jep.isValidThread();
+        } catch (JepException e) {
+            throw new UndeclaredThrowableException(e);
+        }
+    }
+
+    protected final void argLong(int i, long value) {
+        this.prims[i] = value;
+    }
+
+    protected final void argDouble(int i, double value) {
+        this.prims[i] = Double.doubleToRawLongBits(value);
+    }
+
+    protected final void argObject(int i, Object value) {
+        this.objs[i] = value;
+    }
+
+    protected final void callVoid(int index) {
+        Dispatch d = getDispatch(index);
+        try {
+            invokeVoid(this.tstate, d.callable, d.types, this.prims,
+                    this.objs);
+        } catch (JepException e) {
+            throw rethrow(d, e);
+        } finally {
+            clearObjects(d);
+        }
+    }
+
+    protected final long callLong(int index) {
+        Dispatch d = getDispatch(index);
+        try {
+            return invokeLong(this.tstate, d.callable, d.types, this.prims,
+                    this.objs, d.returnTypeId);
+        } catch (JepException e) {
+            throw rethrow(d, e);
+        } finally {
+            clearObjects(d);
+        }
+    }
+
+    protected final double callDouble(int index) {
+        Dispatch d = getDispatch(index);
+        try {
+            return invokeDouble(this.tstate, d.callable, d.types, this.prims,
+                    this.objs);
+        } catch (JepException e) {
+            throw rethrow(d, e);
+        } finally {
+            clearObjects(d);
+        }
+    }
+
+    protected final boolean callBoolean(int index) {
+        Dispatch d = getDispatch(index);
+        try {
+            return invokeBoolean(this.tstate, d.callable, d.types,
+                    this.prims, this.objs);
+        } catch (JepException e) {
+            throw rethrow(d, e);
+        } finally {
+            clearObjects(d);
+        }
+    }
+
+    protected final Object callObject(int index) {
+        Dispatch d = getDispatch(index);
+        try {
+            return invokeObject(this.tstate, d.callable, d.types,
+                    this.prims, this.objs, d.returnType);
+        } catch (JepException e) {
+            throw rethrow(d, e);
+        } finally {
+            clearObjects(d);
+        }
+    }
+
+    private Dispatch getDispatch(int index) {
+        // the generated method already called checkThread()
+        Dispatch d = this.dispatch[index];
+        if (d == null) {
+            try {
+                d = resolve(this.methods[index]);
+            } catch (JepException e) {
+                throw new UndeclaredThrowableException(e);
+            }
+            this.dispatch[index] = d;
+        }
+        return d;
+    }
+
+    // don't keep arguments alive after the call
+    private void clearObjects(Dispatch d) {
+        if (d.objects > 0)
+            Arrays.fill(this.objs, 0, d.objects, null);
+    }
+
+    /*
+     * Looks up the python method and the conversions once so the next calls
+     * don't have to.
+     */
+    private Dispatch resolve(Method method) throws JepException {
+        long callable;
+        if (this.functional) {
+            // lives as long as this proxy
+            callable = this.target;
+        } else {
+            callable = InvocationHandler.getCallable(this.tstate,
+                    this.target, method.getName());
+            jep.trackProxyTarget(this, new PyObject(this.tstate, callable,
+                    this.jep));
+        }
+
+        Class<?>[] params = method.getParameterTypes();
+        int[] types = new int[params.length];
+        int objects = 0;
+        for (int i = 0; i < params.length; i++) {
+            types[i] = InvocationHandler.getParameterTypeId(params[i]);
+            if (!params[i].isPrimitive()) {
+                // a box may be null, the native side looks at it instead
+                if (isPrimitiveId(types[i]))
+                    types[i] = Util.JDYNAMIC_ID;
+                objects = i + 1;
+            }
+        }
+
+        Class<?> returnType = method.getReturnType();
+        int returnTypeId = Util.JOBJECT_ID;
+        if (returnType == Void.TYPE)
+            returnTypeId = Util.JVOID_ID;
+        else if (returnType.isPrimitive())
+            returnTypeId = InvocationHandler.getParameterTypeId(returnType);
+        if (returnType.isPrimitive()
+                || !InvocationHandler.isConvertible(returnType))
+            returnType = null;
+
+        boolean declares = false;
+        for (Class<?> e : method.getExceptionTypes()) {
+            if (e.isAssignableFrom(JepException.class))
+                declares = true;
+        }
+
+        return new Dispatch(callable, types, returnTypeId, returnType,
+                declares, objects);
+    }
+
+    private static boolean isPrimitiveId(int typeId) {
+        switch (typeId) {
+        case Util.JBOOLEAN_ID:
+        case Util.JINT_ID:
+        case Util.JLONG_ID:
+        case Util.JDOUBLE_ID:
+        case Util.JSHORT_ID:
+        case Util.JFLOAT_ID:
+        case Util.JCHAR_ID:
+        case Util.JBYTE_ID:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /*
+     * The same as java.lang.reflect.Proxy, a checked exception the method
+     * doesn't declare is wrapped.
+     */
+    private static RuntimeException rethrow(Dispatch d, JepException e) {
+        if (d.declaresJepException)
+            GeneratedProxy.<RuntimeException> throwUnchecked(e);
+        return new UndeclaredThrowableException(e);
+    }
+
+    @SuppressWarnings("unchecked")
+    private static <T extends Throwable> void throwUnchecked(Throwable t)
+            throws T {
+        throw (T) t;
+    }
+
+    private static native void invokeVoid(long tstate, long callable,
+            int[] types, long[] prims, Object[] objs) throws JepException;
+
+    private static native long invokeLong(long tstate, long callable,
+            int[] types, long[] prims, Object[] objs, int returnType)
+            throws JepException;
+
+    private static native double invokeDouble(long tstate, long callable,
+            int[] types, long[] prims, Object[] objs) throws JepException;
+
+    private static native boolean invokeBoolean(long tstate, long callable,
+            int[] types, long[] prims, Object[] objs) throws JepException;
+
+    private static native Object invokeObject(long tstate, long callable,
+            int[] types, long[] prims, Object[] objs, Class<?> returnType)
+            throws JepException;
+}
@@ -25,6 +25,9 @@
 package jep;
 
 import java.lang.reflect.Method;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
 
 import jep.python.PyObject;
 
@@ -42,6 +45,43 @@ public class InvocationHandler implements java.lang.reflect.InvocationHandler {
 
     private Jep jep;
 
+    private static final Object[] NO_ARGS = new Object[0];
+
+    /*
+     * what each method invoked on the proxy resolved to. the proxy class
+     * hands us the same Method instance every time. only used from the
+     * jep's thread.
+     */
+    private final Map<Method, CachedMethod> methods = new HashMap<Method, CachedMethod>();
+
+    /**
+     * The Python callable, argument type ids and return conversion for a
+     * Method, worked out on its first invocation.
+     */
+    private static final class CachedMethod {
+
+        /*
+         * the bound python method, released once the proxy is collected.
+         * assigning a new method to the target afterwards isn't seen.
+         */
+        final long callable;
+
+        final int[] types;
+
+        // null to box the result like Jep.getValue(String)
+        final Class<?> returnType;
+
+        final boolean isVoid;
+
+        CachedMethod(long callable, int[] types, Class<?> returnType,
+                boolean isVoid) {
+            this.callable = callable;
+            this.types = types;
+            this.returnType = returnType;
+            this.isVoid = isVoid;
+        }
+    }
+
     /**
      * Creates a new <code>InvocationHandler</code> instance.
      *
@@ -60,15 +100,8 @@ public class InvocationHandler implements java.lang.reflect.InvocationHandler {
         this.target = ltarget;
         this.jep = jep;
 
-        // track target with jep.
-
-        // this ensures that our target doesn't get garbage collected,
-        // and since we can't have a close(), it'll get cleaned up.
-
-        // correction. object is now increfed before being returned to
-        // Java since in some cases the garbage collection could run
-        // before this.
-        jep.trackObject(new PyObject(this.tstate, this.target, this.jep), false);
+        // the target is increfed before being returned to Java, and
+        // jep.Proxy has the jep release it once the proxy is collected.
     }
 
     /**
@@ -120,20 +153,94 @@ public class InvocationHandler implements java.lang.reflect.InvocationHandler {
             throws Throwable {
         this.jep.isValidThread();
 
+        CachedMethod cached = methods.get(method);
+        if (cached == null) {
+            cached = resolve(proxy, method);
+            methods.put(method, cached);
+        }
+
         // java passes null args sometimes. *shrugs*
         if (args == null)
-            args = new Object[0];
+            args = NO_ARGS;
+
+        Object ret = invoke(this.tstate, cached.callable, args, cached.types,
+                cached.returnType);
+        if (cached.isVoid)
+            return null;
+        return ret;
+    }
+
+    /*
+     * Looks up the python method and the conversions once so the next calls
+     * don't have to.
+     */
+    private CachedMethod resolve(Object proxy, Method method)
+            throws JepException {
+        long callable = getCallable(this.tstate, this.target,
+                method.getName());
+        jep.trackProxyTarget(proxy, new PyObject(this.tstate, callable,
+                this.jep));
+
+        Class<?>[] params = method.getParameterTypes();
+        int[] types = new int[params.length];
+        for (int i = 0; i < params.length; i++)
+            types[i] = getParameterTypeId(params[i]);
 
-        // find typeid for args. it's easier in Java and I'm a lazy
-        // bastard.
-        int types[] = new int[args.length];
-        for (int i = 0; i < args.length; i++)
-            types[i] = Util.getTypeId(args[i]);
+        Class<?> returnType = method.getReturnType();
+        boolean isVoid = returnType == Void.TYPE;
+        if (isVoid || !isConvertible(returnType))
+            returnType = null;
 
-        return invoke(method.getName(), this.tstate, this.target, args, types,
-                Util.getTypeId(method.getReturnType()));
+        return new CachedMethod(callable, types, returnType, isVoid);
     }
 
-    private static native Object invoke(String name, long tstate, long target,
-            Object[] args, int[] types, int returnType);
+    /*
+     * Parameter types that decide the argument's type id. Anything else, like
+     * Object or an interface, could be passed any type.
+     */
+    static int getParameterTypeId(Class<?> clazz) {
+        if (clazz == Integer.TYPE || clazz == Integer.class)
+            return Util.JINT_ID;
+        if (clazz == Long.TYPE || clazz == Long.class)
+            return Util.JLONG_ID;
+        if (clazz == Double.TYPE || clazz == Double.class)
+            return Util.JDOUBLE_ID;
+        if (clazz == Float.TYPE || clazz == Float.class)
+            return Util.JFLOAT_ID;
+        if (clazz == Boolean.TYPE || clazz == Boolean.class)
+            return Util.JBOOLEAN_ID;
+        if (clazz == Short.TYPE || clazz == Short.class)
+            return Util.JSHORT_ID;
+        if (clazz == Byte.TYPE || clazz == Byte.class)
+            return Util.JBYTE_ID;
+        if (clazz == Character.TYPE || clazz == Character.class)
+            return Util.JCHAR_ID;
+        if (clazz == String.class)
+            return Util.JSTRING_ID;
+        if (clazz == Class.class)
+            return Util.JCLASS_ID;
+        if (clazz.isArray())
+            return Util.JARRAY_ID;
+        return Util.JDYNAMIC_ID;
+    }
+
+    /*
+     * Return types converted natively like Jep.getValue(String, Class),
+     * e.g. so an int method gets an Integer back instead of a Long. The
+     * rest are boxed like getValue(String) and left to the proxy to cast.
+     */
+    static boolean isConvertible(Class<?> clazz) {
+        return clazz == Integer.TYPE || clazz == Integer.class
+                || clazz == Long.TYPE || clazz == Long.class
+                || clazz == Double.TYPE || clazz == Double.class
+                || clazz == Boolean.TYPE || clazz == Boolean.class
+                || clazz == String.class || clazz.isArray()
+                || clazz == List.class || clazz == Map.class;
+    }
+
+    static native long getCallable(long tstate, long target,
+            String name) throws JepException;
+
+    private static native Object invoke(long tstate, long callable,
+            Object[] args, int[] types, Class<?> returnType);
 }
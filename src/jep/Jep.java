@@ -26,11 +26,19 @@ package jep;
 
 import java.io.Closeable;
 import java.io.File;
+import java.lang.ref.Reference;
+import java.lang.ref.ReferenceQueue;
+import java.lang.ref.WeakReference;
 import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.HashSet;
 import java.util.List;
+import java.util.Map;
+import java.util.Set;
 
 import jep.python.PyModule;
 import jep.python.PyObject;
+import jep.python.PySlot;
 
 /**
  * <p>
@@ -81,6 +89,61 @@ public final class Jep implements Closeable {
      */
     private final List<PyObject> pythonObjects = new ArrayList<PyObject>();
 
+    /*
+     * objects Java holds on to internally, such as proxy targets, their
+     * cached callables and compiled code. kept across reset(), only released
+     * on close.
+     */
+    private final List<PyObject> internalObjects = new ArrayList<PyObject>();
+
+    /*
+     * python callables of functional proxies, released once their proxy is
+     * garbage collected or this is closed.
+     */
+    private final Set<ProxyTarget> proxyTargets = new HashSet<ProxyTarget>();
+
+    private final ReferenceQueue<Object> proxyQueue = new ReferenceQueue<Object>();
+
+    private static class ProxyTarget extends WeakReference<Object> {
+
+        private final PyObject target;
+
+        ProxyTarget(Object proxy, PyObject target,
+                ReferenceQueue<Object> queue) {
+            super(proxy, queue);
+            this.target = target;
+        }
+    }
+
+    // slots created on this interpreter, see slot(String)
+    private final Set<PySlot> pythonSlots = new HashSet<PySlot>();
+
+    // runtime counters, created the first time they are enabled
+    private JepStats stats = null;
+
+    /*
+     * python exceptions held by JepExceptions that haven't been described
+     * yet, by pointer. released once the JepException is garbage collected
+     * or this is closed. guarded by exceptionLock, which is never held while
+     * calling native code that takes the GIL.
+     */
+    private final Map<Long, PendingException> pendingExceptions = new HashMap<Long, PendingException>();
+
+    private final Object exceptionLock = new Object();
+
+    private final ReferenceQueue<JepException> exceptionQueue = new ReferenceQueue<JepException>();
+
+    private static class PendingException extends WeakReference<JepException> {
+
+        private final long pyException;
+
+        PendingException(JepException e, long pyException,
+                ReferenceQueue<JepException> queue) {
+            super(e, queue);
+            this.pyException = pyException;
+        }
+    }
+
     /**
      * Tracks if this thread has been used for an interpreter before. Using
      * different interpreter instances on the same thread is iffy at best. If
@@ -248,6 +311,21 @@ public final class Jep implements Closeable {
      */
     public Jep(boolean interactive, String includePath, ClassLoader cl,
             ClassEnquirer ce) throws JepException {
+        this(new JepConfig().setInteractive(interactive)
+                .setIncludePath(includePath).setClassLoader(cl)
+                .setClassEnquirer(ce));
+    }
+
+    /**
+     * Creates a new <code>Jep</code> instance and its associated
+     * sub-interpreter.
+     * 
+     * @param config
+     *            the configuration for the sub-interpreter
+     * @exception JepException
+     *                if an error occurs
+     */
+    public Jep(JepConfig config) throws JepException {
         if (threadUsed.get()) {
             /*
              * TODO: Throw a JepException if this is detected. This is
@@ -266,18 +344,19 @@ public final class Jep implements Closeable {
             System.err.println(warning.toString());
         }
 
-        if (cl == null)
+        if (config.classLoader == null)
             this.classLoader = this.getClass().getClassLoader();
         else
-            this.classLoader = cl;
+            this.classLoader = config.classLoader;
 
-        this.interactive = interactive;
+        this.interactive = config.interactive;
         this.tstate = init(this.classLoader);
         threadUsed.set(true);
         this.thread = Thread.currentThread();
 
         // why write C code if you don't have to? :-)
-        if (includePath != null) {
+        if (config.includePath != null) {
+            String includePath = config.includePath.toString();
 
             // Added for compatibility with Windows file system
             if (includePath.contains("\\")) {
@@ -290,6 +369,13 @@ public final class Jep implements Closeable {
         }
 
         eval("import jep");
+        if (config.sharedModules != null && !config.sharedModules.isEmpty()) {
+            set("sharedModules", config.sharedModules);
+            eval("import jep.shared_modules_hook");
+            eval("jep.shared_modules_hook.setupImporter(sharedModules)");
+            eval("del sharedModules");
+        }
+        ClassEnquirer ce = config.classEnquirer;
         if (ce == null) {
             ce = ClassList.getInstance();
         }
@@ -297,6 +383,9 @@ public final class Jep implements Closeable {
         eval("jep.hook.setupImporter(classlist)");
         eval("del classlist");
         eval(null); // flush
+
+        // so reset() works without calling snapshot()
+        snapshot();
     }
 
     private native long init(ClassLoader classloader) throws JepException;
@@ -315,6 +404,7 @@ public final class Jep implements Closeable {
             throw new JepException("Invalid thread access.");
         if (this.tstate == 0)
             throw new JepException("Initialization failed.");
+        releaseCollectedExceptions();
     }
 
     /**
@@ -352,13 +442,97 @@ public final class Jep implements Closeable {
             throw new JepException("Invalid file: " + file.getAbsolutePath());
 
         setClassLoader(cl);
-        run(this.tstate, script);
+        Object event = beginEvent(JepEvents.RUN_SCRIPT);
+        try {
+            run(this.tstate, script);
+        } finally {
+            commitEvent(event, script);
+        }
     }
 
     private native void run(long tstate, String script) throws JepException;
 
     /**
-     * Invokes a Python function.
+     * <p>
+     * Sets a directory where {@link #runScript(String)} saves compiled
+     * scripts so later processes can skip compiling them. The most recently
+     * used compiled scripts are always cached in memory, shared by all Jep
+     * instances, and reused as long as the script is run by the same name
+     * and optimization level and its size and modification time don't
+     * change.
+     * </p>
+     * 
+     * @param dir
+     *            a directory path, or null to only cache in memory
+     * @exception JepException
+     *                if the directory can't be created or written to
+     */
+    public static void setScriptCacheDir(String dir) throws JepException {
+        if (dir != null) {
+            File file = new File(dir);
+            if (!file.isDirectory())
+                file.mkdirs();
+            if (!file.isDirectory() || !file.canWrite())
+                throw new JepException("Invalid script cache directory: "
+                        + file.getAbsolutePath());
+            dir = file.getAbsolutePath();
+        }
+
+        setCodeCacheDir(dir);
+    }
+
+    private static native void setCodeCacheDir(String dir);
+
+    /**
+     * Empties the compiled script cache and resets its counters. Files in
+     * the script cache directory are left alone.
+     */
+    public static void clearScriptCache() {
+        clearCodeCache();
+    }
+
+    private static native void clearCodeCache();
+
+    /**
+     * Gets the number of times {@link #runScript(String)} reused a compiled
+     * script.
+     * 
+     * @return number of cache hits
+     */
+    public static long getScriptCacheHits() {
+        return getCodeCacheStats()[0];
+    }
+
+    /**
+     * Gets the number of times {@link #runScript(String)} had to compile a
+     * script.
+     * 
+     * @return number of cache misses
+     */
+    public static long getScriptCacheMisses() {
+        return getCodeCacheStats()[1];
+    }
+
+    private static native long[] getCodeCacheStats();
+
+    /**
+     * Gets the number of live Python wrappers of Java objects, arrays,
+     * methods and fields, and of the JNI global references created and
+     * deleted, across every interpreter in the process. The counts are always
+     * kept, so a leak test can compare them before and after repeating some
+     * work, and a monitor can watch for global references growing.
+     * 
+     * @return the counts at the time of the call
+     */
+    public static JepLiveCounts getLiveCounts() {
+        return new JepLiveCounts(getLiveCountArray());
+    }
+
+    private static native long[] getLiveCountArray();
+
+    /**
+     * Invokes a Python function. A dotted name such as
+     * <code>obj.method</code> invokes an attribute of a global.
      * 
      * @param name
      *            must be a valid Python function name in globals dict
@@ -377,11 +551,75 @@ public final class Jep implements Closeable {
         for (int i = 0; i < args.length; i++)
             types[i] = Util.getTypeId(args[i]);
 
-        return invoke(this.tstate, name, args, types);
+        Object event = beginEvent(JepEvents.INVOKE);
+        try {
+            return invoke(this.tstate, name, args, types);
+        } catch (NoSuchMethodException e) {
+            throw new JepException(e.getMessage(), e);
+        } finally {
+            commitEvent(event, name);
+        }
+    }
+
+    /**
+     * Like {@link #invoke(String, Object...)} but a name that isn't found or
+     * isn't callable is a NoSuchMethodException, for javax.script.
+     */
+    Object invokeOrThrow(String name, Object... args) throws JepException,
+            NoSuchMethodException {
+        if (name == null || name.trim().equals(""))
+            throw new JepException("Invalid function name.");
+
+        int[] types = new int[args.length];
+
+        for (int i = 0; i < args.length; i++)
+            types[i] = Util.getTypeId(args[i]);
+
+        Object event = beginEvent(JepEvents.INVOKE);
+        try {
+            return invoke(this.tstate, name, args, types);
+        } finally {
+            commitEvent(event, name);
+        }
     }
 
     private native Object invoke(long tstate, String name, Object[] args,
-            int[] types);
+            int[] types) throws JepException, NoSuchMethodException;
+
+    /**
+     * Creates a proxy implementing an interface with the methods of a Python
+     * global, for javax.script.
+     * 
+     * @param name
+     *            a global, or an attribute of one like <code>obj.attr</code>,
+     *            or null to use the functions in the global scope
+     * @param iface
+     *            the interface to implement
+     * @return the proxy
+     * @exception JepException
+     *                if the name isn't found or the proxy can't be made
+     */
+    Object proxy(String name, Class<?> iface) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        // a new reference, the proxy owns it
+        long target = lookupGlobal(this.tstate, name);
+        ClassLoader loader = iface.getClassLoader();
+        if (loader == null)
+            loader = this.classLoader;
+        try {
+            return Proxy.newProxyInstance(this.tstate, target, this, loader,
+                    new Class<?>[] { iface });
+        } catch (IllegalArgumentException e) {
+            new PyObject(this.tstate, target, this).close();
+            throw new JepException(e);
+        }
+    }
+
+    private native long lookupGlobal(long tstate, String name)
+            throws JepException;
 
     /**
      * <p>
@@ -444,7 +682,13 @@ public final class Jep implements Closeable {
                     return true; // nothing to eval
 
                 // null means we send lines, whether or not it compiles.
-                eval(this.tstate, this.evalLines.toString());
+                String lines = this.evalLines.toString();
+                Object event = beginEvent(JepEvents.EVAL);
+                try {
+                    eval(this.tstate, lines);
+                } finally {
+                    commitEvent(event, lines);
+                }
                 this.evalLines = null;
                 return true;
             } else {
@@ -453,7 +697,12 @@ public final class Jep implements Closeable {
                         || (this.evalLines == null && compileString(
                                 this.tstate, str) == 1)) {
 
-                    eval(this.tstate, str);
+                    Object event = beginEvent(JepEvents.EVAL);
+                    try {
+                        eval(this.tstate, str);
+                    } finally {
+                        commitEvent(event, str);
+                    }
                     return true;
                 }
 
@@ -477,6 +726,83 @@ public final class Jep implements Closeable {
 
     private native void eval(long tstate, String str) throws JepException;
 
+    /**
+     * Executes Python statements from memory, the same as
+     * {@link #runScript(String)} but without a script file. Unlike
+     * {@link #eval(String)}, the source may contain any number of complete
+     * statements and is never buffered.
+     * 
+     * @param source
+     *            a <code>String</code> of Python statements
+     * @exception JepException
+     *                if an error occurs
+     */
+    public void exec(String source) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        if (source == null)
+            throw new JepException("Source cannot be null.");
+
+        exec(this.tstate, source.replaceAll("\r", ""));
+    }
+
+    private native void exec(long tstate, String source) throws JepException;
+
+    /**
+     * Compiles Python source into a code object that can be run any number of
+     * times with {@link #exec(PyObject)} without parsing it again. The code
+     * object is released when this Jep is closed.
+     * 
+     * @param source
+     *            a <code>String</code> of Python statements
+     * @param filename
+     *            the filename to report in tracebacks, may be null
+     * @return a <code>PyObject</code> holding the code object
+     * @exception JepException
+     *                if an error occurs
+     */
+    public PyObject compile(String source, String filename)
+            throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        if (source == null)
+            throw new JepException("Source cannot be null.");
+
+        // compile returns a new reference, don't incref again. code doesn't
+        // hold the globals so it can outlive reset()
+        return trackInternal(new PyObject(this.tstate, compile(this.tstate,
+                source.replaceAll("\r", ""), filename), this), false);
+    }
+
+    private native long compile(long tstate, String source, String filename)
+            throws JepException;
+
+    /**
+     * Runs a code object returned by {@link #compile(String, String)} in the
+     * sub-interpreter's global scope.
+     * 
+     * @param code
+     *            a <code>PyObject</code> from compile()
+     * @exception JepException
+     *                if an error occurs
+     */
+    public void exec(PyObject code) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        if (code == null)
+            throw new JepException("Code cannot be null.");
+
+        exec(this.tstate, code.getPointer());
+    }
+
+    private native void exec(long tstate, long code) throws JepException;
+
     /**
      * 
      * <p>
@@ -526,6 +852,163 @@ public final class Jep implements Closeable {
 
     private native Object getValue(long tstate, String str) throws JepException;
 
+    /**
+     * Retrieves a value from the sub-interpreter converted directly to the
+     * requested Java type. Unlike {@link #getValue(String)} the conversion
+     * is chosen by the requested type and nothing falls back to a String, a
+     * value that can't be converted raises a JepException instead. Supported
+     * types are:
+     * 
+     * <ul>
+     * <li>primitive arrays such as <code>long[]</code> and
+     * <code>double[]</code>, from Python sequences or numpy arrays. A
+     * <code>byte[]</code> is copied from any bytes-like object.</li>
+     * <li>object arrays such as <code>String[]</code>, converting each item
+     * to the component type</li>
+     * <li><code>List</code> and <code>Map</code>, from lists, tuples and
+     * dictionaries. The items are converted like
+     * {@link #getValue(String)}, generic types such as
+     * <code>Map&lt;String, Double&gt;</code> are erased and can't be
+     * checked.</li>
+     * <li><code>Long</code>, <code>Integer</code>, <code>Short</code> and
+     * <code>Byte</code> from a Python int that fits, <code>Double</code>
+     * and <code>Float</code> from an int or float, and
+     * <code>Character</code> from a one character str or an int char code.
+     * Their primitive classes work the same way, and also accept the boxed
+     * Java object.</li>
+     * <li><code>jep.NDArray</code>, from numpy arrays</li>
+     * <li><code>java.nio.ByteBuffer</code>, a direct buffer holding a copy of
+     * any bytes-like object</li>
+     * <li>any other type a Java object or {@link #getValue(String)} result is
+     * an instance of</li>
+     * </ul>
+     * 
+     * <pre>
+     * <code>
+     * jep.eval("x = [1, 2, 3]");
+     * long[] x = jep.getValue("x", long[].class);
+     * </code>
+     * </pre>
+     * 
+     * @param <T>
+     *            the type of the value
+     * @param str
+     *            the Python expression to evaluate in the sub-interpreter's
+     *            global scope
+     * @param clazz
+     *            the Java type to convert the value to
+     * @return the converted value, or null if the value is None
+     * @exception JepException
+     *                if an error occurs or the value cannot be converted,
+     *                including None to a primitive class
+     */
+    @SuppressWarnings("unchecked")
+    public <T> T getValue(String str, Class<T> clazz) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        // unchecked since long.class is a Class<Long> holding a Long
+        return (T) getValueAs(this.tstate, str, clazz);
+    }
+
+    private native Object getValueAs(long tstate, String str, Class<?> clazz)
+            throws JepException;
+
+    /**
+     * Retrieves several values from the sub-interpreter at once, each
+     * converted the same as {@link #getValue(String)}. The sub-interpreter is
+     * only entered once and plain variable names are looked up directly
+     * instead of being evaluated, so this is much cheaper than many separate
+     * calls to getValue.
+     * 
+     * @param names
+     *            the names of the Python variables, or Python expressions,
+     *            to get from the sub-interpreter's global scope
+     * @return the values in the same order as the names
+     * @exception JepException
+     *                if an error occurs
+     */
+    public Object[] getValues(String... names) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        return getValues(this.tstate, names);
+    }
+
+    private native Object[] getValues(long tstate, String[] names)
+            throws JepException;
+
+    /**
+     * Retrieves the value of a Python int as a Java <code>long</code> without
+     * boxing it. This is cheaper than {@link #getValue(String)} when it is
+     * called frequently. Floats are not truncated, they raise a JepException
+     * like None does.
+     * 
+     * @param str
+     *            the Python expression to evaluate in the sub-interpreter's
+     *            global scope
+     * @return the value as a <code>long</code>
+     * @exception JepException
+     *                if an error occurs or the value cannot be converted
+     */
+    public long getLong(String str) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        return getLong(this.tstate, str);
+    }
+
+    private native long getLong(long tstate, String str) throws JepException;
+
+    /**
+     * Retrieves the value of a Python float as a Java <code>double</code>
+     * without boxing it. This is cheaper than {@link #getValue(String)} when
+     * it is called frequently. Python ints and other objects that implement
+     * <code>__float__</code> are also accepted, None raises a JepException.
+     * 
+     * @param str
+     *            the Python expression to evaluate in the sub-interpreter's
+     *            global scope
+     * @return the value as a <code>double</code>
+     * @exception JepException
+     *                if an error occurs or the value cannot be converted
+     */
+    public double getDouble(String str) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        return getDouble(this.tstate, str);
+    }
+
+    private native double getDouble(long tstate, String str) throws JepException;
+
+    /**
+     * Retrieves the value of a Python bool as a Java <code>boolean</code>
+     * without boxing it. This is cheaper than {@link #getValue(String)} when
+     * it is called frequently. Only True and False are accepted, any other
+     * value including None raises a JepException.
+     * 
+     * @param str
+     *            the Python expression to evaluate in the sub-interpreter's
+     *            global scope
+     * @return the value as a <code>boolean</code>
+     * @exception JepException
+     *                if an error occurs or the value cannot be converted
+     */
+    public boolean getBoolean(String str) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        return getBoolean(this.tstate, str);
+    }
+
+    private native boolean getBoolean(long tstate, String str) throws JepException;
+
     /**
      * Retrieves a Python string object as a Java array.
      * 
@@ -545,7 +1028,14 @@ public final class Jep implements Closeable {
             throw new JepException("Jep has been closed.");
         isValidThread();
 
-        return getValue_floatarray(this.tstate, str);
+        Object event = JepEvents.begin(JepEvents.ARRAY_CONVERSION);
+        float[] result = null;
+        try {
+            result = getValue_floatarray(this.tstate, str);
+            return result;
+        } finally {
+            JepEvents.commitArray(event, str, result, false);
+        }
     }
 
     private native float[] getValue_floatarray(long tstate, String str)
@@ -566,7 +1056,14 @@ public final class Jep implements Closeable {
             throw new JepException("Jep has been closed.");
         isValidThread();
 
-        return getValue_bytearray(this.tstate, str);
+        Object event = JepEvents.begin(JepEvents.ARRAY_CONVERSION);
+        byte[] result = null;
+        try {
+            result = getValue_bytearray(this.tstate, str);
+            return result;
+        } finally {
+            JepEvents.commitArray(event, str, result, false);
+        }
     }
 
     private native byte[] getValue_bytearray(long tstate, String str)
@@ -611,6 +1108,35 @@ public final class Jep implements Closeable {
         return obj;
     }
 
+    /*
+     * Tracks a Python object that Java keeps internally, e.g. for a proxy,
+     * so reset() doesn't release it while the proxy can still be called.
+     */
+    PyObject trackInternal(PyObject obj, boolean inc) throws JepException {
+        if (inc)
+            obj.incref();
+
+        this.internalObjects.add(obj);
+        return obj;
+    }
+
+    /*
+     * Tracks a Python object a proxy holds, i.e. its target or a method it
+     * resolved, so it's released when the proxy is no longer used instead of
+     * on close. Called on the Jep's thread, which is also when the collected
+     * proxies are released.
+     */
+    void trackProxyTarget(Object proxy, PyObject target) {
+        Reference<? extends Object> ref;
+        while ((ref = this.proxyQueue.poll()) != null) {
+            ProxyTarget collected = (ProxyTarget) ref;
+            if (this.proxyTargets.remove(collected))
+                collected.target.close();
+        }
+
+        this.proxyTargets.add(new ProxyTarget(proxy, target, this.proxyQueue));
+    }
+
     /**
      * Create a Python module on the interpreter. If the given name is valid,
      * imported module, this method will return that module.
@@ -629,6 +1155,122 @@ public final class Jep implements Closeable {
     private native long createModule(long tstate, String name)
             throws JepException;
 
+    /**
+     * Binds a variable in the sub-interpreter's global scope to a
+     * {@link PySlot}. The name is converted to an interned Python string once
+     * so setting or getting the variable through the slot, e.g. in a loop
+     * that sets a value and invokes a function, skips converting the name on
+     * every call. Slots stay valid across {@link #reset()} and are closed
+     * when this Jep is closed.
+     * 
+     * @param name
+     *            the Python name for the variable
+     * @return a <code>PySlot</code> value
+     * @exception JepException
+     *                if an error occurs
+     */
+    public PySlot slot(String name) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        return trackSlot(new PySlot(this.tstate, slot(this.tstate, name),
+                this));
+    }
+
+    private native long slot(long tstate, String name) throws JepException;
+
+    /**
+     * Track slots so they are released when this Jep is closed.
+     * 
+     * <b>Internal use only.</b>
+     * 
+     * @param slot
+     *            a <code>PySlot</code> value
+     * @return same slot, for inlining stuff
+     */
+    public PySlot trackSlot(PySlot slot) {
+        this.pythonSlots.add(slot);
+        return slot;
+    }
+
+    /**
+     * Forget a slot that was closed before this Jep.
+     * 
+     * <b>Internal use only.</b>
+     * 
+     * @param slot
+     *            a <code>PySlot</code> value
+     */
+    public void untrackSlot(PySlot slot) {
+        this.pythonSlots.remove(slot);
+    }
+
+    // -------------------------------------------------- reset
+
+    /**
+     * Saves the sub-interpreter's global scope and loaded modules for
+     * {@link #reset()}. A snapshot is taken automatically when the Jep is
+     * created, call this again after any imports or setup that should
+     * survive a reset.
+     * 
+     * @exception JepException
+     *                if an error occurs
+     */
+    public void snapshot() throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        snapshot(this.tstate);
+    }
+
+    private native void snapshot(long tstate) throws JepException;
+
+    /**
+     * Resets the global scope to the last {@link #snapshot()}. This is much
+     * faster than closing and creating a new Jep, the sub-interpreter,
+     * imported modules, and Java class and method caches are kept.
+     * PyObjects returned by this Jep, such as modules from
+     * {@link #createModule(String)}, are closed. Proxies from
+     * <code>jep.jproxy()</code> and compiled code stay valid.
+     * 
+     * Note the snapshot is shallow: a global that was changed in place, such
+     * as a list that was appended to, keeps its changes.
+     * 
+     * @exception JepException
+     *                if an error occurs
+     */
+    public void reset() throws JepException {
+        reset(false);
+    }
+
+    /**
+     * Resets the global scope to the last {@link #snapshot()}.
+     * 
+     * @param dropModules
+     *            also remove modules imported since the snapshot from
+     *            <code>sys.modules</code> so they are imported fresh
+     * @exception JepException
+     *                if an error occurs
+     * @see #reset()
+     */
+    public void reset(boolean dropModules) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        for (int i = 0; i < this.pythonObjects.size(); i++)
+            pythonObjects.get(i).close();
+        this.pythonObjects.clear();
+        this.evalLines = null;
+
+        reset(this.tstate, dropModules);
+    }
+
+    private native void reset(long tstate, boolean dropModules)
+            throws JepException;
+
     // -------------------------------------------------- set things
 
     /**
@@ -702,6 +1344,13 @@ public final class Jep implements Closeable {
             set(name, ((Short) v).shortValue());
         } else if (v instanceof Boolean) {
             set(name, ((Boolean) v).booleanValue());
+        } else if (v instanceof NDArray) {
+            Object event = JepEvents.beginArray(v);
+            try {
+                set(tstate, name, v);
+            } finally {
+                JepEvents.commitArray(event, name, v, true);
+            }
         } else {
             set(tstate, name, v);
         }
@@ -936,7 +1585,12 @@ public final class Jep implements Closeable {
             throw new JepException("Jep has been closed.");
         isValidThread();
 
-        set(tstate, name, v);
+        Object event = JepEvents.beginArray(v);
+        try {
+            set(tstate, name, v);
+        } finally {
+            JepEvents.commitArray(event, name, v, true);
+        }
     }
 
     private native void set(long tstate, String name, boolean[] v)
@@ -958,7 +1612,12 @@ public final class Jep implements Closeable {
             throw new JepException("Jep has been closed.");
         isValidThread();
 
-        set(tstate, name, v);
+        Object event = JepEvents.beginArray(v);
+        try {
+            set(tstate, name, v);
+        } finally {
+            JepEvents.commitArray(event, name, v, true);
+        }
     }
 
     private native void set(long tstate, String name, int[] v)
@@ -980,7 +1639,12 @@ public final class Jep implements Closeable {
             throw new JepException("Jep has been closed.");
         isValidThread();
 
-        set(tstate, name, v);
+        Object event = JepEvents.beginArray(v);
+        try {
+            set(tstate, name, v);
+        } finally {
+            JepEvents.commitArray(event, name, v, true);
+        }
     }
 
     private native void set(long tstate, String name, short[] v)
@@ -1002,7 +1666,12 @@ public final class Jep implements Closeable {
             throw new JepException("Jep has been closed.");
         isValidThread();
 
-        set(tstate, name, v);
+        Object event = JepEvents.beginArray(v);
+        try {
+            set(tstate, name, v);
+        } finally {
+            JepEvents.commitArray(event, name, v, true);
+        }
     }
 
     private native void set(long tstate, String name, byte[] v)
@@ -1024,7 +1693,12 @@ public final class Jep implements Closeable {
             throw new JepException("Jep has been closed.");
         isValidThread();
 
-        set(tstate, name, v);
+        Object event = JepEvents.beginArray(v);
+        try {
+            set(tstate, name, v);
+        } finally {
+            JepEvents.commitArray(event, name, v, true);
+        }
     }
 
     private native void set(long tstate, String name, long[] v)
@@ -1046,7 +1720,12 @@ public final class Jep implements Closeable {
             throw new JepException("Jep has been closed.");
         isValidThread();
 
-        set(tstate, name, v);
+        Object event = JepEvents.beginArray(v);
+        try {
+            set(tstate, name, v);
+        } finally {
+            JepEvents.commitArray(event, name, v, true);
+        }
     }
 
     private native void set(long tstate, String name, double[] v)
@@ -1068,12 +1747,343 @@ public final class Jep implements Closeable {
             throw new JepException("Jep has been closed.");
         isValidThread();
 
-        set(tstate, name, v);
+        Object event = JepEvents.beginArray(v);
+        try {
+            set(tstate, name, v);
+        } finally {
+            JepEvents.commitArray(event, name, v, true);
+        }
     }
 
     private native void set(long tstate, String name, float[] v)
             throws JepException;
 
+    /**
+     * Sets several Java Objects into the sub-interpreter's global scope at
+     * once. Each value is converted the same as {@link #set(String, Object)}
+     * but the sub-interpreter is only entered once, which is much cheaper
+     * than many separate calls to set. If a value fails to convert the
+     * values before it remain set.
+     * 
+     * @param values
+     *            the Python names and values of the variables
+     * @exception JepException
+     *                if an error occurs
+     */
+    public void setAll(Map<String, ?> values) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        String[] names = new String[values.size()];
+        Object[] objects = new Object[names.length];
+        int i = 0;
+        for (Map.Entry<String, ?> entry : values.entrySet()) {
+            names[i] = entry.getKey();
+            objects[i] = entry.getValue();
+            i++;
+        }
+        setAll(tstate, names, objects);
+    }
+
+    private native void setAll(long tstate, String[] names, Object[] values)
+            throws JepException;
+
+    // -------------------------------------------------- exceptions
+
+    /**
+     * Called by native code holding the GIL when it makes a JepException from
+     * a Python exception. Returns the Python exceptions of JepExceptions that
+     * were garbage collected without being described, for the native code to
+     * release.
+     * 
+     * @param e
+     *            the new exception
+     * @param pyException
+     *            pointer to the Python exception
+     * @return pointers to release, or null
+     */
+    long[] trackException(JepException e, long pyException) {
+        synchronized (this.exceptionLock) {
+            long[] released = pollExceptions();
+            this.pendingExceptions.put(pyException, new PendingException(e,
+                    pyException, this.exceptionQueue));
+            return released;
+        }
+    }
+
+    // forgets the collected JepExceptions, returns their python exceptions
+    private long[] pollExceptions() {
+        List<Long> released = null;
+        Reference<? extends JepException> ref;
+        while ((ref = this.exceptionQueue.poll()) != null) {
+            PendingException pending = (PendingException) ref;
+            // the pointer may have been reused by a newer exception
+            if (this.pendingExceptions.get(pending.pyException) == pending) {
+                this.pendingExceptions.remove(pending.pyException);
+                if (released == null)
+                    released = new ArrayList<Long>();
+                released.add(pending.pyException);
+            }
+        }
+
+        if (released == null)
+            return null;
+        long[] ret = new long[released.size()];
+        for (int i = 0; i < ret.length; i++)
+            ret[i] = released.get(i);
+        return ret;
+    }
+
+    /*
+     * Releases the python exceptions of collected JepExceptions, so they
+     * don't wait for the next JepException. Called on the Jep's thread by
+     * every call that checks isValidThread().
+     */
+    private void releaseCollectedExceptions() {
+        long[] released;
+        synchronized (this.exceptionLock) {
+            released = pollExceptions();
+        }
+        if (released != null)
+            releaseExceptions(this.tstate, released);
+    }
+
+    /**
+     * Builds the message and stack trace of a Python exception held by a
+     * JepException, and releases the Python exception.
+     * 
+     * @param pyException
+     *            pointer to the Python exception
+     * @return the message and stack trace, or null if this isn't the Jep's
+     *         thread or it's closed
+     */
+    Object[] describeException(long pyException) {
+        if (this.closed || this.thread != Thread.currentThread())
+            return null;
+        synchronized (this.exceptionLock) {
+            PendingException pending = this.pendingExceptions
+                    .remove(pyException);
+            if (pending == null)
+                return null;
+            // don't enqueue it once the JepException is collected
+            pending.clear();
+        }
+        return describeException(this.tstate, pyException);
+    }
+
+    private native Object[] describeException(long tstate, long pyException);
+
+    // describe exceptions still in use and release the rest
+    private void releaseExceptions() {
+        List<PendingException> pending;
+        synchronized (this.exceptionLock) {
+            if (this.pendingExceptions.isEmpty())
+                return;
+            pending = new ArrayList<PendingException>(
+                    this.pendingExceptions.values());
+        }
+        for (PendingException p : pending) {
+            JepException e = p.get();
+            if (e != null)
+                e.getMessage();
+        }
+
+        long[] ptrs;
+        synchronized (this.exceptionLock) {
+            if (this.pendingExceptions.isEmpty())
+                return;
+            ptrs = new long[this.pendingExceptions.size()];
+            int i = 0;
+            for (PendingException p : this.pendingExceptions.values()) {
+                p.clear();
+                ptrs[i++] = p.pyException;
+            }
+            this.pendingExceptions.clear();
+        }
+        releaseExceptions(this.tstate, ptrs);
+    }
+
+    private native void releaseExceptions(long tstate, long[] pyExceptions);
+
+    // -------------------------------------------------- stats
+
+    /**
+     * Turns the runtime counters of this interpreter on or off. The first time
+     * they are enabled a {@link JepStats} MBean is registered with the platform
+     * MBean server. While disabled the counters are left as they are and cost
+     * next to nothing.
+     * 
+     * @param enabled
+     *            whether to update the counters
+     * @exception JepException
+     *                if an error occurs
+     */
+    public void setStatsEnabled(boolean enabled) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        if (this.stats == null) {
+            if (!enabled)
+                return;
+            this.stats = new JepStats(this);
+            this.stats.register(this.thread.getName());
+        }
+        setStatsEnabled(this.tstate, enabled);
+        this.stats.setEnabled(enabled);
+    }
+
+    private native void setStatsEnabled(long tstate, boolean enabled);
+
+    /**
+     * Gets the runtime counters of this interpreter. Unlike most methods the
+     * returned object may be used from any thread, and keeps the final counts
+     * after this Jep is closed.
+     * 
+     * @return the counters, or null if they were never enabled
+     */
+    public JepStats getStats() {
+        return this.stats;
+    }
+
+    long[] readStats() {
+        return getStats(this.tstate);
+    }
+
+    private static native long[] getStats(long tstate);
+
+    /**
+     * Turns profiling of the calls Python makes to Java methods and
+     * constructors on or off. Each call is timed converting its arguments,
+     * in Java and converting its result, see {@link #getProfile(String)}.
+     * What was profiled is kept when profiling is turned off, Python code can
+     * forget it with <code>jep.resetProfile()</code>.
+     * 
+     * @param enabled
+     *            whether to profile calls
+     * @exception JepException
+     *                if an error occurs
+     */
+    public void setProfilingEnabled(boolean enabled) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        setProfilingEnabled(this.tstate, enabled);
+    }
+
+    private native void setProfilingEnabled(long tstate, boolean enabled)
+            throws JepException;
+
+    /**
+     * Reports on the calls profiled since
+     * {@link #setProfilingEnabled(boolean)}, the same as
+     * <code>jep.profile.dump(format)</code> in Python.
+     * 
+     * @param format
+     *            <code>"table"</code>, <code>"json"</code> or
+     *            <code>"folded"</code> for flame graph tools
+     * @return the report
+     * @exception JepException
+     *                if an error occurs
+     */
+    public String getProfile(String format) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        if (!"table".equals(format) && !"json".equals(format)
+                && !"folded".equals(format))
+            throw new JepException("Unknown profile format: " + format);
+        return (String) getValue("__import__('jep.profile').profile.dump('"
+                + format + "')");
+    }
+
+    // -------------------------------------------------- string cache
+
+    /**
+     * Gives this interpreter a cache of the Python strings made from short
+     * Java Strings, for workloads that convert the same map keys, column
+     * names or enum names over and over. Strings of up to 64 chars are
+     * shared while they stay in the cache, which saves allocating them and
+     * keeps their hash for dict lookups with them. The cache has a
+     * fixed number of slots, each keeping the last string that hashed to it.
+     * Setting a size replaces the cache with an empty one.
+     * 
+     * @param size
+     *            the number of strings to keep, rounded up to a power of two,
+     *            or 0 to remove the cache
+     * @exception JepException
+     *                if an error occurs
+     */
+    public void setStringCacheSize(int size) throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        setStringCacheSize(this.tstate, size);
+    }
+
+    private native void setStringCacheSize(long tstate, int size)
+            throws JepException;
+
+    /**
+     * Gets the number of conversions the string cache answered.
+     * 
+     * @return hits since the cache was last sized
+     * @exception JepException
+     *                if an error occurs
+     */
+    public long getStringCacheHits() throws JepException {
+        return readStringCacheStats()[1];
+    }
+
+    /**
+     * Gets the number of short strings the string cache had to convert.
+     * 
+     * @return misses since the cache was last sized
+     * @exception JepException
+     *                if an error occurs
+     */
+    public long getStringCacheMisses() throws JepException {
+        return readStringCacheStats()[2];
+    }
+
+    private long[] readStringCacheStats() throws JepException {
+        if (this.closed)
+            throw new JepException("Jep has been closed.");
+        isValidThread();
+
+        return getStringCacheStats(this.tstate);
+    }
+
+    private static native long[] getStringCacheStats(long tstate);
+
+    // -------------------------------------------------- JFR events
+
+    /*
+     * Begins a JFR event for entering Python, null unless one is being
+     * recorded. The time waited for the GIL is kept from here until
+     * commitEvent.
+     */
+    private Object beginEvent(int type) {
+        Object event = JepEvents.begin(type);
+        if (event != null)
+            startGilTiming(this.tstate);
+        return event;
+    }
+
+    private void commitEvent(Object event, String what) {
+        if (event != null)
+            JepEvents.commit(event, what,
+                    Long.valueOf(takeGilWait(this.tstate)));
+    }
+
+    private static native void startGilTiming(long tstate);
+
+    private static native long takeGilWait(long tstate);
+
     // -------------------------------------------------- close me
 
     /**
@@ -1082,7 +2092,7 @@ public final class Jep implements Closeable {
      * 
      */
     @Override
-    public synchronized void close() {
+    public void close() {
         if (this.closed)
             return;
 
@@ -1111,6 +2121,23 @@ public final class Jep implements Closeable {
         // close all the PyObjects we created
         for (int i = 0; i < this.pythonObjects.size(); i++)
             pythonObjects.get(i).close();
+        for (int i = 0; i < this.internalObjects.size(); i++)
+            internalObjects.get(i).close();
+        this.internalObjects.clear();
+        for (ProxyTarget t : this.proxyTargets) {
+            t.clear();
+            t.target.close();
+        }
+        this.proxyTargets.clear();
+        // closing a slot untracks it
+        for (PySlot s : new ArrayList<PySlot>(this.pythonSlots))
+            s.close();
+
+        // JepExceptions can't be described once python is gone
+        releaseExceptions();
+
+        if (this.stats != null)
+            this.stats.close();
 
         this.closed = true;
         this.close(tstate);
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep;
+
+import javax.script.CompiledScript;
+import javax.script.ScriptContext;
+import javax.script.ScriptEngine;
+import javax.script.ScriptException;
+
+import jep.python.PyObject;
+
+/**
+ * A script compiled by {@link JepScriptEngine#compile(String)}. Holds the
+ * Python code object so each eval() skips parsing and compiling.
+ * 
+ * Note: eval() always returns null due to Python limitations.
+ */
+class JepCompiledScript extends CompiledScript {
+
+    private final JepScriptEngine engine;
+
+    private final PyObject code;
+
+    /**
+     * Make a new JepCompiledScript
+     * 
+     * @param engine
+     *            the engine that compiled the script
+     * @param code
+     *            the compiled code object
+     */
+    JepCompiledScript(JepScriptEngine engine, PyObject code) {
+        this.engine = engine;
+        this.code = code;
+    }
+
+    @Override
+    public Object eval(ScriptContext context) throws ScriptException {
+        return this.engine.eval(this.code, context);
+    }
+
+    @Override
+    public ScriptEngine getEngine() {
+        return this.engine;
+    }
+}
@@ -0,0 +1,168 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep;
+
+import java.io.File;
+import java.util.Arrays;
+import java.util.HashSet;
+import java.util.Set;
+
+/**
+ * <p>
+ * A configuration object for constructing a Jep instance, corresponding to the
+ * configuration of the particular Python sub-interpreter. This class is
+ * intended to make constructing Jep instances easier while maintaining
+ * compatible APIs between releases.
+ * </p>
+ * 
+ * <pre>
+ * Jep jep = new Jep(new JepConfig().setInteractive(true)
+ *         .addSharedModules(&quot;numpy&quot;));
+ * </pre>
+ * 
+ * @since 3.5
+ */
+public class JepConfig {
+
+    protected boolean interactive = false;
+
+    protected StringBuilder includePath = null;
+
+    protected ClassLoader classLoader = null;
+
+    protected ClassEnquirer classEnquirer = null;
+
+    protected Set<String> sharedModules = null;
+
+    /**
+     * Sets whether {@link Jep#eval(String)} should support the slower
+     * behavior of potentially waiting for multiple statements
+     * 
+     * @param interactive
+     *            whether the Jep instance should be interactive
+     * @return a reference to this JepConfig
+     */
+    public JepConfig setInteractive(boolean interactive) {
+        this.interactive = interactive;
+        return this;
+    }
+
+    /**
+     * Sets a path of directories separated by File.pathSeparator that will be
+     * appended to the sub-intepreter's <code>sys.path</code>
+     * 
+     * @param includePath
+     *            directory or directories to include on sys.path
+     * @return a reference to this JepConfig
+     */
+    public JepConfig setIncludePath(String includePath) {
+        this.includePath = null;
+        if (includePath != null)
+            this.includePath = new StringBuilder(includePath);
+        return this;
+    }
+
+    /**
+     * Adds a path of directories to the sub-interpreter's <code>sys.path</code>
+     * 
+     * @param includePaths
+     *            directories to include on sys.path
+     * @return a reference to this JepConfig
+     */
+    public JepConfig addIncludePaths(String... includePaths) {
+        for (String path : includePaths) {
+            if (this.includePath == null)
+                this.includePath = new StringBuilder();
+            else
+                this.includePath.append(File.pathSeparator);
+            this.includePath.append(path);
+        }
+        return this;
+    }
+
+    /**
+     * Sets the ClassLoader to use when importing Java classes from Python
+     * 
+     * @param classLoader
+     *            the initial ClassLoader for the Jep instance
+     * @return a reference to this JepConfig
+     */
+    public JepConfig setClassLoader(ClassLoader classLoader) {
+        this.classLoader = classLoader;
+        return this;
+    }
+
+    /**
+     * Sets a ClassEnquirer to determine which imports are Python vs Java, or
+     * null for the default {@link ClassList}
+     * 
+     * @param classEnquirer
+     *            the ClassEnquirer for the Jep instance
+     * @return a reference to this JepConfig
+     */
+    public JepConfig setClassEnquirer(ClassEnquirer classEnquirer) {
+        this.classEnquirer = classEnquirer;
+        return this;
+    }
+
+    /**
+     * <p>
+     * Sets the names of modules which should be shared with other Jep
+     * sub-interpreters. A shared module is imported once in the top Python
+     * interpreter and every sub-interpreter that imports it, or any of its
+     * submodules, gets the same module object. This makes importing large
+     * libraries faster, uses less memory, and can fix problems with CPython
+     * extensions that don't support sub-interpreters, such as numpy.
+     * </p>
+     * 
+     * <p>
+     * Shared modules see the top interpreter's globals and builtins, so
+     * changes to them are visible to every sub-interpreter.
+     * </p>
+     * 
+     * @param sharedModules
+     *            a set of top level module names
+     * @return a reference to this JepConfig
+     */
+    public JepConfig setSharedModules(Set<String> sharedModules) {
+        this.sharedModules = sharedModules;
+        return this;
+    }
+
+    /**
+     * Adds module names to the set of shared modules
+     * 
+     * @param sharedModule
+     *            top level module names to share
+     * @return a reference to this JepConfig
+     * @see #setSharedModules(Set)
+     */
+    public JepConfig addSharedModules(String... sharedModule) {
+        if (this.sharedModules == null)
+            this.sharedModules = new HashSet<String>();
+        this.sharedModules.addAll(Arrays.asList(sharedModule));
+        return this;
+    }
+}
@@ -0,0 +1,289 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep;
+
+import java.lang.reflect.Array;
+import java.lang.reflect.Constructor;
+import java.lang.reflect.Method;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+
+/**
+ * <p>
+ * Java Flight Recorder events for the time Jep spends in Python: running
+ * scripts, evals, invokes and converting large arrays. The interpreter
+ * entries record how long they waited for the GIL, so Python latency can be
+ * matched with garbage collection and thread contention in one recording.
+ * </p>
+ * 
+ * <p>
+ * Jep still runs on Java versions without JFR, so the events are defined
+ * at runtime through <code>jdk.jfr.EventFactory</code>. Without it, or
+ * while no recording has an event enabled, beginning an event returns null
+ * and costs next to nothing.
+ * </p>
+ * 
+ * @version $Id: $
+ */
+final class JepEvents {
+
+    static final int RUN_SCRIPT = 0;
+
+    static final int EVAL = 1;
+
+    static final int INVOKE = 2;
+
+    static final int ARRAY_CONVERSION = 3;
+
+    /**
+     * Arrays smaller than this many bytes don't get an event, set with the
+     * <code>jep.jfr.arrayThreshold</code> system property.
+     */
+    static final int ARRAY_THRESHOLD = Integer.getInteger(
+            "jep.jfr.arrayThreshold", 64 * 1024).intValue();
+
+    private static Object[] types;
+
+    private static Method isEnabled;
+
+    private static Method newEvent;
+
+    private static Method begin;
+
+    private static Method end;
+
+    private static Method shouldCommit;
+
+    private static Method set;
+
+    private static Method commit;
+
+    // jdk.jfr.EventFactory per event, null if JFR isn't available
+    private static final Object[] factories = createFactories();
+
+    private JepEvents() {
+    }
+
+    private static Object[] createFactories() {
+        try {
+            Class<?> factoryClass = Class.forName("jdk.jfr.EventFactory");
+            Class<?> eventClass = Class.forName("jdk.jfr.Event");
+            Class<?> typeClass = Class.forName("jdk.jfr.EventType");
+            Method create = factoryClass.getMethod("create", List.class,
+                    List.class);
+
+            Object[] result = new Object[4];
+            result[RUN_SCRIPT] = create.invoke(null, describe("RunScript",
+                    "Run Script", "A script run by Jep.runScript()"),
+                    fields(new Object[][] {
+                            { String.class, "script", "Script", null },
+                            { long.class, "gilWait", "GIL Wait", "Timespan" } }));
+            result[EVAL] = create.invoke(null, describe("Eval", "Eval",
+                    "Python statements run by Jep.eval()"),
+                    fields(new Object[][] {
+                            { String.class, "source", "Source", null },
+                            { long.class, "gilWait", "GIL Wait", "Timespan" } }));
+            result[INVOKE] = create.invoke(null, describe("Invoke", "Invoke",
+                    "A Python function called by Jep.invoke()"),
+                    fields(new Object[][] {
+                            { String.class, "function", "Function", null },
+                            { long.class, "gilWait", "GIL Wait", "Timespan" } }));
+            result[ARRAY_CONVERSION] = create.invoke(null, describe(
+                    "ArrayConversion", "Array Conversion",
+                    "A large array copied between Java and Python"),
+                    fields(new Object[][] {
+                            { String.class, "name", "Variable", null },
+                            { String.class, "arrayType", "Array Type", null },
+                            { boolean.class, "toPython", "To Python", null },
+                            { long.class, "bytes", "Bytes", "DataAmount" } }));
+
+            types = new Object[result.length];
+            Method getEventType = factoryClass.getMethod("getEventType");
+            for (int i = 0; i < result.length; i++)
+                types[i] = getEventType.invoke(result[i]);
+            isEnabled = typeClass.getMethod("isEnabled");
+            newEvent = factoryClass.getMethod("newEvent");
+            begin = eventClass.getMethod("begin");
+            end = eventClass.getMethod("end");
+            shouldCommit = eventClass.getMethod("shouldCommit");
+            set = eventClass.getMethod("set", int.class, Object.class);
+            commit = eventClass.getMethod("commit");
+            return result;
+        } catch (Exception e) {
+            // no JFR, before Java 9 or in a restricted environment
+            return null;
+        } catch (LinkageError e) {
+            return null;
+        }
+    }
+
+    // the name, label, category and description of an event type
+    private static List<Object> describe(String name, String label,
+            String description) throws Exception {
+        List<Object> result = new ArrayList<Object>();
+        result.add(annotation("Name", "jep." + name));
+        result.add(annotation("Label", label));
+        result.add(annotation("Category", new String[] { "Jep" }));
+        result.add(annotation("Description", description));
+        return result;
+    }
+
+    // type, name, label and an optional unit annotation of each field
+    private static List<Object> fields(Object[][] fields) throws Exception {
+        Class<?> descriptorClass = Class.forName("jdk.jfr.ValueDescriptor");
+        Constructor<?> ctor = descriptorClass.getConstructor(Class.class,
+                String.class, List.class);
+
+        List<Object> result = new ArrayList<Object>();
+        for (Object[] field : fields) {
+            List<Object> annotations = new ArrayList<Object>();
+            annotations.add(annotation("Label", field[2]));
+            if ("Timespan".equals(field[3]))
+                annotations.add(annotation("Timespan", "NANOSECONDS"));
+            else if ("DataAmount".equals(field[3]))
+                annotations.add(annotation("DataAmount", "BYTES"));
+            result.add(ctor.newInstance(field[0], field[1],
+                    Collections.unmodifiableList(annotations)));
+        }
+        return result;
+    }
+
+    private static Object annotation(String type, Object value)
+            throws Exception {
+        Class<?> annotationClass = Class.forName("jdk.jfr.AnnotationElement");
+        Constructor<?> ctor = annotationClass.getConstructor(Class.class,
+                Object.class);
+        return ctor.newInstance(Class.forName("jdk.jfr." + type), value);
+    }
+
+    /**
+     * Begins an event if JFR is recording it.
+     * 
+     * @param type
+     *            one of the event constants
+     * @return the event to pass to commit, or null if it isn't recorded
+     */
+    static Object begin(int type) {
+        if (factories == null)
+            return null;
+        try {
+            if (!((Boolean) isEnabled.invoke(types[type])).booleanValue())
+                return null;
+            Object event = newEvent.invoke(factories[type]);
+            begin.invoke(event);
+            return event;
+        } catch (Exception e) {
+            return null;
+        }
+    }
+
+    /**
+     * Begins an event for converting an array, if it is large enough.
+     * 
+     * @param array
+     *            a primitive array or NDArray
+     * @return the event to pass to commitArray, or null if it isn't recorded
+     */
+    static Object beginArray(Object array) {
+        if (factories == null || arrayBytes(array) < ARRAY_THRESHOLD)
+            return null;
+        return begin(ARRAY_CONVERSION);
+    }
+
+    /**
+     * Ends and commits an event with the values of its fields in order.
+     * 
+     * @param event
+     *            the event from begin, may be null
+     * @param values
+     *            the values of the event's fields
+     */
+    static void commit(Object event, Object... values) {
+        if (event == null)
+            return;
+        try {
+            end.invoke(event);
+            if (!((Boolean) shouldCommit.invoke(event)).booleanValue())
+                return;
+            for (int i = 0; i < values.length; i++)
+                set.invoke(event, i, values[i]);
+            commit.invoke(event);
+        } catch (Exception e) {
+            // lose the event rather than fail the call
+        }
+    }
+
+    /**
+     * Commits an array conversion event if the array is large enough.
+     * 
+     * @param event
+     *            the event from begin or beginArray, may be null
+     * @param name
+     *            the Python variable
+     * @param array
+     *            the converted array, may be null
+     * @param toPython
+     *            if the array went from Java to Python
+     */
+    static void commitArray(Object event, String name, Object array,
+            boolean toPython) {
+        if (event == null)
+            return;
+        long bytes = arrayBytes(array);
+        if (bytes < ARRAY_THRESHOLD)
+            return;
+        if (array instanceof NDArray)
+            array = ((NDArray<?>) array).getData();
+        commit(event, name, array.getClass().getSimpleName(),
+                Boolean.valueOf(toPython), Long.valueOf(bytes));
+    }
+
+    /**
+     * @param array
+     *            a primitive array or NDArray
+     * @return the size of its data, 0 for anything else
+     */
+    static long arrayBytes(Object array) {
+        if (array instanceof NDArray)
+            array = ((NDArray<?>) array).getData();
+        if (array == null || !array.getClass().isArray())
+            return 0;
+
+        Class<?> component = array.getClass().getComponentType();
+        long size;
+        if (component == byte.class || component == boolean.class)
+            size = 1;
+        else if (component == short.class || component == char.class)
+            size = 2;
+        else if (component == int.class || component == float.class)
+            size = 4;
+        else if (component == long.class || component == double.class)
+            size = 8;
+        else
+            return 0;
+        return size * Array.getLength(array);
+    }
+}
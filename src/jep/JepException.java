@@ -24,9 +24,21 @@
  */
 package jep;
 
+import java.io.ObjectStreamException;
+import java.io.PrintStream;
+import java.io.PrintWriter;
+
 /**
  * JepException - it happens.
  * 
+ * <p>
+ * A JepException from a Python error keeps the Python exception and only
+ * builds the message and stack trace the first time they're used, since
+ * callers often catch and ignore expected errors. That has to happen on the
+ * Jep's thread while the Jep is open, otherwise only the Python exception
+ * type is available.
+ * </p>
+ * 
  * @author [mrjohnson0 at sourceforge.net] Mike Johnson
  * @version $Id$
  */
@@ -34,6 +46,16 @@ public class JepException extends Exception {
 
     private static final long serialVersionUID = 1L;
 
+    // set until the python exception has been described
+    private transient Jep jep = null;
+
+    private transient long pyException = 0;
+
+    private String pythonMessage = null;
+
+    // true if the message comes from a cause that hasn't been described
+    private boolean lazyCause = false;
+
     /**
      * Creates a new <code>JepException</code> instance.
      * 
@@ -59,7 +81,8 @@ public class JepException extends Exception {
      *            a <code>Throwable</code> value
      */
     public JepException(Throwable t) {
-        super(t);
+        super(isLazy(t) ? null : (t == null ? null : t.toString()), t);
+        this.lazyCause = isLazy(t);
     }
 
     /**
@@ -73,4 +96,98 @@ public class JepException extends Exception {
     public JepException(String s, Throwable t) {
         super(s, t);
     }
+
+    /**
+     * Made by process_py_exception in native code, the Jep tracks the Python
+     * exception until it's described or this is garbage collected.
+     * 
+     * @param type
+     *            the Python exception type, used if the message can't be made
+     * @param t
+     *            the Java exception the Python exception wraps, or null
+     * @param jep
+     *            the Jep the exception came from
+     * @param pyException
+     *            pointer to the Python exception
+     */
+    JepException(String type, Throwable t, Jep jep, long pyException) {
+        super(type, t);
+        this.jep = jep;
+        this.pyException = pyException;
+    }
+
+    private static boolean isLazy(Throwable t) {
+        return t instanceof JepException && ((JepException) t).jep != null;
+    }
+
+    // build the message and stack trace from python if they haven't been
+    private void describe() {
+        Jep j;
+        long ptr;
+        synchronized (this) {
+            j = this.jep;
+            ptr = this.pyException;
+        }
+        if (j == null)
+            return;
+
+        // only one caller gets the details, the Jep forgets the pointer
+        Object[] details = j.describeException(ptr);
+        if (details == null)
+            return;
+
+        synchronized (this) {
+            this.jep = null;
+            this.pyException = 0;
+            this.pythonMessage = (String) details[0];
+            if (details[1] != null)
+                setStackTrace((StackTraceElement[]) details[1]);
+        }
+    }
+
+    // describe this and any causes so they print properly
+    private void describeAll() {
+        for (Throwable t = this; t != null; t = t.getCause()) {
+            if (t instanceof JepException)
+                ((JepException) t).describe();
+        }
+    }
+
+    @Override
+    public String getMessage() {
+        describe();
+        if (this.pythonMessage != null)
+            return this.pythonMessage;
+        if (this.lazyCause && getCause() != null)
+            return getCause().toString();
+        return super.getMessage();
+    }
+
+    @Override
+    public StackTraceElement[] getStackTrace() {
+        describe();
+        return super.getStackTrace();
+    }
+
+    @Override
+    public void printStackTrace(PrintStream s) {
+        describeAll();
+        super.printStackTrace(s);
+    }
+
+    @Override
+    public void printStackTrace(PrintWriter s) {
+        describeAll();
+        super.printStackTrace(s);
+    }
+
+    // the python exception can't be serialized, describe it first
+    private Object writeReplace() throws ObjectStreamException {
+        describeAll();
+        if (this.lazyCause) {
+            this.pythonMessage = getMessage();
+            this.lazyCause = false;
+        }
+        return this;
+    }
 }
@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep;
+
+/**
+ * A snapshot of the live Python wrappers of Java objects and of the JNI global
+ * references made by Jep, see {@link Jep#getLiveCounts()}. The counts are
+ * process wide. Objects only go away once Python collects them, so leak
+ * tests should run <code>gc.collect()</code> before taking a snapshot. The
+ * same counts are available to Python as <code>jep.liveCounts()</code>.
+ * 
+ * @version $Id: $
+ */
+public final class JepLiveCounts {
+
+    /**
+     * Where global references are created, in the order of pyembed.h.
+     */
+    public enum Site {
+        /** the object and class of Python wrappers of Java objects */
+        PYJOBJECT,
+        /** the array, class and component class of Python wrapped arrays */
+        PYJARRAY,
+        /** the reflected method and parameter types of Python methods */
+        PYJMETHOD,
+        /** the reflected field of Python fields */
+        PYJFIELD,
+        /** the constructor parameter types of Python wrapped classes */
+        PYJCLASS,
+        /** the class loader and caller of each Jep */
+        THREAD
+    }
+
+    // indexes of the native counts, these must be the same as pyembed.h
+    private static final int PYJOBJECTS = 0;
+
+    private static final int PYJARRAYS = 1;
+
+    private static final int PYJMETHODS = 2;
+
+    private static final int PYJFIELDS = 3;
+
+    private static final int OBJECT_TYPES = 4;
+
+    private final long[] counts;
+
+    JepLiveCounts(long[] counts) {
+        this.counts = counts;
+    }
+
+    /**
+     * @return live Python wrappers of Java objects, including classes and
+     *         collections
+     */
+    public long getPyJobjects() {
+        return this.counts[PYJOBJECTS];
+    }
+
+    /**
+     * @return live Python wrappers of Java arrays
+     */
+    public long getPyJarrays() {
+        return this.counts[PYJARRAYS];
+    }
+
+    /**
+     * @return live Python wrappers of Java methods
+     */
+    public long getPyJmethods() {
+        return this.counts[PYJMETHODS];
+    }
+
+    /**
+     * @return live Python wrappers of Java fields
+     */
+    public long getPyJfields() {
+        return this.counts[PYJFIELDS];
+    }
+
+    /**
+     * @param site
+     *            where the references were made
+     * @return global references created at the site
+     */
+    public long getGlobalRefsCreated(Site site) {
+        return this.counts[OBJECT_TYPES + site.ordinal()];
+    }
+
+    /**
+     * @param site
+     *            where the references were made
+     * @return global references made at the site that have been deleted
+     */
+    public long getGlobalRefsDeleted(Site site) {
+        return this.counts[OBJECT_TYPES + Site.values().length
+                + site.ordinal()];
+    }
+
+    /**
+     * @param site
+     *            where the references were made
+     * @return global references made at the site that are still live
+     */
+    public long getGlobalRefs(Site site) {
+        return getGlobalRefsCreated(site) - getGlobalRefsDeleted(site);
+    }
+
+    /**
+     * @return global references made by Jep that are still live
+     */
+    public long getGlobalRefs() {
+        long live = 0;
+        for (Site site : Site.values())
+            live += getGlobalRefs(site);
+        return live;
+    }
+
+    @Override
+    public String toString() {
+        StringBuilder sb = new StringBuilder("JepLiveCounts[pyjobjects=")
+                .append(getPyJobjects()).append(", pyjarrays=")
+                .append(getPyJarrays()).append(", pyjmethods=")
+                .append(getPyJmethods()).append(", pyjfields=")
+                .append(getPyJfields()).append(", globalRefs=")
+                .append(getGlobalRefs());
+        for (Site site : Site.values())
+            sb.append(", ").append(site.name().toLowerCase()).append('=')
+                    .append(getGlobalRefs(site));
+        return sb.append(']').toString();
+    }
+}
@@ -24,12 +24,13 @@
  */
 package jep;
 
-import java.io.File;
-import java.io.FileWriter;
 import java.io.IOException;
 import java.io.Reader;
 
 import javax.script.Bindings;
+import javax.script.Compilable;
+import javax.script.CompiledScript;
+import javax.script.Invocable;
 import javax.script.ScriptContext;
 import javax.script.ScriptEngine;
 import javax.script.ScriptEngineFactory;
@@ -37,14 +38,21 @@ import javax.script.ScriptException;
 import javax.script.SimpleBindings;
 
 import jep.python.PyModule;
+import jep.python.PyObject;
 
 /**
- * Implements {@link javax.script.ScriptEngine}
+ * Implements {@link javax.script.ScriptEngine}, {@link javax.script.Compilable}
+ * and {@link javax.script.Invocable}.
+ * 
+ * <p>
+ * Scripts are run from memory. Use {@link #compile(String)} to parse a script
+ * once and run it many times.
+ * </p>
  * 
  * @author [mrjohnson0 at sourceforge.net] Mike Johnson
  * @version $Id$
  */
-public class JepScriptEngine implements ScriptEngine {
+public class JepScriptEngine implements ScriptEngine, Compilable, Invocable {
     private Jep jep = null;
 
     private Bindings bindings = new SimpleBindings();
@@ -95,23 +103,27 @@ public class JepScriptEngine implements ScriptEngine {
         }
     }
 
-    // write temp file from Reader
-    private File writeTemp(Reader reader) throws IOException {
-        File temp = File.createTempFile("jep", ".py");
-        FileWriter fout = new FileWriter(temp);
-
-        char[] buf = new char[1024];
+    // read the whole script from Reader
+    private String readAll(Reader reader) throws ScriptException {
+        StringBuilder source = new StringBuilder();
+        char[] buf = new char[4096];
         int count;
 
-        while ((count = reader.read(buf)) > 0)
-            fout.write(buf, 0, count);
+        try {
+            while ((count = reader.read(buf)) > 0)
+                source.append(buf, 0, count);
+        } catch (IOException e) {
+            throw (ScriptException) new ScriptException(
+                    "Error reading script: " + e.getMessage()).initCause(e);
+        }
 
-        fout.close();
-        return temp;
+        return source.toString();
     }
 
     private Object eval(Reader reader, ScriptContext context, Bindings bindings)
             throws ScriptException {
+        String source = readAll(reader);
+
         try {
             // make sure to always set a context, even if null (None)
             _setContext(context);
@@ -119,13 +131,22 @@ public class JepScriptEngine implements ScriptEngine {
             // turn off interactive mode
             this.jep.setInteractive(false);
 
-            File temp = writeTemp(reader);
-
             // okay sic jep on it
-            this.jep.runScript(temp.getAbsolutePath());
-        } catch (IOException e) {
-            throw new ScriptException("Error writing to file: "
-                    + e.getMessage());
+            this.jep.exec(source);
+        } catch (JepException e) {
+            throw (ScriptException) new ScriptException(e.getMessage())
+                    .initCause(e);
+        }
+
+        return null;
+    }
+
+    // run a code object from compile()
+    Object eval(PyObject code, ScriptContext context) throws ScriptException {
+        try {
+            _setContext(context);
+            this.jep.setInteractive(false);
+            this.jep.exec(code);
         } catch (JepException e) {
             throw (ScriptException) new ScriptException(e.getMessage())
                     .initCause(e);
@@ -138,8 +159,8 @@ public class JepScriptEngine implements ScriptEngine {
      * <pre>
      * Run script from reader.
      * 
-     * Performance of this method will suck compared to using
-     * Jep.runScript(). Use the compiled interface or something.
+     * The script is parsed every time. Use compile() to run the same
+     * script more than once.
      * 
      * </pre>
      * 
@@ -269,6 +290,145 @@ public class JepScriptEngine implements ScriptEngine {
         return null;
     }
 
+    // -------------------------------------------------- compilable
+
+    /**
+     * Compiles a script into a code object that is run by
+     * {@link CompiledScript#eval()} without parsing it again.
+     * 
+     * @param script
+     *            a <code>String</code> value
+     * @return a <code>CompiledScript</code> value
+     * @exception ScriptException
+     *                if an error occurs
+     */
+    @Override
+    public CompiledScript compile(String script) throws ScriptException {
+        try {
+            return new JepCompiledScript(this, this.jep.compile(script,
+                    "<script>"));
+        } catch (JepException e) {
+            throw (ScriptException) new ScriptException(e.getMessage())
+                    .initCause(e);
+        }
+    }
+
+    /**
+     * Compiles a script read from <code>reader</code>.
+     * 
+     * @param reader
+     *            a <code>Reader</code> value
+     * @return a <code>CompiledScript</code> value
+     * @exception ScriptException
+     *                if an error occurs
+     */
+    @Override
+    public CompiledScript compile(Reader reader) throws ScriptException {
+        return compile(readAll(reader));
+    }
+
+    // -------------------------------------------------- invocable
+
+    /**
+     * Calls a function in the global scope.
+     * 
+     * @param name
+     *            the name of the Python function
+     * @param args
+     *            arguments to pass to the function
+     * @return the function's return value
+     * @exception ScriptException
+     *                if an error occurs
+     * @exception NoSuchMethodException
+     *                if there is no callable by that name
+     */
+    @Override
+    public Object invokeFunction(String name, Object... args)
+            throws ScriptException, NoSuchMethodException {
+        try {
+            return this.jep.invokeOrThrow(name, args);
+        } catch (JepException e) {
+            throw (ScriptException) new ScriptException(e.getMessage())
+                    .initCause(e);
+        }
+    }
+
+    /**
+     * Calls a method on a Python object. Python objects can't be returned to
+     * Java as themselves, so <code>thiz</code> is the name of a global Python
+     * variable.
+     * 
+     * @param thiz
+     *            a <code>String</code> name of a Python global
+     * @param name
+     *            the name of the method
+     * @param args
+     *            arguments to pass to the method
+     * @return the method's return value
+     * @exception ScriptException
+     *                if an error occurs
+     * @exception NoSuchMethodException
+     *                if the object has no such method
+     */
+    @Override
+    public Object invokeMethod(Object thiz, String name, Object... args)
+            throws ScriptException, NoSuchMethodException {
+        if (!(thiz instanceof String))
+            throw new IllegalArgumentException(
+                    "thiz must be the name of a Python global.");
+
+        return invokeFunction(thiz + "." + name, args);
+    }
+
+    /**
+     * Gets an implementation of an interface backed by functions in the
+     * global scope.
+     * 
+     * @param clasz
+     *            the interface to implement
+     * @return a Proxy instance
+     * @exception IllegalArgumentException
+     *                if it isn't an interface or the proxy can't be made
+     */
+    @Override
+    public <T> T getInterface(Class<T> clasz) {
+        return _getInterface(null, clasz);
+    }
+
+    /**
+     * Gets an implementation of an interface backed by methods of a Python
+     * object. See {@link #invokeMethod(Object, String, Object...)}.
+     * 
+     * @param thiz
+     *            a <code>String</code> name of a Python global
+     * @param clasz
+     *            the interface to implement
+     * @return a Proxy instance
+     * @exception IllegalArgumentException
+     *                if thiz isn't found, it isn't an interface or the proxy
+     *                can't be made
+     */
+    @Override
+    public <T> T getInterface(Object thiz, Class<T> clasz) {
+        if (!(thiz instanceof String))
+            throw new IllegalArgumentException(
+                    "thiz must be the name of a Python global.");
+
+        return _getInterface((String) thiz, clasz);
+    }
+
+    // target is the name of a global, or null for the global scope
+    private <T> T _getInterface(String target, Class<T> clasz) {
+        if (clasz == null || !clasz.isInterface())
+            throw new IllegalArgumentException("Not an interface: " + clasz);
+
+        try {
+            return clasz.cast(this.jep.proxy(target, clasz));
+        } catch (JepException e) {
+            throw new IllegalArgumentException(e.getMessage(), e);
+        }
+    }
+
     /**
      * Describe <code>getFactory</code> method here.
      * 
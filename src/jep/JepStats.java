@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep;
+
+import java.lang.management.ManagementFactory;
+
+import javax.management.JMException;
+import javax.management.MBeanServer;
+import javax.management.ObjectName;
+
+/**
+ * Runtime counters of a Jep, see {@link Jep#setStatsEnabled(boolean)}. The
+ * counters are kept natively and can be read from any thread, e.g. by a JMX
+ * client through the <code>jep:type=JepStats</code> MBean registered for
+ * each Jep that has enabled them. The same counters are available to Python
+ * as <code>jep.stats()</code>.
+ * 
+ * @version $Id: $
+ */
+public final class JepStats implements JepStatsMBean {
+
+    // indexes of the native counters, these must be the same as pyembed.h
+    private static final int JAVA_CALLS = 0;
+
+    private static final int OBJECTS_CREATED = 1;
+
+    private static final int TYPE_LOOKUPS = 2;
+
+    private static final int JAVA_EXCEPTIONS = 3;
+
+    private static final int PYTHON_EXCEPTIONS = 4;
+
+    private static final int GIL_ACQUIRES = 5;
+
+    private static final int GIL_WAIT_NANOS = 6;
+
+    private static final int INTERPRETER_NANOS = 7;
+
+    private static final int BYTES_CONVERTED = 8;
+
+    private static final int COUNT = 9;
+
+    private final Jep jep;
+
+    private volatile boolean enabled = false;
+
+    // the counters when the Jep closed
+    private long[] last = null;
+
+    private ObjectName name = null;
+
+    JepStats(Jep jep) {
+        this.jep = jep;
+    }
+
+    /*
+     * Registers the MBean with the platform MBean server. Stats still work
+     * without JMX, so failing to register isn't an error.
+     */
+    void register(String threadName) {
+        try {
+            MBeanServer server = ManagementFactory.getPlatformMBeanServer();
+            ObjectName on = new ObjectName("jep:type=JepStats,thread="
+                    + ObjectName.quote(threadName) + ",id="
+                    + Integer.toHexString(System.identityHashCode(jep)));
+            server.registerMBean(this, on);
+            this.name = on;
+        } catch (JMException e) {
+            // not available through JMX
+        } catch (SecurityException e) {
+            // not available through JMX
+        }
+    }
+
+    void setEnabled(boolean enabled) {
+        this.enabled = enabled;
+    }
+
+    /*
+     * Keeps the final counters and unregisters the MBean. Synchronized with
+     * read() so the native counters aren't read after they are freed.
+     */
+    synchronized void close() {
+        this.last = this.jep.readStats();
+        this.enabled = false;
+        if (this.name != null) {
+            try {
+                ManagementFactory.getPlatformMBeanServer()
+                        .unregisterMBean(this.name);
+            } catch (JMException e) {
+                // already gone
+            }
+            this.name = null;
+        }
+    }
+
+    private synchronized long read(int index) {
+        if (this.last != null)
+            return this.last[index];
+        return this.jep.readStats()[index];
+    }
+
+    /**
+     * Gets all the counters at once.
+     * 
+     * @return the counters in the order of the getters of
+     *         {@link JepStatsMBean}
+     */
+    public synchronized long[] toArray() {
+        if (this.last != null)
+            return this.last.clone();
+        return this.jep.readStats();
+    }
+
+    @Override
+    public boolean isEnabled() {
+        return this.enabled;
+    }
+
+    @Override
+    public long getJavaCalls() {
+        return read(JAVA_CALLS);
+    }
+
+    @Override
+    public long getObjectsCreated() {
+        return read(OBJECTS_CREATED);
+    }
+
+    @Override
+    public long getTypeLookups() {
+        return read(TYPE_LOOKUPS);
+    }
+
+    @Override
+    public long getJavaExceptions() {
+        return read(JAVA_EXCEPTIONS);
+    }
+
+    @Override
+    public long getPythonExceptions() {
+        return read(PYTHON_EXCEPTIONS);
+    }
+
+    @Override
+    public long getGilAcquires() {
+        return read(GIL_ACQUIRES);
+    }
+
+    @Override
+    public long getGilWaitNanos() {
+        return read(GIL_WAIT_NANOS);
+    }
+
+    @Override
+    public long getInterpreterNanos() {
+        return read(INTERPRETER_NANOS);
+    }
+
+    @Override
+    public long getBytesConverted() {
+        return read(BYTES_CONVERTED);
+    }
+
+    @Override
+    public String toString() {
+        long[] c = toArray();
+        StringBuilder sb = new StringBuilder("JepStats[enabled=")
+                .append(this.enabled);
+        String[] names = { "javaCalls", "objectsCreated", "typeLookups",
+                "javaExceptions", "pythonExceptions", "gilAcquires",
+                "gilWaitNanos", "interpreterNanos", "bytesConverted" };
+        for (int i = 0; i < COUNT; i++)
+            sb.append(", ").append(names[i]).append('=').append(c[i]);
+        return sb.append(']').toString();
+    }
+}
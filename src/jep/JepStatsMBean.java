@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep;
+
+/**
+ * The JMX management interface of {@link JepStats}.
+ * 
+ * @version $Id: $
+ */
+public interface JepStatsMBean {
+
+    /**
+     * @return if the counters are being updated
+     */
+    public boolean isEnabled();
+
+    /**
+     * @return Java methods and constructors called from Python
+     */
+    public long getJavaCalls();
+
+    /**
+     * @return Python wrappers made for Java objects
+     */
+    public long getObjectsCreated();
+
+    /**
+     * @return times the Jep type of a Java class was looked up
+     */
+    public long getTypeLookups();
+
+    /**
+     * @return Java exceptions raised in Python
+     */
+    public long getJavaExceptions();
+
+    /**
+     * @return Python exceptions thrown to Java
+     */
+    public long getPythonExceptions();
+
+    /**
+     * @return times Java entered the interpreter
+     */
+    public long getGilAcquires();
+
+    /**
+     * @return nanoseconds spent waiting for the GIL to enter the interpreter
+     */
+    public long getGilWaitNanos();
+
+    /**
+     * Not the time the GIL was held, Java methods called from Python
+     * release the GIL but are counted.
+     * 
+     * @return nanoseconds spent in the interpreter after entering it from
+     *         Java, including calls Python makes back into Java
+     */
+    public long getInterpreterNanos();
+
+    /**
+     * @return bytes of array data copied between Java and Python
+     */
+    public long getBytesConverted();
+}
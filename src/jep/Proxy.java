@@ -26,6 +26,8 @@ package jep;
 
 import java.lang.reflect.InvocationHandler;
 
+import jep.python.PyObject;
+
 /**
  * Extends java.lang.reflect.Proxy for callbacks.
  * 
@@ -51,7 +53,8 @@ public class Proxy extends java.lang.reflect.Proxy {
      * <pre>
      * Returns an instance of a proxy class for the specified
      * interfaces that dispatches method invocations to the specified
-     * invocation handler. This method is equivalent to:
+     * invocation handler. A class generated by ProxyGenerator is
+     * used when it can be, otherwise this is equivalent to:
      * 
      * Proxy.getProxyClass(loader, interfaces).
      *     getConstructor(new Class[] { InvocationHandler.class }).
@@ -80,13 +83,6 @@ public class Proxy extends java.lang.reflect.Proxy {
             ClassLoader loader, String[] interfaces)
             throws IllegalArgumentException {
 
-        InvocationHandler ih = null;
-        try {
-            ih = new jep.InvocationHandler(tstate, ltarget, jep);
-        } catch (JepException e) {
-            throw new IllegalArgumentException(e);
-        }
-
         Class classes[] = new Class[interfaces.length];
         try {
             for (int i = 0; i < interfaces.length; i++)
@@ -95,6 +91,83 @@ public class Proxy extends java.lang.reflect.Proxy {
             throw new IllegalArgumentException(e);
         }
 
-        return Proxy.newProxyInstance(loader, classes, ih);
+        return newProxyInstance(tstate, ltarget, jep, loader, classes);
+    }
+
+    /**
+     * Like {@link #newProxyInstance(long, long, Jep, ClassLoader, String[])}
+     * for interfaces that are already loaded.
+     * 
+     * @param tstate
+     *            a <code>long</code> value
+     * @param ltarget
+     *            a <code>long</code> value
+     * @param jep
+     *            a <code>Jep</code> value
+     * @param loader
+     *            the class loader to define the proxy class
+     * @param classes
+     *            the interfaces to implement
+     * @return an <code>Object</code> value
+     * @exception IllegalArgumentException
+     *                if an error occurs
+     */
+    static Object newProxyInstance(long tstate, long ltarget, Jep jep,
+            ClassLoader loader, Class<?>[] classes)
+            throws IllegalArgumentException {
+        try {
+            // a generated class passes primitives without boxing them
+            Object proxy = ProxyGenerator.newProxyInstance(tstate, ltarget,
+                    jep, loader, classes);
+            if (proxy != null)
+                return proxy;
+
+            InvocationHandler ih = new jep.InvocationHandler(tstate, ltarget,
+                    jep);
+            proxy = Proxy.newProxyInstance(loader, classes, ih);
+            jep.trackProxyTarget(proxy, new PyObject(tstate, ltarget, jep));
+            return proxy;
+        } catch (JepException e) {
+            throw new IllegalArgumentException(e);
+        }
+    }
+
+    /**
+     * Checks if a Python callable can be converted to an interface, i.e.
+     * the interface has a single abstract method.
+     * 
+     * @param iface
+     *            the parameter type
+     * @return a <code>boolean</code> value
+     */
+    public static boolean isFunctional(Class<?> iface) {
+        return ProxyGenerator.isFunctional(iface);
+    }
+
+    /**
+     * Returns an instance of a functional interface that calls a Python
+     * callable for its single abstract method.
+     * 
+     * @param tstate
+     *            a <code>long</code> value
+     * @param ltarget
+     *            the Python callable, increfed by the caller
+     * @param jep
+     *            a <code>Jep</code> value
+     * @param iface
+     *            the interface to implement
+     * @return an <code>Object</code> value, or null if the interface isn't
+     *         functional
+     * @exception IllegalArgumentException
+     *                if an error occurs
+     */
+    public static Object newFunctionalInstance(long tstate, long ltarget,
+            Jep jep, Class<?> iface) throws IllegalArgumentException {
+        try {
+            return ProxyGenerator.newFunctionalInstance(tstate, ltarget, jep,
+                    iface);
+        } catch (JepException e) {
+            throw new IllegalArgumentException(e);
+        }
     }
 }
@@ -0,0 +1,660 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep;
+
+import java.io.ByteArrayOutputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.lang.ref.Reference;
+import java.lang.ref.WeakReference;
+import java.lang.reflect.Constructor;
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.lang.reflect.Modifier;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.WeakHashMap;
+
+import jep.python.PyObject;
+
+/**
+ * Generates and caches {@link GeneratedProxy} subclasses implementing a set
+ * of interfaces, so calls from Java to Python don't have to go through
+ * java.lang.reflect.Proxy. Primitive arguments and results are passed
+ * without boxing them or allocating an argument array.
+ * 
+ * <b>Internal use only.</b>
+ * 
+ * @version $Id: $
+ */
+final class ProxyGenerator {
+
+    private static final String SUPER = "jep/GeneratedProxy";
+
+    private static final String CONSTRUCTOR = "(JJLjep/Jep;[Ljava/lang/reflect/Method;)V";
+
+    /*
+     * the generated classes by loader and interface names. held weakly so
+     * neither the loader nor the classes are kept alive, each proxy keeps
+     * its Generated. NOT_GENERATED if a class can't be made.
+     */
+    private static final Map<ClassLoader, Map<List<String>, Reference<Generated>>> generated = new WeakHashMap<ClassLoader, Map<List<String>, Reference<Generated>>>();
+
+    private static final Reference<Generated> NOT_GENERATED = new WeakReference<Generated>(
+            null);
+
+    private static int count = 0;
+
+    private static final class Generated {
+
+        final Constructor<?> constructor;
+
+        final Method[] methods;
+
+        // names in one loader can still be different classes
+        final Class<?>[] interfaces;
+
+        Generated(Constructor<?> constructor, Method[] methods,
+                Class<?>[] interfaces) {
+            this.constructor = constructor;
+            this.methods = methods;
+            this.interfaces = interfaces;
+        }
+    }
+
+    /**
+     * Defines classes in a loader that sees both the interfaces and jep.
+     */
+    private static final class ProxyClassLoader extends ClassLoader {
+
+        ProxyClassLoader(ClassLoader parent) {
+            super(parent);
+        }
+
+        Class<?> define(String name, byte[] b) {
+            return defineClass(name, b, 0, b.length);
+        }
+
+        @Override
+        protected Class<?> findClass(String name)
+                throws ClassNotFoundException {
+            // the interfaces' loader may not see jep itself
+            return Class.forName(name, false,
+                    GeneratedProxy.class.getClassLoader());
+        }
+    }
+
+    private ProxyGenerator() {
+    }
+
+    /**
+     * Creates a proxy for a Python object implementing the interfaces.
+     * 
+     * @param tstate
+     *            the thread state id
+     * @param target
+     *            the python object's id
+     * @param jep
+     *            the jep interpreter
+     * @param loader
+     *            the class loader that loaded the interfaces
+     * @param interfaces
+     *            the interfaces to implement
+     * @return the proxy, or null if a class can't be generated for these
+     *         interfaces and java.lang.reflect.Proxy should be used
+     * @exception JepException
+     *                if an error occurs
+     */
+    static Object newProxyInstance(long tstate, long target, Jep jep,
+            ClassLoader loader, Class<?>[] interfaces) throws JepException {
+        Generated g = getGenerated(loader, interfaces);
+        if (g == null)
+            return null;
+        GeneratedProxy proxy = construct(g, tstate, target, jep);
+        // pyembed_jproxy increfs the target, jep releases it once the proxy
+        // is collected
+        jep.trackProxyTarget(proxy, new PyObject(tstate, target, jep));
+        return proxy;
+    }
+
+    /**
+     * Checks if a Python callable can be passed as the interface, i.e. it is
+     * a public interface with a single abstract method.
+     * 
+     * @param iface
+     *            the parameter type
+     * @return if the interface is functional
+     */
+    static boolean isFunctional(Class<?> iface) {
+        if (!iface.isInterface())
+            return false;
+        Generated g = getGenerated(iface.getClassLoader(),
+                new Class<?>[] { iface });
+        return g != null && g.methods.length == 1;
+    }
+
+    /**
+     * Creates a proxy calling a Python callable for the single abstract
+     * method of a functional interface.
+     * 
+     * @param tstate
+     *            the thread state id
+     * @param target
+     *            the python callable's id
+     * @param jep
+     *            the jep interpreter
+     * @param iface
+     *            the interface to implement
+     * @return the proxy, or null if the interface isn't functional
+     * @exception JepException
+     *                if an error occurs
+     */
+    static Object newFunctionalInstance(long tstate, long target, Jep jep,
+            Class<?> iface) throws JepException {
+        if (!isFunctional(iface))
+            return null;
+
+        Generated g = getGenerated(iface.getClassLoader(),
+                new Class<?>[] { iface });
+        GeneratedProxy proxy = construct(g, tstate, target, jep);
+        proxy.dispatchToTarget();
+        // pyembed_callable_proxy increfs the callable, callables are often
+        // short lived so it's released once the proxy is collected
+        jep.trackProxyTarget(proxy, new PyObject(tstate, target, jep));
+        return proxy;
+    }
+
+    private static GeneratedProxy construct(Generated g, long tstate,
+            long target, Jep jep) throws JepException {
+        try {
+            GeneratedProxy proxy = (GeneratedProxy) g.constructor
+                    .newInstance(new Object[] { tstate, target, jep,
+                            g.methods });
+            proxy.generated = g;
+            return proxy;
+        } catch (InvocationTargetException e) {
+            if (e.getCause() instanceof JepException)
+                throw (JepException) e.getCause();
+            throw new JepException(e.getCause());
+        } catch (Exception e) {
+            throw new JepException(e);
+        }
+    }
+
+    private static synchronized Generated getGenerated(ClassLoader loader,
+            Class<?>[] interfaces) {
+        Map<List<String>, Reference<Generated>> byNames = generated
+                .get(loader);
+        if (byNames == null) {
+            byNames = new HashMap<List<String>, Reference<Generated>>();
+            generated.put(loader, byNames);
+        }
+
+        List<String> key = new ArrayList<String>(interfaces.length);
+        for (Class<?> iface : interfaces)
+            key.add(iface.getName());
+        Reference<Generated> ref = byNames.get(key);
+        if (ref == NOT_GENERATED)
+            return null;
+        Generated g = ref == null ? null : ref.get();
+        if (g != null && Arrays.equals(g.interfaces, interfaces))
+            return g;
+
+        try {
+            g = generate(loader, interfaces.clone());
+        } catch (Exception e) {
+            // let java.lang.reflect.Proxy deal with it
+        } catch (LinkageError e) {
+            // e.g. an interface that isn't visible from the loader
+        }
+        byNames.put(key, g == null ? NOT_GENERATED
+                : new WeakReference<Generated>(g));
+        return g;
+    }
+
+    private static Generated generate(ClassLoader loader,
+            Class<?>[] interfaces) throws Exception {
+        Map<String, Method> methods = new LinkedHashMap<String, Method>();
+        for (Class<?> iface : interfaces) {
+            // non-public interfaces need a class in their own package
+            if (!iface.isInterface() || !Modifier.isPublic(iface.getModifiers()))
+                return null;
+
+            for (Method method : iface.getMethods()) {
+                // static and default methods stay with the interface
+                if (!Modifier.isAbstract(method.getModifiers())
+                        || isObjectMethod(method))
+                    continue;
+
+                String key = method.getName()
+                        + parameterDescriptor(method.getParameterTypes());
+                Method other = methods.get(key);
+                if (other == null)
+                    methods.put(key, method);
+                else if (other.getReturnType() != method.getReturnType())
+                    return null;
+            }
+        }
+
+        String name = "jep.proxy.$Proxy" + count++;
+
+        Method[] list = methods.values().toArray(new Method[methods.size()]);
+        byte[] b = new ClassWriter(name.replace('.', '/'), interfaces, list)
+                .toByteArray();
+
+        Class<?> clazz = new ProxyClassLoader(loader).define(name, b);
+        // the loader has to agree with the caller on the classes involved
+        if (!GeneratedProxy.class.isAssignableFrom(clazz)
+                || !Arrays.equals(clazz.getInterfaces(), interfaces))
+            return null;
+
+        Constructor<?> constructor = clazz.getConstructor(Long.TYPE,
+                Long.TYPE, Jep.class, Method[].class);
+        return new Generated(constructor, list, interfaces);
+    }
+
+    // the proxy keeps Object's equals, hashCode and toString
+    private static boolean isObjectMethod(Method method) {
+        try {
+            Object.class.getMethod(method.getName(),
+                    method.getParameterTypes());
+            return true;
+        } catch (NoSuchMethodException e) {
+            return false;
+        }
+    }
+
+    private static String parameterDescriptor(Class<?>[] params) {
+        StringBuilder sb = new StringBuilder("(");
+        for (Class<?> param : params)
+            sb.append(descriptor(param));
+        return sb.append(')').toString();
+    }
+
+    private static String descriptor(Class<?> clazz) {
+        if (clazz == Integer.TYPE)
+            return "I";
+        if (clazz == Long.TYPE)
+            return "J";
+        if (clazz == Double.TYPE)
+            return "D";
+        if (clazz == Float.TYPE)
+            return "F";
+        if (clazz == Boolean.TYPE)
+            return "Z";
+        if (clazz == Short.TYPE)
+            return "S";
+        if (clazz == Byte.TYPE)
+            return "B";
+        if (clazz == Character.TYPE)
+            return "C";
+        if (clazz == Void.TYPE)
+            return "V";
+        if (clazz.isArray())
+            return clazz.getName().replace('.', '/');
+        return "L" + clazz.getName().replace('.', '/') + ";";
+    }
+
+    // the name a CONSTANT_Class uses, arrays use their descriptor
+    private static String internalName(Class<?> clazz) {
+        if (clazz.isArray())
+            return descriptor(clazz);
+        return clazz.getName().replace('.', '/');
+    }
+
+    /**
+     * Writes a class file with just enough of the format for the proxy
+     * methods. There are no branches, so no stack map frames are needed.
+     */
+    private static final class ClassWriter {
+
+        // java 5, the interfaces may be newer
+        private static final int VERSION = 49;
+
+        private static final int ACC_PUBLIC = 0x0001;
+
+        private static final int ACC_FINAL = 0x0010;
+
+        private static final int ACC_SUPER = 0x0020;
+
+        // opcodes
+        private static final int ICONST_0 = 0x03;
+
+        private static final int BIPUSH = 0x10;
+
+        private static final int SIPUSH = 0x11;
+
+        private static final int ILOAD = 0x15;
+
+        private static final int LLOAD = 0x16;
+
+        private static final int FLOAD = 0x17;
+
+        private static final int DLOAD = 0x18;
+
+        private static final int ALOAD = 0x19;
+
+        private static final int ALOAD_0 = 0x2a;
+
+        private static final int I2L = 0x85;
+
+        private static final int F2D = 0x8d;
+
+        private static final int L2I = 0x88;
+
+        private static final int D2F = 0x90;
+
+        private static final int I2B = 0x91;
+
+        private static final int I2C = 0x92;
+
+        private static final int I2S = 0x93;
+
+        private static final int IRETURN = 0xac;
+
+        private static final int LRETURN = 0xad;
+
+        private static final int FRETURN = 0xae;
+
+        private static final int DRETURN = 0xaf;
+
+        private static final int ARETURN = 0xb0;
+
+        private static final int RETURN = 0xb1;
+
+        private static final int INVOKEVIRTUAL = 0xb6;
+
+        private static final int INVOKESPECIAL = 0xb7;
+
+        private static final int CHECKCAST = 0xc0;
+
+        private final ByteArrayOutputStream poolBytes = new ByteArrayOutputStream();
+
+        private final DataOutputStream pool = new DataOutputStream(poolBytes);
+
+        private final Map<String, Integer> constants = new HashMap<String, Integer>();
+
+        private int poolCount = 1;
+
+        private final String name;
+
+        private final Class<?>[] interfaces;
+
+        private final Method[] methods;
+
+        ClassWriter(String name, Class<?>[] interfaces, Method[] methods) {
+            this.name = name;
+            this.interfaces = interfaces;
+            this.methods = methods;
+        }
+
+        byte[] toByteArray() throws IOException {
+            ByteArrayOutputStream methodBytes = new ByteArrayOutputStream();
+            DataOutputStream out = new DataOutputStream(methodBytes);
+            writeConstructor(out);
+            for (int i = 0; i < methods.length; i++)
+                writeMethod(out, methods[i], i);
+
+            int thisClass = classRef(name);
+            int superClass = classRef(SUPER);
+            List<Integer> ifaces = new ArrayList<Integer>();
+            for (Class<?> iface : interfaces)
+                ifaces.add(classRef(internalName(iface)));
+
+            ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+            DataOutputStream cf = new DataOutputStream(bytes);
+            cf.writeInt(0xCAFEBABE);
+            cf.writeShort(0);
+            cf.writeShort(VERSION);
+            cf.writeShort(poolCount);
+            pool.flush();
+            poolBytes.writeTo(cf);
+            cf.writeShort(ACC_PUBLIC | ACC_FINAL | ACC_SUPER);
+            cf.writeShort(thisClass);
+            cf.writeShort(superClass);
+            cf.writeShort(ifaces.size());
+            for (int iface : ifaces)
+                cf.writeShort(iface);
+            cf.writeShort(0); // fields
+            cf.writeShort(methods.length + 1);
+            out.flush();
+            methodBytes.writeTo(cf);
+            cf.writeShort(0); // attributes
+            cf.flush();
+            return bytes.toByteArray();
+        }
+
+        private void writeConstructor(DataOutputStream out)
+                throws IOException {
+            ByteArrayOutputStream code = new ByteArrayOutputStream();
+            code.write(ALOAD_0);
+            code.write(LLOAD);
+            code.write(1);
+            code.write(LLOAD);
+            code.write(3);
+            code.write(ALOAD);
+            code.write(5);
+            code.write(ALOAD);
+            code.write(6);
+            writeRef(code, INVOKESPECIAL,
+                    methodRef(SUPER, "<init>", CONSTRUCTOR));
+            code.write(RETURN);
+            writeMethodInfo(out, ACC_PUBLIC, "<init>", CONSTRUCTOR, 7, 7,
+                    code.toByteArray());
+        }
+
+        /*
+         * Checks the thread, stores each argument with argLong, argDouble or
+         * argObject, then calls the call method for the return type and
+         * converts its result.
+         */
+        private void writeMethod(DataOutputStream out, Method method,
+                int index) throws IOException {
+            ByteArrayOutputStream code = new ByteArrayOutputStream();
+            Class<?>[] params = method.getParameterTypes();
+            int local = 1;
+            // before any argument is stored in the shared arrays
+            code.write(ALOAD_0);
+            writeRef(code, INVOKEVIRTUAL,
+                    methodRef(SUPER, "checkThread", "()V"));
+            for (int i = 0; i < params.length; i++) {
+                Class<?> p = params[i];
+                code.write(ALOAD_0);
+                writeInt(code, i);
+                if (p == Long.TYPE) {
+                    code.write(LLOAD);
+                    code.write(local);
+                    local += 2;
+                    writeRef(code, INVOKEVIRTUAL,
+                            methodRef(SUPER, "argLong", "(IJ)V"));
+                } else if (p == Double.TYPE) {
+                    code.write(DLOAD);
+                    code.write(local);
+                    local += 2;
+                    writeRef(code, INVOKEVIRTUAL,
+                            methodRef(SUPER, "argDouble", "(ID)V"));
+                } else if (p == Float.TYPE) {
+                    code.write(FLOAD);
+                    code.write(local++);
+                    code.write(F2D);
+                    writeRef(code, INVOKEVIRTUAL,
+                            methodRef(SUPER, "argDouble", "(ID)V"));
+                } else if (p.isPrimitive()) {
+                    code.write(ILOAD);
+                    code.write(local++);
+                    code.write(I2L);
+                    writeRef(code, INVOKEVIRTUAL,
+                            methodRef(SUPER, "argLong", "(IJ)V"));
+                } else {
+                    code.write(ALOAD);
+                    code.write(local++);
+                    writeRef(code, INVOKEVIRTUAL, methodRef(SUPER,
+                            "argObject", "(ILjava/lang/Object;)V"));
+                }
+            }
+
+            Class<?> r = method.getReturnType();
+            code.write(ALOAD_0);
+            writeInt(code, index);
+            if (r == Void.TYPE) {
+                writeRef(code, INVOKEVIRTUAL,
+                        methodRef(SUPER, "callVoid", "(I)V"));
+                code.write(RETURN);
+            } else if (r == Boolean.TYPE) {
+                writeRef(code, INVOKEVIRTUAL,
+                        methodRef(SUPER, "callBoolean", "(I)Z"));
+                code.write(IRETURN);
+            } else if (r == Double.TYPE || r == Float.TYPE) {
+                writeRef(code, INVOKEVIRTUAL,
+                        methodRef(SUPER, "callDouble", "(I)D"));
+                if (r == Float.TYPE) {
+                    code.write(D2F);
+                    code.write(FRETURN);
+                } else {
+                    code.write(DRETURN);
+                }
+            } else if (r.isPrimitive()) {
+                writeRef(code, INVOKEVIRTUAL,
+                        methodRef(SUPER, "callLong", "(I)J"));
+                if (r == Long.TYPE) {
+                    code.write(LRETURN);
+                } else {
+                    // the native side checked the range
+                    code.write(L2I);
+                    if (r == Short.TYPE)
+                        code.write(I2S);
+                    else if (r == Byte.TYPE)
+                        code.write(I2B);
+                    else if (r == Character.TYPE)
+                        code.write(I2C);
+                    code.write(IRETURN);
+                }
+            } else {
+                writeRef(code, INVOKEVIRTUAL, methodRef(SUPER, "callObject",
+                        "(I)Ljava/lang/Object;"));
+                if (r != Object.class)
+                    writeRef(code, CHECKCAST, classRef(internalName(r)));
+                code.write(ARETURN);
+            }
+
+            // this, the index and a wide argument
+            writeMethodInfo(out, ACC_PUBLIC | ACC_FINAL, method.getName(),
+                    parameterDescriptor(params) + descriptor(r), 4, local,
+                    code.toByteArray());
+        }
+
+        private void writeMethodInfo(DataOutputStream out, int access,
+                String methodName, String desc, int maxStack, int maxLocals,
+                byte[] code) throws IOException {
+            int nameIndex = utf8(methodName);
+            int descIndex = utf8(desc);
+            int codeIndex = utf8("Code");
+
+            out.writeShort(access);
+            out.writeShort(nameIndex);
+            out.writeShort(descIndex);
+            out.writeShort(1); // attributes
+            out.writeShort(codeIndex);
+            out.writeInt(12 + code.length);
+            out.writeShort(maxStack);
+            out.writeShort(maxLocals);
+            out.writeInt(code.length);
+            out.write(code);
+            out.writeShort(0); // exception table
+            out.writeShort(0); // attributes
+        }
+
+        private static void writeInt(ByteArrayOutputStream code, int value) {
+            if (value <= 5) {
+                code.write(ICONST_0 + value);
+            } else if (value < 128) {
+                code.write(BIPUSH);
+                code.write(value);
+            } else {
+                code.write(SIPUSH);
+                code.write(value >> 8);
+                code.write(value);
+            }
+        }
+
+        private static void writeRef(ByteArrayOutputStream code, int opcode,
+                int index) {
+            code.write(opcode);
+            code.write(index >> 8);
+            code.write(index);
+        }
+
+        private int utf8(String s) throws IOException {
+            Integer index = constants.get("U" + s);
+            if (index == null) {
+                pool.writeByte(1);
+                pool.writeUTF(s);
+                index = add("U" + s);
+            }
+            return index;
+        }
+
+        private int classRef(String internal) throws IOException {
+            Integer index = constants.get("C" + internal);
+            if (index == null) {
+                int nameIndex = utf8(internal);
+                pool.writeByte(7);
+                pool.writeShort(nameIndex);
+                index = add("C" + internal);
+            }
+            return index;
+        }
+
+        private int methodRef(String owner, String methodName, String desc)
+                throws IOException {
+            String key = "M" + owner + "." + methodName + desc;
+            Integer index = constants.get(key);
+            if (index == null) {
+                int classIndex = classRef(owner);
+                int nameIndex = utf8(methodName);
+                int descIndex = utf8(desc);
+                pool.writeByte(12);
+                pool.writeShort(nameIndex);
+                pool.writeShort(descIndex);
+                int nameAndType = add("N" + key);
+                pool.writeByte(10);
+                pool.writeShort(classIndex);
+                pool.writeShort(nameAndType);
+                index = add(key);
+            }
+            return index;
+        }
+
+        private int add(String key) {
+            int index = poolCount++;
+            constants.put(key, index);
+            return index;
+        }
+    }
+}
@@ -59,6 +59,10 @@ public final class Util {
 
     public static final int JCLASS_ID = 12;
 
+    // the type must be found from the argument itself, for parameters
+    // declared as Object or an interface
+    public static final int JDYNAMIC_ID = -2;
+
     private Util() {
     }
 
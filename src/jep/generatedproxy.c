@@ -0,0 +1,190 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 c-style: "K&R" -*- */
+/* 
+   jep - Java Embedded Python
+
+   Copyright (c) 2015 JEP AUTHORS.
+
+   This file is licenced under the the zlib/libpng License.
+
+   This software is provided 'as-is', without any express or implied
+   warranty. In no event will the authors be held liable for any
+   damages arising from the use of this software.
+   
+   Permission is granted to anyone to use this software for any
+   purpose, including commercial applications, and to alter it and
+   redistribute it freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you
+   must not claim that you wrote the original software. If you use
+   this software in a product, an acknowledgment in the product
+   documentation would be appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and
+   must not be misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.   
+*/
+
+#include "generatedproxy.h"
+
+#include "util.h"
+#include "pyembed.h"
+
+
+// called by the methods of classes jep.ProxyGenerator makes, the
+// arguments and result of each call are passed without boxing them.
+
+
+/*
+ * Calls the python method and converts its result to returnTypeId, see
+ * pyembed_unbox_result.  Returns 0 with a java exception thrown.
+ */
+static int generatedproxy_invoke(JNIEnv *env,
+                                 jlong _jepThread,
+                                 jlong _callable,
+                                 jintArray types,
+                                 jlongArray prims,
+                                 jobjectArray objs,
+                                 int returnTypeId,
+                                 jclass returnType,
+                                 jvalue *out) {
+    JepThread     *jepThread;
+    PyObject      *pyret;
+    int            ok = 0;
+
+    jepThread = (JepThread *) (intptr_t) _jepThread;
+    if(!jepThread || !_callable) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return 0;
+    }
+
+    pyembed_acquire_thread(jepThread);
+    pyret = pyembed_call_unboxed(env,
+                                 (PyObject *) (intptr_t) _callable,
+                                 types,
+                                 prims,
+                                 objs);
+    if(pyret) {
+        ok = pyembed_unbox_result(env, pyret, returnTypeId, returnType, out);
+        Py_DECREF(pyret);
+    }
+    pyembed_release_thread(jepThread);
+
+    return ok;
+}
+
+
+/*
+ * Class:     jep_GeneratedProxy
+ * Method:    invokeVoid
+ * Signature: (JJ[I[J[Ljava/lang/Object;)V
+ */
+JNIEXPORT void JNICALL Java_jep_GeneratedProxy_invokeVoid
+(JNIEnv *env,
+ jclass clazz,
+ jlong jepThread,
+ jlong callable,
+ jintArray types,
+ jlongArray prims,
+ jobjectArray objs) {
+
+    jvalue ret;
+
+    generatedproxy_invoke(env, jepThread, callable, types, prims, objs,
+                          JVOID_ID, NULL, &ret);
+}
+
+
+/*
+ * Class:     jep_GeneratedProxy
+ * Method:    invokeLong
+ * Signature: (JJ[I[J[Ljava/lang/Object;I)J
+ */
+JNIEXPORT jlong JNICALL Java_jep_GeneratedProxy_invokeLong
+(JNIEnv *env,
+ jclass clazz,
+ jlong jepThread,
+ jlong callable,
+ jintArray types,
+ jlongArray prims,
+ jobjectArray objs,
+ jint returnType) {
+
+    jvalue ret;
+
+    if(!generatedproxy_invoke(env, jepThread, callable, types, prims, objs,
+                              (int) returnType, NULL, &ret))
+        return 0;
+    return ret.j;
+}
+
+
+/*
+ * Class:     jep_GeneratedProxy
+ * Method:    invokeDouble
+ * Signature: (JJ[I[J[Ljava/lang/Object;)D
+ */
+JNIEXPORT jdouble JNICALL Java_jep_GeneratedProxy_invokeDouble
+(JNIEnv *env,
+ jclass clazz,
+ jlong jepThread,
+ jlong callable,
+ jintArray types,
+ jlongArray prims,
+ jobjectArray objs) {
+
+    jvalue ret;
+
+    if(!generatedproxy_invoke(env, jepThread, callable, types, prims, objs,
+                              JDOUBLE_ID, NULL, &ret))
+        return 0;
+    return ret.d;
+}
+
+
+/*
+ * Class:     jep_GeneratedProxy
+ * Method:    invokeBoolean
+ * Signature: (JJ[I[J[Ljava/lang/Object;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_jep_GeneratedProxy_invokeBoolean
+(JNIEnv *env,
+ jclass clazz,
+ jlong jepThread,
+ jlong callable,
+ jintArray types,
+ jlongArray prims,
+ jobjectArray objs) {
+
+    jvalue ret;
+
+    if(!generatedproxy_invoke(env, jepThread, callable, types, prims, objs,
+                              JBOOLEAN_ID, NULL, &ret))
+        return JNI_FALSE;
+    return ret.z;
+}
+
+
+/*
+ * Class:     jep_GeneratedProxy
+ * Method:    invokeObject
+ * Signature: (JJ[I[J[Ljava/lang/Object;Ljava/lang/Class;)Ljava/lang/Object;
+ */
+JNIEXPORT jobject JNICALL Java_jep_GeneratedProxy_invokeObject
+(JNIEnv *env,
+ jclass clazz,
+ jlong jepThread,
+ jlong callable,
+ jintArray types,
+ jlongArray prims,
+ jobjectArray objs,
+ jclass returnType) {
+
+    jvalue ret;
+
+    if(!generatedproxy_invoke(env, jepThread, callable, types, prims, objs,
+                              JOBJECT_ID, returnType, &ret))
+        return NULL;
+    return ret.l;
+}
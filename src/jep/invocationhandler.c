@@ -32,57 +32,85 @@
 #include "pyembed.h"
 
 
-// note that this function is called by java, not python. this is
-// different than most of our calls. so i don't use the util functions
-// for exception processing. if there's a java exception, just return
-// NULL.
+// note that these functions are called by java, not python. this is
+// different than most of our calls.
+
 
 /*
  * Class:     jep_InvocationHandler
- * Method:    invoke
- * Signature: (Ljava/lang/String;JJ[Ljava/lang/Object;[Ljava/lang/Class;Ljava/lang/Class;)Ljava/lang/Object;
+ * Method:    getCallable
+ * Signature: (JJLjava/lang/String;)J
  */
-JNIEXPORT jobject JNICALL Java_jep_InvocationHandler_invoke
+JNIEXPORT jlong JNICALL Java_jep_InvocationHandler_getCallable
 (JNIEnv *env,
  jclass clazz,
- jstring jname,
  jlong _jepThread,
  jlong _target,
- jobjectArray args,
- jintArray types,
- jint returnType) {
+ jstring jname) {
 
     JepThread     *jepThread;
-    jobject        ret;
     const char    *cname;
     PyObject      *target;
     PyObject      *callable;
 
-    target   = (PyObject *) (intptr_t) _target;
-    ret      = NULL;
-    callable = NULL;
+    target = (PyObject *) (intptr_t) _target;
 
     jepThread = (JepThread *) (intptr_t) _jepThread;
     if(!jepThread) {
         THROW_JEP(env, "Couldn't get thread objects.");
-        return NULL;
+        return 0;
     }
 
-    PyEval_AcquireThread(jepThread->tstate);
-
-    // now get the callable object
     cname = jstring2char(env, jname);
-    // python docs say this returns a new ref. they lie like dogs.
+    if(!cname)
+        return 0;
+
+    pyembed_acquire_thread(jepThread);
+
+    // the bound method, the java side owns this new ref
     callable = PyObject_GetAttrString(target, (char *) cname);
+    if(process_py_exception(env, 0) && callable) {
+        Py_DECREF(callable);
+        callable = NULL;
+    }
+
+    pyembed_release_thread(jepThread);
     release_utf_char(env, jname, cname);
 
-    if(process_py_exception(env, 0) || !callable)
-        goto EXIT;
+    return (jlong) (intptr_t) callable;
+}
+
+
+/*
+ * Class:     jep_InvocationHandler
+ * Method:    invoke
+ * Signature: (JJ[Ljava/lang/Object;[ILjava/lang/Class;)Ljava/lang/Object;
+ */
+JNIEXPORT jobject JNICALL Java_jep_InvocationHandler_invoke
+(JNIEnv *env,
+ jclass clazz,
+ jlong _jepThread,
+ jlong _callable,
+ jobjectArray args,
+ jintArray types,
+ jclass returnType) {
+
+    JepThread     *jepThread;
+    jobject        ret;
 
-    ret = pyembed_invoke(env, callable, args, types);
+    jepThread = (JepThread *) (intptr_t) _jepThread;
+    if(!jepThread || !_callable) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return NULL;
+    }
 
-EXIT:
-    PyEval_ReleaseThread(jepThread->tstate);
+    pyembed_acquire_thread(jepThread);
+    ret = pyembed_invoke_as(env,
+                            (PyObject *) (intptr_t) _callable,
+                            args,
+                            types,
+                            returnType);
+    pyembed_release_thread(jepThread);
 
     return ret;
 }
@@ -84,6 +84,78 @@ JNIEXPORT void JNICALL Java_jep_Jep_run
 }
 
 
+/*
+ * Class:     jep_Jep
+ * Method:    setCodeCacheDir
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_jep_Jep_setCodeCacheDir
+(JNIEnv *env, jclass clazz, jstring jdir) {
+    const char *dir;
+
+    dir = jstring2char(env, jdir);
+    pyembed_set_code_cache_dir(env, dir);
+    release_utf_char(env, jdir, dir);
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    clearCodeCache
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_jep_Jep_clearCodeCache
+(JNIEnv *env, jclass clazz) {
+    pyembed_clear_code_cache();
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    getCodeCacheStats
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL Java_jep_Jep_getCodeCacheStats
+(JNIEnv *env, jclass clazz) {
+    jeplong    stats[2];
+    jlong      jstats[2];
+    jlongArray ret;
+
+    pyembed_get_code_cache_stats(stats);
+    jstats[0] = (jlong) stats[0];
+    jstats[1] = (jlong) stats[1];
+
+    ret = (*env)->NewLongArray(env, 2);
+    if(ret)
+        (*env)->SetLongArrayRegion(env, ret, 0, 2, jstats);
+    return ret;
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    getLiveCountArray
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL Java_jep_Jep_getLiveCountArray
+(JNIEnv *env, jclass clazz) {
+    jeplong    counts[JEP_LIVE_COUNT + 2 * JEP_REF_SITES];
+    jlong      jcounts[JEP_LIVE_COUNT + 2 * JEP_REF_SITES];
+    jlongArray ret;
+    int        i;
+
+    pyembed_get_live_counts(counts);
+    for(i = 0; i < JEP_LIVE_COUNT + 2 * JEP_REF_SITES; i++)
+        jcounts[i] = (jlong) counts[i];
+
+    ret = (*env)->NewLongArray(env, JEP_LIVE_COUNT + 2 * JEP_REF_SITES);
+    if(ret)
+        (*env)->SetLongArrayRegion(env, ret, 0,
+                                   JEP_LIVE_COUNT + 2 * JEP_REF_SITES, jcounts);
+    return ret;
+}
+
+
 /*
  * Class:     jep_Jep
  * Method:    invoke
@@ -107,6 +179,26 @@ JNIEXPORT jobject JNICALL Java_jep_Jep_invoke
 }
 
 
+/*
+ * Class:     jep_Jep
+ * Method:    lookupGlobal
+ * Signature: (JLjava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_jep_Jep_lookupGlobal
+(JNIEnv *env, jobject obj, jlong tstate, jstring name) {
+    const char *cname = NULL;
+    jlong ret;
+
+    if(name)
+        cname = jstring2char(env, name);
+    ret = pyembed_lookup_target(env, (intptr_t) tstate, cname);
+    if(name)
+        release_utf_char(env, name, cname);
+
+    return ret;
+}
+
+
 /*
  * Class:     jep_Jep
  * Method:    compileString
@@ -124,6 +216,54 @@ JNIEXPORT jint JNICALL Java_jep_Jep_compileString
 }
 
 
+/*
+ * Class:     jep_Jep
+ * Method:    compile
+ * Signature: (JLjava/lang/String;Ljava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_jep_Jep_compile
+(JNIEnv *env, jobject obj, jlong tstate, jstring jstr, jstring jfilename) {
+    const char *str, *filename;
+    jlong ret;
+
+    str      = jstring2char(env, jstr);
+    filename = jstring2char(env, jfilename);
+    ret = (jlong) pyembed_compile_code(env,
+                                       (intptr_t) tstate,
+                                       (char *) str,
+                                       (char *) filename);
+    release_utf_char(env, jstr, str);
+    release_utf_char(env, jfilename, filename);
+    return ret;
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    exec
+ * Signature: (JLjava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_jep_Jep_exec__JLjava_lang_String_2
+(JNIEnv *env, jobject obj, jlong tstate, jstring jstr) {
+    const char *str;
+
+    str = jstring2char(env, jstr);
+    pyembed_exec(env, (intptr_t) tstate, (char *) str);
+    release_utf_char(env, jstr, str);
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    exec
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_jep_Jep_exec__JJ
+(JNIEnv *env, jobject obj, jlong tstate, jlong code) {
+    pyembed_exec_code(env, (intptr_t) tstate, (intptr_t) code);
+}
+
+
 /*
  * Class:     jep_Jep
  * Method:    eval
@@ -156,6 +296,74 @@ JNIEXPORT jobject JNICALL Java_jep_Jep_getValue
 }
 
 
+/*
+ * Class:     jep_Jep
+ * Method:    getLong
+ * Signature: (JLjava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_jep_Jep_getLong
+(JNIEnv *env, jobject obj, jlong tstate, jstring jstr) {
+    const char *str;
+    jlong ret;
+
+    str = jstring2char(env, jstr);
+    ret = pyembed_getvalue_long(env, (intptr_t) tstate, (char *) str);
+    release_utf_char(env, jstr, str);
+    return ret;
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    getDouble
+ * Signature: (JLjava/lang/String;)D
+ */
+JNIEXPORT jdouble JNICALL Java_jep_Jep_getDouble
+(JNIEnv *env, jobject obj, jlong tstate, jstring jstr) {
+    const char *str;
+    jdouble ret;
+
+    str = jstring2char(env, jstr);
+    ret = pyembed_getvalue_double(env, (intptr_t) tstate, (char *) str);
+    release_utf_char(env, jstr, str);
+    return ret;
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    getBoolean
+ * Signature: (JLjava/lang/String;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_jep_Jep_getBoolean
+(JNIEnv *env, jobject obj, jlong tstate, jstring jstr) {
+    const char *str;
+    jboolean ret;
+
+    str = jstring2char(env, jstr);
+    ret = pyembed_getvalue_boolean(env, (intptr_t) tstate, (char *) str);
+    release_utf_char(env, jstr, str);
+    return ret;
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    getValueAs
+ * Signature: (JLjava/lang/String;Ljava/lang/Class;)Ljava/lang/Object;
+ */
+JNIEXPORT jobject JNICALL Java_jep_Jep_getValueAs
+(JNIEnv *env, jobject obj, jlong tstate, jstring jstr, jclass clazz) {
+    const char *str;
+    jobject ret;
+
+    str = jstring2char(env, jstr);
+    ret = pyembed_getvalue_as(env, (intptr_t) tstate, (char *) str, clazz);
+    release_utf_char(env, jstr, str);
+    return ret;
+}
+
+
 /*
  * Class:     jep_Jep
  * Method:    getValue_floatarray
@@ -219,6 +427,50 @@ JNIEXPORT void JNICALL Java_jep_Jep_setClassLoader
 }
 
 
+/*
+ * Class:     jep_Jep
+ * Method:    snapshot
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_jep_Jep_snapshot
+(JNIEnv *env, jobject obj, jlong tstate) {
+    pyembed_snapshot(env, (intptr_t) tstate);
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    reset
+ * Signature: (JZ)V
+ */
+JNIEXPORT void JNICALL Java_jep_Jep_reset
+(JNIEnv *env, jobject obj, jlong tstate, jboolean dropModules) {
+    pyembed_reset(env, (intptr_t) tstate, (int) dropModules);
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    describeException
+ * Signature: (JJ)[Ljava/lang/Object;
+ */
+JNIEXPORT jobjectArray JNICALL Java_jep_Jep_describeException
+(JNIEnv *env, jobject obj, jlong tstate, jlong pyException) {
+    return pyembed_describe_exception(env, (intptr_t) tstate, pyException);
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    releaseExceptions
+ * Signature: (J[J)V
+ */
+JNIEXPORT void JNICALL Java_jep_Jep_releaseExceptions
+(JNIEnv *env, jobject obj, jlong tstate, jlongArray pyExceptions) {
+    pyembed_release_exceptions(env, (intptr_t) tstate, pyExceptions);
+}
+
+
 /*
  * Class:     jep_Jep
  * Method:    close
@@ -442,3 +694,143 @@ JNIEXPORT void JNICALL Java_jep_Jep_set__JLjava_lang_String_2_3F
     pyembed_setparameter_array(env, (intptr_t) tstate, 0, name, (jobjectArray) jarr);
     release_utf_char(env, jname, name);
 }
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    setAll
+ * Signature: (J[Ljava/lang/String;[Ljava/lang/Object;)V
+ */
+JNIEXPORT void JNICALL Java_jep_Jep_setAll
+(JNIEnv *env, jobject obj, jlong tstate, jobjectArray names, jobjectArray values) {
+    pyembed_setparameters(env, (intptr_t) tstate, names, values);
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    getValues
+ * Signature: (J[Ljava/lang/String;)[Ljava/lang/Object;
+ */
+JNIEXPORT jobjectArray JNICALL Java_jep_Jep_getValues
+(JNIEnv *env, jobject obj, jlong tstate, jobjectArray names) {
+    return pyembed_getvalues(env, (intptr_t) tstate, names);
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    slot
+ * Signature: (JLjava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_jep_Jep_slot
+(JNIEnv *env, jobject obj, jlong tstate, jstring jname) {
+    const char *name;
+    jlong ret;
+
+    name = jstring2char(env, jname);
+    ret  = pyembed_slot_new(env, (intptr_t) tstate, 0, name);
+    release_utf_char(env, jname, name);
+    return ret;
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    setStatsEnabled
+ * Signature: (JZ)V
+ */
+JNIEXPORT void JNICALL Java_jep_Jep_setStatsEnabled
+(JNIEnv *env, jobject obj, jlong tstate, jboolean enabled) {
+    pyembed_set_stats_enabled(env, (intptr_t) tstate, enabled ? 1 : 0);
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    getStats
+ * Signature: (J)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_jep_Jep_getStats
+(JNIEnv *env, jclass clazz, jlong tstate) {
+    jeplong    stats[JEP_STAT_COUNT];
+    jlong      jstats[JEP_STAT_COUNT];
+    jlongArray ret;
+    int        i;
+
+    pyembed_get_stats((intptr_t) tstate, stats);
+    for(i = 0; i < JEP_STAT_COUNT; i++)
+        jstats[i] = (jlong) stats[i];
+
+    ret = (*env)->NewLongArray(env, JEP_STAT_COUNT);
+    if(ret)
+        (*env)->SetLongArrayRegion(env, ret, 0, JEP_STAT_COUNT, jstats);
+    return ret;
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    setProfilingEnabled
+ * Signature: (JZ)V
+ */
+JNIEXPORT void JNICALL Java_jep_Jep_setProfilingEnabled
+(JNIEnv *env, jobject obj, jlong tstate, jboolean enabled) {
+    pyembed_set_profile_enabled(env, (intptr_t) tstate, enabled ? 1 : 0);
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    setStringCacheSize
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_jep_Jep_setStringCacheSize
+(JNIEnv *env, jobject obj, jlong tstate, jint size) {
+    pyembed_set_string_cache(env, (intptr_t) tstate, (int) size);
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    getStringCacheStats
+ * Signature: (J)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_jep_Jep_getStringCacheStats
+(JNIEnv *env, jclass clazz, jlong tstate) {
+    jeplong    stats[3];
+    jlong      jstats[3];
+    jlongArray ret;
+    int        i;
+
+    pyembed_get_string_cache_stats((intptr_t) tstate, stats);
+    for(i = 0; i < 3; i++)
+        jstats[i] = (jlong) stats[i];
+
+    ret = (*env)->NewLongArray(env, 3);
+    if(ret)
+        (*env)->SetLongArrayRegion(env, ret, 0, 3, jstats);
+    return ret;
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    startGilTiming
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_jep_Jep_startGilTiming
+(JNIEnv *env, jclass clazz, jlong tstate) {
+    pyembed_start_gil_timing((intptr_t) tstate);
+}
+
+
+/*
+ * Class:     jep_Jep
+ * Method:    takeGilWait
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_jep_Jep_takeGilWait
+(JNIEnv *env, jclass clazz, jlong tstate) {
+    return (jlong) pyembed_take_gil_wait((intptr_t) tstate);
+}
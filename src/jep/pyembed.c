@@ -55,6 +55,19 @@
 # include <stdio.h>
 #endif
 
+#include <sys/stat.h>
+#include <limits.h>
+#include <ctype.h>
+#ifdef WIN32
+# include <windows.h>
+#else
+# include <time.h>
+# include <sys/time.h>
+#endif
+#ifndef PATH_MAX
+# define PATH_MAX 4096
+#endif
+
 
 // The following includes were added to support compilation on RHEL 4, which
 // ships with python2.3.  With python2.4 (and possibly beyond), the includes
@@ -74,6 +87,9 @@
 #include "pyjarray.h"
 #include "util.h"
 
+// PyThread_type_lock, Python.h only includes it from 3.7
+#include "pythread.h"
+
 
 #ifdef __APPLE__
 #ifndef WITH_NEXT_FRAMEWORK
@@ -86,13 +102,35 @@ char **environ = NULL;
 
 static PyThreadState *mainThreadState = NULL;
 
+/*
+ * Every thread that needs the top interpreter borrows mainThreadState, but
+ * a thread state can only be used by one thread at a time. Shared imports
+ * can release the GIL part way through, so hold this lock too.
+ */
+static PyThread_type_lock mainThreadLock = NULL;
+
 static PyObject* pyembed_findclass(PyObject*, PyObject*);
 static PyObject* pyembed_forname(PyObject*, PyObject*);
 static PyObject* pyembed_set_print_stack(PyObject*, PyObject*);
 static PyObject* pyembed_jproxy(PyObject*, PyObject*);
+static PyObject* pyembed_shared_import(PyObject*, PyObject*);
+static PyObject* pyembed_stats(PyObject*, PyObject*);
+static PyObject* pyembed_live_counts(PyObject*, PyObject*);
+static PyObject* pyembed_string_cache_stats(PyObject*, PyObject*);
+static void pyembed_string_cache_free(JepThread*);
+static PyObject* pyembed_set_profiling(PyObject*, PyObject*);
+static PyObject* pyembed_reset_profile(PyObject*, PyObject*);
+static PyObject* pyembed_profile_data(PyObject*, PyObject*);
+static void pyembed_profile_clear(JepThread*);
 
 static int maybe_pyc_file(FILE*, const char*, const char*, int);
 static void pyembed_run_pyc(JepThread *jepThread, FILE *);
+static PyObject* pyembed_get_code(const char*, FILE*);
+static jobject pyembed_convert_as(JNIEnv*, PyObject*, jclass);
+static int pyembed_as_long(PyObject*, jeplong*);
+static int pyembed_as_ranged(PyObject*, jeplong, jeplong, jeplong*);
+static int pyembed_as_double(PyObject*, jdouble*);
+static int pyembed_as_boolean(PyObject*, jboolean*);
 
 
 // ClassLoader.loadClass
@@ -101,19 +139,28 @@ static jmethodID loadClassMethod = 0;
 // jep.Proxy.newProxyInstance
 static jmethodID newProxyMethod = 0;
 
-#if PY_MAJOR_VERSION < 3
-// Integer(int)
-static jmethodID integerIConstructor = 0;
-#endif
+// jep.Proxy and its functional interface methods
+static jclass    proxyClass = NULL;
+static jmethodID proxyIsFunctional = 0;
+static jmethodID proxyNewFunctional = 0;
+
+// Integer.valueOf(int)
+static jmethodID integerValueOf = 0;
 
-// Long(long)
-static jmethodID longJConstructor = 0;
+// Long.valueOf(long)
+static jmethodID longValueOf = 0;
 
-// Double(double)
-static jmethodID doubleDConstructor = 0;
+// Double.valueOf(double)
+static jmethodID doubleValueOf = 0;
 
-// Boolean(boolean)
-static jmethodID booleanBConstructor = 0;
+// Boolean.valueOf(boolean)
+static jmethodID booleanValueOf = 0;
+
+// Short, Byte, Float and Character valueOf
+static jmethodID shortValueOf = 0;
+static jmethodID byteValueOf = 0;
+static jmethodID floatValueOf = 0;
+static jmethodID charValueOf = 0;
 
 // ArrayList(int)
 static jmethodID arraylistIConstructor = 0;
@@ -123,6 +170,9 @@ static jmethodID arraylistAdd = 0;
 static jmethodID hashmapIConstructor = 0;
 static jmethodID hashmapPut = 0;
 
+// Collections.unmodifiableList(List)
+static jmethodID unmodifiableList = 0;
+
 static struct PyMethodDef jep_methods[] = {
     { "findClass",
       pyembed_findclass,
@@ -157,6 +207,50 @@ static struct PyMethodDef jep_methods[] = {
       "Accepts two arguments: ([a class object], [list of java interfaces "
       "to implement, string names])" },
 
+    { "sharedImport",
+      pyembed_shared_import,
+      METH_VARARGS,
+      "Import a module in the top interpreter so it can be shared.\n"
+      "Returns a dict of the module and its loaded submodules by name." },
+
+    { "stats",
+      pyembed_stats,
+      METH_VARARGS,
+      "Returns a dict of the runtime counters of this interpreter, zero\n"
+      "unless enabled with Jep.setStatsEnabled(true)." },
+
+    { "liveCounts",
+      pyembed_live_counts,
+      METH_VARARGS,
+      "Returns a dict of the live Java wrappers in the process by type,\n"
+      "and of the JNI global refs created and deleted by where they're\n"
+      "made.  Call gc.collect() first for exact counts." },
+
+    { "stringCacheStats",
+      pyembed_string_cache_stats,
+      METH_VARARGS,
+      "Returns a dict of the size, hits, misses and hit_rate of this\n"
+      "interpreter's cache of short Java strings, see\n"
+      "Jep.setStringCacheSize()." },
+
+    { "setProfiling",
+      pyembed_set_profiling,
+      METH_VARARGS,
+      "Turn profiling of calls to Java methods and constructors on or off\n"
+      "(True|False).  See jep.profile to report on them." },
+
+    { "resetProfile",
+      pyembed_reset_profile,
+      METH_VARARGS,
+      "Forget the calls profiled so far." },
+
+    { "profileData",
+      pyembed_profile_data,
+      METH_VARARGS,
+      "Returns a list of a dict per profiled Java method, with the\n"
+      "calls, errors and the time spent in each phase of the calls:\n"
+      "args, java and result." },
+
     { NULL, NULL }
 };
 
@@ -225,7 +319,21 @@ void pyembed_startup(void) {
 
     // save a pointer to the main PyThreadState object
     mainThreadState = PyThreadState_Get();
+    mainThreadLock  = PyThread_allocate_lock();
+    PyEval_ReleaseThread(mainThreadState);
+}
+
+
+// **** don't hold the GIL when calling ****
+static void pyembed_acquire_main(void) {
+    PyThread_acquire_lock(mainThreadLock, WAIT_LOCK);
+    PyEval_AcquireThread(mainThreadState);
+}
+
+
+static void pyembed_release_main(void) {
     PyEval_ReleaseThread(mainThreadState);
+    PyThread_release_lock(mainThreadLock);
 }
 
 
@@ -245,12 +353,12 @@ intptr_t pyembed_thread_init(JNIEnv *env, jobject cl, jobject caller) {
         return 0;
     }
     
-    PyEval_AcquireThread(mainThreadState);
+    pyembed_acquire_main();
     
     jepThread = PyMem_Malloc(sizeof(JepThread));
     if(!jepThread) {
         THROW_JEP(env, "Out of memory.");
-        PyEval_ReleaseThread(mainThreadState);
+        pyembed_release_main();
         return 0;
     }
     
@@ -260,6 +368,7 @@ intptr_t pyembed_thread_init(JNIEnv *env, jobject cl, jobject caller) {
      * save/release and reacquire it since that doesn't seem documented
      */
     PyEval_SaveThread();
+    PyThread_release_lock(mainThreadLock);
     PyEval_AcquireThread(jepThread->tstate);
 
     // store java.lang.Class objects for later use.
@@ -283,10 +392,21 @@ intptr_t pyembed_thread_init(JNIEnv *env, jobject cl, jobject caller) {
     jepThread->modjep          = initjep();
     jepThread->globals         = globals;
     jepThread->env             = env;
-    jepThread->classloader     = (*env)->NewGlobalRef(env, cl);
-    jepThread->caller          = (*env)->NewGlobalRef(env, caller);
+    jepThread->classloader     = pyembed_new_global_ref(env, JEP_REF_THREAD, cl);
+    jepThread->caller          = pyembed_new_global_ref(env, JEP_REF_THREAD, caller);
     jepThread->printStack      = 0;
     jepThread->fqnToPyJmethods = NULL;
+    jepThread->fqnToPyJclass   = NULL;
+    jepThread->snapshotGlobals = NULL;
+    jepThread->snapshotModules = NULL;
+    jepThread->callableProxies = NULL;
+    jepThread->stats           = NULL;
+    jepThread->timeGil         = 0;
+    jepThread->gilWait         = 0;
+    jepThread->profiling       = 0;
+    jepThread->profile         = NULL;
+    jepThread->stringCache     = NULL;
+    memset(jepThread->nameCache, 0, sizeof(jepThread->nameCache));
 
     if((tdict = PyThreadState_GetDict()) != NULL) {
         PyObject *key, *t;
@@ -309,9 +429,37 @@ intptr_t pyembed_thread_init(JNIEnv *env, jobject cl, jobject caller) {
 }
 
 
+/*
+ * Takes the shared modules out of the sub-interpreter's sys.modules so
+ * ending it doesn't clear them for the other interpreters, see
+ * jep.shared_modules_hook.  Hold the GIL.
+ */
+static void pyembed_teardown_shared_modules(void) {
+    PyObject *modules, *hook, *ret;
+
+    modules = PyImport_GetModuleDict();                         /* borrowed */
+    hook    = PyDict_GetItemString(modules, "jep.shared_modules_hook");
+    if(hook == NULL)
+        return;
+
+    ret = PyObject_CallMethod(hook, "teardownImporter", NULL);
+    if(ret == NULL) {
+        PyErr_Print();
+        printf("WARNING: failed to tear down shared modules.\n");
+    }
+    Py_XDECREF(ret);
+}
+
+
+// the last thread to look up its JepThread and the result
+static PyThreadState *currentTstate    = NULL;
+static JepThread     *currentJepThread = NULL;
+
+
 void pyembed_thread_close(JNIEnv *env, intptr_t _jepThread) {
     JepThread     *jepThread;
     PyObject      *tdict, *key;
+    int            i;
 
     jepThread = (JepThread *) _jepThread;
     if(!jepThread) {
@@ -321,6 +469,8 @@ void pyembed_thread_close(JNIEnv *env, intptr_t _jepThread) {
     
     PyEval_AcquireThread(jepThread->tstate);
 
+    pyembed_teardown_shared_modules();
+
     key = PyString_FromString(DICT_KEY);
     if((tdict = PyThreadState_GetDict()) != NULL && key != NULL)
         PyDict_DelItem(tdict, key);
@@ -328,17 +478,32 @@ void pyembed_thread_close(JNIEnv *env, intptr_t _jepThread) {
 
     Py_CLEAR(jepThread->globals);
     Py_CLEAR(jepThread->fqnToPyJmethods);
+    Py_CLEAR(jepThread->fqnToPyJclass);
+    Py_CLEAR(jepThread->snapshotGlobals);
+    Py_CLEAR(jepThread->snapshotModules);
+    Py_CLEAR(jepThread->callableProxies);
     Py_CLEAR(jepThread->modjep);
 
-    if(jepThread->classloader) {
-        (*env)->DeleteGlobalRef(env, jepThread->classloader);
-    }
-    if(jepThread->caller) {
-        (*env)->DeleteGlobalRef(env, jepThread->caller);
+    if(jepThread->stats && jepThread->stats->enabled)
+        pyembedStatsEnabled--;
+    if(jepThread->profiling)
+        pyembedProfileEnabled--;
+    pyembed_profile_clear(jepThread);
+    pyembed_string_cache_free(jepThread);
+    for(i = 0; i < JEP_NAME_CACHE_SLOTS; i++)
+        Py_CLEAR(jepThread->nameCache[i].str);
+    if(currentJepThread == jepThread) {
+        currentTstate    = NULL;
+        currentJepThread = NULL;
     }
+
+    pyembed_delete_global_ref(env, JEP_REF_THREAD, jepThread->classloader);
+    pyembed_delete_global_ref(env, JEP_REF_THREAD, jepThread->caller);
     
     Py_EndInterpreter(jepThread->tstate);
     
+    if(jepThread->stats)
+        PyMem_Free(jepThread->stats);
     PyMem_Free(jepThread);
     PyEval_ReleaseLock();
 }
@@ -379,412 +544,2867 @@ JepThread* pyembed_get_jepthread(void) {
 }
 
 
-// used by _forname
-#define LOAD_CLASS_METHOD(env, cl)                                          \
-{                                                                           \
-    if(loadClassMethod == 0) {                                              \
-        jobject clazz;                                                      \
-                                                                            \
-        clazz = (*env)->GetObjectClass(env, cl);                            \
-        if(process_java_exception(env) || !clazz)                           \
-            return NULL;                                                    \
-                                                                            \
-        loadClassMethod =                                                   \
-            (*env)->GetMethodID(env,                                        \
-                                clazz,                                      \
-                                "loadClass",                                \
-                                "(Ljava/lang/String;)Ljava/lang/Class;");   \
-                                                                            \
-        if(process_java_exception(env) || !loadClassMethod) {               \
-            (*env)->DeleteLocalRef(env, clazz);                             \
-            return NULL;                                                    \
-        }                                                                   \
-                                                                            \
-        (*env)->DeleteLocalRef(env, clazz);                                 \
-    }                                                                       \
-}
-
-
-static PyObject* pyembed_jproxy(PyObject *self, PyObject *args) {
-    PyThreadState *_save;
+/*
+ * pyembed_get_jepthread for the counters, which run on hot paths: remembers
+ * the last thread so repeated calls on it skip the dict lookup.  Works with
+ * an error set.  Hold the GIL.
+ */
+JepThread* pyembed_current_jepthread(void) {
+    PyThreadState *tstate = CURRENT_TSTATE();
     JepThread     *jepThread;
-    JNIEnv        *env = NULL;
-    PyObject      *pytarget;
-    PyObject      *interfaces;
-    jclass         clazz;
-    jobject        cl;
-    jobject        classes;
-    Py_ssize_t     inum, i;
-    jobject        proxy;
+    PyObject      *ptype, *pvalue, *ptrace;
 
-    if(!PyArg_ParseTuple(args, "OO!:jproxy",
-                         &pytarget, 
-                         &PyList_Type,
-                         &interfaces))
-        return NULL;
+    if(tstate == currentTstate)
+        return currentJepThread;
 
+    // the lookup doesn't work with an error set
+    PyErr_Fetch(&ptype, &pvalue, &ptrace);
     jepThread = pyembed_get_jepthread();
-    if(!jepThread) {
-        if(!PyErr_Occurred())
-            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
-        return NULL;
+    PyErr_Restore(ptype, pvalue, ptrace);
+
+    // threads without a Jep aren't remembered, their tstate may be reused
+    if(jepThread) {
+        currentTstate    = tstate;
+        currentJepThread = jepThread;
     }
+    return jepThread;
+}
 
-    env = jepThread->env;
-    cl  = jepThread->classloader;
 
-    Py_UNBLOCK_THREADS;
-    clazz = (*env)->FindClass(env, "jep/Proxy");
-    Py_BLOCK_THREADS;
-    if(process_java_exception(env) || !clazz)
-        return NULL;
+int pyembedStatsEnabled = 0;
 
-    if(newProxyMethod == 0) {
-        newProxyMethod =
-            (*env)->GetStaticMethodID(
-                env,
-                clazz,
-                "newProxyInstance",
-                "(JJLjep/Jep;Ljava/lang/ClassLoader;[Ljava/lang/String;)Ljava/lang/Object;");
 
-        if(process_java_exception(env) || !newProxyMethod)
-            return NULL;
+// a monotonic clock for the GIL counters and call profiles
+jeplong pyembed_nanos(void) {
+#ifdef WIN32
+    LARGE_INTEGER count, freq;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (jeplong) (count.QuadPart / freq.QuadPart) * 1000000000 +
+        (jeplong) (count.QuadPart % freq.QuadPart) * 1000000000 /
+        freq.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (jeplong) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (jeplong) tv.tv_sec * 1000000000 + (jeplong) tv.tv_usec * 1000;
+#endif
+}
+
+
+/*
+ * Enters the sub-interpreter from java, the same as
+ * PyEval_AcquireThread(jepThread->tstate) but counted when stats are
+ * enabled or timed for JFR events.
+ */
+void pyembed_acquire_thread(JepThread *jepThread) {
+    JepStats *stats = jepThread->stats;
+    jeplong   start, now;
+
+    if((!stats || !stats->enabled) && !jepThread->timeGil) {
+        PyEval_AcquireThread(jepThread->tstate);
+        return;
     }
 
-    inum = (int) PyList_GET_SIZE(interfaces);
-    if(inum < 1)
-        return PyErr_Format(PyExc_ValueError, "Empty interface list.");
+    start = pyembed_nanos();
+    PyEval_AcquireThread(jepThread->tstate);
+    now = pyembed_nanos();
 
-    // now convert string list to java array
+    if(jepThread->timeGil)
+        jepThread->gilWait += now - start;
+    if(!stats || !stats->enabled)
+        return;
 
-    classes = (*env)->NewObjectArray(env, (jsize) inum, JSTRING_TYPE, NULL);
-    if(process_java_exception(env) || !classes)
-        return NULL;
+    stats->counters[JEP_STAT_GIL_ACQUIRES]++;
+    stats->counters[JEP_STAT_GIL_WAIT_NANOS] += now - start;
+    if(stats->depth++ == 0)
+        stats->enteredAt = now;
+}
 
-    for(i = 0; i < inum; i++) {
-        char     *str;
-        jstring   jstr;
-        PyObject *item;
 
-        item = PyList_GET_ITEM(interfaces, i);
-        if(!PyString_Check(item))
-            return PyErr_Format(PyExc_ValueError, "Item %zd not a string.", i);
+void pyembed_release_thread(JepThread *jepThread) {
+    JepStats *stats = jepThread->stats;
 
-        str  = PyString_AsString(item);
-        jstr = (*env)->NewStringUTF(env, (const char *) str);
+    // python calling java calling back into python is one entry
+    if(stats && stats->enabled && stats->depth > 0 && --stats->depth == 0)
+        stats->counters[JEP_STAT_INTERPRETER_NANOS] +=
+            pyembed_nanos() - stats->enteredAt;
 
-        (*env)->SetObjectArrayElement(env, classes, (jsize) i, jstr);
-        (*env)->DeleteLocalRef(env, jstr);
-    }
+    PyEval_ReleaseThread(jepThread->tstate);
+}
 
-    // do the deed
-    proxy = (*env)->CallStaticObjectMethod(env,
-                                           clazz,
-                                           newProxyMethod,
-                                           (jlong) (intptr_t) jepThread,
-                                           (jlong) (intptr_t) pytarget,
-                                           jepThread->caller,
-                                           cl,
-                                           classes);
-    if(process_java_exception(env) || !proxy)
-        return NULL;
 
-    // make sure target doesn't get garbage collected
-    Py_INCREF(pytarget);
+/*
+ * Starts keeping the time the Jep waits for the GIL.  Only call from the
+ * Jep's thread, it doesn't take the GIL.  Each call needs a
+ * pyembed_take_gil_wait, they nest for events started from callbacks: the
+ * wait keeps adding up and each event remembers where it started, so an
+ * inner event's wait also counts for the outer one.
+ */
+void pyembed_start_gil_timing(intptr_t _jepThread) {
+    JepThread *jepThread = (JepThread *) _jepThread;
+    int        depth;
 
-    return pyjobject_new(env, proxy);
+    if(!jepThread)
+        return;
+    depth = jepThread->timeGil++;
+    if(depth == 0)
+        jepThread->gilWait = 0;
+    if(depth < JEP_GIL_TIMING_DEPTH)
+        jepThread->gilWaitStarts[depth] = jepThread->gilWait;
 }
 
 
-static PyObject* pyembed_set_print_stack(PyObject *self, PyObject *args) {
-    JepThread *jepThread;
-    char      *print = 0;
+/*
+ * The time waited for the GIL since the matching start, from the Jep's
+ * thread.  Timing stops once every start has been taken.
+ */
+jeplong pyembed_take_gil_wait(intptr_t _jepThread) {
+    JepThread *jepThread = (JepThread *) _jepThread;
+    int        depth;
 
-    if(!PyArg_ParseTuple(args, "b:setPrintStack", &print))
-        return NULL;
+    if(!jepThread || jepThread->timeGil <= 0)
+        return 0;
+    depth = --jepThread->timeGil;
+    if(depth >= JEP_GIL_TIMING_DEPTH)
+        depth = JEP_GIL_TIMING_DEPTH - 1;
+    return jepThread->gilWait - jepThread->gilWaitStarts[depth];
+}
 
-    jepThread = pyembed_get_jepthread();
-    if(!jepThread) {
-        if(!PyErr_Occurred())
-            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
-        return NULL;
-    }
 
-    if(print == 0)
-        jepThread->printStack = 0;
-    else
-        jepThread->printStack = 1;
+// use JEP_STAT, this looks up the current thread's Jep
+void pyembed_stat_add(int stat, jeplong n) {
+    JepThread *jepThread = pyembed_current_jepthread();
 
-    Py_INCREF(Py_None);
-    return Py_None;
+    if(jepThread)
+        JEP_THREAD_STAT(jepThread, stat, n);
 }
 
 
-static PyObject* pyembed_forname(PyObject *self, PyObject *args) {
-    JNIEnv    *env       = NULL;
-    char      *name;
-    jobject    cl;
-    jclass     objclazz;
-    jstring    jstr;
+void pyembed_set_stats_enabled(JNIEnv *env, intptr_t _jepThread, int enabled) {
     JepThread *jepThread;
+    JepStats  *stats;
 
-    if(!PyArg_ParseTuple(args, "s", &name))
-        return NULL;
-    
-    jepThread = pyembed_get_jepthread();
+    jepThread = (JepThread *) _jepThread;
     if(!jepThread) {
-        if(!PyErr_Occurred())
-            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
-        return NULL;
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return;
     }
-    
-    env = jepThread->env;
-    cl  = jepThread->classloader;
-    
-    LOAD_CLASS_METHOD(env, cl);
-    
-    jstr = (*env)->NewStringUTF(env, (const char *) name);
-    if(process_java_exception(env) || !jstr)
-        return NULL;
-    
-    objclazz = (jclass) (*env)->CallObjectMethod(env,
-                                                 cl,
-                                                 loadClassMethod,
-                                                 jstr);
-    if(process_java_exception(env) || !objclazz) {
-        return NULL;
+
+    PyEval_AcquireThread(jepThread->tstate);
+
+    stats = jepThread->stats;
+    if(!stats && enabled) {
+        // kept until the Jep closes so readers never see it freed
+        stats = (JepStats *) PyMem_Malloc(sizeof(JepStats));
+        if(!stats) {
+            PyEval_ReleaseThread(jepThread->tstate);
+            THROW_JEP(env, "Out of memory.");
+            return;
+        }
+        memset(stats, 0, sizeof(JepStats));
+        jepThread->stats = stats;
     }
-    
-    return (PyObject *) pyjobject_new_class(env, objclazz);
+
+    if(stats && stats->enabled != enabled) {
+        stats->enabled = enabled;
+        stats->depth   = 0;
+        if(enabled)
+            pyembedStatsEnabled++;
+        else
+            pyembedStatsEnabled--;
+    }
+
+    PyEval_ReleaseThread(jepThread->tstate);
 }
 
 
-static PyObject* pyembed_findclass(PyObject *self, PyObject *args) {
-    JNIEnv    *env       = NULL;
-    char      *name, *p;
-    jclass     clazz;
+/*
+ * Copies the counters to out, JEP_STAT_COUNT of them.  Doesn't take the GIL
+ * so it can be called from any thread while the Jep is open.
+ */
+void pyembed_get_stats(intptr_t _jepThread, jeplong *out) {
     JepThread *jepThread;
-    
-    if(!PyArg_ParseTuple(args, "s", &name))
+
+    jepThread = (JepThread *) _jepThread;
+    if(jepThread && jepThread->stats)
+        memcpy(out, jepThread->stats->counters, sizeof(jeplong) * JEP_STAT_COUNT);
+    else
+        memset(out, 0, sizeof(jeplong) * JEP_STAT_COUNT);
+}
+
+
+// jep.stats(), the counters of the current thread's Jep by name
+static PyObject* pyembed_stats(PyObject *self, PyObject *args) {
+    static const char *names[JEP_STAT_COUNT] = {
+        "java_calls",
+        "objects_created",
+        "type_lookups",
+        "java_exceptions",
+        "python_exceptions",
+        "gil_acquires",
+        "gil_wait_nanos",
+        "interpreter_nanos",
+        "bytes_converted"
+    };
+    JepThread *jepThread;
+    jeplong    counters[JEP_STAT_COUNT];
+    PyObject  *result;
+    int        i;
+
+    if(!PyArg_ParseTuple(args, ":stats"))
         return NULL;
-    
+
     jepThread = pyembed_get_jepthread();
     if(!jepThread) {
         if(!PyErr_Occurred())
             PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
         return NULL;
     }
-    
-    env = jepThread->env;
-    
-    // replace '.' with '/'
-    // i'm told this is okay to do with unicode.
-    for(p = name; *p != '\0'; p++) {
-        if(*p == '.')
-            *p = '/';
+
+    pyembed_get_stats((intptr_t) jepThread, counters);
+
+    result = PyDict_New();
+    if(!result)
+        return NULL;
+    for(i = 0; i < JEP_STAT_COUNT; i++) {
+        PyObject *value = PyLong_FromLongLong(counters[i]);
+        if(!value || PyDict_SetItemString(result, names[i], value) != 0) {
+            Py_XDECREF(value);
+            Py_DECREF(result);
+            return NULL;
+        }
+        Py_DECREF(value);
     }
-    
-    clazz = (*env)->FindClass(env, name);
-    if(process_java_exception(env))
+    if(PyDict_SetItemString(result, "enabled",
+                            (jepThread->stats && jepThread->stats->enabled) ?
+                            Py_True : Py_False) != 0) {
+        Py_DECREF(result);
         return NULL;
-    
-    return (PyObject *) pyjobject_new_class(env, clazz);
+    }
+    return result;
+}
+
+
+jeplong pyembedLiveObjects[JEP_LIVE_COUNT];
+
+static jeplong refsCreated[JEP_REF_SITES];
+static jeplong refsDeleted[JEP_REF_SITES];
+
+static const char *refSiteNames[JEP_REF_SITES] = {
+    "pyjobject",
+    "pyjarray",
+    "pyjmethod",
+    "pyjfield",
+    "pyjclass",
+    "thread"
+};
+
+
+// NewGlobalRef counted by site, hold the GIL
+jobject pyembed_new_global_ref(JNIEnv *env, int site, jobject obj) {
+    jobject ref = (*env)->NewGlobalRef(env, obj);
+    if(ref)
+        refsCreated[site]++;
+    return ref;
+}
+
+
+// DeleteGlobalRef counted by site, hold the GIL
+void pyembed_delete_global_ref(JNIEnv *env, int site, jobject ref) {
+    if(!ref)
+        return;
+    (*env)->DeleteGlobalRef(env, ref);
+    refsDeleted[site]++;
+}
+
+
+/*
+ * Copies the live objects, then the global refs created and deleted per
+ * site to out, JEP_LIVE_COUNT + 2 * JEP_REF_SITES of them.  Doesn't take
+ * the GIL so a count may be off by one while another thread changes it.
+ */
+void pyembed_get_live_counts(jeplong *out) {
+    memcpy(out, pyembedLiveObjects, sizeof(jeplong) * JEP_LIVE_COUNT);
+    out += JEP_LIVE_COUNT;
+    memcpy(out, refsCreated, sizeof(jeplong) * JEP_REF_SITES);
+    out += JEP_REF_SITES;
+    memcpy(out, refsDeleted, sizeof(jeplong) * JEP_REF_SITES);
+}
+
+
+// adds name: value to dict, stealing the value
+static int pyembed_dict_steal(PyObject *dict, const char *name, PyObject *value) {
+    int ret;
+
+    if(!value)
+        return -1;
+    ret = PyDict_SetItemString(dict, name, value);
+    Py_DECREF(value);
+    return ret;
+}
+
+
+// jep.liveCounts()
+static PyObject* pyembed_live_counts(PyObject *self, PyObject *args) {
+    static const char *names[JEP_LIVE_COUNT] = {
+        "pyjobject",
+        "pyjarray",
+        "pyjmethod",
+        "pyjfield"
+    };
+    PyObject *result, *objects = NULL, *refs = NULL;
+    int       i;
+
+    if(!PyArg_ParseTuple(args, ":liveCounts"))
+        return NULL;
+
+    result = PyDict_New();
+    if(!result)
+        return NULL;
+
+    objects = PyDict_New();
+    if(pyembed_dict_steal(result, "objects", objects) != 0)
+        goto EXIT_ERROR;
+    for(i = 0; i < JEP_LIVE_COUNT; i++) {
+        if(pyembed_dict_steal(objects, names[i],
+                              PyLong_FromLongLong(pyembedLiveObjects[i])) != 0)
+            goto EXIT_ERROR;
+    }
+
+    refs = PyDict_New();
+    if(pyembed_dict_steal(result, "global_refs", refs) != 0)
+        goto EXIT_ERROR;
+    for(i = 0; i < JEP_REF_SITES; i++) {
+        PyObject *site = PyDict_New();
+        if(pyembed_dict_steal(refs, refSiteNames[i], site) != 0)
+            goto EXIT_ERROR;
+        if(pyembed_dict_steal(site, "created",
+                              PyLong_FromLongLong(refsCreated[i])) != 0 ||
+           pyembed_dict_steal(site, "deleted",
+                              PyLong_FromLongLong(refsDeleted[i])) != 0 ||
+           pyembed_dict_steal(site, "live",
+                              PyLong_FromLongLong(refsCreated[i] -
+                                                  refsDeleted[i])) != 0)
+            goto EXIT_ERROR;
+    }
+    return result;
+
+EXIT_ERROR:
+    Py_DECREF(result);
+    return NULL;
+}
+
+
+int pyembedStringCaches = 0;
+
+// the last thread to use a string cache and its cache, saves a dict lookup
+static PyThreadState  *stringCacheTstate = NULL;
+static JepStringCache *stringCacheLast   = NULL;
+
+
+static void pyembed_string_cache_free(JepThread *jepThread) {
+    JepStringCache *cache = jepThread->stringCache;
+    unsigned int    i;
+
+    if(!cache)
+        return;
+
+    jepThread->stringCache = NULL;
+    pyembedStringCaches--;
+    stringCacheTstate = NULL;
+    stringCacheLast   = NULL;
+
+    for(i = 0; i <= cache->mask; i++)
+        Py_XDECREF(cache->slots[i].str);
+    PyMem_Free(cache->slots);
+    PyMem_Free(cache);
+}
+
+
+// the current thread's cache or NULL, hold the GIL
+static JepStringCache* pyembed_string_cache(void) {
+    PyThreadState *tstate = CURRENT_TSTATE();
+    JepThread     *jepThread;
+    PyObject      *ptype, *pvalue, *ptrace;
+
+    if(tstate == stringCacheTstate)
+        return stringCacheLast;
+
+    // the lookup doesn't work with an error set
+    PyErr_Fetch(&ptype, &pvalue, &ptrace);
+    jepThread = pyembed_get_jepthread();
+    PyErr_Restore(ptype, pvalue, ptrace);
+
+    stringCacheTstate = tstate;
+    stringCacheLast   = jepThread ? jepThread->stringCache : NULL;
+    return stringCacheLast;
+}
+
+
+#if PY_MAJOR_VERSION >= 3 && PY_MINOR_VERSION >= 3
+static int pyembed_string_matches(PyObject *str, const jchar *chars, jsize len) {
+    void       *data;
+    int         kind;
+    Py_ssize_t  i;
+
+    if(PyUnicode_GET_LENGTH(str) != len)
+        return 0;
+    kind = PyUnicode_KIND(str);
+    data = PyUnicode_DATA(str);
+    if(kind == PyUnicode_2BYTE_KIND)
+        return memcmp(data, chars, sizeof(jchar) * len) == 0;
+    for(i = 0; i < len; i++) {
+        if(PyUnicode_READ(kind, data, i) != chars[i])
+            return 0;
+    }
+    return 1;
+}
+#endif
+
+
+/*
+ * The str of up to JEP_STRING_CACHE_MAX_CHARS UTF-16 chars, shared from the
+ * current thread's string cache when it has one.  Use when
+ * pyembedStringCaches is set.  returns new reference.
+ */
+PyObject* pyembed_cached_pystring(const jchar *chars, jsize len) {
+#if PY_MAJOR_VERSION >= 3 && PY_MINOR_VERSION >= 3
+    JepStringCache  *cache;
+    JepCachedString *slot;
+    PyObject        *str;
+    unsigned int     hash = 2166136261U;
+    jsize            i;
+
+    cache = pyembed_string_cache();
+    if(!cache)
+        return utf16_topystring(chars, len);
+
+    // FNV-1a
+    for(i = 0; i < len; i++) {
+        hash ^= chars[i];
+        hash *= 16777619U;
+    }
+
+    slot = &cache->slots[hash & cache->mask];
+    if(slot->str && slot->hash == hash &&
+       pyembed_string_matches(slot->str, chars, len)) {
+        cache->hits++;
+        Py_INCREF(slot->str);
+        return slot->str;
+    }
+
+    cache->misses++;
+    str = utf16_topystring(chars, len);
+    if(!str)
+        return NULL;
+
+    // surrogate pairs make a shorter str that could never match
+    // not interned, interned strs are immortal from python 3.12 on
+    if(PyUnicode_GET_LENGTH(str) == len) {
+        Py_XDECREF(slot->str);
+        Py_INCREF(str);
+        slot->str  = str;
+        slot->hash = hash;
+    }
+    return str;
+#else
+    return NULL;
+#endif
+}
+
+
+/*
+ * Replaces the string cache of a Jep with an empty one of at least size
+ * slots, or removes it when size is 0.
+ */
+void pyembed_set_string_cache(JNIEnv *env, intptr_t _jepThread, int size) {
+    JepThread      *jepThread;
+    JepStringCache *cache;
+    unsigned int    slots = 1;
+
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return;
+    }
+
+    PyEval_AcquireThread(jepThread->tstate);
+
+    pyembed_string_cache_free(jepThread);
+    if(size <= 0) {
+        PyEval_ReleaseThread(jepThread->tstate);
+        return;
+    }
+
+    while(slots < (unsigned int) size && slots < (1U << 24))
+        slots <<= 1;
+
+    cache = (JepStringCache *) PyMem_Malloc(sizeof(JepStringCache));
+    if(cache) {
+        cache->slots = (JepCachedString *) PyMem_Malloc(
+            sizeof(JepCachedString) * slots);
+        if(!cache->slots) {
+            PyMem_Free(cache);
+            cache = NULL;
+        }
+    }
+    if(!cache) {
+        PyEval_ReleaseThread(jepThread->tstate);
+        THROW_JEP(env, "Out of memory.");
+        return;
+    }
+
+    memset(cache->slots, 0, sizeof(JepCachedString) * slots);
+    cache->mask   = slots - 1;
+    cache->hits   = 0;
+    cache->misses = 0;
+
+    jepThread->stringCache = cache;
+    pyembedStringCaches++;
+    stringCacheTstate = NULL;
+    stringCacheLast   = NULL;
+
+    PyEval_ReleaseThread(jepThread->tstate);
+}
+
+
+/*
+ * Copies the slots, hits and misses of a Jep's string cache to out, all
+ * zero without one.  Doesn't take the GIL, call from the Jep's thread.
+ */
+void pyembed_get_string_cache_stats(intptr_t _jepThread, jeplong *out) {
+    JepThread      *jepThread = (JepThread *) _jepThread;
+    JepStringCache *cache     = jepThread ? jepThread->stringCache : NULL;
+
+    if(cache) {
+        out[0] = (jeplong) cache->mask + 1;
+        out[1] = cache->hits;
+        out[2] = cache->misses;
+    } else {
+        out[0] = out[1] = out[2] = 0;
+    }
+}
+
+
+// jep.stringCacheStats()
+static PyObject* pyembed_string_cache_stats(PyObject *self, PyObject *args) {
+    JepThread *jepThread;
+    jeplong    stats[3];
+    double     rate;
+
+    if(!PyArg_ParseTuple(args, ":stringCacheStats"))
+        return NULL;
+
+    jepThread = pyembed_get_jepthread();
+    if(!jepThread) {
+        if(!PyErr_Occurred())
+            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
+        return NULL;
+    }
+
+    pyembed_get_string_cache_stats((intptr_t) jepThread, stats);
+    rate = (stats[1] + stats[2]) ? (double) stats[1] / (stats[1] + stats[2]) : 0;
+    return Py_BuildValue("{s:L,s:L,s:L,s:d}",
+                         "size", stats[0],
+                         "hits", stats[1],
+                         "misses", stats[2],
+                         "hit_rate", rate);
+}
+
+
+int pyembedProfileEnabled = 0;
+
+// each time a Jep starts a new profile, see JepProfileRef
+static int profileGenerations = 0;
+
+static jmethodID objectToStringMethod = 0;
+
+
+/*
+ * Names a profiled method the way a stack trace would, e.g. the toString()
+ * "public static java.lang.Integer java.lang.Integer.valueOf(int)" becomes
+ * "java.lang.Integer.valueOf(int)".  Returns a new reference, NULL with an
+ * error set on failure.
+ */
+static PyObject* pyembed_profile_name(JNIEnv *env,
+                                      jclass clazz,
+                                      jmethodID methodId,
+                                      int isStatic) {
+    jobject     member;
+    jstring     jstr;
+    const char *str;
+    const char *paren, *start, *end;
+    char       *buf;
+    PyObject   *name = NULL;
+
+    if(!objectToStringMethod) {
+        jclass objectClass = (*env)->FindClass(env, "java/lang/Object");
+        if(process_java_exception(env) || !objectClass)
+            return NULL;
+        objectToStringMethod = (*env)->GetMethodID(env,
+                                                   objectClass,
+                                                   "toString",
+                                                   "()Ljava/lang/String;");
+        (*env)->DeleteLocalRef(env, objectClass);
+        if(process_java_exception(env) || !objectToStringMethod)
+            return NULL;
+    }
+
+    member = (*env)->ToReflectedMethod(env,
+                                       clazz,
+                                       methodId,
+                                       isStatic ? JNI_TRUE : JNI_FALSE);
+    if(process_java_exception(env) || !member)
+        return NULL;
+
+    jstr = (jstring) (*env)->CallObjectMethod(env,
+                                              member,
+                                              objectToStringMethod);
+    (*env)->DeleteLocalRef(env, member);
+    if(process_java_exception(env) || !jstr)
+        return NULL;
+
+    str   = jstring2char(env, jstr);
+    paren = strchr(str, '(');
+    end   = strchr(str, ')');
+    if(!paren || !end) {
+        name = PyString_FromString(str);
+    } else {
+        // modifiers and the return type come before the last space
+        for(start = paren; start > str && *(start - 1) != ' '; start--)
+            ;
+        buf = PyMem_Malloc(end - start + 2);
+        if(!buf) {
+            PyErr_NoMemory();
+        } else {
+            memcpy(buf, start, end - start + 1);
+            buf[end - start + 1] = '\0';
+            name = PyString_FromString(buf);
+            PyMem_Free(buf);
+        }
+    }
+    release_utf_char(env, jstr, str);
+    return name;
+}
+
+
+/*
+ * Gets the profile of a method being called when the current thread's Jep
+ * is profiling, NULL otherwise.  Only call when pyembedProfileEnabled.
+ * Profiling is best effort: failing to make a profile leaves no error and
+ * the call just isn't profiled.
+ */
+JepCallProfile* pyembed_profile_get(JNIEnv *env,
+                                    JepProfileRef *ref,
+                                    jclass clazz,
+                                    jmethodID methodId,
+                                    int isStatic) {
+    JepThread      *jepThread;
+    JepCallProfile *profile = NULL;
+    PyObject       *key, *value;
+
+    jepThread = pyembed_current_jepthread();
+    if(!jepThread || !jepThread->profiling)
+        return NULL;
+
+    if(ref->profile && ref->generation == jepThread->profileGeneration)
+        return ref->profile;
+
+    key = PyLong_FromVoidPtr((void *) methodId);
+    if(!key) {
+        PyErr_Clear();
+        return NULL;
+    }
+
+    value = PyDict_GetItem(jepThread->profile, key);          /* borrowed */
+    if(value) {
+        profile = (JepCallProfile *) PyLong_AsVoidPtr(value);
+    } else {
+        profile = (JepCallProfile *) PyMem_Malloc(sizeof(JepCallProfile));
+        if(profile) {
+            memset(profile, 0, sizeof(JepCallProfile));
+            profile->name = pyembed_profile_name(env,
+                                                 clazz,
+                                                 methodId,
+                                                 isStatic);
+            value = PyLong_FromVoidPtr(profile);
+            if(!profile->name || !value ||
+               PyDict_SetItem(jepThread->profile, key, value) != 0) {
+                Py_XDECREF(profile->name);
+                PyMem_Free(profile);
+                profile = NULL;
+            }
+            Py_XDECREF(value);
+        }
+    }
+    Py_DECREF(key);
+
+    if(!profile) {
+        PyErr_Clear();
+        return NULL;
+    }
+
+    ref->profile    = profile;
+    ref->generation = jepThread->profileGeneration;
+    return profile;
+}
+
+
+// the histogram bucket of nanos, see JEP_PROFILE_SUB_BITS
+static int pyembed_profile_bucket(jeplong nanos) {
+    jeplong v;
+    int     msb = 0;
+    int     bucket;
+
+    if(nanos < (1 << JEP_PROFILE_SUB_BITS))
+        return nanos < 0 ? 0 : (int) nanos;
+
+    for(v = nanos; v >>= 1;)
+        msb++;
+    bucket = ((msb - JEP_PROFILE_SUB_BITS + 1) << JEP_PROFILE_SUB_BITS) +
+        (int) ((nanos >> (msb - JEP_PROFILE_SUB_BITS)) &
+               ((1 << JEP_PROFILE_SUB_BITS) - 1));
+    return bucket < JEP_PROFILE_BUCKETS ? bucket : JEP_PROFILE_BUCKETS - 1;
+}
+
+
+// the smallest nanos in a bucket
+static jeplong pyembed_profile_bucket_low(int bucket) {
+    int msb;
+
+    if(bucket < (1 << JEP_PROFILE_SUB_BITS))
+        return bucket;
+    msb = (bucket >> JEP_PROFILE_SUB_BITS) + JEP_PROFILE_SUB_BITS - 1;
+    return ((jeplong) ((1 << JEP_PROFILE_SUB_BITS) +
+                       (bucket & ((1 << JEP_PROFILE_SUB_BITS) - 1))))
+        << (msb - JEP_PROFILE_SUB_BITS);
+}
+
+
+/*
+ * Records a call that started at start and finished converting its args at
+ * argsDone and calling java at javaDone.  Either of those is 0 if the call
+ * failed before reaching it, the phase that failed then lasts until now.
+ */
+void pyembed_profile_record(JepCallProfile *profile,
+                            jeplong start,
+                            jeplong argsDone,
+                            jeplong javaDone,
+                            int failed) {
+    jeplong marks[JEP_PROFILE_PHASES + 1];
+    int     i;
+
+    marks[0] = start;
+    marks[1] = argsDone;
+    marks[2] = javaDone;
+    marks[3] = pyembed_nanos();
+
+    profile->calls++;
+    if(failed)
+        profile->errors++;
+
+    for(i = 0; i < JEP_PROFILE_PHASES; i++) {
+        jeplong end     = marks[i + 1] ? marks[i + 1] : marks[3];
+        jeplong elapsed = end - marks[i];
+
+        profile->total[i] += elapsed;
+        if(elapsed > profile->max[i])
+            profile->max[i] = elapsed;
+        profile->buckets[i][pyembed_profile_bucket(elapsed)]++;
+        if(!marks[i + 1])
+            break;
+    }
+}
+
+
+// frees the profiles of a Jep, hold the GIL
+static void pyembed_profile_clear(JepThread *jepThread) {
+    PyObject  *key, *value;
+    Py_ssize_t pos = 0;
+
+    if(!jepThread->profile)
+        return;
+
+    while(PyDict_Next(jepThread->profile, &pos, &key, &value)) {
+        JepCallProfile *profile = (JepCallProfile *) PyLong_AsVoidPtr(value);
+        if(profile) {
+            Py_XDECREF(profile->name);
+            PyMem_Free(profile);
+        }
+    }
+    Py_CLEAR(jepThread->profile);
+}
+
+
+// starts or stops profiling, keeping what was profiled.  hold the GIL.
+static int pyembed_profile_enable(JepThread *jepThread, int enabled) {
+    if(enabled == jepThread->profiling)
+        return 0;
+
+    if(enabled && !jepThread->profile) {
+        jepThread->profile = PyDict_New();
+        if(!jepThread->profile)
+            return -1;
+        jepThread->profileGeneration = ++profileGenerations;
+    }
+
+    jepThread->profiling = enabled;
+    if(enabled)
+        pyembedProfileEnabled++;
+    else
+        pyembedProfileEnabled--;
+    return 0;
+}
+
+
+void pyembed_set_profile_enabled(JNIEnv *env, intptr_t _jepThread, int enabled) {
+    JepThread *jepThread;
+
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return;
+    }
+
+    pyembed_acquire_thread(jepThread);
+    if(pyembed_profile_enable(jepThread, enabled) != 0)
+        process_py_exception(env, 0);
+    pyembed_release_thread(jepThread);
+}
+
+
+// jep.setProfiling(enabled)
+static PyObject* pyembed_set_profiling(PyObject *self, PyObject *args) {
+    JepThread *jepThread;
+    int        enabled;
+
+    if(!PyArg_ParseTuple(args, "i:setProfiling", &enabled))
+        return NULL;
+
+    jepThread = pyembed_get_jepthread();
+    if(!jepThread) {
+        if(!PyErr_Occurred())
+            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
+        return NULL;
+    }
+
+    if(pyembed_profile_enable(jepThread, enabled ? 1 : 0) != 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+
+// jep.resetProfile(), forgets what was profiled
+static PyObject* pyembed_reset_profile(PyObject *self, PyObject *args) {
+    JepThread *jepThread;
+    int        profiling;
+
+    if(!PyArg_ParseTuple(args, ":resetProfile"))
+        return NULL;
+
+    jepThread = pyembed_get_jepthread();
+    if(!jepThread) {
+        if(!PyErr_Occurred())
+            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
+        return NULL;
+    }
+
+    profiling = jepThread->profiling;
+    if(pyembed_profile_enable(jepThread, 0) != 0)
+        return NULL;
+    pyembed_profile_clear(jepThread);
+    if(pyembed_profile_enable(jepThread, profiling) != 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+
+// a dict of a phase of a call profile, its histogram as (low, high, count)
+static PyObject* pyembed_profile_phase(JepCallProfile *profile, int phase) {
+    PyObject *histogram, *result;
+    int       i;
+
+    histogram = PyList_New(0);
+    if(!histogram)
+        return NULL;
+    for(i = 0; i < JEP_PROFILE_BUCKETS; i++) {
+        PyObject *bucket;
+
+        if(!profile->buckets[phase][i])
+            continue;
+        bucket = Py_BuildValue("(LLL)",
+                               (PY_LONG_LONG) pyembed_profile_bucket_low(i),
+                               (PY_LONG_LONG) pyembed_profile_bucket_low(i + 1),
+                               (PY_LONG_LONG) profile->buckets[phase][i]);
+        if(!bucket || PyList_Append(histogram, bucket) != 0) {
+            Py_XDECREF(bucket);
+            Py_DECREF(histogram);
+            return NULL;
+        }
+        Py_DECREF(bucket);
+    }
+
+    result = Py_BuildValue("{s:L,s:L,s:N}",
+                           "total", (PY_LONG_LONG) profile->total[phase],
+                           "max", (PY_LONG_LONG) profile->max[phase],
+                           "histogram", histogram);
+    return result;
+}
+
+
+// jep.profileData(), a list of a dict per profiled method
+static PyObject* pyembed_profile_data(PyObject *self, PyObject *args) {
+    static const char *phases[JEP_PROFILE_PHASES] = {
+        "args",
+        "java",
+        "result"
+    };
+    JepThread *jepThread;
+    PyObject  *result, *key, *value;
+    Py_ssize_t pos = 0;
+    int        i;
+
+    if(!PyArg_ParseTuple(args, ":profileData"))
+        return NULL;
+
+    jepThread = pyembed_get_jepthread();
+    if(!jepThread) {
+        if(!PyErr_Occurred())
+            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
+        return NULL;
+    }
+
+    result = PyList_New(0);
+    if(!result || !jepThread->profile)
+        return result;
+
+    while(PyDict_Next(jepThread->profile, &pos, &key, &value)) {
+        JepCallProfile *profile = (JepCallProfile *) PyLong_AsVoidPtr(value);
+        PyObject       *entry;
+
+        entry = Py_BuildValue("{s:O,s:L,s:L}",
+                              "method", profile->name,
+                              "calls", (PY_LONG_LONG) profile->calls,
+                              "errors", (PY_LONG_LONG) profile->errors);
+        if(!entry)
+            goto EXIT_ERROR;
+        for(i = 0; i < JEP_PROFILE_PHASES; i++) {
+            PyObject *phase = pyembed_profile_phase(profile, i);
+            if(!phase || PyDict_SetItemString(entry, phases[i], phase) != 0) {
+                Py_XDECREF(phase);
+                Py_DECREF(entry);
+                goto EXIT_ERROR;
+            }
+            Py_DECREF(phase);
+        }
+        if(PyList_Append(result, entry) != 0) {
+            Py_DECREF(entry);
+            goto EXIT_ERROR;
+        }
+        Py_DECREF(entry);
+    }
+    return result;
+
+EXIT_ERROR:
+    Py_DECREF(result);
+    return NULL;
+}
+
+
+/*
+ * Imports a module in the top interpreter and returns a dict of it and any
+ * of its submodules already loaded there, for jep.shared_modules_hook to put
+ * in the sub-interpreter's sys.modules. Every sub-interpreter then shares
+ * the same module objects instead of importing them again.
+ */
+static PyObject* pyembed_shared_import(PyObject *self, PyObject *args) {
+    JepThread  *jepThread;
+    char       *name;
+    size_t      namelen;
+    PyObject   *subPath, *mainPath, *module, *modules;
+    PyObject   *key, *value, *result = NULL;
+    PyObject   *ptype, *pvalue, *ptrace;
+    Py_ssize_t  i, pos;
+
+    if(!PyArg_ParseTuple(args, "s:sharedImport", &name))
+        return NULL;
+
+    jepThread = pyembed_get_jepthread();
+    if(!jepThread) {
+        if(!PyErr_Occurred())
+            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
+        return NULL;
+    }
+
+    subPath = PySys_GetObject("path"); /* borrowed */
+    Py_XINCREF(subPath);
+
+    // swap to the top interpreter. only one thread can be in there.
+    PyEval_ReleaseThread(jepThread->tstate);
+    pyembed_acquire_main();
+
+    // the module may only be on the sub-interpreter's path, e.g. from
+    // includePath, so copy over anything missing.
+    mainPath = PySys_GetObject("path"); /* borrowed */
+    if(subPath != NULL && mainPath != NULL && PyList_Check(subPath)) {
+        for(i = 0; i < PyList_GET_SIZE(subPath); i++) {
+            PyObject *item = PyList_GET_ITEM(subPath, i);
+            if(PyString_Check(item) && PySequence_Contains(mainPath, item) == 0) {
+                PyObject *copy = PyString_FromString(PyString_AsString(item));
+                if(copy) {
+                    PyList_Append(mainPath, copy);
+                    Py_DECREF(copy);
+                }
+            }
+        }
+        PyErr_Clear();
+    }
+
+    module = PyImport_ImportModule(name); /* new ref */
+    if(module != NULL) {
+        result = PyDict_New();
+        namelen = strlen(name);
+        modules = PyImport_GetModuleDict(); /* borrowed */
+
+        pos = 0;
+        while(result != NULL && PyDict_Next(modules, &pos, &key, &value)) {
+            const char *modname;
+
+            if(value == Py_None || !PyString_Check(key))
+                continue;
+
+            modname = PyString_AsString(key);
+            if(modname != NULL
+               && strncmp(modname, name, namelen) == 0
+               && (modname[namelen] == '\0' || modname[namelen] == '.'))
+                PyDict_SetItem(result, key, value);
+        }
+        Py_DECREF(module);
+    }
+
+    // carry any error back to the sub-interpreter
+    PyErr_Fetch(&ptype, &pvalue, &ptrace);
+    pyembed_release_main();
+    PyEval_AcquireThread(jepThread->tstate);
+    PyErr_Restore(ptype, pvalue, ptrace);
+
+    Py_XDECREF(subPath);
+    if(PyErr_Occurred()) {
+        Py_XDECREF(result);
+        return NULL;
+    }
+    return result;
+}
+
+
+// used by _forname
+#define LOAD_CLASS_METHOD(env, cl)                                          \
+{                                                                           \
+    if(loadClassMethod == 0) {                                              \
+        jobject clazz;                                                      \
+                                                                            \
+        clazz = (*env)->GetObjectClass(env, cl);                            \
+        if(process_java_exception(env) || !clazz)                           \
+            return NULL;                                                    \
+                                                                            \
+        loadClassMethod =                                                   \
+            (*env)->GetMethodID(env,                                        \
+                                clazz,                                      \
+                                "loadClass",                                \
+                                "(Ljava/lang/String;)Ljava/lang/Class;");   \
+                                                                            \
+        if(process_java_exception(env) || !loadClassMethod) {               \
+            (*env)->DeleteLocalRef(env, clazz);                             \
+            return NULL;                                                    \
+        }                                                                   \
+                                                                            \
+        (*env)->DeleteLocalRef(env, clazz);                                 \
+    }                                                                       \
+}
+
+
+static PyObject* pyembed_jproxy(PyObject *self, PyObject *args) {
+    PyThreadState *_save;
+    JepThread     *jepThread;
+    JNIEnv        *env = NULL;
+    PyObject      *pytarget;
+    PyObject      *interfaces;
+    jclass         clazz;
+    jobject        cl;
+    jobject        classes;
+    Py_ssize_t     inum, i;
+    jobject        proxy;
+
+    if(!PyArg_ParseTuple(args, "OO!:jproxy",
+                         &pytarget, 
+                         &PyList_Type,
+                         &interfaces))
+        return NULL;
+
+    jepThread = pyembed_get_jepthread();
+    if(!jepThread) {
+        if(!PyErr_Occurred())
+            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
+        return NULL;
+    }
+
+    env = jepThread->env;
+    cl  = jepThread->classloader;
+
+    Py_UNBLOCK_THREADS;
+    clazz = (*env)->FindClass(env, "jep/Proxy");
+    Py_BLOCK_THREADS;
+    if(process_java_exception(env) || !clazz)
+        return NULL;
+
+    if(newProxyMethod == 0) {
+        newProxyMethod =
+            (*env)->GetStaticMethodID(
+                env,
+                clazz,
+                "newProxyInstance",
+                "(JJLjep/Jep;Ljava/lang/ClassLoader;[Ljava/lang/String;)Ljava/lang/Object;");
+
+        if(process_java_exception(env) || !newProxyMethod)
+            return NULL;
+    }
+
+    inum = (int) PyList_GET_SIZE(interfaces);
+    if(inum < 1)
+        return PyErr_Format(PyExc_ValueError, "Empty interface list.");
+
+    // now convert string list to java array
+
+    classes = (*env)->NewObjectArray(env, (jsize) inum, JSTRING_TYPE, NULL);
+    if(process_java_exception(env) || !classes)
+        return NULL;
+
+    for(i = 0; i < inum; i++) {
+        char     *str;
+        jstring   jstr;
+        PyObject *item;
+
+        item = PyList_GET_ITEM(interfaces, i);
+        if(!PyString_Check(item))
+            return PyErr_Format(PyExc_ValueError, "Item %zd not a string.", i);
+
+        str  = PyString_AsString(item);
+        jstr = (*env)->NewStringUTF(env, (const char *) str);
+
+        (*env)->SetObjectArrayElement(env, classes, (jsize) i, jstr);
+        (*env)->DeleteLocalRef(env, jstr);
+    }
+
+    // do the deed
+    proxy = (*env)->CallStaticObjectMethod(env,
+                                           clazz,
+                                           newProxyMethod,
+                                           (jlong) (intptr_t) jepThread,
+                                           (jlong) (intptr_t) pytarget,
+                                           jepThread->caller,
+                                           cl,
+                                           classes);
+    if(process_java_exception(env) || !proxy)
+        return NULL;
+
+    // make sure target doesn't get garbage collected
+    Py_INCREF(pytarget);
+
+    return pyjobject_new(env, proxy);
+}
+
+
+// returns 0 with a java exception thrown
+static int pyembed_init_functional(JNIEnv *env) {
+    jclass clazz;
+
+    if(proxyNewFunctional)
+        return 1;
+
+    clazz = (*env)->FindClass(env, "jep/Proxy");
+    if(!clazz)
+        return 0;
+
+    proxyIsFunctional =
+        (*env)->GetStaticMethodID(env,
+                                  clazz,
+                                  "isFunctional",
+                                  "(Ljava/lang/Class;)Z");
+    if(proxyIsFunctional)
+        proxyNewFunctional =
+            (*env)->GetStaticMethodID(
+                env,
+                clazz,
+                "newFunctionalInstance",
+                "(JJLjep/Jep;Ljava/lang/Class;)Ljava/lang/Object;");
+    if(proxyNewFunctional)
+        proxyClass = (*env)->NewGlobalRef(env, clazz);
+    (*env)->DeleteLocalRef(env, clazz);
+
+    if(!proxyClass) {
+        proxyNewFunctional = 0;
+        return 0;
+    }
+    return 1;
+}
+
+
+/*
+ * Checks if a python callable can be passed as paramType, an interface
+ * with a single abstract method like Runnable or Comparator.  Never leaves
+ * an exception behind.
+ */
+int pyembed_is_functional(JNIEnv *env, jclass paramType) {
+    jboolean functional;
+
+    if(!pyembed_init_functional(env)) {
+        (*env)->ExceptionClear(env);
+        return 0;
+    }
+
+    functional = (*env)->CallStaticBooleanMethod(env,
+                                                 proxyClass,
+                                                 proxyIsFunctional,
+                                                 paramType);
+    if((*env)->ExceptionCheck(env)) {
+        (*env)->ExceptionClear(env);
+        return 0;
+    }
+    return functional ? 1 : 0;
+}
+
+
+/*
+ * Returns a local ref to a proxy calling callable for the functional
+ * interface iface, like jproxy but the callable itself is called.  Proxies
+ * are cached per callable so passing the same function in a loop reuses
+ * one.  Returns NULL with a python error, or without one if iface isn't a
+ * functional interface.
+ *
+ * The cache keeps the proxies of the JEP_CALLABLE_PROXIES_MAX most recently
+ * used callables.  It can't be keyed weakly since each proxy keeps its
+ * callable alive, instead an evicted proxy is released and Jep releases its
+ * callable once java has collected the proxy too.
+ */
+jobject pyembed_callable_proxy(JNIEnv *env, PyObject *callable, jclass iface) {
+    JepThread     *jepThread;
+    PyObject      *proxies;
+    PyObject      *pyproxy;
+    jobject        proxy;
+    Py_ssize_t     i;
+
+    jepThread = pyembed_get_jepthread();
+    if(!jepThread) {
+        if(!PyErr_Occurred())
+            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
+        return NULL;
+    }
+
+    if(!jepThread->callableProxies) {
+        jepThread->callableProxies = PyDict_New();
+        if(!jepThread->callableProxies)
+            return NULL;
+    }
+
+    // unhashable callables are never found, or cached
+    proxies = PyDict_GetItem(jepThread->callableProxies, callable); /* borrowed */
+    if(proxies) {
+        // move it to the end, dicts keep insertion order from python 3.6
+        Py_INCREF(proxies);
+        if(PyDict_DelItem(jepThread->callableProxies, callable) != 0 ||
+           PyDict_SetItem(jepThread->callableProxies, callable, proxies) != 0)
+            PyErr_Clear();
+        Py_DECREF(proxies);
+        proxies = PyDict_GetItem(jepThread->callableProxies, callable);
+    }
+    if(proxies) {
+        for(i = 0; i < PyList_GET_SIZE(proxies); i++) {
+            pyproxy = PyList_GET_ITEM(proxies, i);
+            proxy   = ((PyJobject_Object *) pyproxy)->object;
+            if((*env)->IsInstanceOf(env, proxy, iface))
+                return (*env)->NewLocalRef(env, proxy);
+        }
+    }
+
+    if(!pyembed_init_functional(env)) {
+        process_java_exception(env);
+        return NULL;
+    }
+
+    proxy = (*env)->CallStaticObjectMethod(env,
+                                           proxyClass,
+                                           proxyNewFunctional,
+                                           (jlong) (intptr_t) jepThread,
+                                           (jlong) (intptr_t) callable,
+                                           jepThread->caller,
+                                           iface);
+    if(process_java_exception(env) || !proxy)
+        return NULL;
+
+    // make sure the callable doesn't get garbage collected, like jproxy
+    Py_INCREF(callable);
+
+    pyproxy = pyjobject_new(env, proxy);
+    if(!pyproxy) {
+        PyErr_Clear();
+        return proxy;
+    }
+
+    if(!proxies) {
+        // evict the least recently used, an arbitrary one before 3.6
+        if(PyDict_Size(jepThread->callableProxies) >= JEP_CALLABLE_PROXIES_MAX) {
+            PyObject   *key;
+            PyObject   *value;
+            Py_ssize_t  pos = 0;
+
+            if(PyDict_Next(jepThread->callableProxies, &pos, &key, &value)) {
+                Py_INCREF(key);
+                if(PyDict_DelItem(jepThread->callableProxies, key) != 0)
+                    PyErr_Clear();
+                Py_DECREF(key);
+            }
+        }
+
+        proxies = PyList_New(0);
+        if(proxies &&
+           PyDict_SetItem(jepThread->callableProxies, callable, proxies) == 0)
+            Py_DECREF(proxies); /* the dict has it */
+        else
+            Py_CLEAR(proxies);
+    }
+    if(!proxies || PyList_Append(proxies, pyproxy) != 0)
+        PyErr_Clear();
+    Py_DECREF(pyproxy);
+
+    return proxy;
+}
+
+
+static PyObject* pyembed_set_print_stack(PyObject *self, PyObject *args) {
+    JepThread *jepThread;
+    char      *print = 0;
+
+    if(!PyArg_ParseTuple(args, "b:setPrintStack", &print))
+        return NULL;
+
+    jepThread = pyembed_get_jepthread();
+    if(!jepThread) {
+        if(!PyErr_Occurred())
+            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
+        return NULL;
+    }
+
+    if(print == 0)
+        jepThread->printStack = 0;
+    else
+        jepThread->printStack = 1;
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+// cached PyJclass for name, or NULL without an exception if not cached
+static PyObject* pyembed_get_cached_class(JepThread *jepThread,
+                                          const char *name) {
+    PyObject *pyjclass;
+
+    if(!jepThread->fqnToPyJclass)
+        return NULL;
+    pyjclass = PyDict_GetItemString(jepThread->fqnToPyJclass, name); /* borrowed */
+    Py_XINCREF(pyjclass);
+    return pyjclass;
+}
+
+
+// returns pyjclass, failing to cache it isn't an error
+static PyObject* pyembed_cache_class(JepThread *jepThread,
+                                     const char *name,
+                                     PyObject *pyjclass) {
+    if(!pyjclass)
+        return NULL;
+
+    if(!jepThread->fqnToPyJclass)
+        jepThread->fqnToPyJclass = PyDict_New();
+    if(!jepThread->fqnToPyJclass ||
+       PyDict_SetItemString(jepThread->fqnToPyJclass, name, pyjclass) != 0)
+        PyErr_Clear();
+    return pyjclass;
+}
+
+
+static PyObject* pyembed_forname(PyObject *self, PyObject *args) {
+    JNIEnv    *env       = NULL;
+    char      *name;
+    jobject    cl;
+    jclass     objclazz;
+    jstring    jstr;
+    JepThread *jepThread;
+    PyObject  *result;
+
+    if(!PyArg_ParseTuple(args, "s", &name))
+        return NULL;
+    
+    jepThread = pyembed_get_jepthread();
+    if(!jepThread) {
+        if(!PyErr_Occurred())
+            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
+        return NULL;
+    }
+
+    if((result = pyembed_get_cached_class(jepThread, name)) != NULL)
+        return result;
+    
+    env = jepThread->env;
+    cl  = jepThread->classloader;
+    
+    LOAD_CLASS_METHOD(env, cl);
+    
+    jstr = (*env)->NewStringUTF(env, (const char *) name);
+    if(process_java_exception(env) || !jstr)
+        return NULL;
+    
+    objclazz = (jclass) (*env)->CallObjectMethod(env,
+                                                 cl,
+                                                 loadClassMethod,
+                                                 jstr);
+    (*env)->DeleteLocalRef(env, jstr);
+    if(process_java_exception(env) || !objclazz) {
+        return NULL;
+    }
+    
+    result = pyembed_cache_class(jepThread,
+                                 name,
+                                 pyjobject_new_class(env, objclazz));
+    (*env)->DeleteLocalRef(env, objclazz);
+    return result;
+}
+
+
+static PyObject* pyembed_findclass(PyObject *self, PyObject *args) {
+    JNIEnv    *env       = NULL;
+    char      *name, *p;
+    jclass     clazz;
+    JepThread *jepThread;
+    PyObject  *result;
+    
+    if(!PyArg_ParseTuple(args, "s", &name))
+        return NULL;
+    
+    jepThread = pyembed_get_jepthread();
+    if(!jepThread) {
+        if(!PyErr_Occurred())
+            PyErr_SetString(PyExc_RuntimeError, "Invalid JepThread pointer.");
+        return NULL;
+    }
+    
+    env = jepThread->env;
+    
+    // replace '.' with '/'
+    // i'm told this is okay to do with unicode.
+    // this also keeps the cache keys apart from forName's, since
+    // FindClass doesn't use our classloader.
+    for(p = name; *p != '\0'; p++) {
+        if(*p == '.')
+            *p = '/';
+    }
+
+    if((result = pyembed_get_cached_class(jepThread, name)) != NULL)
+        return result;
+    
+    clazz = (*env)->FindClass(env, name);
+    if(process_java_exception(env))
+        return NULL;
+    
+    result = pyembed_cache_class(jepThread,
+                                 name,
+                                 pyjobject_new_class(env, clazz));
+    (*env)->DeleteLocalRef(env, clazz);
+    return result;
+}
+
+
+// look up a global by name. a dotted name such as "obj.method" resolves
+// the first part in globals and the rest as attributes. returns a new
+// reference or NULL, which may or may not have set a python error.
+// **** hold lock before calling ****
+static PyObject* pyembed_lookup_global(JepThread *jepThread,
+                                       const char *cname) {
+    PyObject   *obj, *attr;
+    const char *start, *dot;
+    char       *part;
+
+    dot = strchr(cname, '.');
+    if(dot == NULL) {
+        obj = PyDict_GetItemString(jepThread->globals, (char *) cname);
+        Py_XINCREF(obj);
+        return obj;
+    }
+
+    part = PyMem_Malloc(strlen(cname) + 1);
+    if(!part) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    strncpy(part, cname, dot - cname);
+    part[dot - cname] = '\0';
+    obj = PyDict_GetItemString(jepThread->globals, part); /* borrowed */
+    Py_XINCREF(obj);
+
+    start = dot + 1;
+    while(obj != NULL && *start != '\0') {
+        dot = strchr(start, '.');
+        if(dot == NULL)
+            dot = start + strlen(start);
+
+        strncpy(part, start, dot - start);
+        part[dot - start] = '\0';
+
+        attr = PyObject_GetAttrString(obj, part); /* new ref */
+        Py_DECREF(obj);
+        obj = attr;
+
+        start = (*dot == '.') ? dot + 1 : dot;
+    }
+
+    PyMem_Free(part);
+    return obj;
+}
+
+
+/*
+ * Looks up a global for a proxy the way pyembed_invoke_method does, or the
+ * __main__ module when cname is NULL.  Returns a new reference as a pointer,
+ * or 0 with a JepException thrown.
+ */
+jlong pyembed_lookup_target(JNIEnv *env,
+                            intptr_t _jepThread,
+                            const char *cname) {
+    PyObject         *obj;
+    JepThread        *jepThread;
+
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return 0;
+    }
+
+    pyembed_acquire_thread(jepThread);
+
+    if(cname == NULL) {
+        obj = PyImport_AddModule("__main__");                /* borrowed */
+        Py_XINCREF(obj);
+    } else {
+        obj = pyembed_lookup_global(jepThread, cname);       /* new ref */
+    }
+    if(!process_py_exception(env, 0) && !obj)
+        THROW_JEP(env, "Object was not found in the global dictionary.");
+
+    pyembed_release_thread(jepThread);
+    return (jlong) (intptr_t) obj;
 }
 
 
 jobject pyembed_invoke_method(JNIEnv *env,
                               intptr_t _jepThread,
-                              const char *cname,
-                              jobjectArray args,
-                              jintArray types) {
-    PyObject         *callable;
+                              const char *cname,
+                              jobjectArray args,
+                              jintArray types) {
+    PyObject         *callable;
+    JepThread        *jepThread;
+    jobject           ret;
+    
+    ret      = NULL;
+    callable = NULL;
+
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return ret;
+    }
+
+    pyembed_acquire_thread(jepThread);
+
+    callable = pyembed_lookup_global(jepThread, cname);  /* new ref */
+    if(!callable && PyErr_ExceptionMatches(PyExc_AttributeError))
+        PyErr_Clear();
+    if(process_py_exception(env, 0))
+        goto EXIT;
+    if(!callable || !PyCallable_Check(callable)) {
+        // Jep.invoke wraps it, javax.script passes it on
+        jclass clazz = (*env)->FindClass(env,
+                                         "java/lang/NoSuchMethodException");
+        if(clazz) {
+            (*env)->ThrowNew(env,
+                             clazz,
+                             callable ? "Object is not callable."
+                             : "Object was not found in the global dictionary.");
+            (*env)->DeleteLocalRef(env, clazz);
+        }
+        goto EXIT;
+    }
+
+    ret = pyembed_invoke(env, callable, args, types);
+
+EXIT:
+    Py_XDECREF(callable);
+    pyembed_release_thread(jepThread);
+
+    return ret;
+}
+
+
+// invoke object callable
+// **** hold lock before calling ****
+/*
+ * The runtime type of an argument whose declared type doesn't pin it down,
+ * the same as Util.getTypeId(Object) but without leaving native code.
+ */
+static int pyembed_arg_type_id(JNIEnv *env, jobject val) {
+    jclass clazz;
+    int    typeId;
+
+    if((*env)->IsInstanceOf(env, val, JSTRING_TYPE))
+        return JSTRING_ID;
+    if((*env)->IsInstanceOf(env, val, JINTEGER_OBJ_TYPE))
+        return JINT_ID;
+    if((*env)->IsInstanceOf(env, val, JDOUBLE_OBJ_TYPE))
+        return JDOUBLE_ID;
+    if((*env)->IsInstanceOf(env, val, JLONG_OBJ_TYPE))
+        return JLONG_ID;
+    if((*env)->IsInstanceOf(env, val, JBOOLEAN_OBJ_TYPE))
+        return JBOOLEAN_ID;
+    if((*env)->IsInstanceOf(env, val, JSHORT_OBJ_TYPE))
+        return JSHORT_ID;
+    if((*env)->IsInstanceOf(env, val, JFLOAT_OBJ_TYPE))
+        return JFLOAT_ID;
+    if((*env)->IsInstanceOf(env, val, JBYTE_OBJ_TYPE))
+        return JBYTE_ID;
+    if((*env)->IsInstanceOf(env, val, JCHAR_OBJ_TYPE))
+        return JCHAR_ID;
+
+    // class, array or object
+    clazz  = (*env)->GetObjectClass(env, val);
+    typeId = get_jtype(env, clazz);
+    (*env)->DeleteLocalRef(env, clazz);
+    return typeId;
+}
+
+
+/*
+ * Converts java arguments to python and calls callable, returning the new
+ * ref result or NULL with a java exception thrown.  A type of
+ * JDYNAMIC_ID is looked up from the argument itself, and null is always
+ * None whatever its type.
+ */
+static PyObject* pyembed_call_java(JNIEnv *env,
+                                   PyObject *callable,
+                                   jobjectArray args,
+                                   jintArray _types) {
+    int            iarg, arglen;
+    jint          *types;       /* pinned primitive array */
+    jboolean       isCopy;
+    PyObject      *pyargs;      /* a tuple */
+    PyObject      *pyret;
+
+    pyret = NULL;
+
+    if(!PyCallable_Check(callable)) {
+        THROW_JEP(env, "pyembed:invoke Invalid callable.");
+        return NULL;
+    }
+
+    // pin primitive array so we can get to it
+    types = (*env)->GetIntArrayElements(env, _types, &isCopy);
+    if(!types)
+        return NULL;
+
+    // first thing to do, convert java arguments to a python tuple
+    arglen = (*env)->GetArrayLength(env, args);
+    pyargs = PyTuple_New(arglen);
+    for(iarg = 0; iarg < arglen; iarg++) {
+        jobject   val;
+        int       typeid;
+        PyObject *pyval;
+
+        val = (*env)->GetObjectArrayElement(env, args, iarg);
+        if((*env)->ExceptionCheck(env)) /* careful, NULL is okay */
+            goto EXIT;
+
+        typeid = (int) types[iarg];
+        if(!val)
+            typeid = -1;
+        else if(typeid == JDYNAMIC_ID)
+            typeid = pyembed_arg_type_id(env, val);
+
+        // now we know the type, convert and add to pyargs.  we know
+        pyval = convert_jobject(env, val, typeid);
+        if((*env)->ExceptionOccurred(env))
+            goto EXIT;
+
+        PyTuple_SET_ITEM(pyargs, iarg, pyval); /* steals */
+        if(val)
+            (*env)->DeleteLocalRef(env, val);
+    } // for(iarg = 0; iarg < arglen; iarg++)
+
+    pyret = PyObject_CallObject(callable, pyargs);
+    if(process_py_exception(env, 0) && pyret) {
+        Py_DECREF(pyret);
+        pyret = NULL;
+    }
+
+EXIT:
+    Py_XDECREF(pyargs);
+    (*env)->ReleaseIntArrayElements(env, _types, types, JNI_ABORT);
+
+    return pyret;
+}
+
+
+jobject pyembed_invoke(JNIEnv *env,
+                       PyObject *callable,
+                       jobjectArray args,
+                       jintArray types) {
+    jobject        ret;
+    PyObject      *pyret;
+
+    pyret = pyembed_call_java(env, callable, args, types);
+    if(!pyret)
+        return NULL;
+
+    // handles errors
+    ret = pyembed_box_py(env, pyret);
+    Py_DECREF(pyret);
+    return ret;
+}
+
+
+/*
+ * Same as pyembed_invoke but the result is converted to returnType like
+ * Jep.getValue(String, Class).  A NULL returnType boxes the result like
+ * pyembed_invoke.  Python errors are thrown as JepExceptions.
+ */
+jobject pyembed_invoke_as(JNIEnv *env,
+                          PyObject *callable,
+                          jobjectArray args,
+                          jintArray types,
+                          jclass returnType) {
+    jobject        ret;
+    PyObject      *pyret;
+
+    pyret = pyembed_call_java(env, callable, args, types);
+    if(!pyret)
+        return NULL;
+
+    if(returnType)
+        ret = pyembed_convert_as(env, pyret, returnType);
+    else
+        ret = pyembed_box_py(env, pyret);
+    Py_DECREF(pyret);
+    process_py_exception(env, 0);
+    return ret;
+}
+
+
+/*
+ * Calls callable for a generated proxy method.  Arguments of the primitive
+ * type ids are read from prims, with doubles and floats as their raw bits,
+ * and the rest from objs like pyembed_call_java.  Returns the new ref
+ * result or NULL with a java exception thrown.
+ */
+PyObject* pyembed_call_unboxed(JNIEnv *env,
+                               PyObject *callable,
+                               jintArray _types,
+                               jlongArray _prims,
+                               jobjectArray objs) {
+    jint           types[256];  /* a java method has at most 255 args */
+    jlong          prims[256];
+    jsize          iarg, arglen;
+    PyObject      *pyargs;      /* a tuple */
+    PyObject      *pyret;
+
+    pyret = NULL;
+
+    if(!PyCallable_Check(callable)) {
+        THROW_JEP(env, "pyembed:invoke Invalid callable.");
+        return NULL;
+    }
+
+    arglen = (*env)->GetArrayLength(env, _types);
+    if(arglen > 255) {
+        THROW_JEP(env, "pyembed:invoke Too many arguments.");
+        return NULL;
+    }
+
+    // copying is cheaper than pinning this few
+    (*env)->GetIntArrayRegion(env, _types, 0, arglen, types);
+    (*env)->GetLongArrayRegion(env, _prims, 0, arglen, prims);
+    if((*env)->ExceptionCheck(env))
+        return NULL;
+
+    pyargs = PyTuple_New(arglen);
+    if(!pyargs) {
+        process_py_exception(env, 0);
+        return NULL;
+    }
+
+    for(iarg = 0; iarg < arglen; iarg++) {
+        PyObject *pyval = NULL;
+
+        // the same conversions as convert_jobject
+        switch(types[iarg]) {
+        case JBOOLEAN_ID:
+            pyval = Py_BuildValue("i", prims[iarg] ? 1 : 0);
+            break;
+
+        case JBYTE_ID:          /* pass through */
+        case JSHORT_ID:         /* pass through */
+        case JINT_ID:
+            pyval = Py_BuildValue("i", (int) prims[iarg]);
+            break;
+
+        case JLONG_ID:
+            pyval = PyLong_FromLongLong(prims[iarg]);
+            break;
+
+        case JCHAR_ID:
+            pyval = PyString_FromFormat("%c", (char) prims[iarg]);
+            break;
+
+        case JFLOAT_ID:         /* pass through */
+        case JDOUBLE_ID: {
+            union {
+                jlong   j;
+                jdouble d;
+            } bits;
+
+            bits.j = prims[iarg];
+            pyval  = PyFloat_FromDouble(bits.d);
+            break;
+        }
+
+        default: {
+            jobject val;
+            int     typeid;
+
+            val = (*env)->GetObjectArrayElement(env, objs, iarg);
+            if((*env)->ExceptionCheck(env)) /* careful, NULL is okay */
+                goto EXIT;
+
+            typeid = (int) types[iarg];
+            if(!val)
+                typeid = -1;
+            else if(typeid == JDYNAMIC_ID)
+                typeid = pyembed_arg_type_id(env, val);
+
+            pyval = convert_jobject(env, val, typeid);
+            if(val)
+                (*env)->DeleteLocalRef(env, val);
+            if((*env)->ExceptionCheck(env)) {
+                Py_XDECREF(pyval);
+                goto EXIT;
+            }
+        }
+        }
+
+        if(!pyval) {
+            process_py_exception(env, 0);
+            goto EXIT;
+        }
+        PyTuple_SET_ITEM(pyargs, iarg, pyval); /* steals */
+    }
+
+    pyret = PyObject_CallObject(callable, pyargs);
+    if(process_py_exception(env, 0) && pyret) {
+        Py_DECREF(pyret);
+        pyret = NULL;
+    }
+
+EXIT:
+    Py_DECREF(pyargs);
+    return pyret;
+}
+
+
+/*
+ * Converts the result of a generated proxy method to its return type id.
+ * Integral types are checked against their range and stored in out->j,
+ * float and double in out->d, boolean in out->z and objects in out->l,
+ * converted to returnType or boxed if it is NULL.  Returns 0 with a
+ * JepException thrown if the result doesn't fit.
+ */
+int pyembed_unbox_result(JNIEnv *env,
+                         PyObject *pyret,
+                         int typeId,
+                         jclass returnType,
+                         jvalue *out) {
+    jeplong v  = 0;
+    int     ok = 1;
+
+    switch(typeId) {
+    case JVOID_ID:
+        return 1;
+
+    case JBOOLEAN_ID:
+        ok = pyembed_as_boolean(pyret, &out->z);
+        break;
+
+    case JLONG_ID:
+        ok = pyembed_as_long(pyret, &v);
+        break;
+
+    case JINT_ID:
+        ok = pyembed_as_ranged(pyret, -2147483647LL - 1, 2147483647LL, &v);
+        break;
+
+    case JSHORT_ID:
+        ok = pyembed_as_ranged(pyret, -32768, 32767, &v);
+        break;
+
+    case JBYTE_ID:
+        ok = pyembed_as_ranged(pyret, -128, 127, &v);
+        break;
+
+    case JCHAR_ID:
+        // like a char parameter, a one character string
+        if(!PyString_Check(pyret) || PyString_GET_SIZE(pyret) != 1) {
+            PyErr_Format(PyExc_TypeError,
+                         "Expected a char but got %s",
+                         Py_TYPE(pyret)->tp_name);
+            ok = 0;
+        } else
+            v = (jeplong) (unsigned char) PyString_AsString(pyret)[0];
+        break;
+
+    case JFLOAT_ID:             /* pass through */
+    case JDOUBLE_ID:
+        ok = pyembed_as_double(pyret, &out->d);
+        break;
+
+    default:
+        if(returnType)
+            out->l = pyembed_convert_as(env, pyret, returnType);
+        else
+            out->l = pyembed_box_py(env, pyret);
+        process_py_exception(env, 0);
+        return !(*env)->ExceptionCheck(env);
+    }
+
+    if(!ok) {
+        process_py_exception(env, 0);
+        return 0;
+    }
+
+    if(typeId != JBOOLEAN_ID && typeId != JFLOAT_ID && typeId != JDOUBLE_ID)
+        out->j = (jlong) v;
+    return 1;
+}
+
+
+void pyembed_eval(JNIEnv *env,
+                  intptr_t _jepThread,
+                  char *str) {
+    PyObject         *result;
+    JepThread        *jepThread;
+    
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return;
+    }
+
+    pyembed_acquire_thread(jepThread);
+    
+    if(str == NULL)
+        goto EXIT;
+
+    if(process_py_exception(env, 1))
+        goto EXIT;
+    
+    result = PyRun_String(str,  /* new ref */
+                          Py_single_input,
+                          jepThread->globals,
+                          jepThread->globals);
+    
+    // c programs inside some java environments may get buffered output
+    fflush(stdout);
+    fflush(stderr);
+    
+    process_py_exception(env, 1);
+    
+    Py_XDECREF(result);
+
+EXIT:
+    pyembed_release_thread(jepThread);
+}
+
+
+// returns 1 if finished, 0 if not, throws exception otherwise
+int pyembed_compile_string(JNIEnv *env,
+                           intptr_t _jepThread,
+                           char *str) {
+    PyObject       *code;
+    int             ret = -1;
+    JepThread      *jepThread;
+    
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return 0;
+    }
+    
+    if(str == NULL)
+        return 0;
+
+    pyembed_acquire_thread(jepThread);
+    
+    code = Py_CompileString(str, "<stdin>", Py_single_input);
+    
+    if(code != NULL) {
+        Py_DECREF(code);
+        ret = 1;
+    }
+    else if(PyErr_ExceptionMatches(PyExc_SyntaxError)) {
+        PyErr_Clear();
+        ret = 0;
+    }
+    else
+        process_py_exception(env, 0);
+
+    pyembed_release_thread(jepThread);
+    return ret;
+}
+
+
+// compiles a whole script into a code object. returns a new ref or 0 and
+// throws an exception.
+intptr_t pyembed_compile_code(JNIEnv *env,
+                              intptr_t _jepThread,
+                              char *str,
+                              char *filename) {
+    PyObject       *code;
+    JepThread      *jepThread;
+    
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return 0;
+    }
+    
+    if(str == NULL)
+        return 0;
+
+    pyembed_acquire_thread(jepThread);
+    
+    code = Py_CompileString(str,
+                            filename ? filename : "<string>",
+                            Py_file_input); /* new ref */
+    if(process_py_exception(env, 0) || code == NULL)
+        code = NULL;
+
+    pyembed_release_thread(jepThread);
+    return (intptr_t) code;
+}
+
+
+// run a whole script from memory, like pyembed_run without the file.
+void pyembed_exec(JNIEnv *env,
+                  intptr_t _jepThread,
+                  char *str) {
+    PyObject         *result;
     JepThread        *jepThread;
-    jobject           ret;
     
-    ret = NULL;
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return;
+    }
+
+    if(str == NULL)
+        return;
+
+    pyembed_acquire_thread(jepThread);
+
+    result = PyRun_String(str,  /* new ref */
+                          Py_file_input,
+                          jepThread->globals,
+                          jepThread->globals);
+    
+    // c programs inside some java environments may get buffered output
+    fflush(stdout);
+    fflush(stderr);
+    
+    process_py_exception(env, 1);
+    Py_XDECREF(result);
+
+    pyembed_release_thread(jepThread);
+}
+
+
+// run a code object from pyembed_compile_code in the globals dict.
+void pyembed_exec_code(JNIEnv *env,
+                       intptr_t _jepThread,
+                       intptr_t _code) {
+    PyObject         *code, *result;
+    JepThread        *jepThread;
+    
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return;
+    }
+
+    pyembed_acquire_thread(jepThread);
+
+    code = (PyObject *) _code;
+    if(code == NULL || !PyCode_Check(code)) {
+        THROW_JEP(env, "Invalid code object.");
+        goto EXIT;
+    }
+
+#if PY_MAJOR_VERSION >= 3
+    result = PyEval_EvalCode(code, jepThread->globals, jepThread->globals);
+#else
+    result = PyEval_EvalCode((PyCodeObject *) code,
+                             jepThread->globals,
+                             jepThread->globals);
+#endif
+
+    // c programs inside some java environments may get buffered output
+    fflush(stdout);
+    fflush(stderr);
+    
+    process_py_exception(env, 1);
+    Py_XDECREF(result);
+
+EXIT:
+    pyembed_release_thread(jepThread);
+}
+
+
+intptr_t pyembed_create_module(JNIEnv *env,
+                               intptr_t _jepThread,
+                               char *str) {
+    PyObject       *module;
+    JepThread      *jepThread;
+    intptr_t        ret;
+    PyObject       *key;
+
+    ret = 0;
+
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return 0;
+    }
+
+    if(str == NULL)
+        return 0;
+
+    pyembed_acquire_thread(jepThread);
+
+    if(PyImport_AddModule(str) == NULL || process_py_exception(env, 1))
+        goto EXIT;
+
+    PyImport_AddModule(str);
+    module = PyImport_ImportModuleEx(str,
+                                     jepThread->globals,
+                                     jepThread->globals,
+                                     NULL); /* new ref */
+
+    key = PyString_FromString(str);
+    PyDict_SetItem(jepThread->globals,
+                   key,
+                   module);     /* takes ownership */
+
+    Py_DECREF(key);
+    Py_DECREF(module);
+
+    if(process_py_exception(env, 0) || module == NULL)
+        ret = 0;
+    else
+        ret = (intptr_t) module;
+
+EXIT:
+    pyembed_release_thread(jepThread);
+
+    return ret;
+}
+
+
+intptr_t pyembed_create_module_on(JNIEnv *env,
+                                  intptr_t _jepThread,
+                                  intptr_t _onModule,
+                                  char *str) {
+    PyObject       *module, *onModule;
+    JepThread      *jepThread;
+    intptr_t        ret;
+    PyObject       *globals;
+    PyObject       *key;
+
+    ret = 0;
+    globals = 0;
 
     jepThread = (JepThread *) _jepThread;
     if(!jepThread) {
         THROW_JEP(env, "Couldn't get thread objects.");
-        return ret;
+        return 0;
     }
 
-    PyEval_AcquireThread(jepThread->tstate);
+    if(str == NULL)
+        return 0;
 
-    callable = PyDict_GetItemString(jepThread->globals, (char *) cname);
-    if(!callable) {
-        THROW_JEP(env, "Object was not found in the global dictionary.");
+    pyembed_acquire_thread(jepThread);
+
+    onModule = (PyObject *) _onModule;
+    if(!PyModule_Check(onModule)) {
+        THROW_JEP(env, "Invalid onModule.");
         goto EXIT;
     }
-    if(process_py_exception(env, 0))
+
+    globals = PyModule_GetDict(onModule);
+    Py_INCREF(globals);
+
+    if(PyImport_AddModule(str) == NULL || process_py_exception(env, 1))
         goto EXIT;
 
-    ret = pyembed_invoke(env, callable, args, types);
+    PyImport_AddModule(str);
+    module = PyImport_ImportModuleEx(str, globals, globals, NULL); /* new ref */
+
+    key = PyString_FromString(str);
+    PyDict_SetItem(globals,
+                   key,
+                   module);     /* ownership */
+    Py_DECREF(key);
+    Py_DECREF(module);
+
+    if(process_py_exception(env, 0) || module == NULL)
+        ret = 0;
+    else
+        ret = (intptr_t) module;
 
 EXIT:
-    PyEval_ReleaseThread(jepThread->tstate);
+    Py_XDECREF(globals);
+
+    pyembed_release_thread(jepThread);
 
     return ret;
 }
 
 
-// invoke object callable
-// **** hold lock before calling ****
-jobject pyembed_invoke(JNIEnv *env,
-                       PyObject *callable,
-                       jobjectArray args,
-                       jintArray _types) {
-    jobject        ret;
-    int            iarg, arglen;
-    jint          *types;       /* pinned primitive array */
-    jboolean       isCopy;
-    PyObject      *pyargs;      /* a tuple */
-    PyObject      *pyret;
+void pyembed_setloader(JNIEnv *env, intptr_t _jepThread, jobject cl) {
+    jobject    oldLoader = NULL;
+    JepThread *jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return;
+    }
+    
+    if(!cl)
+        return;
+    
+    // the GIL guards the global ref counts
+    pyembed_acquire_thread(jepThread);
+
+    oldLoader = jepThread->classloader;
+    pyembed_delete_global_ref(env, JEP_REF_THREAD, oldLoader);
+    
+    jepThread->classloader = pyembed_new_global_ref(env, JEP_REF_THREAD, cl);
+
+    // classes from the old loader shouldn't be found anymore
+    Py_CLEAR(jepThread->fqnToPyJclass);
+    pyembed_release_thread(jepThread);
+}
+
+
+// save copies of globals and sys.modules for pyembed_reset
+void pyembed_snapshot(JNIEnv *env, intptr_t _jepThread) {
+    JepThread *jepThread;
+    PyObject  *globals, *modules;
+
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return;
+    }
+
+    pyembed_acquire_thread(jepThread);
+
+    globals = PyDict_Copy(jepThread->globals);          /* new ref */
+    modules = PyDict_Copy(PyImport_GetModuleDict());    /* new ref */
+    if(process_py_exception(env, 0) || !globals || !modules) {
+        Py_XDECREF(globals);
+        Py_XDECREF(modules);
+        goto EXIT;
+    }
+
+    Py_XDECREF(jepThread->snapshotGlobals);
+    Py_XDECREF(jepThread->snapshotModules);
+    jepThread->snapshotGlobals = globals;
+    jepThread->snapshotModules = modules;
+
+EXIT:
+    pyembed_release_thread(jepThread);
+}
+
+
+/*
+ * Restore globals to the last snapshot. The globals dict itself is kept,
+ * functions defined before the snapshot still reference it. Values are not
+ * copied, so objects changed in place since the snapshot stay changed.
+ * If dropModules is set, modules imported since the snapshot are removed
+ * from sys.modules.
+ */
+void pyembed_reset(JNIEnv *env, intptr_t _jepThread, int dropModules) {
+    JepThread  *jepThread;
+    PyObject   *modules, *key, *value, *keys;
+    Py_ssize_t  i;
+
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return;
+    }
+
+    pyembed_acquire_thread(jepThread);
+
+    if(!jepThread->snapshotGlobals) {
+        THROW_JEP(env, "No snapshot to reset to.");
+        goto EXIT;
+    }
+
+    PyDict_Clear(jepThread->globals);
+    if(PyDict_Update(jepThread->globals, jepThread->snapshotGlobals) != 0) {
+        process_py_exception(env, 0);
+        goto EXIT;
+    }
+
+    if(dropModules) {
+        modules = PyImport_GetModuleDict(); /* borrowed */
+        keys    = PyDict_Keys(modules);     /* new ref */
+        if(process_py_exception(env, 0) || !keys)
+            goto EXIT;
+
+        for(i = 0; i < PyList_GET_SIZE(keys); i++) {
+            key = PyList_GET_ITEM(keys, i);
+            if(PyDict_GetItem(jepThread->snapshotModules, key) == NULL)
+                PyDict_DelItem(modules, key);
+        }
+
+        // and put back any the script replaced or deleted
+        i = 0;
+        while(PyDict_Next(jepThread->snapshotModules, &i, &key, &value))
+            PyDict_SetItem(modules, key, value);
+
+        Py_DECREF(keys);
+        process_py_exception(env, 0);
+    }
+
+EXIT:
+    pyembed_release_thread(jepThread);
+}
+
+
+/*
+ * Builds the message and stack trace of a python exception held by a
+ * JepException, see process_py_exception, and releases it.  This thread may
+ * already have the GIL, e.g. when python prints a java exception that has
+ * the JepException as its cause.
+ */
+jobjectArray pyembed_describe_exception(JNIEnv *env,
+                                        intptr_t _jepThread,
+                                        jlong pyException) {
+    JepThread    *jepThread;
+    PyObject     *exc, *ptype, *pvalue, *ptrace;
+    jobjectArray  result;
+    int           hasGIL;
+
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return NULL;
+    }
+
+    hasGIL = CURRENT_TSTATE() == jepThread->tstate;
+    if(!hasGIL)
+        pyembed_acquire_thread(jepThread);
+
+    // don't disturb an exception python is in the middle of
+    PyErr_Fetch(&ptype, &pvalue, &ptrace);
+
+    exc    = (PyObject *) (intptr_t) pyException;
+    result = describe_py_exception(env, exc);
+    Py_DECREF(exc);
+    if(!result)
+        PyErr_Clear();
+
+    PyErr_Restore(ptype, pvalue, ptrace);
+    if(!hasGIL)
+        pyembed_release_thread(jepThread);
+    return result;
+}
+
+
+// releases python exceptions held by JepExceptions that weren't described
+void pyembed_release_exceptions(JNIEnv *env,
+                                intptr_t _jepThread,
+                                jlongArray pyExceptions) {
+    JepThread *jepThread;
+    jsize      i, len;
+    jlong     *ptrs;
+    int        hasGIL;
+
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return;
+    }
+
+    len  = (*env)->GetArrayLength(env, pyExceptions);
+    ptrs = (*env)->GetLongArrayElements(env, pyExceptions, NULL);
+    if(!ptrs)
+        return;
+
+    // Jep.isValidThread() may be called back from python
+    hasGIL = CURRENT_TSTATE() == jepThread->tstate;
+    if(!hasGIL)
+        pyembed_acquire_thread(jepThread);
+    for(i = 0; i < len; i++) {
+        PyObject *exc = (PyObject *) (intptr_t) ptrs[i];
+        Py_DECREF(exc);
+    }
+    if(!hasGIL)
+        pyembed_release_thread(jepThread);
+
+    (*env)->ReleaseLongArrayElements(env, pyExceptions, ptrs, JNI_ABORT);
+}
+
+
+// convert pyobject to boxed java value
+jobject pyembed_box_py(JNIEnv *env, PyObject *result) {
+
+    if(result == Py_None) {
+        /*
+         * To ensure we get back a Java null instead of the word "None", we
+         * return NULL in this case.  All the other return NULLs below will
+         * set the error indicator which should be checked for and handled by
+         * code calling pyembed_box_py.
+         */
+        return NULL;
+    }
+
+    // class and object need to return a new local ref so the object
+    // isn't garbage collected.
+    if(pyjclass_check(result))
+        return (*env)->NewLocalRef(env, ((PyJobject_Object *) result)->clazz);
+
+    if(pyjobject_check(result))
+        return (*env)->NewLocalRef(env, ((PyJobject_Object *) result)->object);
+
+    if(PyString_Check(result))
+        return pystring_tojstring(env, result);
+
+    if(PyBool_Check(result)) {
+        jboolean b = JNI_FALSE;
+        if(result == Py_True)
+            b = JNI_TRUE;
+
+        if(booleanValueOf == 0) {
+            booleanValueOf = (*env)->GetStaticMethodID(env,
+                                                       JBOOLEAN_OBJ_TYPE,
+                                                       "valueOf",
+                                                       "(Z)Ljava/lang/Boolean;");
+            if(process_java_exception(env) || !booleanValueOf)
+                return NULL;
+        }
+
+        return (*env)->CallStaticObjectMethod(env,
+                                              JBOOLEAN_OBJ_TYPE,
+                                              booleanValueOf,
+                                              b);
+    }
+
+#if PY_MAJOR_VERSION < 3
+    if(PyInt_Check(result)) {
+        jint i = (jint) PyInt_AS_LONG(result);
+
+        if(integerValueOf == 0) {
+            integerValueOf = (*env)->GetStaticMethodID(env,
+                                                       JINTEGER_OBJ_TYPE,
+                                                       "valueOf",
+                                                       "(I)Ljava/lang/Integer;");
+            if(process_java_exception(env) || !integerValueOf)
+                return NULL;
+        }
+
+        return (*env)->CallStaticObjectMethod(env,
+                                              JINTEGER_OBJ_TYPE,
+                                              integerValueOf,
+                                              i);
+    }
+#endif
+
+    if(PyLong_Check(result)) {
+        jeplong i = PyLong_AsLongLong(result);
+
+        if(longValueOf == 0) {
+            longValueOf = (*env)->GetStaticMethodID(env,
+                                                    JLONG_OBJ_TYPE,
+                                                    "valueOf",
+                                                    "(J)Ljava/lang/Long;");
+            if(process_java_exception(env) || !longValueOf)
+                return NULL;
+        }
+
+        return (*env)->CallStaticObjectMethod(env,
+                                              JLONG_OBJ_TYPE,
+                                              longValueOf,
+                                              i);
+    }
+
+    if(PyFloat_Check(result)) {
+        jdouble d = (jdouble) PyFloat_AS_DOUBLE(result);
+
+        if(doubleValueOf == 0) {
+            doubleValueOf = (*env)->GetStaticMethodID(env,
+                                                      JDOUBLE_OBJ_TYPE,
+                                                      "valueOf",
+                                                      "(D)Ljava/lang/Double;");
+            if(process_java_exception(env) || !doubleValueOf)
+                return NULL;
+        }
+
+        return (*env)->CallStaticObjectMethod(env,
+                                              JDOUBLE_OBJ_TYPE,
+                                              doubleValueOf,
+                                              d);
+    }
+
+    if(pyjarray_check(result)) {
+        PyJarray_Object *t = (PyJarray_Object *) result;
+        pyjarray_release_pinned(t, JNI_COMMIT);
+
+        return (*env)->NewLocalRef(env, t->object);
+    }
+
+    if(PyList_Check(result) || PyTuple_Check(result)) {
+        jobject list;
+        Py_ssize_t i;
+        Py_ssize_t size;
+        int modifiable = PyList_Check(result);
+
+        if(arraylistIConstructor == 0) {
+            arraylistIConstructor = (*env)->GetMethodID(env,
+                                                    JARRAYLIST_TYPE,
+                                                    "<init>",
+                                                    "(I)V");
+        }
+        if(arraylistAdd == 0) {
+            arraylistAdd = (*env)->GetMethodID(env,
+                                               JARRAYLIST_TYPE,
+                                               "add",
+                                               "(Ljava/lang/Object;)Z");
+        }
+        if(!modifiable && unmodifiableList == 0) {
+            unmodifiableList = (*env)->GetStaticMethodID(env,
+                                                         JCOLLECTIONS_TYPE,
+                                                         "unmodifiableList",
+                                                         "(Ljava/util/List;)Ljava/util/List;");
+        }
+
+        if(process_java_exception(env) || !arraylistIConstructor || !arraylistAdd) {
+            return NULL;
+        }
+        if(!modifiable && !unmodifiableList) {
+            return NULL;
+        }
+
+        if(modifiable) {
+            size = PyList_Size(result);
+        } else {
+            size = PyTuple_Size(result);
+        }
+
+        /*
+         * each boxed item is a local ref, a large list would otherwise
+         * overflow the local ref table of the calling native frame.  only
+         * the list survives PopLocalFrame.
+         */
+        if((*env)->PushLocalFrame(env, 16) != 0) {
+            process_java_exception(env);
+            return NULL;
+        }
+
+        list = (*env)->NewObject(env, JARRAYLIST_TYPE, arraylistIConstructor, (jint) size);
+        if(process_java_exception(env) || !list) {
+            (*env)->PopLocalFrame(env, NULL);
+            return NULL;
+        }
 
-    types    = NULL;
-    ret      = NULL;
-    pyret    = NULL;
+        for(i=0; i < size; i++) {
+            PyObject *item;
+            jobject value;
 
-    if(!PyCallable_Check(callable)) {
-        THROW_JEP(env, "pyembed:invoke Invalid callable.");
-        return NULL;
-    }
+            if(modifiable) {
+                item = PyList_GetItem(result, i);
+            } else {
+                item = PyTuple_GetItem(result, i);
+            }
+            value = pyembed_box_py(env, item);
+            if(value == NULL && PyErr_Occurred()) {
+                /*
+                 * java exceptions will have been transformed to python
+                 * exceptions by this point
+                 */
+                (*env)->PopLocalFrame(env, NULL);
+                return NULL;
+            }
+            (*env)->CallBooleanMethod(env, list, arraylistAdd, value);
+            if(process_java_exception(env)) {
+                (*env)->PopLocalFrame(env, NULL);
+                return NULL;
+            }
+            if(value)
+                (*env)->DeleteLocalRef(env, value);
+        }
 
-    // pin primitive array so we can get to it
-    types = (*env)->GetIntArrayElements(env, _types, &isCopy);
+        if(!modifiable) {
+            // make the tuple unmodifiable in Java
+            list = (*env)->CallStaticObjectMethod(env,
+                                                  JCOLLECTIONS_TYPE,
+                                                  unmodifiableList,
+                                                  list);
+            if(process_java_exception(env) || !list) {
+                (*env)->PopLocalFrame(env, NULL);
+                return NULL;
+            }
+        }
+        return (*env)->PopLocalFrame(env, list);
+    } // end of list and tuple conversion
 
-    // first thing to do, convert java arguments to a python tuple
-    arglen = (*env)->GetArrayLength(env, args);
-    pyargs = PyTuple_New(arglen);
-    for(iarg = 0; iarg < arglen; iarg++) {
-        jobject   val;
-        int       typeid;
-        PyObject *pyval;
+    if(PyDict_Check(result)) {
+        jobject map, jkey, jvalue;
+        Py_ssize_t size, pos;
+        PyObject *key, *value;
 
-        val = (*env)->GetObjectArrayElement(env, args, iarg);
-        if((*env)->ExceptionCheck(env)) /* careful, NULL is okay */
-            goto EXIT;
+        if(hashmapIConstructor == 0) {
+            hashmapIConstructor = (*env)->GetMethodID(env,
+                                                    JHASHMAP_TYPE,
+                                                    "<init>",
+                                                    "(I)V");
+        }
+        if(hashmapPut == 0) {
+            hashmapPut = (*env)->GetMethodID(env,
+                                               JHASHMAP_TYPE,
+                                               "put",
+                                               "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+        }
 
-        typeid = (int) types[iarg];
+        if(process_java_exception(env) || !hashmapIConstructor || !hashmapPut) {
+            return NULL;
+        }
 
-        // now we know the type, convert and add to pyargs.  we know
-        pyval = convert_jobject(env, val, typeid);
-        if((*env)->ExceptionOccurred(env))
-            goto EXIT;
+        // same as lists, keep the local refs of the entries bounded
+        if((*env)->PushLocalFrame(env, 16) != 0) {
+            process_java_exception(env);
+            return NULL;
+        }
 
-        PyTuple_SET_ITEM(pyargs, iarg, pyval); /* steals */
-        if(val)
-            (*env)->DeleteLocalRef(env, val);
-    } // for(iarg = 0; iarg < arglen; iarg++)
+        size = PyDict_Size(result);
+        map = (*env)->NewObject(env, JHASHMAP_TYPE, hashmapIConstructor, (jint) size);
+        if(process_java_exception(env) || !map) {
+            (*env)->PopLocalFrame(env, NULL);
+            return NULL;
+        }
 
-    pyret = PyObject_CallObject(callable, pyargs);
-    if(process_py_exception(env, 0) || !pyret)
-        goto EXIT;
+        pos = 0;
+        while(PyDict_Next(result, &pos, &key, &value)) {
+            jobject old;
 
-    // handles errors
-    ret = pyembed_box_py(env, pyret);
+            // None boxes to null, HashMap allows both
+            jkey = pyembed_box_py(env, key);
+            if(!jkey && PyErr_Occurred()) {
+                (*env)->PopLocalFrame(env, NULL);
+                return NULL;
+            }
+            jvalue = pyembed_box_py(env, value);
+            if(!jvalue && PyErr_Occurred()) {
+                (*env)->PopLocalFrame(env, NULL);
+                return NULL;
+            }
 
-EXIT:
-    Py_XDECREF(pyargs);
-    Py_XDECREF(pyret);
+            old = (*env)->CallObjectMethod(env, map, hashmapPut, jkey, jvalue);
+            if(process_java_exception(env)) {
+                (*env)->PopLocalFrame(env, NULL);
+                return NULL;
+            }
+            if(old)
+                (*env)->DeleteLocalRef(env, old);
+            if(jkey)
+                (*env)->DeleteLocalRef(env, jkey);
+            if(jvalue)
+                (*env)->DeleteLocalRef(env, jvalue);
+        }
 
-    if(types) {
-        (*env)->ReleaseIntArrayElements(env,
-                                        _types,
-                                        types,
-                                        JNI_ABORT);
+        return (*env)->PopLocalFrame(env, map);
+    }
 
-        (*env)->DeleteLocalRef(env, _types);
+#if USE_NUMPY
+    if(npy_array_check(result)) {
+        return convert_pyndarray_jndarray(env, result);
     }
+#endif
 
-    return ret;
+    // TODO find a better solution than this
+    // convert everything else to string
+    {
+        jobject ret;
+        PyObject *t = PyObject_Str(result);
+        if(!t)
+            return NULL;
+        ret = (jobject) pystring_tojstring(env, t);
+        Py_DECREF(t);
+
+        return ret;
+    }
 }
 
 
-void pyembed_eval(JNIEnv *env,
-                  intptr_t _jepThread,
-                  char *str) {
-    PyObject         *result;
-    JepThread        *jepThread;
-    
+jobject pyembed_getvalue_on(JNIEnv *env,
+                            intptr_t _jepThread,
+                            intptr_t _onModule,
+                            char *str) {
+    PyObject       *dict, *result, *onModule;
+    jobject         ret = NULL;
+    JepThread      *jepThread;
+
+    result = 0;
+
     jepThread = (JepThread *) _jepThread;
     if(!jepThread) {
         THROW_JEP(env, "Couldn't get thread objects.");
-        return;
+        return NULL;
     }
-
-    PyEval_AcquireThread(jepThread->tstate);
     
     if(str == NULL)
+        return NULL;
+    
+    pyembed_acquire_thread(jepThread);
+    
+    if(process_py_exception(env, 1))
         goto EXIT;
 
-    if(process_py_exception(env, 1))
+    onModule = (PyObject *) _onModule;
+    if(!PyModule_Check(onModule)) {
+        THROW_JEP(env, "pyembed_getvalue_on: Invalid onModule.");
         goto EXIT;
+    }
     
-    result = PyRun_String(str,  /* new ref */
-                          Py_single_input,
-                          jepThread->globals,
-                          jepThread->globals);
+    dict = PyModule_GetDict(onModule);
+    Py_INCREF(dict);
     
-    // c programs inside some java environments may get buffered output
-    fflush(stdout);
-    fflush(stderr);
+    result = PyRun_String(str, Py_eval_input, dict, dict);      /* new ref */
     
     process_py_exception(env, 1);
+    Py_DECREF(dict);
+    
+    if(result == NULL)
+        goto EXIT;              /* don't return, need to release GIL */
+    if(result == Py_None)
+        goto EXIT;
+    
+    // convert results to jobject
+    ret = pyembed_box_py(env, result);
     
-    Py_XDECREF(result);
-
 EXIT:
-    PyEval_ReleaseThread(jepThread->tstate);
+    pyembed_release_thread(jepThread);
+
+    Py_XDECREF(result);
+    return ret;
 }
 
 
-// returns 1 if finished, 0 if not, throws exception otherwise
-int pyembed_compile_string(JNIEnv *env,
-                           intptr_t _jepThread,
-                           char *str) {
-    PyObject       *code;
-    int             ret = -1;
+jobject pyembed_getvalue(JNIEnv *env, intptr_t _jepThread, char *str) {
+    PyObject       *result;
+    jobject         ret = NULL;
     JepThread      *jepThread;
+
+    result = NULL;
     
     jepThread = (JepThread *) _jepThread;
     if(!jepThread) {
         THROW_JEP(env, "Couldn't get thread objects.");
-        return 0;
+        return NULL;
     }
     
     if(str == NULL)
-        return 0;
-
-    PyEval_AcquireThread(jepThread->tstate);
+        return NULL;
     
-    code = Py_CompileString(str, "<stdin>", Py_single_input);
+    pyembed_acquire_thread(jepThread);
     
-    if(code != NULL) {
-        Py_DECREF(code);
-        ret = 1;
-    }
-    else if(PyErr_ExceptionMatches(PyExc_SyntaxError)) {
-        PyErr_Clear();
-        ret = 0;
-    }
-    else
-        process_py_exception(env, 0);
+    if(process_py_exception(env, 1))
+        goto EXIT;
+    
+    result = PyRun_String(str,  /* new ref */
+                          Py_eval_input,
+                          jepThread->globals,
+                          jepThread->globals);
+    
+    process_py_exception(env, 1);
+    
+    if(result == NULL || result == Py_None)
+        goto EXIT;              /* don't return, need to release GIL */
+    
+    // convert results to jobject
+    ret = pyembed_box_py(env, result);
+    
+EXIT:
+    pyembed_release_thread(jepThread);
 
-    PyEval_ReleaseThread(jepThread->tstate);
+    Py_XDECREF(result);
     return ret;
 }
 
 
-intptr_t pyembed_create_module(JNIEnv *env,
-                               intptr_t _jepThread,
-                               char *str) {
-    PyObject       *module;
-    JepThread      *jepThread;
-    intptr_t        ret;
-    PyObject       *key;
+/*
+ * Evaluates str for one of the primitive getters.  Must hold the GIL.
+ * Returns a new ref, or NULL with the python error set, None is a type
+ * error since there's no null for a primitive.
+ */
+static PyObject* pyembed_eval_primitive(JepThread *jepThread,
+                                        char *str,
+                                        const char *typeName) {
+    PyObject *result;
+
+    result = PyRun_String(str,  /* new ref */
+                          Py_eval_input,
+                          jepThread->globals,
+                          jepThread->globals);
+    if(result == Py_None) {
+        Py_DECREF(result);
+        PyErr_Format(PyExc_TypeError,
+                     "Cannot convert None to Java %s: %s",
+                     typeName,
+                     str);
+        return NULL;
+    }
+    return result;
+}
 
-    ret = 0;
+
+// like getvalue but returns an unboxed long, no Long is ever created
+jlong pyembed_getvalue_long(JNIEnv *env, intptr_t _jepThread, char *str) {
+    PyObject       *result, *index;
+    jlong           ret = 0;
+    JepThread      *jepThread;
 
     jepThread = (JepThread *) _jepThread;
     if(!jepThread) {
@@ -795,49 +3415,34 @@ intptr_t pyembed_create_module(JNIEnv *env,
     if(str == NULL)
         return 0;
 
-    PyEval_AcquireThread(jepThread->tstate);
-
-    if(PyImport_AddModule(str) == NULL || process_py_exception(env, 1))
-        goto EXIT;
-
-    PyImport_AddModule(str);
-    module = PyImport_ImportModuleEx(str,
-                                     jepThread->globals,
-                                     jepThread->globals,
-                                     NULL); /* new ref */
-
-    key = PyString_FromString(str);
-    PyDict_SetItem(jepThread->globals,
-                   key,
-                   module);     /* takes ownership */
-
-    Py_DECREF(key);
-    Py_DECREF(module);
+    pyembed_acquire_thread(jepThread);
 
-    if(process_py_exception(env, 0) || module == NULL)
-        ret = 0;
-    else
-        ret = (intptr_t) module;
+    if(process_py_exception(env, 1))
+        goto EXIT;
 
-EXIT:
-    PyEval_ReleaseThread(jepThread->tstate);
+    result = pyembed_eval_primitive(jepThread, str, "long");
+    if(result) {
+        // __index__ so floats fail instead of being truncated
+        index = PyNumber_Index(result); /* new ref */
+        Py_DECREF(result);
+        if(index) {
+            ret = (jlong) PyLong_AsLongLong(index);
+            Py_DECREF(index);
+        }
+    }
+    process_py_exception(env, 1);
 
+EXIT:
+    pyembed_release_thread(jepThread);
     return ret;
 }
 
 
-intptr_t pyembed_create_module_on(JNIEnv *env,
-                                  intptr_t _jepThread,
-                                  intptr_t _onModule,
-                                  char *str) {
-    PyObject       *module, *onModule;
+// like getvalue but returns an unboxed double
+jdouble pyembed_getvalue_double(JNIEnv *env, intptr_t _jepThread, char *str) {
+    PyObject       *result;
+    jdouble         ret = 0;
     JepThread      *jepThread;
-    intptr_t        ret;
-    PyObject       *globals;
-    PyObject       *key;
-
-    ret = 0;
-    globals = 0;
 
     jepThread = (JepThread *) _jepThread;
     if(!jepThread) {
@@ -848,429 +3453,739 @@ intptr_t pyembed_create_module_on(JNIEnv *env,
     if(str == NULL)
         return 0;
 
-    PyEval_AcquireThread(jepThread->tstate);
+    pyembed_acquire_thread(jepThread);
 
-    onModule = (PyObject *) _onModule;
-    if(!PyModule_Check(onModule)) {
-        THROW_JEP(env, "Invalid onModule.");
+    if(process_py_exception(env, 1))
         goto EXIT;
+
+    result = pyembed_eval_primitive(jepThread, str, "double");
+    if(result) {
+        if(PyFloat_Check(result))
+            ret = (jdouble) PyFloat_AS_DOUBLE(result);
+        else
+            ret = (jdouble) PyFloat_AsDouble(result);
+        Py_DECREF(result);
     }
+    process_py_exception(env, 1);
 
-    globals = PyModule_GetDict(onModule);
-    Py_INCREF(globals);
+EXIT:
+    pyembed_release_thread(jepThread);
+    return ret;
+}
 
-    if(PyImport_AddModule(str) == NULL || process_py_exception(env, 1))
-        goto EXIT;
 
-    PyImport_AddModule(str);
-    module = PyImport_ImportModuleEx(str, globals, globals, NULL); /* new ref */
+// like getvalue but returns an unboxed boolean, only True and False convert
+jboolean pyembed_getvalue_boolean(JNIEnv *env, intptr_t _jepThread, char *str) {
+    PyObject       *result;
+    jboolean        ret = JNI_FALSE;
+    JepThread      *jepThread;
 
-    key = PyString_FromString(str);
-    PyDict_SetItem(globals,
-                   key,
-                   module);     /* ownership */
-    Py_DECREF(key);
-    Py_DECREF(module);
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return JNI_FALSE;
+    }
 
-    if(process_py_exception(env, 0) || module == NULL)
-        ret = 0;
-    else
-        ret = (intptr_t) module;
+    if(str == NULL)
+        return JNI_FALSE;
 
-EXIT:
-    Py_XDECREF(globals);
+    pyembed_acquire_thread(jepThread);
 
-    PyEval_ReleaseThread(jepThread->tstate);
+    if(process_py_exception(env, 1))
+        goto EXIT;
+
+    result = pyembed_eval_primitive(jepThread, str, "boolean");
+    if(result) {
+        if(PyBool_Check(result)) {
+            if(result == Py_True)
+                ret = JNI_TRUE;
+        } else {
+            PyErr_Format(PyExc_TypeError,
+                         "Cannot convert %s to Java boolean: %s",
+                         Py_TYPE(result)->tp_name,
+                         str);
+        }
+        Py_DECREF(result);
+    }
+    process_py_exception(env, 1);
 
+EXIT:
+    pyembed_release_thread(jepThread);
     return ret;
 }
 
 
-void pyembed_setloader(JNIEnv *env, intptr_t _jepThread, jobject cl) {
-    jobject    oldLoader = NULL;
-    JepThread *jepThread = (JepThread *) _jepThread;
-    if(!jepThread) {
-        THROW_JEP(env, "Couldn't get thread objects.");
-        return;
-    }
-    
-    if(!cl)
-        return;
-    
-    oldLoader = jepThread->classloader;
-    if(oldLoader)
-        (*env)->DeleteGlobalRef(env, oldLoader);
-    
-    jepThread->classloader = (*env)->NewGlobalRef(env, cl);
-}
+// Class.getComponentType()
+static jmethodID classComponentType = 0;
 
+// ByteBuffer.allocateDirect(int)
+static jmethodID bytebufferAllocateDirect = 0;
 
-// convert pyobject to boxed java value
-jobject pyembed_box_py(JNIEnv *env, PyObject *result) {
+// an integer that isn't a float, see PyNumber_Index
+static int pyembed_as_long(PyObject *value, jeplong *out) {
+    PyObject *index;
 
-    if(result == Py_None) {
-        /*
-         * To ensure we get back a Java null instead of the word "None", we
-         * return NULL in this case.  All the other return NULLs below will
-         * set the error indicator which should be checked for and handled by
-         * code calling pyembed_box_py.
-         */
-        return NULL;
+    if(PyFloat_Check(value)) {
+        PyErr_Format(PyExc_TypeError,
+                     "Expected an integer but got %s",
+                     Py_TYPE(value)->tp_name);
+        return 0;
     }
 
-    // class and object need to return a new local ref so the object
-    // isn't garbage collected.
-    if(pyjclass_check(result))
-        return (*env)->NewLocalRef(env, ((PyJobject_Object *) result)->clazz);
+    index = PyNumber_Index(value); /* new ref */
+    if(!index)
+        return 0;
+    *out = PyLong_AsLongLong(index);
+    Py_DECREF(index);
+    return !PyErr_Occurred();
+}
 
-    if(pyjobject_check(result))
-        return (*env)->NewLocalRef(env, ((PyJobject_Object *) result)->object);
 
-    if(PyString_Check(result)) {
-        char *s = PyString_AS_STRING(result);
-        return (*env)->NewStringUTF(env, (const char *) s);
+// an integer that fits in a narrower java type without truncating
+static int pyembed_as_ranged(PyObject *value,
+                             jeplong min,
+                             jeplong max,
+                             jeplong *out) {
+    if(!pyembed_as_long(value, out))
+        return 0;
+    if(*out < min || *out > max) {
+        PyErr_Format(PyExc_OverflowError,
+                     "%lld is out of range for the Java type",
+                     (long long) *out);
+        return 0;
     }
+    return 1;
+}
 
-    if(PyBool_Check(result)) {
-        jclass clazz;
-        jboolean b = JNI_FALSE;
-        if(result == Py_True)
-            b = JNI_TRUE;
 
-        clazz = (*env)->FindClass(env, "java/lang/Boolean");
+static int pyembed_as_double(PyObject *value, jdouble *out) {
+    if(PyFloat_Check(value)) {
+        *out = (jdouble) PyFloat_AS_DOUBLE(value);
+        return 1;
+    }
 
-        if(booleanBConstructor == 0) {
-            booleanBConstructor = (*env)->GetMethodID(env,
-                                                      clazz,
-                                                      "<init>",
-                                                      "(Z)V");
-        }
+    // str has no __float__ so only numbers make it through
+    *out = (jdouble) PyFloat_AsDouble(value);
+    return !PyErr_Occurred();
+}
 
-        if(!process_java_exception(env) && booleanBConstructor)
-            return (*env)->NewObject(env, clazz, booleanBConstructor, b);
-        else
-            return NULL;
+
+static int pyembed_as_boolean(PyObject *value, jboolean *out) {
+    if(!PyBool_Check(value)) {
+        PyErr_Format(PyExc_TypeError,
+                     "Expected a bool but got %s",
+                     Py_TYPE(value)->tp_name);
+        return 0;
     }
 
-#if PY_MAJOR_VERSION < 3
-    if(PyInt_Check(result)) {
-        jclass clazz;
-        jint i = (jint) PyInt_AS_LONG(result);
+    *out = (value == Py_True) ? JNI_TRUE : JNI_FALSE;
+    return 1;
+}
 
-        clazz = (*env)->FindClass(env, "java/lang/Integer");
 
-        if(integerIConstructor == 0) {
-            integerIConstructor = (*env)->GetMethodID(env,
-                                                      clazz,
-                                                      "<init>",
-                                                      "(I)V");
-        }
+// calls the static valueOf of a box class, looked up the first time
+static jobject pyembed_value_of(JNIEnv *env,
+                                jclass clazz,
+                                jmethodID *valueOf,
+                                const char *sig,
+                                jvalue v) {
+    jobject ret;
 
-        if(!process_java_exception(env) && integerIConstructor)
-            return (*env)->NewObject(env, clazz, integerIConstructor, i);
-        else
+    if(*valueOf == 0) {
+        *valueOf = (*env)->GetStaticMethodID(env, clazz, "valueOf", sig);
+        if(process_java_exception(env) || !*valueOf)
             return NULL;
     }
+
+    ret = (*env)->CallStaticObjectMethodA(env, clazz, *valueOf, &v);
+    if(process_java_exception(env))
+        return NULL;
+    return ret;
+}
+
+
+// the python types pyembed_box_py converts without falling back to str()
+static int pyembed_boxes_natively(PyObject *value) {
+    if(PyString_Check(value) || PyBool_Check(value) || PyInt_Check(value) ||
+       PyLong_Check(value) || PyFloat_Check(value) || PyList_Check(value) ||
+       PyTuple_Check(value) || PyDict_Check(value))
+        return 1;
+#if USE_NUMPY
+    if(npy_array_check(value))
+        return 1;
 #endif
+    return 0;
+}
 
-    if(PyLong_Check(result)) {
-        jclass clazz;
-        jeplong i = PyLong_AsLongLong(result);
 
-        clazz = (*env)->FindClass(env, "java/lang/Long");
+// copies a bytes-like object into a new byte[]
+static jobject pyembed_buffer_bytearray(JNIEnv *env, PyObject *value) {
+    Py_buffer view;
+    jbyteArray arr;
 
-        if(longJConstructor == 0) {
-            longJConstructor = (*env)->GetMethodID(env,
-                                                   clazz,
-                                                   "<init>",
-                                                   "(J)V");
+    if(PyObject_GetBuffer(value, &view, PyBUF_SIMPLE) != 0)
+        return NULL;
+
+    arr = (*env)->NewByteArray(env, (jsize) view.len);
+    if(!process_java_exception(env) && arr) {
+        (*env)->SetByteArrayRegion(env,
+                                   arr,
+                                   0,
+                                   (jsize) view.len,
+                                   (jbyte *) view.buf);
+        JEP_STAT(JEP_STAT_BYTES_CONVERTED, (jeplong) view.len);
+        if(process_java_exception(env)) {
+            (*env)->DeleteLocalRef(env, arr);
+            arr = NULL;
         }
+    }
 
-        if(!process_java_exception(env) && longJConstructor)
-            return (*env)->NewObject(env, clazz, longJConstructor, i);
-        else
+    PyBuffer_Release(&view);
+    return arr;
+}
+
+
+/*
+ * Copies a bytes-like object into a new direct ByteBuffer.  The python memory
+ * isn't shared since the buffer could outlive the object.
+ */
+static jobject pyembed_buffer_bytebuffer(JNIEnv *env, PyObject *value) {
+    Py_buffer view;
+    jobject   buffer;
+    void     *address;
+
+    if(!PyObject_CheckBuffer(value)) {
+        PyErr_Format(PyExc_TypeError,
+                     "Cannot convert %s to java.nio.ByteBuffer",
+                     Py_TYPE(value)->tp_name);
+        return NULL;
+    }
+
+    if(bytebufferAllocateDirect == 0) {
+        bytebufferAllocateDirect = (*env)->GetStaticMethodID(env,
+                                                             JBYTEBUFFER_TYPE,
+                                                             "allocateDirect",
+                                                             "(I)Ljava/nio/ByteBuffer;");
+        if(process_java_exception(env) || !bytebufferAllocateDirect)
             return NULL;
     }
 
-    if(PyFloat_Check(result)) {
-        jclass clazz;
-        jdouble d = (jdouble) PyFloat_AS_DOUBLE(result);
+    if(PyObject_GetBuffer(value, &view, PyBUF_SIMPLE) != 0)
+        return NULL;
 
-        clazz = (*env)->FindClass(env, "java/lang/Double");
+    buffer = (*env)->CallStaticObjectMethod(env,
+                                            JBYTEBUFFER_TYPE,
+                                            bytebufferAllocateDirect,
+                                            (jint) view.len);
+    if(process_java_exception(env) || !buffer) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
 
-        if(doubleDConstructor == 0) {
-            doubleDConstructor = (*env)->GetMethodID(env,
-                                                    clazz,
-                                                    "<init>",
-                                                    "(D)V");
-        }
+    address = (*env)->GetDirectBufferAddress(env, buffer);
+    if(address) {
+        memcpy(address, view.buf, (size_t) view.len);
+        JEP_STAT(JEP_STAT_BYTES_CONVERTED, (jeplong) view.len);
+    }
+    PyBuffer_Release(&view);
 
-        if(!process_java_exception(env) && doubleDConstructor)
-            return (*env)->NewObject(env, clazz, doubleDConstructor, d);
-        else
-            return NULL;
+    if(!address) {
+        (*env)->DeleteLocalRef(env, buffer);
+        PyErr_SetString(PyExc_RuntimeError,
+                        "JVM doesn't support direct ByteBuffer access");
+        return NULL;
     }
+    return buffer;
+}
 
-    if(pyjarray_check(result)) {
-        PyJarray_Object *t = (PyJarray_Object *) result;
-        pyjarray_release_pinned(t, JNI_COMMIT);
 
-        return t->object;
+/*
+ * Fills a new primitive array from a python sequence, element by element.
+ * byte[] from a bytes-like object is a single copy instead.
+ */
+static jobject pyembed_sequence_primitivearray(JNIEnv *env,
+                                               PyObject *value,
+                                               jclass clazz) {
+    PyObject   *seq;
+    PyObject  **items;
+    Py_ssize_t  size, i;
+    jarray      arr  = NULL;
+    void       *elems = NULL;
+    int         ok    = 1;
+
+    if((*env)->IsSameObject(env, clazz, JBYTE_ARRAY_TYPE) &&
+       PyObject_CheckBuffer(value) && !PyString_Check(value))
+        return pyembed_buffer_bytearray(env, value);
+
+    seq = PySequence_Fast(value, "Expected a sequence"); /* new ref */
+    if(!seq)
+        return NULL;
+    size  = PySequence_Fast_GET_SIZE(seq);
+    items = PySequence_Fast_ITEMS(seq);
+
+    if((*env)->IsSameObject(env, clazz, JLONG_ARRAY_TYPE))
+        arr = (*env)->NewLongArray(env, (jsize) size);
+    else if((*env)->IsSameObject(env, clazz, JINT_ARRAY_TYPE))
+        arr = (*env)->NewIntArray(env, (jsize) size);
+    else if((*env)->IsSameObject(env, clazz, JSHORT_ARRAY_TYPE))
+        arr = (*env)->NewShortArray(env, (jsize) size);
+    else if((*env)->IsSameObject(env, clazz, JBYTE_ARRAY_TYPE))
+        arr = (*env)->NewByteArray(env, (jsize) size);
+    else if((*env)->IsSameObject(env, clazz, JDOUBLE_ARRAY_TYPE))
+        arr = (*env)->NewDoubleArray(env, (jsize) size);
+    else if((*env)->IsSameObject(env, clazz, JFLOAT_ARRAY_TYPE))
+        arr = (*env)->NewFloatArray(env, (jsize) size);
+    else if((*env)->IsSameObject(env, clazz, JBOOLEAN_ARRAY_TYPE))
+        arr = (*env)->NewBooleanArray(env, (jsize) size);
+    else {
+        Py_DECREF(seq);
+        PyErr_SetString(PyExc_TypeError, "Unsupported primitive array type");
+        return NULL;
     }
 
-    if(PyList_Check(result) || PyTuple_Check(result)) {
-        jclass clazz;
-        jobject list;
-        Py_ssize_t i;
-        Py_ssize_t size;
-        int modifiable = PyList_Check(result);
+    if(process_java_exception(env) || !arr) {
+        Py_DECREF(seq);
+        return NULL;
+    }
 
-        clazz = (*env)->FindClass(env, "java/util/ArrayList");
-        if(arraylistIConstructor == 0) {
-            arraylistIConstructor = (*env)->GetMethodID(env,
-                                                    clazz,
-                                                    "<init>",
-                                                    "(I)V");
+    /*
+     * not a critical region, converting the items calls back into python
+     * which can take arbitrarily long.
+     */
+    if((*env)->IsSameObject(env, clazz, JLONG_ARRAY_TYPE)) {
+        jlong *a = (*env)->GetLongArrayElements(env, arr, NULL);
+        elems = a;
+        for(i = 0; a && ok && i < size; i++) {
+            jeplong v;
+            ok = pyembed_as_long(items[i], &v);
+            a[i] = (jlong) v;
         }
-        if(arraylistAdd == 0) {
-            arraylistAdd = (*env)->GetMethodID(env,
-                                               clazz,
-                                               "add",
-                                               "(Ljava/lang/Object;)Z");
+        if(a)
+            (*env)->ReleaseLongArrayElements(env, arr, a, ok ? 0 : JNI_ABORT);
+    } else if((*env)->IsSameObject(env, clazz, JINT_ARRAY_TYPE)) {
+        jint *a = (*env)->GetIntArrayElements(env, arr, NULL);
+        elems = a;
+        for(i = 0; a && ok && i < size; i++) {
+            jeplong v;
+            ok = pyembed_as_ranged(items[i],
+                                   -2147483647LL - 1,
+                                   2147483647LL,
+                                   &v);
+            a[i] = (jint) v;
         }
-
-        if(process_java_exception(env) || !arraylistIConstructor || !arraylistAdd) {
-            return NULL;
+        if(a)
+            (*env)->ReleaseIntArrayElements(env, arr, a, ok ? 0 : JNI_ABORT);
+    } else if((*env)->IsSameObject(env, clazz, JSHORT_ARRAY_TYPE)) {
+        jshort *a = (*env)->GetShortArrayElements(env, arr, NULL);
+        elems = a;
+        for(i = 0; a && ok && i < size; i++) {
+            jeplong v;
+            ok = pyembed_as_ranged(items[i], -32768, 32767, &v);
+            a[i] = (jshort) v;
         }
-
-        if(modifiable) {
-            size = PyList_Size(result);
-        } else {
-            size = PyTuple_Size(result);
+        if(a)
+            (*env)->ReleaseShortArrayElements(env, arr, a, ok ? 0 : JNI_ABORT);
+    } else if((*env)->IsSameObject(env, clazz, JBYTE_ARRAY_TYPE)) {
+        jbyte *a = (*env)->GetByteArrayElements(env, arr, NULL);
+        elems = a;
+        for(i = 0; a && ok && i < size; i++) {
+            jeplong v;
+            ok = pyembed_as_ranged(items[i], -128, 127, &v);
+            a[i] = (jbyte) v;
         }
-        list = (*env)->NewObject(env, clazz, arraylistIConstructor, (int) size);
-        if(process_java_exception(env) || !list) {
-            return NULL;
+        if(a)
+            (*env)->ReleaseByteArrayElements(env, arr, a, ok ? 0 : JNI_ABORT);
+    } else if((*env)->IsSameObject(env, clazz, JDOUBLE_ARRAY_TYPE)) {
+        jdouble *a = (*env)->GetDoubleArrayElements(env, arr, NULL);
+        elems = a;
+        for(i = 0; a && ok && i < size; i++)
+            ok = pyembed_as_double(items[i], &a[i]);
+        if(a)
+            (*env)->ReleaseDoubleArrayElements(env, arr, a, ok ? 0 : JNI_ABORT);
+    } else if((*env)->IsSameObject(env, clazz, JFLOAT_ARRAY_TYPE)) {
+        jfloat *a = (*env)->GetFloatArrayElements(env, arr, NULL);
+        elems = a;
+        for(i = 0; a && ok && i < size; i++) {
+            jdouble v;
+            ok = pyembed_as_double(items[i], &v);
+            a[i] = (jfloat) v;
         }
+        if(a)
+            (*env)->ReleaseFloatArrayElements(env, arr, a, ok ? 0 : JNI_ABORT);
+    } else {
+        jboolean *a = (*env)->GetBooleanArrayElements(env, arr, NULL);
+        elems = a;
+        for(i = 0; a && ok && i < size; i++)
+            ok = pyembed_as_boolean(items[i], &a[i]);
+        if(a)
+            (*env)->ReleaseBooleanArrayElements(env, arr, a, ok ? 0 : JNI_ABORT);
+    }
 
-        for(i=0; i < size; i++) {
-            PyObject *item;
-            jobject value;
+    Py_DECREF(seq);
+    if(!elems) {
+        process_java_exception(env);
+        ok = 0;
+    }
+    if(!ok) {
+        (*env)->DeleteLocalRef(env, arr);
+        return NULL;
+    }
+    return arr;
+}
 
-            if(modifiable) {
-                item = PyList_GetItem(result, i);
-            } else {
-                item = PyTuple_GetItem(result, i);
-            }
-            value = pyembed_box_py(env, item);
-            if(value == NULL && PyErr_Occurred()) {
-                /*
-                 * java exceptions will have been transformed to python
-                 * exceptions by this point
-                 */
-                (*env)->DeleteLocalRef(env, list);
-                return NULL;
-            }
-            (*env)->CallBooleanMethod(env, list, arraylistAdd, value);
-            if(process_java_exception(env)) {
-                (*env)->DeleteLocalRef(env, list);
-                return NULL;
-            }
-        }
 
-        if(modifiable) {
-            return list;
+/*
+ * Converts a python object straight to an instance of clazz, for
+ * Jep.getValue(String, Class).  Unlike pyembed_box_py nothing falls back to
+ * str(), anything that doesn't fit raises a TypeError, including None for a
+ * primitive class.  Returns a new local ref, or NULL for None or with the
+ * python error set.
+ */
+static jobject pyembed_convert_as(JNIEnv *env, PyObject *value, jclass clazz) {
+    jobject ret = NULL;
+    int     typeId;
+
+    typeId = get_jtype(env, clazz);
+    if(process_java_exception(env) || typeId < 0)
+        return NULL;
+
+    // a primitive class means the boxed type
+    switch(typeId) {
+    case JLONG_ID:
+        clazz = JLONG_OBJ_TYPE;
+        break;
+    case JINT_ID:
+        clazz = JINTEGER_OBJ_TYPE;
+        break;
+    case JDOUBLE_ID:
+        clazz = JDOUBLE_OBJ_TYPE;
+        break;
+    case JBOOLEAN_ID:
+        clazz = JBOOLEAN_OBJ_TYPE;
+        break;
+    case JSHORT_ID:
+        clazz = JSHORT_OBJ_TYPE;
+        break;
+    case JBYTE_ID:
+        clazz = JBYTE_OBJ_TYPE;
+        break;
+    case JFLOAT_ID:
+        clazz = JFLOAT_OBJ_TYPE;
+        break;
+    case JCHAR_ID:
+        clazz = JCHAR_OBJ_TYPE;
+        break;
+    case JARRAY_ID:
+    case JSTRING_ID:
+    case JCLASS_ID:
+    case JOBJECT_ID:
+        break;
+    default:
+        goto TYPE_ERROR;
+    }
+
+    // a primitive can't be null
+    if(value == Py_None) {
+        if(typeId == JARRAY_ID || typeId == JSTRING_ID ||
+           typeId == JCLASS_ID || typeId == JOBJECT_ID)
+            return NULL;
+        PyErr_SetString(PyExc_TypeError,
+                        "None cannot be converted to a Java primitive");
+        return NULL;
+    }
+
+    // java objects are passed through as long as they fit the box
+    if(pyjobject_check(value) || pyjarray_check(value)) {
+        jobject obj;
+        if(pyjarray_check(value)) {
+            pyjarray_release_pinned((PyJarray_Object *) value, JNI_COMMIT);
+            obj = ((PyJarray_Object *) value)->object;
+        } else if(pyjclass_check(value)) {
+            obj = ((PyJobject_Object *) value)->clazz;
         } else {
-            // make the tuple unmodifiable in Java
-            jclass collections;
-            jmethodID unmodifiableList;
+            obj = ((PyJobject_Object *) value)->object;
+        }
 
-            collections = (*env)->FindClass(env, "java/util/Collections");
-            if(process_java_exception(env) || !collections) {
-                return NULL;
-            }
+        if(!(*env)->IsInstanceOf(env, obj, clazz))
+            goto TYPE_ERROR;
+        return (*env)->NewLocalRef(env, obj);
+    }
 
-            unmodifiableList = (*env)->GetStaticMethodID(env,
-                                                         collections,
-                                                         "unmodifiableList",
-                                                         "(Ljava/util/List;)Ljava/util/List;");
-            if(process_java_exception(env) || !unmodifiableList) {
-                return NULL;
+    if(typeId == JARRAY_ID) {
+        jclass      component;
+        PyObject   *seq;
+        Py_ssize_t  size, i;
+
+#if USE_NUMPY
+        if(npy_array_check(value)) {
+            ret = convert_pyndarray_jprimitivearray(env, value, clazz);
+            if(!ret)
+                goto TYPE_ERROR;
+            if(!(*env)->IsInstanceOf(env, ret, clazz)) {
+                (*env)->DeleteLocalRef(env, ret);
+                goto TYPE_ERROR;
             }
-            list = (*env)->CallStaticObjectMethod(env,
-                                                  collections,
-                                                  unmodifiableList,
-                                                  list);
-            if(process_java_exception(env) || !list) {
+            return ret;
+        }
+#endif
+
+        if(classComponentType == 0) {
+            classComponentType = (*env)->GetMethodID(env,
+                                                     JCLASS_TYPE,
+                                                     "getComponentType",
+                                                     "()Ljava/lang/Class;");
+            if(process_java_exception(env) || !classComponentType)
                 return NULL;
-            }
-            return list;
         }
-    } // end of list and tuple conversion
 
-    if(PyDict_Check(result)) {
-        jclass clazz;
-        jobject map, jkey, jvalue;
-        Py_ssize_t size, pos;
-        PyObject *key, *value;
+        component = (jclass) (*env)->CallObjectMethod(env,
+                                                      clazz,
+                                                      classComponentType);
+        if(process_java_exception(env) || !component)
+            return NULL;
+
+        if(!(*env)->IsAssignableFrom(env, component, JOBJECT_TYPE)) {
+            (*env)->DeleteLocalRef(env, component);
+            if(!PySequence_Check(value) || PyString_Check(value))
+                goto TYPE_ERROR;
+            return pyembed_sequence_primitivearray(env, value, clazz);
+        }
 
-        clazz = (*env)->FindClass(env, "java/util/HashMap");
-        if(hashmapIConstructor == 0) {
-            hashmapIConstructor = (*env)->GetMethodID(env,
-                                                    clazz,
-                                                    "<init>",
-                                                    "(I)V");
+        // object arrays convert each item to the component type
+        if(!PySequence_Check(value) || PyString_Check(value)) {
+            (*env)->DeleteLocalRef(env, component);
+            goto TYPE_ERROR;
         }
-        if(hashmapPut == 0) {
-            hashmapPut = (*env)->GetMethodID(env,
-                                               clazz,
-                                               "put",
-                                               "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+        seq = PySequence_Fast(value, "Expected a sequence"); /* new ref */
+        if(!seq) {
+            (*env)->DeleteLocalRef(env, component);
+            return NULL;
         }
 
-        if(process_java_exception(env) || !hashmapIConstructor || !hashmapPut) {
+        size = PySequence_Fast_GET_SIZE(seq);
+        ret  = (*env)->NewObjectArray(env, (jsize) size, component, NULL);
+        if(process_java_exception(env) || !ret) {
+            (*env)->DeleteLocalRef(env, component);
+            Py_DECREF(seq);
             return NULL;
         }
 
-        size = PyDict_Size(result);
-        map = (*env)->NewObject(env, clazz, hashmapIConstructor, (jint) size);
-        if(process_java_exception(env) || !map) {
+        for(i = 0; i < size; i++) {
+            jobject item;
+
+            item = pyembed_convert_as(env,
+                                      PySequence_Fast_GET_ITEM(seq, i),
+                                      component);
+            if(!item && PyErr_Occurred())
+                break;
+            (*env)->SetObjectArrayElement(env, ret, (jsize) i, item);
+            if(item)
+                (*env)->DeleteLocalRef(env, item);
+            if(process_java_exception(env))
+                break;
+        }
+
+        (*env)->DeleteLocalRef(env, component);
+        Py_DECREF(seq);
+        if(PyErr_Occurred()) {
+            (*env)->DeleteLocalRef(env, ret);
             return NULL;
         }
+        return ret;
+    } // end of arrays
 
-        pos = 0;
-        while(PyDict_Next(result, &pos, &key, &value)) {
-            jkey = pyembed_box_py(env, key);
-            if(!jkey) {
-                return NULL;
-            }
-            jvalue = pyembed_box_py(env, value);
-            if(!jvalue) {
+#if USE_NUMPY
+    if((*env)->IsSameObject(env, clazz, JEP_NDARRAY_TYPE)) {
+        if(!npy_array_check(value))
+            goto TYPE_ERROR;
+        return convert_pyndarray_jndarray(env, value);
+    }
+#endif
+
+    if((*env)->IsSameObject(env, clazz, JBYTEBUFFER_TYPE))
+        return pyembed_buffer_bytebuffer(env, value);
+
+    // numbers box to the requested type instead of the one box_py picks
+    if((*env)->IsSameObject(env, clazz, JLONG_OBJ_TYPE)) {
+        jeplong v;
+
+        if(PyBool_Check(value) || !pyembed_as_long(value, &v))
+            goto TYPE_ERROR;
+        if(longValueOf == 0) {
+            longValueOf = (*env)->GetStaticMethodID(env,
+                                                    JLONG_OBJ_TYPE,
+                                                    "valueOf",
+                                                    "(J)Ljava/lang/Long;");
+            if(process_java_exception(env) || !longValueOf)
                 return NULL;
-            }
+        }
+        return (*env)->CallStaticObjectMethod(env,
+                                              JLONG_OBJ_TYPE,
+                                              longValueOf,
+                                              (jlong) v);
+    }
 
-            (*env)->CallObjectMethod(env, map, hashmapPut, jkey, jvalue);
-            if(process_java_exception(env)) {
+    if((*env)->IsSameObject(env, clazz, JINTEGER_OBJ_TYPE)) {
+        jeplong v;
+
+        if(PyBool_Check(value) ||
+           !pyembed_as_ranged(value, -2147483647LL - 1, 2147483647LL, &v))
+            goto TYPE_ERROR;
+        if(integerValueOf == 0) {
+            integerValueOf = (*env)->GetStaticMethodID(env,
+                                                       JINTEGER_OBJ_TYPE,
+                                                       "valueOf",
+                                                       "(I)Ljava/lang/Integer;");
+            if(process_java_exception(env) || !integerValueOf)
                 return NULL;
-            }
         }
+        return (*env)->CallStaticObjectMethod(env,
+                                              JINTEGER_OBJ_TYPE,
+                                              integerValueOf,
+                                              (jint) v);
+    }
 
-        return map;
+    if((*env)->IsSameObject(env, clazz, JDOUBLE_OBJ_TYPE)) {
+        jdouble v;
+
+        if(PyBool_Check(value) || !pyembed_as_double(value, &v))
+            goto TYPE_ERROR;
+        if(doubleValueOf == 0) {
+            doubleValueOf = (*env)->GetStaticMethodID(env,
+                                                      JDOUBLE_OBJ_TYPE,
+                                                      "valueOf",
+                                                      "(D)Ljava/lang/Double;");
+            if(process_java_exception(env) || !doubleValueOf)
+                return NULL;
+        }
+        return (*env)->CallStaticObjectMethod(env,
+                                              JDOUBLE_OBJ_TYPE,
+                                              doubleValueOf,
+                                              v);
     }
 
-#if USE_NUMPY
-    if(npy_array_check(result)) {
-        return convert_pyndarray_jndarray(env, result);
+    if((*env)->IsSameObject(env, clazz, JSHORT_OBJ_TYPE)) {
+        jvalue  jv;
+        jeplong v;
+
+        if(PyBool_Check(value) ||
+           !pyembed_as_ranged(value, -32768LL, 32767LL, &v))
+            goto TYPE_ERROR;
+        jv.s = (jshort) v;
+        return pyembed_value_of(env, clazz, &shortValueOf,
+                                "(S)Ljava/lang/Short;", jv);
     }
-#endif
 
-    // TODO find a better solution than this
-    // convert everything else to string
-    {
-        jobject ret;
-        char *tt;
-        PyObject *t = PyObject_Str(result);
-        tt = PyString_AsString(t);
-        ret = (jobject) (*env)->NewStringUTF(env, (const char *) tt);
-        Py_DECREF(t);
+    if((*env)->IsSameObject(env, clazz, JBYTE_OBJ_TYPE)) {
+        jvalue  jv;
+        jeplong v;
 
-        return ret;
+        if(PyBool_Check(value) ||
+           !pyembed_as_ranged(value, -128LL, 127LL, &v))
+            goto TYPE_ERROR;
+        jv.b = (jbyte) v;
+        return pyembed_value_of(env, clazz, &byteValueOf,
+                                "(B)Ljava/lang/Byte;", jv);
     }
-}
 
+    if((*env)->IsSameObject(env, clazz, JFLOAT_OBJ_TYPE)) {
+        jvalue  jv;
+        jdouble v;
+
+        if(PyBool_Check(value) || !pyembed_as_double(value, &v))
+            goto TYPE_ERROR;
+        jv.f = (jfloat) v;
+        if(Py_IS_INFINITY(jv.f) && !Py_IS_INFINITY(v)) {
+            PyErr_Format(PyExc_OverflowError,
+                         "%g is out of range for java.lang.Float",
+                         (double) v);
+            return NULL;
+        }
+        return pyembed_value_of(env, clazz, &floatValueOf,
+                                "(F)Ljava/lang/Float;", jv);
+    }
 
-jobject pyembed_getvalue_on(JNIEnv *env,
-                            intptr_t _jepThread,
-                            intptr_t _onModule,
-                            char *str) {
-    PyObject       *dict, *result, *onModule;
-    jobject         ret = NULL;
-    JepThread      *jepThread;
+    if((*env)->IsSameObject(env, clazz, JCHAR_OBJ_TYPE)) {
+        jvalue  jv;
+        jeplong v;
+
+        // a single character, or its code
+        if(PyString_Check(value)) {
+#if PY_MAJOR_VERSION >= 3 && PY_MINOR_VERSION >= 3
+            if(PyUnicode_GET_LENGTH(value) != 1 ||
+               PyUnicode_READ_CHAR(value, 0) > 0xFFFF)
+                goto TYPE_ERROR;
+            v = (jeplong) PyUnicode_READ_CHAR(value, 0);
+#else
+            if(PyString_GET_SIZE(value) != 1)
+                goto TYPE_ERROR;
+            v = (jeplong) (unsigned char) PyString_AsString(value)[0];
+#endif
+        } else if(PyBool_Check(value) ||
+                  !pyembed_as_ranged(value, 0LL, 65535LL, &v)) {
+            goto TYPE_ERROR;
+        }
+        jv.c = (jchar) v;
+        return pyembed_value_of(env, clazz, &charValueOf,
+                                "(C)Ljava/lang/Character;", jv);
+    }
 
-    result = 0;
+    if(!pyembed_boxes_natively(value))
+        goto TYPE_ERROR;
 
-    jepThread = (JepThread *) _jepThread;
-    if(!jepThread) {
-        THROW_JEP(env, "Couldn't get thread objects.");
+    ret = pyembed_box_py(env, value);
+    if(!ret)
         return NULL;
+    if(!(*env)->IsInstanceOf(env, ret, clazz)) {
+        (*env)->DeleteLocalRef(env, ret);
+        goto TYPE_ERROR;
     }
-    
-    if(str == NULL)
-        return NULL;
-    
-    PyEval_AcquireThread(jepThread->tstate);
-    
-    if(process_py_exception(env, 1))
-        goto EXIT;
+    return ret;
 
-    onModule = (PyObject *) _onModule;
-    if(!PyModule_Check(onModule)) {
-        THROW_JEP(env, "pyembed_getvalue_on: Invalid onModule.");
-        goto EXIT;
+TYPE_ERROR:
+    if(!PyErr_Occurred()) {
+        PyErr_Format(PyExc_TypeError,
+                     "Cannot convert %s to the requested Java type",
+                     Py_TYPE(value)->tp_name);
     }
-    
-    dict = PyModule_GetDict(onModule);
-    Py_INCREF(dict);
-    
-    result = PyRun_String(str, Py_eval_input, dict, dict);      /* new ref */
-    
-    process_py_exception(env, 1);
-    Py_DECREF(dict);
-    
-    if(result == NULL)
-        goto EXIT;              /* don't return, need to release GIL */
-    if(result == Py_None)
-        goto EXIT;
-    
-    // convert results to jobject
-    ret = pyembed_box_py(env, result);
-    
-EXIT:
-    PyEval_ReleaseThread(jepThread->tstate);
-
-    Py_XDECREF(result);
-    return ret;
+    return NULL;
 }
 
 
-jobject pyembed_getvalue(JNIEnv *env, intptr_t _jepThread, char *str) {
+jobject pyembed_getvalue_as(JNIEnv *env,
+                            intptr_t _jepThread,
+                            char *str,
+                            jclass clazz) {
     PyObject       *result;
     jobject         ret = NULL;
     JepThread      *jepThread;
 
-    result = NULL;
-    
     jepThread = (JepThread *) _jepThread;
     if(!jepThread) {
         THROW_JEP(env, "Couldn't get thread objects.");
         return NULL;
     }
-    
-    if(str == NULL)
+
+    if(str == NULL || clazz == NULL)
         return NULL;
-    
-    PyEval_AcquireThread(jepThread->tstate);
-    
+
+    pyembed_acquire_thread(jepThread);
+
     if(process_py_exception(env, 1))
         goto EXIT;
-    
+
     result = PyRun_String(str,  /* new ref */
                           Py_eval_input,
                           jepThread->globals,
                           jepThread->globals);
-    
+    if(result) {
+        ret = pyembed_convert_as(env, result, clazz);
+        Py_DECREF(result);
+    }
     process_py_exception(env, 1);
-    
-    if(result == NULL || result == Py_None)
-        goto EXIT;              /* don't return, need to release GIL */
-    
-    // convert results to jobject
-    ret = pyembed_box_py(env, result);
-    
-EXIT:
-    PyEval_ReleaseThread(jepThread->tstate);
 
-    Py_XDECREF(result);
+EXIT:
+    pyembed_release_thread(jepThread);
     return ret;
 }
 
@@ -1292,7 +4207,7 @@ jobject pyembed_getvalue_array(JNIEnv *env, intptr_t _jepThread, char *str, int
     if(str == NULL)
         return NULL;
     
-    PyEval_AcquireThread(jepThread->tstate);
+    pyembed_acquire_thread(jepThread);
     
     if(process_py_exception(env, 1))
         goto EXIT;
@@ -1334,35 +4249,472 @@ jobject pyembed_getvalue_array(JNIEnv *env, intptr_t _jepThread, char *str, int
             (*env)->SetFloatArrayRegion(env, ret, 0, (jsize) (n / SIZEOF_FLOAT), (jfloat *) s);
             break;
 
-        case JBYTE_ID:
-            ret = (*env)->NewByteArray(env, (jsize) n);
-            (*env)->SetByteArrayRegion(env, ret, 0, (jsize) n, (jbyte *) s);
-            break;
+        case JBYTE_ID:
+            ret = (*env)->NewByteArray(env, (jsize) n);
+            (*env)->SetByteArrayRegion(env, ret, 0, (jsize) n, (jbyte *) s);
+            break;
+
+        default:
+            THROW_JEP(env, "Internal error: array type not handled.");
+            ret = NULL;
+            goto EXIT;
+
+        } // switch
+
+    }
+    else{
+        THROW_JEP(env, "Value is not a string.");
+        goto EXIT;
+    }
+    
+    
+EXIT:
+    pyembed_release_thread(jepThread);
+
+    Py_XDECREF(result);
+    return ret;
+}
+
+
+
+
+
+
+// -------------------------------------------------- script code cache
+
+/*
+ * Process-wide cache of compiled scripts for pyembed_run(). Code objects
+ * can't be shared between sub-interpreters, so entries hold the marshalled
+ * code instead, keyed by the script's absolute path, the name it was run
+ * with, which becomes co_filename, and the optimization level, and checked
+ * against its size and mtime in nanoseconds where stat has them.  At most
+ * CODE_CACHE_MAX_ENTRIES are kept, the least recently used is dropped first.
+ * Everything here is protected by the GIL.
+ */
+#define CODE_CACHE_BUCKETS     64
+#define CODE_CACHE_MAX_ENTRIES 256
+#define CODE_CACHE_EXT         ".jepc"
+
+typedef struct __CodeCacheEntry {
+    char                    *path;
+    jeplong                  size;
+    jeplong                  mtime;
+    char                    *data;      /* marshalled code object */
+    Py_ssize_t               len;
+    struct __CodeCacheEntry *next;      /* in the bucket */
+    struct __CodeCacheEntry *newer;     /* in the LRU list */
+    struct __CodeCacheEntry *older;
+} CodeCacheEntry;
+
+static CodeCacheEntry *codeCache[CODE_CACHE_BUCKETS];
+static CodeCacheEntry *codeCacheNewest  = NULL;
+static CodeCacheEntry *codeCacheOldest  = NULL;
+static int             codeCacheEntries = 0;
+static char           *codeCacheDir     = NULL;
+static jeplong         codeCacheHits    = 0;
+static jeplong         codeCacheMisses  = 0;
+
+
+// FNV-1a, for buckets and cache file names
+static unsigned int code_cache_hash(const char *path) {
+    unsigned int h = 2166136261U;
+
+    for(; *path; path++) {
+        h ^= (unsigned char) *path;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+
+static void code_cache_free_entry(CodeCacheEntry *entry) {
+    free(entry->path);
+    free(entry->data);
+    free(entry);
+}
+
+
+static void code_cache_lru_unlink(CodeCacheEntry *entry) {
+    if(entry->newer)
+        entry->newer->older = entry->older;
+    else
+        codeCacheNewest = entry->older;
+    if(entry->older)
+        entry->older->newer = entry->newer;
+    else
+        codeCacheOldest = entry->newer;
+    entry->newer = entry->older = NULL;
+}
+
+
+static void code_cache_lru_push(CodeCacheEntry *entry) {
+    entry->newer = NULL;
+    entry->older = codeCacheNewest;
+    if(codeCacheNewest)
+        codeCacheNewest->newer = entry;
+    codeCacheNewest = entry;
+    if(!codeCacheOldest)
+        codeCacheOldest = entry;
+}
+
+
+// unlinks an entry from its bucket and the LRU list and frees it
+static void code_cache_drop(CodeCacheEntry *entry) {
+    CodeCacheEntry **prev;
+
+    prev = &codeCache[code_cache_hash(entry->path) % CODE_CACHE_BUCKETS];
+    while(*prev != entry)
+        prev = &(*prev)->next;
+    *prev = entry->next;
+
+    code_cache_lru_unlink(entry);
+    codeCacheEntries--;
+    code_cache_free_entry(entry);
+}
+
+
+// returns the cached entry for path or NULL. stale entries are dropped.
+static CodeCacheEntry* code_cache_get(const char *path,
+                                      jeplong size,
+                                      jeplong mtime) {
+    CodeCacheEntry *entry;
+
+    entry = codeCache[code_cache_hash(path) % CODE_CACHE_BUCKETS];
+    for(; entry != NULL; entry = entry->next) {
+        if(strcmp(entry->path, path) != 0)
+            continue;
+
+        if(entry->size == size && entry->mtime == mtime) {
+            code_cache_lru_unlink(entry);
+            code_cache_lru_push(entry);
+            return entry;
+        }
+
+        // script changed
+        code_cache_drop(entry);
+        return NULL;
+    }
+
+    return NULL;
+}
+
+
+// copies data into a new cache entry. returns NULL if out of memory.
+static CodeCacheEntry* code_cache_put(const char *path,
+                                      jeplong size,
+                                      jeplong mtime,
+                                      const char *data,
+                                      Py_ssize_t len) {
+    CodeCacheEntry *entry;
+    unsigned int    bucket;
+
+    entry = malloc(sizeof(CodeCacheEntry));
+    if(!entry)
+        return NULL;
+
+    entry->path  = malloc(strlen(path) + 1);
+    entry->data  = malloc(len);
+    if(!entry->path || !entry->data) {
+        free(entry->path);
+        free(entry->data);
+        free(entry);
+        return NULL;
+    }
+
+    strcpy(entry->path, path);
+    memcpy(entry->data, data, len);
+    entry->len   = len;
+    entry->size  = size;
+    entry->mtime = mtime;
+
+    bucket        = code_cache_hash(path) % CODE_CACHE_BUCKETS;
+    entry->next   = codeCache[bucket];
+    codeCache[bucket] = entry;
+    code_cache_lru_push(entry);
+
+    if(++codeCacheEntries > CODE_CACHE_MAX_ENTRIES)
+        code_cache_drop(codeCacheOldest);
+    return entry;
+}
+
+
+// cache files look like: magic, size, mtime, key length, key, code
+static void code_cache_file_name(const char *path, char *buf, size_t buflen) {
+    PyOS_snprintf(buf, buflen, "%s%c%08x%s",
+                  codeCacheDir,
+                  FILE_SEP,
+                  code_cache_hash(path),
+                  CODE_CACHE_EXT);
+}
+
+
+// reads a marshalled code object from the cache dir, NULL if not found.
+// caller must free() the result.
+static char* code_cache_read_file(const char *path,
+                                  jeplong size,
+                                  jeplong mtime,
+                                  Py_ssize_t *len) {
+    char     fname[PATH_MAX];
+    FILE    *fp;
+    long     magic;
+    jeplong  fsize, fmtime;
+    size_t   pathlen;
+    char    *fpath = NULL, *data = NULL;
+    long     start, end;
+
+    code_cache_file_name(path, fname, sizeof(fname));
+    if((fp = fopen(fname, "rb")) == NULL)
+        return NULL;
+
+    if(fread(&magic, sizeof(magic), 1, fp) != 1
+       || magic != PyImport_GetMagicNumber()
+       || fread(&fsize, sizeof(fsize), 1, fp) != 1
+       || fread(&fmtime, sizeof(fmtime), 1, fp) != 1
+       || fread(&pathlen, sizeof(pathlen), 1, fp) != 1
+       || fsize != size || fmtime != mtime
+       || pathlen != strlen(path))
+        goto EXIT;
+
+    // hash collisions are unlikely, but check the path anyway
+    fpath = malloc(pathlen + 1);
+    if(!fpath || fread(fpath, 1, pathlen, fp) != pathlen)
+        goto EXIT;
+    fpath[pathlen] = '\0';
+    if(strcmp(fpath, path) != 0)
+        goto EXIT;
+
+    start = ftell(fp);
+    fseek(fp, 0, SEEK_END);
+    end = ftell(fp);
+    fseek(fp, start, SEEK_SET);
+    if(end <= start)
+        goto EXIT;
+
+    *len = (Py_ssize_t) (end - start);
+    data = malloc(*len);
+    if(data && fread(data, 1, *len, fp) != (size_t) *len) {
+        free(data);
+        data = NULL;
+    }
+
+EXIT:
+    free(fpath);
+    fclose(fp);
+    return data;
+}
+
+
+/*
+ * best effort, errors just mean the next process compiles again.  written
+ * to a temp file and renamed so other processes never read half a file.
+ */
+static void code_cache_write_file(const char *path,
+                                  jeplong size,
+                                  jeplong mtime,
+                                  const char *data,
+                                  Py_ssize_t len) {
+    char     fname[PATH_MAX];
+    char     tmpname[PATH_MAX];
+    FILE    *fp;
+    long     magic;
+    size_t   pathlen;
+
+    code_cache_file_name(path, fname, sizeof(fname));
+#ifdef WIN32
+    PyOS_snprintf(tmpname, sizeof(tmpname), "%s.%lu.tmp", fname,
+                  (unsigned long) GetCurrentProcessId());
+#else
+    PyOS_snprintf(tmpname, sizeof(tmpname), "%s.%lu.tmp", fname,
+                  (unsigned long) getpid());
+#endif
+    if((fp = fopen(tmpname, "wb")) == NULL)
+        return;
+
+    magic   = PyImport_GetMagicNumber();
+    pathlen = strlen(path);
+    if(fwrite(&magic, sizeof(magic), 1, fp) != 1
+       || fwrite(&size, sizeof(size), 1, fp) != 1
+       || fwrite(&mtime, sizeof(mtime), 1, fp) != 1
+       || fwrite(&pathlen, sizeof(pathlen), 1, fp) != 1
+       || fwrite(path, 1, pathlen, fp) != pathlen
+       || fwrite(data, 1, len, fp) != (size_t) len) {
+        fclose(fp);
+        remove(tmpname);
+        return;
+    }
+
+    if(fclose(fp) != 0) {
+        remove(tmpname);
+        return;
+    }
+#ifdef WIN32
+    // rename doesn't replace an existing file here
+    remove(fname);
+#endif
+    if(rename(tmpname, fname) != 0)
+        remove(tmpname);
+}
+
+
+// st_mtime in nanoseconds, only to the second without the stat fields
+static jeplong code_cache_mtime(struct stat *st) {
+    jeplong mtime = (jeplong) st->st_mtime * 1000000000;
+
+#if defined(HAVE_STAT_TV_NSEC)
+    mtime += (jeplong) st->st_mtim.tv_nsec;
+#elif defined(HAVE_STAT_TV_NSEC2)
+    mtime += (jeplong) st->st_mtimespec.tv_nsec;
+#endif
+    return mtime;
+}
+
+
+// compile a script, or reuse the cached code if the file hasn't changed.
+// returns a new ref or NULL with a python error set.
+// **** hold lock before calling ****
+static PyObject* pyembed_get_code(const char *file, FILE *fp) {
+    struct stat     st;
+    char            path[PATH_MAX];
+    char           *key;
+    jeplong         size, mtime;
+    CodeCacheEntry *entry;
+    PyObject       *code, *marshalled;
+    char           *source, *data;
+    Py_ssize_t      len;
+    size_t          nread;
+
+    if(stat(file, &st) != 0) {
+        PyErr_SetFromErrnoWithFilename(PyExc_IOError, (char *) file);
+        return NULL;
+    }
+    size  = (jeplong) st.st_size;
+    mtime = code_cache_mtime(&st);
+
+#ifdef WIN32
+    if(_fullpath(path, file, PATH_MAX) == NULL)
+#else
+    if(realpath(file, path) == NULL)
+#endif
+    {
+        strncpy(path, file, PATH_MAX - 1);
+        path[PATH_MAX - 1] = '\0';
+    }
+
+    /*
+     * the code is compiled with file as co_filename and the optimization
+     * level drops asserts and docstrings, so all of them are the key
+     */
+    key = malloc(strlen(path) + strlen(file) + 16);
+    if(!key)
+        return PyErr_NoMemory();
+    sprintf(key, "%s\n%s\n%d", path, file, Py_OptimizeFlag);
+
+    entry = code_cache_get(key, size, mtime);
+    if(entry == NULL && codeCacheDir != NULL) {
+        data = code_cache_read_file(key, size, mtime, &len);
+        if(data != NULL) {
+            entry = code_cache_put(key, size, mtime, data, len);
+            free(data);
+        }
+    }
+
+    if(entry != NULL) {
+        code = PyMarshal_ReadObjectFromString(entry->data, entry->len);
+        if(code != NULL && PyCode_Check(code)) {
+            codeCacheHits++;
+            free(key);
+            return code;
+        }
 
-        default:
-            THROW_JEP(env, "Internal error: array type not handled.");
-            ret = NULL;
-            goto EXIT;
+        // corrupt entry, fall through and compile it again
+        Py_XDECREF(code);
+        PyErr_Clear();
+        code_cache_drop(entry);
+    }
 
-        } // switch
+    codeCacheMisses++;
 
+    code = NULL;
+    source = malloc((size_t) st.st_size + 1);
+    if(!source) {
+        PyErr_NoMemory();
+        goto EXIT;
     }
-    else{
-        THROW_JEP(env, "Value is not a string.");
+
+    nread = fread(source, 1, (size_t) st.st_size, fp);
+    source[nread] = '\0';
+
+    code = Py_CompileString(source, file, Py_file_input); /* new ref */
+    free(source);
+    if(code == NULL)
+        goto EXIT;
+
+    marshalled = PyMarshal_WriteObjectToString(code, Py_MARSHAL_VERSION);
+    if(marshalled == NULL) {
+        // not worth failing the script over
+        PyErr_Clear();
         goto EXIT;
     }
-    
-    
+
+    data = PyBytes_AS_STRING(marshalled);
+    len  = PyBytes_GET_SIZE(marshalled);
+    code_cache_put(key, size, mtime, data, len);
+    if(codeCacheDir != NULL)
+        code_cache_write_file(key, size, mtime, data, len);
+    Py_DECREF(marshalled);
+
 EXIT:
-    PyEval_ReleaseThread(jepThread->tstate);
+    free(key);
+    return code;
+}
 
-    Py_XDECREF(result);
-    return ret;
+
+// dir may be NULL to turn off the on-disk cache
+void pyembed_set_code_cache_dir(JNIEnv *env, const char *dir) {
+    char *copy = NULL;
+
+    if(dir != NULL) {
+        copy = malloc(strlen(dir) + 1);
+        if(!copy) {
+            THROW_JEP(env, "Out of memory.");
+            return;
+        }
+        strcpy(copy, dir);
+    }
+
+    pyembed_acquire_main();
+    free(codeCacheDir);
+    codeCacheDir = copy;
+    pyembed_release_main();
 }
 
 
+void pyembed_clear_code_cache(void) {
+    CodeCacheEntry *entry, *next;
+    int             i;
+
+    pyembed_acquire_main();
+    for(i = 0; i < CODE_CACHE_BUCKETS; i++) {
+        for(entry = codeCache[i]; entry != NULL; entry = next) {
+            next = entry->next;
+            code_cache_free_entry(entry);
+        }
+        codeCache[i] = NULL;
+    }
+    codeCacheNewest  = NULL;
+    codeCacheOldest  = NULL;
+    codeCacheEntries = 0;
+    codeCacheHits    = 0;
+    codeCacheMisses  = 0;
+    pyembed_release_main();
+}
 
 
+// stats[0] is hits, stats[1] is misses
+void pyembed_get_code_cache_stats(jeplong *stats) {
+    stats[0] = codeCacheHits;
+    stats[1] = codeCacheMisses;
+}
 
 
 void pyembed_run(JNIEnv *env,
@@ -1377,7 +4729,7 @@ void pyembed_run(JNIEnv *env,
         return;
     }
 
-    PyEval_AcquireThread(jepThread->tstate);
+    pyembed_acquire_thread(jepThread);
     
     if(file != NULL) {
         FILE *script = fopen(file, "r");
@@ -1405,11 +4757,22 @@ void pyembed_run(JNIEnv *env,
             pyembed_run_pyc(jepThread, script);
         }
         else {
-            PyRun_File(script,
-                       file,
-                       Py_file_input,
-                       jepThread->globals,
-                       jepThread->globals);
+            PyObject *code, *result;
+
+            code = pyembed_get_code(file, script); /* new ref */
+            if(code != NULL) {
+#if PY_MAJOR_VERSION >= 3
+                result = PyEval_EvalCode(code,
+                                         jepThread->globals,
+                                         jepThread->globals);
+#else
+                result = PyEval_EvalCode((PyCodeObject *) code,
+                                         jepThread->globals,
+                                         jepThread->globals);
+#endif
+                Py_XDECREF(result);
+                Py_DECREF(code);
+            }
         }
 
         // c programs inside some java environments may get buffered output
@@ -1421,7 +4784,7 @@ void pyembed_run(JNIEnv *env,
     }
 
 EXIT:
-    PyEval_ReleaseThread(jepThread->tstate);
+    pyembed_release_thread(jepThread);
 }
 
 
@@ -1514,7 +4877,7 @@ static int maybe_pyc_file(FILE *fp, const char* filename, const char* ext,
         return;                                                     \
     }                                                               \
                                                                     \
-    PyEval_AcquireThread(jepThread->tstate);                        \
+    pyembed_acquire_thread(jepThread);                              \
                                                                     \
     pymodule = NULL;                                                \
     if(module != 0)                                                 \
@@ -1556,7 +4919,7 @@ void pyembed_setparameter_object(JNIEnv *env,
         }
     }
 
-    PyEval_ReleaseThread(jepThread->tstate);
+    pyembed_release_thread(jepThread);
     return;
 }
 
@@ -1595,7 +4958,7 @@ void pyembed_setparameter_array(JNIEnv *env,
         }
     }
 
-    PyEval_ReleaseThread(jepThread->tstate);
+    pyembed_release_thread(jepThread);
     return;
 }
 
@@ -1634,7 +4997,7 @@ void pyembed_setparameter_class(JNIEnv *env,
         }
     }
 
-    PyEval_ReleaseThread(jepThread->tstate);
+    pyembed_release_thread(jepThread);
     return;
 }
 
@@ -1671,7 +5034,7 @@ void pyembed_setparameter_string(JNIEnv *env,
                            pyvalue); // steals reference
     }
 
-    PyEval_ReleaseThread(jepThread->tstate);
+    pyembed_release_thread(jepThread);
     return;
 }
 
@@ -1706,7 +5069,7 @@ void pyembed_setparameter_int(JNIEnv *env,
                            pyvalue); // steals reference
     }
 
-    PyEval_ReleaseThread(jepThread->tstate);
+    pyembed_release_thread(jepThread);
     return;
 }
 
@@ -1741,7 +5104,7 @@ void pyembed_setparameter_long(JNIEnv *env,
                            pyvalue); // steals reference
     }
 
-    PyEval_ReleaseThread(jepThread->tstate);
+    pyembed_release_thread(jepThread);
     return;
 }
 
@@ -1776,7 +5139,7 @@ void pyembed_setparameter_double(JNIEnv *env,
                            pyvalue); // steals reference
     }
 
-    PyEval_ReleaseThread(jepThread->tstate);
+    pyembed_release_thread(jepThread);
     return;
 }
 
@@ -1811,6 +5174,529 @@ void pyembed_setparameter_float(JNIEnv *env,
                            pyvalue); // steals reference
     }
 
-    PyEval_ReleaseThread(jepThread->tstate);
+    pyembed_release_thread(jepThread);
     return;
 }
+
+
+// Number.intValue(), Long.longValue(), Number.doubleValue(), Boolean.booleanValue()
+static jmethodID numberIntValue = 0;
+static jmethodID longLongValue = 0;
+static jmethodID numberDoubleValue = 0;
+static jmethodID booleanBooleanValue = 0;
+
+
+/*
+ * Converts a value for pyembed_setparameters the same way Jep.set(String,
+ * Object) picks a pyembed_setparameter_* function, so Float is set as a
+ * float and Short and Byte as ints like their setters.  Returns a new ref.
+ */
+static PyObject* pyembed_convert_set_value(JNIEnv *env, jobject value) {
+    if(value == NULL)
+        Py_RETURN_NONE;
+
+    if((*env)->IsInstanceOf(env, value, JSTRING_TYPE)) {
+        return jstring_topystring(env, value);
+    }
+
+    if((*env)->IsInstanceOf(env, value, JCLASS_TYPE))
+        return (PyObject *) pyjobject_new_class(env, value);
+
+    if((*env)->IsInstanceOf(env, value, JINTEGER_OBJ_TYPE) ||
+       (*env)->IsInstanceOf(env, value, JSHORT_OBJ_TYPE) ||
+       (*env)->IsInstanceOf(env, value, JBYTE_OBJ_TYPE)) {
+        jint i;
+
+        // Number.intValue() covers all three
+        if(numberIntValue == 0) {
+            jclass clazz = (*env)->FindClass(env, "java/lang/Number");
+            if(process_java_exception(env) || !clazz)
+                return NULL;
+            numberIntValue = (*env)->GetMethodID(env,
+                                                 clazz,
+                                                 "intValue",
+                                                 "()I");
+            (*env)->DeleteLocalRef(env, clazz);
+            if(process_java_exception(env) || !numberIntValue)
+                return NULL;
+        }
+        i = (*env)->CallIntMethod(env, value, numberIntValue);
+        if(process_java_exception(env))
+            return NULL;
+        return PyInt_FromLong(i);
+    }
+
+    if((*env)->IsInstanceOf(env, value, JLONG_OBJ_TYPE)) {
+        jlong l;
+
+        if(longLongValue == 0) {
+            longLongValue = (*env)->GetMethodID(env,
+                                                JLONG_OBJ_TYPE,
+                                                "longValue",
+                                                "()J");
+            if(process_java_exception(env) || !longLongValue)
+                return NULL;
+        }
+        l = (*env)->CallLongMethod(env, value, longLongValue);
+        if(process_java_exception(env))
+            return NULL;
+        return PyLong_FromLongLong(l);
+    }
+
+    if((*env)->IsInstanceOf(env, value, JDOUBLE_OBJ_TYPE) ||
+       (*env)->IsInstanceOf(env, value, JFLOAT_OBJ_TYPE)) {
+        jdouble d;
+
+        // Number.doubleValue() covers both
+        if(numberDoubleValue == 0) {
+            jclass clazz = (*env)->FindClass(env, "java/lang/Number");
+            if(process_java_exception(env) || !clazz)
+                return NULL;
+            numberDoubleValue = (*env)->GetMethodID(env,
+                                                   clazz,
+                                                   "doubleValue",
+                                                   "()D");
+            (*env)->DeleteLocalRef(env, clazz);
+            if(process_java_exception(env) || !numberDoubleValue)
+                return NULL;
+        }
+        d = (*env)->CallDoubleMethod(env, value, numberDoubleValue);
+        if(process_java_exception(env))
+            return NULL;
+        return PyFloat_FromDouble(d);
+    }
+
+    if((*env)->IsInstanceOf(env, value, JBOOLEAN_OBJ_TYPE)) {
+        jboolean b;
+
+        if(booleanBooleanValue == 0) {
+            booleanBooleanValue = (*env)->GetMethodID(env,
+                                                      JBOOLEAN_OBJ_TYPE,
+                                                      "booleanValue",
+                                                      "()Z");
+            if(process_java_exception(env) || !booleanBooleanValue)
+                return NULL;
+        }
+        b = (*env)->CallBooleanMethod(env, value, booleanBooleanValue);
+        if(process_java_exception(env))
+            return NULL;
+        // same as Jep.set(String, boolean)
+        return PyInt_FromLong(b ? 1 : 0);
+    }
+
+    return pyjobject_new(env, value);
+}
+
+
+// whether str can be looked up directly instead of evaluated
+static int pyembed_is_identifier(const char *str) {
+    const char *c;
+
+    if(!str || !(isalpha((unsigned char) *str) || *str == '_'))
+        return 0;
+    for(c = str + 1; *c; c++) {
+        if(!(isalnum((unsigned char) *c) || *c == '_'))
+            return 0;
+    }
+    return 1;
+}
+
+
+/*
+ * Returns a python str for a java String, new ref.  Identifiers are interned
+ * so they share the hash and identity of the keys in the globals.  Short
+ * names are kept in the Jep's name cache, so a name used again skips the
+ * UTF-8 round trip and the intern table.
+ */
+static PyObject* pyembed_intern_name(JNIEnv *env,
+                                     JepThread *jepThread,
+                                     jstring jname) {
+    const char *name;
+    PyObject   *ret;
+
+    if(jname == NULL) {
+        PyErr_SetString(PyExc_ValueError, "name is invalid.");
+        return NULL;
+    }
+
+#if PY_MAJOR_VERSION >= 3 && PY_MINOR_VERSION >= 3
+    {
+        jchar            buf[JEP_STRING_CACHE_MAX_CHARS];
+        JepCachedString *slot;
+        unsigned int     hash = 2166136261U;
+        jsize            i, len;
+
+        len = (*env)->GetStringLength(env, jname);
+        if(len <= JEP_STRING_CACHE_MAX_CHARS) {
+            (*env)->GetStringRegion(env, jname, 0, len, buf);
+            if(process_java_exception(env))
+                return NULL;
+
+            // FNV-1a, like pyembed_cached_pystring
+            for(i = 0; i < len; i++) {
+                hash ^= buf[i];
+                hash *= 16777619U;
+            }
+
+            slot = &jepThread->nameCache[hash % JEP_NAME_CACHE_SLOTS];
+            if(slot->str && slot->hash == hash &&
+               pyembed_string_matches(slot->str, buf, len)) {
+                Py_INCREF(slot->str);
+                return slot->str;
+            }
+
+            ret = utf16_topystring(buf, len);
+            if(!ret)
+                return NULL;
+            name = PyString_AsString(ret);
+            if(!name) {
+                Py_DECREF(ret);
+                return NULL;
+            }
+            if(pyembed_is_identifier(name))
+                PyUnicode_InternInPlace(&ret);
+
+            // surrogate pairs make a shorter str that could never match
+            if(PyUnicode_GET_LENGTH(ret) == len) {
+                Py_XDECREF(slot->str);
+                Py_INCREF(ret);
+                slot->str  = ret;
+                slot->hash = hash;
+            }
+            return ret;
+        }
+    }
+#endif
+
+    name = jstring2char(env, jname);
+    if(!name) {
+        process_java_exception(env);
+        return NULL;
+    }
+    if(pyembed_is_identifier(name))
+        ret = PyString_InternFromString(name);
+    else
+        ret = PyString_FromString(name);
+    release_utf_char(env, jname, name);
+    return ret;
+}
+
+
+/*
+ * Sets several globals for Jep.setAll while holding the GIL once.  Stops at
+ * the first value that fails, the ones before it stay set.
+ */
+void pyembed_setparameters(JNIEnv *env,
+                           intptr_t _jepThread,
+                           jobjectArray names,
+                           jobjectArray values) {
+    JepThread *jepThread;
+    jsize      i, len;
+
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return;
+    }
+
+    len = (*env)->GetArrayLength(env, names);
+
+    pyembed_acquire_thread(jepThread);
+
+    for(i = 0; i < len; i++) {
+        jobject   jname, jvalue;
+        PyObject *key, *pyvalue = NULL;
+        int       failed;
+
+        jname  = (*env)->GetObjectArrayElement(env, names, i);
+        jvalue = (*env)->GetObjectArrayElement(env, values, i);
+
+        key = pyembed_intern_name(env, jepThread, (jstring) jname);
+        if(key)
+            pyvalue = pyembed_convert_set_value(env, jvalue);
+
+        failed = !key || !pyvalue ||
+            PyDict_SetItem(jepThread->globals, key, pyvalue) != 0;
+        Py_XDECREF(key);
+        Py_XDECREF(pyvalue);
+        if(jname)
+            (*env)->DeleteLocalRef(env, jname);
+        if(jvalue)
+            (*env)->DeleteLocalRef(env, jvalue);
+
+        if(failed) {
+            process_py_exception(env, 0);
+            break;
+        }
+    }
+
+    pyembed_release_thread(jepThread);
+}
+
+
+/*
+ * Gets several values for Jep.getValues while holding the GIL once.  Plain
+ * names are looked up in the globals directly, anything else, including a
+ * name that isn't a global, is evaluated like pyembed_getvalue so builtins
+ * and errors behave the same.
+ */
+jobjectArray pyembed_getvalues(JNIEnv *env,
+                               intptr_t _jepThread,
+                               jobjectArray names) {
+    JepThread   *jepThread;
+    jobjectArray ret = NULL;
+    jsize        i, len;
+
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return NULL;
+    }
+
+    len = (*env)->GetArrayLength(env, names);
+    ret = (*env)->NewObjectArray(env, len, JOBJECT_TYPE, NULL);
+    if(!ret)
+        return NULL;
+
+    pyembed_acquire_thread(jepThread);
+
+    if(process_py_exception(env, 1))
+        goto EXIT_ERROR;
+
+    for(i = 0; i < len; i++) {
+        jstring     jname;
+        const char *str    = NULL;
+        PyObject   *key, *result = NULL;
+        jobject     value  = NULL;
+
+        jname = (jstring) (*env)->GetObjectArrayElement(env, names, i);
+        if(jname == NULL) {
+            THROW_JEP(env, "name is invalid.");
+            goto EXIT_ERROR;
+        }
+
+        key = pyembed_intern_name(env, jepThread, jname);       /* new ref */
+        (*env)->DeleteLocalRef(env, jname);
+        if(key)
+            str = PyString_AsString(key);  /* kept by key */
+        if(str && pyembed_is_identifier(str)) {
+            result = PyDict_GetItem(jepThread->globals, key); /* borrowed */
+            Py_XINCREF(result);
+        }
+        if(str && !result && !PyErr_Occurred()) {
+            result = PyRun_String(str,  /* new ref */
+                                  Py_eval_input,
+                                  jepThread->globals,
+                                  jepThread->globals);
+        }
+        Py_XDECREF(key);
+
+        if(result) {
+            value = pyembed_box_py(env, result);
+            Py_DECREF(result);
+        }
+        if(process_py_exception(env, 1))
+            goto EXIT_ERROR;
+
+        if(value) {
+            (*env)->SetObjectArrayElement(env, ret, i, value);
+            (*env)->DeleteLocalRef(env, value);
+        }
+    }
+
+    pyembed_release_thread(jepThread);
+    return ret;
+
+EXIT_ERROR:
+    pyembed_release_thread(jepThread);
+    (*env)->DeleteLocalRef(env, ret);
+    return NULL;
+}
+
+
+/*
+ * Creates a slot for PySlot: a tuple of the interned name and the namespace
+ * it's bound to.  The namespace is the globals when module is 0, a module's
+ * dict, or any other object whose attribute the slot sets.  Returns a new
+ * ref as a pointer, 0 on error.
+ */
+intptr_t pyembed_slot_new(JNIEnv *env,
+                          intptr_t _jepThread,
+                          intptr_t module,
+                          const char *name) {
+    JepThread *jepThread;
+    PyObject  *key, *ns, *slot = NULL;
+
+    jepThread = (JepThread *) _jepThread;
+    if(!jepThread) {
+        THROW_JEP(env, "Couldn't get thread objects.");
+        return 0;
+    }
+
+    if(name == NULL) {
+        THROW_JEP(env, "name is invalid.");
+        return 0;
+    }
+
+    pyembed_acquire_thread(jepThread);
+
+    if(module == 0)
+        ns = jepThread->globals;
+    else if(PyModule_Check((PyObject *) module))
+        ns = PyModule_GetDict((PyObject *) module); /* borrowed */
+    else
+        ns = (PyObject *) module;
+
+    key = PyString_InternFromString(name);
+    if(key) {
+        slot = PyTuple_Pack(2, key, ns); /* new ref */
+        Py_DECREF(key);
+    }
+    process_py_exception(env, 0);
+
+    pyembed_release_thread(jepThread);
+    return (intptr_t) slot;
+}
+
+
+// steals the value.  must hold the GIL.
+static void pyembed_slot_store(JNIEnv *env,
+                               PyObject *slot,
+                               PyObject *value) {
+    PyObject *key, *ns;
+
+    if(!value) {
+        process_py_exception(env, 0);
+        return;
+    }
+
+    key = PyTuple_GET_ITEM(slot, 0);
+    ns  = PyTuple_GET_ITEM(slot, 1);
+    if(PyDict_Check(ns))
+        PyDict_SetItem(ns, key, value);
+    else
+        PyObject_SetAttr(ns, key, value);
+    Py_DECREF(value);
+    process_py_exception(env, 0);
+}
+
+
+void pyembed_slot_set_long(JNIEnv *env,
+                           intptr_t _jepThread,
+                           intptr_t slot,
+                           jeplong value) {
+    JepThread *jepThread = (JepThread *) _jepThread;
+
+    if(!jepThread || !slot) {
+        THROW_JEP(env, "Invalid slot.");
+        return;
+    }
+
+    pyembed_acquire_thread(jepThread);
+    pyembed_slot_store(env, (PyObject *) slot, PyLong_FromLongLong(value));
+    pyembed_release_thread(jepThread);
+}
+
+
+void pyembed_slot_set_int(JNIEnv *env,
+                          intptr_t _jepThread,
+                          intptr_t slot,
+                          int value) {
+    JepThread *jepThread = (JepThread *) _jepThread;
+
+    if(!jepThread || !slot) {
+        THROW_JEP(env, "Invalid slot.");
+        return;
+    }
+
+    pyembed_acquire_thread(jepThread);
+    pyembed_slot_store(env, (PyObject *) slot, PyInt_FromLong(value));
+    pyembed_release_thread(jepThread);
+}
+
+
+void pyembed_slot_set_double(JNIEnv *env,
+                             intptr_t _jepThread,
+                             intptr_t slot,
+                             double value) {
+    JepThread *jepThread = (JepThread *) _jepThread;
+
+    if(!jepThread || !slot) {
+        THROW_JEP(env, "Invalid slot.");
+        return;
+    }
+
+    pyembed_acquire_thread(jepThread);
+    pyembed_slot_store(env, (PyObject *) slot, PyFloat_FromDouble(value));
+    pyembed_release_thread(jepThread);
+}
+
+
+// converts like Jep.set(String, Object), see pyembed_convert_set_value
+void pyembed_slot_set_object(JNIEnv *env,
+                             intptr_t _jepThread,
+                             intptr_t slot,
+                             jobject value) {
+    JepThread *jepThread = (JepThread *) _jepThread;
+
+    if(!jepThread || !slot) {
+        THROW_JEP(env, "Invalid slot.");
+        return;
+    }
+
+    pyembed_acquire_thread(jepThread);
+    pyembed_slot_store(env,
+                       (PyObject *) slot,
+                       pyembed_convert_set_value(env, value));
+    pyembed_release_thread(jepThread);
+}
+
+
+// the slot's value converted like pyembed_getvalue
+jobject pyembed_slot_get(JNIEnv *env, intptr_t _jepThread, intptr_t slot) {
+    JepThread *jepThread = (JepThread *) _jepThread;
+    PyObject  *key, *ns, *result;
+    jobject    ret = NULL;
+
+    if(!jepThread || !slot) {
+        THROW_JEP(env, "Invalid slot.");
+        return NULL;
+    }
+
+    pyembed_acquire_thread(jepThread);
+
+    key = PyTuple_GET_ITEM((PyObject *) slot, 0);
+    ns  = PyTuple_GET_ITEM((PyObject *) slot, 1);
+    if(PyDict_Check(ns)) {
+        result = PyDict_GetItem(ns, key); /* borrowed */
+        if(result)
+            Py_INCREF(result);
+        else
+            PyErr_Format(PyExc_NameError,
+                         "name '%s' is not defined",
+                         PyString_AsString(key));
+    } else {
+        result = PyObject_GetAttr(ns, key); /* new ref */
+    }
+
+    if(result) {
+        ret = pyembed_box_py(env, result);
+        Py_DECREF(result);
+    }
+    process_py_exception(env, 1);
+
+    pyembed_release_thread(jepThread);
+    return ret;
+}
+
+
+void pyembed_slot_release(JNIEnv *env, intptr_t _jepThread, intptr_t slot) {
+    JepThread *jepThread = (JepThread *) _jepThread;
+
+    if(!jepThread || !slot)
+        return;
+
+    pyembed_acquire_thread(jepThread);
+    Py_DECREF((PyObject *) slot);
+    pyembed_release_thread(jepThread);
+}
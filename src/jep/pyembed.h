@@ -49,6 +49,162 @@
 
 #define DICT_KEY "jep"
 
+/*
+ * Runtime counters kept per Jep while stats are enabled, see jep.JepStats.
+ * The order must match JepStats.java.
+ */
+enum {
+    JEP_STAT_JAVA_CALLS,        /* java methods and constructors called */
+    JEP_STAT_OBJECTS_CREATED,   /* pyjobjects made by pyjobject_new */
+    JEP_STAT_TYPE_LOOKUPS,      /* get_jtype calls */
+    JEP_STAT_JAVA_EXCEPTIONS,   /* java exceptions raised in python */
+    JEP_STAT_PYTHON_EXCEPTIONS, /* python exceptions thrown to java */
+    JEP_STAT_GIL_ACQUIRES,      /* entering the interpreter from java */
+    JEP_STAT_GIL_WAIT_NANOS,    /* waiting for the GIL on entering */
+    JEP_STAT_INTERPRETER_NANOS, /* in the interpreter, outermost entries,
+                                   including java calls that release the
+                                   GIL */
+    JEP_STAT_BYTES_CONVERTED,   /* array data copied between java and python */
+    JEP_STAT_COUNT
+};
+
+typedef struct {
+    int     enabled;
+    int     depth;              /* nested entries into the interpreter */
+    jeplong enteredAt;          /* when the outermost entry got the GIL */
+    jeplong counters[JEP_STAT_COUNT];
+} JepStats;
+
+/*
+ * Non-zero if any Jep has stats enabled, so counting costs a single check
+ * otherwise.  Only use with the GIL held.
+ */
+extern int pyembedStatsEnabled;
+
+#define JEP_STAT(stat, n)                       \
+    do {                                        \
+        if(pyembedStatsEnabled)                 \
+            pyembed_stat_add((stat), (n));      \
+    } while(0)
+
+// the same when the JepThread is at hand
+#define JEP_THREAD_STAT(jepThread, stat, n)                     \
+    do {                                                        \
+        if((jepThread)->stats && (jepThread)->stats->enabled)   \
+            (jepThread)->stats->counters[(stat)] += (n);        \
+    } while(0)
+
+/*
+ * Process wide counts of the live python wrappers of java objects, always
+ * kept so leak tests can check for exact zero growth, see jep.JepLiveCounts.
+ * The order must match JepLiveCounts.java.  Only change with the GIL held.
+ */
+enum {
+    JEP_LIVE_PYJOBJECTS,        /* including pyjclasses and collections */
+    JEP_LIVE_PYJARRAYS,
+    JEP_LIVE_PYJMETHODS,
+    JEP_LIVE_PYJFIELDS,
+    JEP_LIVE_COUNT
+};
+
+// where global refs are made, so a leak points to its cause
+enum {
+    JEP_REF_PYJOBJECT,          /* object and class of pyjobjects */
+    JEP_REF_PYJARRAY,           /* array, class and component class */
+    JEP_REF_PYJMETHOD,          /* reflected method and parameter types */
+    JEP_REF_PYJFIELD,           /* reflected field */
+    JEP_REF_PYJCLASS,           /* constructor parameter types */
+    JEP_REF_THREAD,             /* classloader and caller of each Jep */
+    JEP_REF_SITES
+};
+
+extern jeplong pyembedLiveObjects[JEP_LIVE_COUNT];
+
+#define JEP_LIVE(type, n) (pyembedLiveObjects[(type)] += (n))
+
+/*
+ * Call profiles of Java methods and constructors called from python, kept
+ * per Jep while profiling is enabled, see Jep.setProfilingEnabled.  Each
+ * phase of a call has a log-linear histogram of nanoseconds: four buckets
+ * per power of two, so a bucket is at most 25% wide.
+ */
+enum {
+    JEP_PROFILE_ARGS,           /* converting python args to java */
+    JEP_PROFILE_JAVA,           /* the java call, without the GIL */
+    JEP_PROFILE_RESULT,         /* taking the GIL back and converting the
+                                   result to python */
+    JEP_PROFILE_PHASES
+};
+
+#define JEP_PROFILE_SUB_BITS 2
+#define JEP_PROFILE_BUCKETS  (42 << JEP_PROFILE_SUB_BITS)
+
+typedef struct {
+    PyObject *name;             /* e.g. java.lang.Integer.valueOf(int) */
+    jeplong   calls;
+    jeplong   errors;           /* calls that raised */
+    jeplong   total[JEP_PROFILE_PHASES];
+    jeplong   max[JEP_PROFILE_PHASES];
+    jeplong   buckets[JEP_PROFILE_PHASES][JEP_PROFILE_BUCKETS];
+} JepCallProfile;
+
+/*
+ * Where a pyjmethod or constructor remembers its profile.  The generation
+ * is unique to each time a Jep starts profiling, so a stale profile is
+ * never used.
+ */
+typedef struct {
+    JepCallProfile *profile;
+    int             generation;
+} JepProfileRef;
+
+// non-zero if any Jep is profiling.  Only use with the GIL held.
+extern int pyembedProfileEnabled;
+
+// when profile isn't NULL, the time into var
+#define JEP_PROFILE_MARK(profile, var)          \
+    do {                                        \
+        if(profile)                             \
+            (var) = pyembed_nanos();            \
+    } while(0)
+
+/*
+ * An optional per-Jep cache of python strs made from short java
+ * Strings, see Jep.setStringCacheSize.  Each slot keeps the last str whose
+ * UTF-16 chars hashed to it, so the cache never grows past its slots.
+ */
+#define JEP_STRING_CACHE_MAX_CHARS 64
+
+// nested JFR events that time the GIL separately, deeper ones share one
+#define JEP_GIL_TIMING_DEPTH 16
+
+/*
+ * Slots of each Jep's cache of the names given to Jep.setAll and
+ * Jep.getValues, by the hash of their UTF-16 chars.
+ */
+#define JEP_NAME_CACHE_SLOTS 64
+
+/*
+ * The most callables whose functional interface proxies are kept for reuse,
+ * see pyembed_callable_proxy.
+ */
+#define JEP_CALLABLE_PROXIES_MAX 256
+
+typedef struct {
+    unsigned int  hash;
+    PyObject     *str;
+} JepCachedString;
+
+typedef struct {
+    unsigned int     mask;      /* number of slots less one */
+    jeplong          hits;
+    jeplong          misses;
+    JepCachedString *slots;
+} JepStringCache;
+
+// the number of Jeps with a string cache.  Only use with the GIL held.
+extern int pyembedStringCaches;
+
 struct __JepThread {
     PyObject      *modjep;
     PyObject      *globals;
@@ -59,6 +215,25 @@ struct __JepThread {
     int            printStack;
     PyObject      *fqnToPyJmethods; /* a dictionary of fully qualified Java 
                                        classnames to PyJmethods on the class */
+    PyObject      *fqnToPyJclass;   /* forName and findClass cache, cleared
+                                       when the classloader changes */
+    PyObject      *snapshotGlobals; /* copy of globals for pyembed_reset */
+    PyObject      *snapshotModules; /* copy of sys.modules for pyembed_reset */
+    PyObject      *callableProxies; /* a dictionary of python callables to
+                                       lists of their functional interface
+                                       proxies, least recently used first */
+    JepStats      *stats;           /* NULL until stats are first enabled */
+    int            timeGil;         /* nested JFR events keeping gilWait */
+    jeplong        gilWait;         /* nanos waiting for the GIL since the
+                                       outermost event started */
+    jeplong        gilWaitStarts[JEP_GIL_TIMING_DEPTH]; /* gilWait when each
+                                                           event started */
+    int            profiling;       /* if java calls are profiled */
+    PyObject      *profile;         /* methodIds to their JepCallProfile
+                                       pointers, kept when profiling stops */
+    int            profileGeneration;
+    JepStringCache *stringCache;    /* NULL unless enabled */
+    JepCachedString nameCache[JEP_NAME_CACHE_SLOTS];
 };
 typedef struct __JepThread JepThread;
 
@@ -70,19 +245,57 @@ intptr_t pyembed_thread_init(JNIEnv*, jobject, jobject);
 void pyembed_thread_close(JNIEnv*, intptr_t);
 
 void pyembed_close(void);
+void pyembed_acquire_thread(JepThread*);
+void pyembed_release_thread(JepThread*);
+void pyembed_stat_add(int, jeplong);
+void pyembed_set_stats_enabled(JNIEnv*, intptr_t, int);
+void pyembed_get_stats(intptr_t, jeplong*);
+jobject pyembed_new_global_ref(JNIEnv*, int, jobject);
+void pyembed_delete_global_ref(JNIEnv*, int, jobject);
+void pyembed_get_live_counts(jeplong*);
+void pyembed_start_gil_timing(intptr_t);
+jeplong pyembed_take_gil_wait(intptr_t);
+jeplong pyembed_nanos(void);
+JepCallProfile* pyembed_profile_get(JNIEnv*, JepProfileRef*, jclass, jmethodID, int);
+void pyembed_profile_record(JepCallProfile*, jeplong, jeplong, jeplong, int);
+void pyembed_set_profile_enabled(JNIEnv*, intptr_t, int);
+PyObject* pyembed_cached_pystring(const jchar*, jsize);
+void pyembed_set_string_cache(JNIEnv*, intptr_t, int);
+void pyembed_get_string_cache_stats(intptr_t, jeplong*);
 void pyembed_run(JNIEnv*, intptr_t, char*);
+void pyembed_set_code_cache_dir(JNIEnv*, const char*);
+void pyembed_clear_code_cache(void);
+void pyembed_get_code_cache_stats(jeplong*);
 jobject pyembed_invoke_method(JNIEnv*, intptr_t,const char*, jobjectArray, jintArray);
+jlong pyembed_lookup_target(JNIEnv*, intptr_t, const char*);
 jobject pyembed_invoke(JNIEnv*, PyObject*, jobjectArray, jintArray);
+jobject pyembed_invoke_as(JNIEnv*, PyObject*, jobjectArray, jintArray, jclass);
+PyObject* pyembed_call_unboxed(JNIEnv*, PyObject*, jintArray, jlongArray, jobjectArray);
+int pyembed_unbox_result(JNIEnv*, PyObject*, int, jclass, jvalue*);
+int pyembed_is_functional(JNIEnv*, jclass);
+jobject pyembed_callable_proxy(JNIEnv*, PyObject*, jclass);
 void pyembed_eval(JNIEnv*, intptr_t, char*);
 int pyembed_compile_string(JNIEnv*, intptr_t, char*);
+intptr_t pyembed_compile_code(JNIEnv*, intptr_t, char*, char*);
+void pyembed_exec(JNIEnv*, intptr_t, char*);
+void pyembed_exec_code(JNIEnv*, intptr_t, intptr_t);
 void pyembed_setloader(JNIEnv*, intptr_t, jobject);
+void pyembed_snapshot(JNIEnv*, intptr_t);
+void pyembed_reset(JNIEnv*, intptr_t, int);
+jobjectArray pyembed_describe_exception(JNIEnv*, intptr_t, jlong);
+void pyembed_release_exceptions(JNIEnv*, intptr_t, jlongArray);
 jobject pyembed_getvalue(JNIEnv*, intptr_t, char*);
+jlong pyembed_getvalue_long(JNIEnv*, intptr_t, char*);
+jdouble pyembed_getvalue_double(JNIEnv*, intptr_t, char*);
+jboolean pyembed_getvalue_boolean(JNIEnv*, intptr_t, char*);
+jobject pyembed_getvalue_as(JNIEnv*, intptr_t, char*, jclass);
 jobject pyembed_getvalue_array(JNIEnv*, intptr_t, char*, int typ);
 jobject pyembed_getvalue_on(JNIEnv*, intptr_t, intptr_t, char*);
 jobject pyembed_box_py(JNIEnv*, PyObject*);
 
 JNIEnv* pyembed_get_env(void);
 JepThread* pyembed_get_jepthread(void);
+JepThread* pyembed_current_jepthread(void);
 
 intptr_t pyembed_create_module(JNIEnv*, intptr_t, char*);
 intptr_t pyembed_create_module_on(JNIEnv*, intptr_t, intptr_t, char*);
@@ -97,5 +310,14 @@ void pyembed_setparameter_int(JNIEnv*, intptr_t, intptr_t, const char*, int);
 void pyembed_setparameter_long(JNIEnv*, intptr_t, intptr_t, const char*, jeplong);
 void pyembed_setparameter_double(JNIEnv*, intptr_t, intptr_t, const char*, double);
 void pyembed_setparameter_float(JNIEnv*, intptr_t, intptr_t, const char*, float);
+void pyembed_setparameters(JNIEnv*, intptr_t, jobjectArray, jobjectArray);
+jobjectArray pyembed_getvalues(JNIEnv*, intptr_t, jobjectArray);
+intptr_t pyembed_slot_new(JNIEnv*, intptr_t, intptr_t, const char*);
+void pyembed_slot_set_int(JNIEnv*, intptr_t, intptr_t, int);
+void pyembed_slot_set_long(JNIEnv*, intptr_t, intptr_t, jeplong);
+void pyembed_slot_set_double(JNIEnv*, intptr_t, intptr_t, double);
+void pyembed_slot_set_object(JNIEnv*, intptr_t, intptr_t, jobject);
+jobject pyembed_slot_get(JNIEnv*, intptr_t, intptr_t);
+void pyembed_slot_release(JNIEnv*, intptr_t, intptr_t);
 
 #endif
@@ -84,12 +84,13 @@ PyObject* pyjarray_new(JNIEnv *env, jobjectArray obj) {
         return NULL;
     
     pyarray                 = PyObject_NEW(PyJarray_Object, &PyJarray_Type);
-    pyarray->object         = (*env)->NewGlobalRef(env, obj);
-    pyarray->clazz          = (*env)->NewGlobalRef(env, clazz);
+    pyarray->object         = pyembed_new_global_ref(env, JEP_REF_PYJARRAY, obj);
+    pyarray->clazz          = pyembed_new_global_ref(env, JEP_REF_PYJARRAY, clazz);
     pyarray->componentType  = -1;
     pyarray->componentClass = NULL;
     pyarray->length         = -1;
     pyarray->pinnedArray    = NULL;
+    JEP_LIVE(JEP_LIVE_PYJARRAYS, 1);
     
     if(pyjarray_init(env, pyarray, 0, NULL))
         return (PyObject *) pyarray;
@@ -220,15 +221,19 @@ PyObject* pyjarray_new_v(PyObject *isnull, PyObject *args) {
         return NULL;
     
     pyarray                 = PyObject_NEW(PyJarray_Object, &PyJarray_Type);
-    pyarray->object         = (*env)->NewGlobalRef(env, arrayObj);
-    pyarray->clazz          = (*env)->NewGlobalRef(env, clazz);
+    pyarray->object         = pyembed_new_global_ref(env, JEP_REF_PYJARRAY, arrayObj);
+    pyarray->clazz          = pyembed_new_global_ref(env, JEP_REF_PYJARRAY, clazz);
     pyarray->componentType  = (int) typeId;
     pyarray->componentClass = NULL;
     pyarray->length         = -1;
     pyarray->pinnedArray    = NULL;
+    JEP_LIVE(JEP_LIVE_PYJARRAYS, 1);
 
-    if(typeId == JOBJECT_ID || typeId == JARRAY_ID)
-        pyarray->componentClass = (*env)->NewGlobalRef(env, componentClass);
+    if(typeId == JOBJECT_ID || typeId == JARRAY_ID) {
+        pyarray->componentClass = pyembed_new_global_ref(env,
+                                                         JEP_REF_PYJARRAY,
+                                                         componentClass);
+    }
     
     (*env)->DeleteLocalRef(env, arrayObj);
     (*env)->DeleteLocalRef(env, clazz);
@@ -287,7 +292,9 @@ static int pyjarray_init(JNIEnv *env,
         if(process_java_exception(env) || comp < 0)
             goto EXIT_ERROR;
     
-        pyarray->componentClass = (*env)->NewGlobalRef(env, compType);
+        pyarray->componentClass = pyembed_new_global_ref(env,
+                                                         JEP_REF_PYJARRAY,
+                                                         compType);
         pyarray->componentType  = comp;
     }
     
@@ -454,6 +461,26 @@ EXIT_ERROR:
 }
 
 
+// bytes per element of a primitive array
+static int pyjarray_component_size(int componentType) {
+    switch(componentType) {
+    case JBOOLEAN_ID:
+    case JBYTE_ID:
+        return 1;
+    case JCHAR_ID:
+    case JSHORT_ID:
+        return 2;
+    case JINT_ID:
+    case JFLOAT_ID:
+        return 4;
+    case JLONG_ID:
+    case JDOUBLE_ID:
+        return 8;
+    }
+    return 0;
+}
+
+
 // pin primitive array memory. NOOP for object arrays.
 void pyjarray_pin(PyJarray_Object *self) {
     JNIEnv *env = pyembed_get_env();
@@ -518,7 +545,14 @@ void pyjarray_pin(PyJarray_Object *self) {
 
     } // switch
 
-    process_java_exception(env);
+    if(process_java_exception(env))
+        return;
+
+    // python works on a copy of the java array
+    if(self->pinnedArray && self->isCopy)
+        JEP_STAT(JEP_STAT_BYTES_CONVERTED,
+                 (jeplong) self->length *
+                 pyjarray_component_size(self->componentType));
 }
 
 
@@ -526,19 +560,18 @@ static void pyjarray_dealloc(PyJarray_Object *self) {
 #if USE_DEALLOC
     JNIEnv *env = pyembed_get_env();
     if(env) {
-        if(self->clazz)
-            (*env)->DeleteGlobalRef(env, self->clazz);
-        if(self->componentClass)
-            (*env)->DeleteGlobalRef(env, self->componentClass);
+        pyembed_delete_global_ref(env, JEP_REF_PYJARRAY, self->clazz);
+        pyembed_delete_global_ref(env, JEP_REF_PYJARRAY,
+                                  self->componentClass);
 
         // can't guarantee mode 0 will work in this case...
         pyjarray_release_pinned(self, JNI_ABORT);
 
         // pyjarray_release_pinned potentially uses self->object so we can
         // only delete self->object afterwards
-        if(self->object)
-            (*env)->DeleteGlobalRef(env, self->object);
+        pyembed_delete_global_ref(env, JEP_REF_PYJARRAY, self->object);
     } // if env
+    JEP_LIVE(JEP_LIVE_PYJARRAYS, -1);
     
     PyObject_Del(self);
 #endif
@@ -643,7 +676,6 @@ static int pyjarray_setitem(PyJarray_Object *self,
         
     case JSTRING_ID: {
         jstring  jstr = NULL;
-        char    *val;
         
         if(newitem == Py_None)
             ; // setting NULL
@@ -653,8 +685,11 @@ static int pyjarray_setitem(PyJarray_Object *self,
                 return -1;
             }
         
-            val  = PyString_AS_STRING(newitem);
-            jstr = (*env)->NewStringUTF(env, (const char *) val);
+            jstr = pystring_tojstring(env, newitem);
+            if(!jstr) {
+                process_java_exception(env);
+                return -1;
+            }
         }
         
         (*env)->SetObjectArrayElement(env,
@@ -842,7 +877,6 @@ static PyObject* pyjarray_item(PyJarray_Object *self, Py_ssize_t pos) {
 
     case JSTRING_ID: {
         jstring     jstr;
-        const char *str;
         
         jstr = (jstring) (*env)->GetObjectArrayElement(env,
                                                        self->object,
@@ -851,10 +885,7 @@ static PyObject* pyjarray_item(PyJarray_Object *self, Py_ssize_t pos) {
         if(process_java_exception(env))
             ;
         else if(jstr != NULL) {
-            str = (*env)->GetStringUTFChars(env, jstr, 0);
-            ret = PyString_FromString((char *) str);
-            
-            (*env)->ReleaseStringUTFChars(env, jstr, str);
+            ret = jstring_topystring(env, jstr);
             (*env)->DeleteLocalRef(env, jstr);
         }
         else {
@@ -964,7 +995,6 @@ static int pyjarray_index(PyJarray_Object *self, PyObject *el) {
         }
         
         for(i = 0; ret == 0 && i < self->length; i++) {
-            const char *val;
             PyObject   *t;
             jstring l = (*env)->GetObjectArrayElement(env,
                                                       self->object,
@@ -977,16 +1007,16 @@ static int pyjarray_index(PyJarray_Object *self, PyObject *el) {
                 continue;
             }
                 
-            val = jstring2char(env, l);
-            t   = PyString_FromString((char *) val);
+            t = jstring_topystring(env, l);
+            (*env)->DeleteLocalRef(env, l);
+            if(!t)
+                return -1;
             
             ret = PyObject_RichCompareBool(el,
                                            t,
                                            Py_EQ);
             
             Py_DECREF(t);
-            release_utf_char(env, l, val);
-            (*env)->DeleteLocalRef(env, l);
 
             if(ret)
                 return i;
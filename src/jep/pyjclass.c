@@ -82,10 +82,12 @@ int pyjclass_init(JNIEnv *env, PyObject *pyjob) {
     jobject           constructor = NULL;
     jclass            initClass   = NULL;
     jobjectArray      parmArray   = NULL;
-    int               i;
+    int               i, j;
 
     pyc = (PyJclass_Object*) pyjob;
-    pyc->initArray  = NULL;
+    pyc->initLen   = 0;
+    pyc->inits     = NULL;
+    pyc->initCache = NULL;
     
     pyjobject = (PyJobject_Object *) pyjob;
 
@@ -127,45 +129,81 @@ int pyjclass_init(JNIEnv *env, PyObject *pyjob) {
     if(process_java_exception(env) || !initArray)
         goto EXIT_ERROR;
 
-    pyc->initArray = (*env)->NewGlobalRef(env, initArray);
-    pyc->initLen   = (*env)->GetArrayLength(env, pyc->initArray);
-
     /*
-     * Optimization for faster performance. Cache number of arguments
-     * for each constructor to avoid repeated reflection lookups.
+     * Optimization for faster performance. Reflect on each constructor
+     * once here, so pyjclass_call only has to match and convert the args.
      */
-    pyc->numArgsPerInit = malloc(sizeof(int) * pyc->initLen);
+    pyc->initLen = (*env)->GetArrayLength(env, initArray);
+    pyc->inits   = calloc(pyc->initLen > 0 ? pyc->initLen : 1,
+                          sizeof(PyJconstructor));
+    if(!pyc->inits) {
+        pyc->initLen = 0;
+        PyErr_NoMemory();
+        goto EXIT_ERROR;
+    }
+
     for(i = 0; i < pyc->initLen; i++) {
+        PyJconstructor *init = &pyc->inits[i];
+
         constructor = (*env)->GetObjectArrayElement(env,
-                                                    pyc->initArray,
+                                                    initArray,
                                                     i);
         if(process_java_exception(env) || !constructor)
             goto EXIT_ERROR;
 
-
-        // we need to get the class java.lang.reflect.Constructor first
-        initClass = (*env)->GetObjectClass(env, constructor);
-        if(process_java_exception(env) || !initClass)
+        init->methodId = (*env)->FromReflectedMethod(env, constructor);
+        if(process_java_exception(env) || !init->methodId)
             goto EXIT_ERROR;
 
-        // next, get parameters for constructor
+        // we need to get the class java.lang.reflect.Constructor first
         if(classGetParmTypes == 0) {
+            initClass = (*env)->GetObjectClass(env, constructor);
+            if(process_java_exception(env) || !initClass)
+                goto EXIT_ERROR;
+
             classGetParmTypes = (*env)->GetMethodID(env,
                                                     initClass,
                                                     "getParameterTypes",
                                                     "()[Ljava/lang/Class;");
             if(process_java_exception(env) || !classGetParmTypes)
                 goto EXIT_ERROR;
+            (*env)->DeleteLocalRef(env, initClass);
         }
+
+        // next, get parameters for constructor
         parmArray = (jobjectArray) (*env)->CallObjectMethod(env,
                                                             constructor,
                                                             classGetParmTypes);
         if(process_java_exception(env) || !parmArray)
             goto EXIT_ERROR;
-
+        (*env)->DeleteLocalRef(env, constructor);
 
         // now we know how many parameters this constructor receives
-        pyc->numArgsPerInit[i] = (*env)->GetArrayLength(env, parmArray);
+        init->numArgs     = (*env)->GetArrayLength(env, parmArray);
+        init->parmTypes   = calloc(init->numArgs + 1, sizeof(jclass));
+        init->parmTypeIds = calloc(init->numArgs + 1, sizeof(int));
+        if(!init->parmTypes || !init->parmTypeIds) {
+            PyErr_NoMemory();
+            goto EXIT_ERROR;
+        }
+
+        for(j = 0; j < init->numArgs; j++) {
+            jclass parmType = (jclass) (*env)->GetObjectArrayElement(env,
+                                                                     parmArray,
+                                                                     j);
+            if(process_java_exception(env) || !parmType)
+                goto EXIT_ERROR;
+
+            init->parmTypeIds[j] = get_jtype(env, parmType);
+            if(PyErr_Occurred() || process_java_exception(env))
+                goto EXIT_ERROR;
+
+            init->parmTypes[j] = pyembed_new_global_ref(env,
+                                                        JEP_REF_PYJCLASS,
+                                                        parmType);
+            (*env)->DeleteLocalRef(env, parmType);
+        }
+        (*env)->DeleteLocalRef(env, parmArray);
     } // end of optimization
 
     /*
@@ -310,31 +348,97 @@ int pyjclass_check(PyObject *obj) {
 static void pyjclass_dealloc(PyJclass_Object *self) {
 #if USE_DEALLOC
     JNIEnv *env = pyembed_get_env();
-    if(env) {
-        if(self->initArray)
-            (*env)->DeleteGlobalRef(env, self->initArray);
+    int     i, j;
+
+    if(self->inits) {
+        for(i = 0; i < self->initLen; i++) {
+            PyJconstructor *init = &self->inits[i];
+            if(env && init->parmTypes) {
+                for(j = 0; j < init->numArgs; j++) {
+                    pyembed_delete_global_ref(env, JEP_REF_PYJCLASS,
+                                              init->parmTypes[j]);
+                }
+            }
+            free(init->parmTypes);
+            free(init->parmTypeIds);
+        }
+        free(self->inits);
     }
-    free(self->numArgsPerInit);
+    Py_CLEAR(self->initCache);
     pyjobject_dealloc((PyJobject_Object*) self);
 #endif
 }
 
 
+// returns 1 if every arg matches the constructor's parameters
+static int pyjclass_matches(JNIEnv *env,
+                            PyJconstructor *init,
+                            PyObject *args) {
+    int parmPos;
+
+    for(parmPos = 0; parmPos < init->numArgs; parmPos++) {
+        PyObject *param = PyTuple_GET_ITEM(args, parmPos);
+        if(!pyarg_matches_jtype(env,
+                                param,
+                                init->parmTypes[parmPos],
+                                init->parmTypeIds[parmPos]))
+            return 0;
+    }
+    return 1;
+}
+
+
+/*
+ * tuple of the args' types, used as the initCache key. new ref.
+ * returns NULL without an exception if which constructor matches depends
+ * on the values and not just the types, e.g. None or a pyjobject.
+ */
+static PyObject* pyjclass_arg_types(PyObject *args) {
+    Py_ssize_t i, len = PyTuple_GET_SIZE(args);
+    PyObject  *types;
+
+    for(i = 0; i < len; i++) {
+        PyObject *param = PyTuple_GET_ITEM(args, i);
+        if(param == Py_None || pyjobject_check(param) ||
+           pyjarray_check(param))
+            return NULL;
+        // could be a char
+        if(PyString_Check(param) && PyString_GET_SIZE(param) == 1)
+            return NULL;
+    }
+
+    types = PyTuple_New(len);
+    if(!types)
+        return NULL;
+    for(i = 0; i < len; i++) {
+        PyObject *type = (PyObject *) Py_TYPE(PyTuple_GET_ITEM(args, i));
+        Py_INCREF(type);
+        PyTuple_SET_ITEM(types, i, type);
+    }
+    return types;
+}
+
+
 // call constructor as a method and return pyjobject.
 PyObject* pyjclass_call(PyJclass_Object *self,
                         PyObject *args,
                         PyObject *keywords) {
-    int            initPos     = 0;
-    int            parmPos     = 0;
-    int            parmLen     = 0;
-    jobjectArray   parmArray   = NULL;
-    JNIEnv        *env;
-    jclass         initClass   = NULL;
-    jobject        constructor = NULL;
-    jvalue        *jargs       = NULL;
-    int            foundArray  = 0;
-    PyThreadState *_save;
-    Py_ssize_t     pyArgLength = 0;
+    int             initPos     = -1;
+    int             i, parmPos  = 0;
+    JNIEnv         *env;
+    PyJconstructor *init        = NULL;
+    jvalue         *jargs       = NULL;
+    int             foundArray  = 0;
+    PyThreadState  *_save;
+    Py_ssize_t      pyArgLength = 0;
+    PyObject       *argTypes    = NULL;
+    PyObject       *cached;
+    jobject         obj         = NULL;
+    PyObject       *pobj        = NULL;
+    JepCallProfile *profile     = NULL;
+    jeplong         callStart   = 0;
+    jeplong         argsDone    = 0;
+    jeplong         javaDone    = 0;
 
     if(!PyTuple_Check(args)) {
         PyErr_Format(PyExc_RuntimeError, "args is not a valid tuple");
@@ -347,6 +451,7 @@ PyObject* pyjclass_call(PyJclass_Object *self,
     }
 
     env = pyembed_get_env();
+    JEP_STAT(JEP_STAT_JAVA_CALLS, 1);
     
     // use a local frame so we don't have to worry too much about references.
     // make sure if this method errors out, that this is popped off again
@@ -355,145 +460,127 @@ PyObject* pyjclass_call(PyJclass_Object *self,
         return NULL;
 
     pyArgLength = PyTuple_Size(args);
-    for(initPos = 0; initPos < self->initLen; initPos++) {
-        parmLen = self->numArgsPerInit[initPos];
-        // skip constructors that don't match the correct number of args
-        if(parmLen != pyArgLength) {
-            continue;
-        }
-        
-        constructor = (*env)->GetObjectArrayElement(env,
-                                                    self->initArray,
-                                                    initPos);
-        if(process_java_exception(env) || !constructor)
-            goto EXIT_ERROR;
-        
-        // get the class java.lang.reflect.Constructor first
-        initClass = (*env)->GetObjectClass(env, constructor);
-        if(process_java_exception(env) || !initClass)
-            goto EXIT_ERROR;
-        
-        // next, get parameters for constructor
-        if(classGetParmTypes == 0) {
-            classGetParmTypes = (*env)->GetMethodID(env,
-                                                    initClass,
-                                                    "getParameterTypes",
-                                                    "()[Ljava/lang/Class;");
-            if(process_java_exception(env) || !classGetParmTypes)
-                goto EXIT_ERROR;
-        }
-        
-        parmArray = (jobjectArray) (*env)->CallObjectMethod(env,
-                                                            constructor,
-                                                            classGetParmTypes);
-        if(process_java_exception(env) || !parmArray)
-            goto EXIT_ERROR;
 
-        // next, find matching constructor for args
-        // the counts match but maybe not the args themselves.
-        jargs = (jvalue *) PyMem_Malloc(sizeof(jvalue) * parmLen);
-        if(!jargs) {
-            THROW_JEP(env, "Out of memory.");
-            goto EXIT_ERROR;
-        }
-        
-        for(parmPos = 0; parmPos < parmLen; parmPos++) {
-            PyObject *param       = PyTuple_GetItem(args, parmPos);
-            int       paramTypeId = -1;
-            jobject   paramType   =
-                (jclass) (*env)->GetObjectArrayElement(env,
-                                                       parmArray,
-                                                       parmPos);
-            
-            if(process_java_exception(env) || !paramType)
+    // use the constructor that matched these arg types last time
+    argTypes = pyjclass_arg_types(args);
+    if(!argTypes && PyErr_Occurred())
+        goto EXIT_ERROR;
+    if(argTypes && self->initCache) {
+        cached = PyDict_GetItem(self->initCache, argTypes); /* borrowed */
+        if(cached)
+            initPos = (int) PyInt_AsLong(cached);
+    }
+
+    if(initPos < 0) {
+        for(i = 0; i < self->initLen; i++) {
+            // skip constructors that don't match the correct number of args
+            if(self->inits[i].numArgs != pyArgLength)
+                continue;
+
+            if(pyjclass_matches(env, &self->inits[i], args)) {
+                initPos = i;
                 break;
-            
-            paramTypeId = get_jtype(env, paramType);
-            if(PyErr_Occurred() || process_java_exception(env))
-                goto EXIT_ERROR;
-            
-            if(paramTypeId == JARRAY_ID)
-                foundArray = 1;
-            
-            // if java and python agree, continue checking
-            if(pyarg_matches_jtype(env, param, paramType, paramTypeId)) {
-                jargs[parmPos] = convert_pyarg_jvalue(env,
-                                                      param,
-                                                      paramType,
-                                                      paramTypeId,
-                                                      parmPos);
-                if(PyErr_Occurred() || process_java_exception(env))
-                    goto EXIT_ERROR;
-                
-                continue; // continue checking parameters
             }
-            
-            break;
-                
-        } // for each parameter type
-            
-        // did they match?
-        if(parmPos == parmLen) {
-            jmethodID methodId = NULL;
-            jobject   obj  = NULL;
-            PyObject *pobj = NULL;
-                
             if(PyErr_Occurred() || process_java_exception(env))
                 goto EXIT_ERROR;
-                
-            // worked out, create new object
-            methodId = (*env)->FromReflectedMethod(env,
-                                                   constructor);
-            if(process_java_exception(env) || !methodId)
-                goto EXIT_ERROR;
-                
-            Py_UNBLOCK_THREADS;
-            obj = (*env)->NewObjectA(env,
-                                     ((PyJobject_Object*) self)->clazz,
-                                     methodId,
-                                     jargs);
-            Py_BLOCK_THREADS;
-            if(process_java_exception(env) || !obj)
-                goto EXIT_ERROR;
-                
-            // finally, make pyjobject and return
-            pobj = pyjobject_new(env, obj);
-            
-            // we already closed the local frame, so make
-            // sure to delete this local ref.
-            PyMem_Free(jargs);
-            
-            // re pin array if needed
-            if(foundArray) {
-                for(parmPos = 0; parmPos < parmLen; parmPos++) {
-                    PyObject *param = PyTuple_GetItem(args, parmPos);
-                    if(param && pyjarray_check(param))
-                        pyjarray_pin((PyJarray_Object *) param);
-                }
-            }
-            
+        }
+
+        if(initPos < 0) {
+            Py_XDECREF(argTypes);
             (*env)->PopLocalFrame(env, NULL);
-            return pobj;
+            PyErr_Format(PyExc_RuntimeError, "Couldn't find matching constructor.");
+            return NULL;
         }
 
-        // prevent memory leak
-        if(jargs) {
-            PyMem_Free(jargs);
+        // remember it, failing to is fine
+        if(argTypes) {
+            if(!self->initCache)
+                self->initCache = PyDict_New();
+            if(self->initCache) {
+                PyObject *pos = PyInt_FromLong(initPos);
+                if(!pos || PyDict_SetItem(self->initCache, argTypes, pos) != 0)
+                    PyErr_Clear();
+                Py_XDECREF(pos);
+            } else {
+                PyErr_Clear();
+            }
         }
-        foundArray = 0;
-    } // for each constructor
-    
-    
+    }
+    Py_CLEAR(argTypes);
+
+    init  = &self->inits[initPos];
+    if(pyembedProfileEnabled) {
+        profile = pyembed_profile_get(env,
+                                      &init->profileRef,
+                                      ((PyJobject_Object*) self)->clazz,
+                                      init->methodId,
+                                      0);
+        JEP_PROFILE_MARK(profile, callStart);
+    }
+
+    jargs = (jvalue *) PyMem_Malloc(sizeof(jvalue) * (init->numArgs + 1));
+    if(!jargs) {
+        THROW_JEP(env, "Out of memory.");
+        goto EXIT_ERROR;
+    }
+
+    for(parmPos = 0; parmPos < init->numArgs; parmPos++) {
+        PyObject *param = PyTuple_GET_ITEM(args, parmPos);
+
+        if(init->parmTypeIds[parmPos] == JARRAY_ID)
+            foundArray = 1;
+
+        jargs[parmPos] = convert_pyarg_jvalue(env,
+                                              param,
+                                              init->parmTypes[parmPos],
+                                              init->parmTypeIds[parmPos],
+                                              parmPos);
+        if(PyErr_Occurred() || process_java_exception(env))
+            goto EXIT_ERROR;
+    }
+
+    JEP_PROFILE_MARK(profile, argsDone);
+    Py_UNBLOCK_THREADS;
+    obj = (*env)->NewObjectA(env,
+                             ((PyJobject_Object*) self)->clazz,
+                             init->methodId,
+                             jargs);
+    JEP_PROFILE_MARK(profile, javaDone);
+    Py_BLOCK_THREADS;
+    if(process_java_exception(env) || !obj)
+        goto EXIT_ERROR;
+
+    // finally, make pyjobject and return
+    pobj = pyjobject_new(env, obj);
+    PyMem_Free(jargs);
+
+    // re pin array if needed
+    if(foundArray) {
+        for(parmPos = 0; parmPos < init->numArgs; parmPos++) {
+            PyObject *param = PyTuple_GetItem(args, parmPos);
+            if(param && pyjarray_check(param))
+                pyjarray_pin((PyJarray_Object *) param);
+        }
+    }
+
     (*env)->PopLocalFrame(env, NULL);
-    PyErr_Format(PyExc_RuntimeError, "Couldn't find matching constructor.");
-    return NULL;
+    if(profile)
+        pyembed_profile_record(profile,
+                               callStart,
+                               argsDone,
+                               javaDone,
+                               pobj == NULL);
+    return pobj;
     
     
 EXIT_ERROR:
+    Py_XDECREF(argTypes);
     if(jargs)
         PyMem_Free(jargs);
     
     (*env)->PopLocalFrame(env, NULL);
+    if(profile)
+        pyembed_profile_record(profile, callStart, argsDone, javaDone, 1);
     
     return NULL;
 }
@@ -32,21 +32,35 @@
 #endif
 #include <jni.h>
 #include <Python.h>
+#include "pyembed.h"
 #include "pyjobject.h"
 
 #ifndef _Included_pyjclass
 #define _Included_pyjclass
 
 PyAPI_DATA(PyTypeObject) PyJclass_Type;
+/*
+ * a constructor, reflected once when the pyjclass is created so calling
+ * it doesn't need to ask Java about its parameters again.
+ */
+typedef struct {
+    jmethodID         methodId;       /* the constructor */
+    int               numArgs;        /* number of parameters */
+    jclass           *parmTypes;      /* global refs to parameter classes */
+    int              *parmTypeIds;    /* parameter type ids from get_jtype */
+    JepProfileRef     profileRef;     /* when profiling calls */
+} PyJconstructor;
+
 /*
  * a pyjclass is a pyjobject with a __call__ method attached, where
  * the call method will invoke constructors.
  */
 typedef struct {
     PyJobject_Object  obj;            /* magic inheritance */
-    jobjectArray      initArray;      /* constructor array */
-    int               initLen;        /* length of initArray */
-    int              *numArgsPerInit; /* pointer to init arg count */
+    int               initLen;        /* length of inits */
+    PyJconstructor   *inits;          /* the public constructors */
+    PyObject         *initCache;      /* tuple of arg types to index in
+                                         inits of the last match */
 } PyJclass_Object;
 
 int pyjclass_init(JNIEnv*, PyObject*);
@@ -84,12 +84,13 @@ PyJfield_Object* pyjfield_new(JNIEnv *env,
         return NULL;
     
     pyf              = PyObject_NEW(PyJfield_Object, &PyJfield_Type);
-    pyf->rfield      = (*env)->NewGlobalRef(env, rfield);
+    pyf->rfield      = pyembed_new_global_ref(env, JEP_REF_PYJFIELD, rfield);
     pyf->pyjobject   = pyjobject;
     pyf->pyFieldName = NULL;
     pyf->fieldTypeId = -1;
     pyf->isStatic    = -1;
     pyf->init        = 0;
+    JEP_LIVE(JEP_LIVE_PYJFIELDS, 1);
     
     // ------------------------------ get field name
     
@@ -246,9 +247,9 @@ static void pyjfield_dealloc(PyJfield_Object *self) {
 #if USE_DEALLOC
     JNIEnv *env  = pyembed_get_env();
     if(env) {
-        if(self->rfield)
-            (*env)->DeleteGlobalRef(env, self->rfield);
+        pyembed_delete_global_ref(env, JEP_REF_PYJFIELD, self->rfield);
     }
+    JEP_LIVE(JEP_LIVE_PYJFIELDS, -1);
     
     Py_CLEAR(self->pyFieldName);
 
@@ -286,7 +287,6 @@ PyObject* pyjfield_get(PyJfield_Object *self) {
 
     case JSTRING_ID: {
         jstring     jstr;
-        const char *str;
         
         if(self->isStatic)
             jstr = (jstring) (*env)->GetStaticObjectField(
@@ -305,10 +305,7 @@ PyObject* pyjfield_get(PyJfield_Object *self) {
             Py_RETURN_NONE;
         }
         
-        str    = (*env)->GetStringUTFChars(env, jstr, 0);
-        result = PyString_FromString(str);
-        
-        (*env)->ReleaseStringUTFChars(env, jstr, str);
+        result = jstring_topystring(env, jstr);
         (*env)->DeleteLocalRef(env, jstr);
         break;
     }
@@ -84,12 +84,15 @@ PyJmethod_Object* pyjmethod_new(JNIEnv *env,
         return NULL;
 
     pym                = PyObject_NEW(PyJmethod_Object, &PyJmethod_Type);
-    pym->rmethod       = (*env)->NewGlobalRef(env, rmethod);
+    pym->rmethod       = pyembed_new_global_ref(env, JEP_REF_PYJMETHOD, rmethod);
     pym->parameters    = NULL;
     pym->lenParameters = 0;
     pym->pyMethodName  = NULL;
     pym->isStatic      = -1;
     pym->returnTypeId  = -1;
+    pym->profileRef.profile    = NULL;
+    pym->profileRef.generation = 0;
+    JEP_LIVE(JEP_LIVE_PYJMETHODS, 1);
     
     // ------------------------------ get method name
     
@@ -142,12 +145,15 @@ PyJmethod_Object* pyjmethod_new_static(JNIEnv *env,
     jstring           jstr         = NULL;
 
     pym                = PyObject_NEW(PyJmethod_Object, &PyJmethod_Type);
-    pym->rmethod       = (*env)->NewGlobalRef(env, rmethod);
+    pym->rmethod       = pyembed_new_global_ref(env, JEP_REF_PYJMETHOD, rmethod);
     pym->parameters    = NULL;
     pym->lenParameters = 0;
     pym->pyMethodName  = NULL;
     pym->isStatic      = -1;
     pym->returnTypeId  = -1;
+    pym->profileRef.profile    = NULL;
+    pym->profileRef.generation = 0;
+    JEP_LIVE(JEP_LIVE_PYJMETHODS, 1);
 
     // ------------------------------ get method name
     
@@ -258,7 +264,7 @@ int pyjmethod_init(JNIEnv *env, PyJmethod_Object *self) {
     if(process_java_exception(env) || !paramArray)
         goto EXIT_ERROR;
     
-    self->parameters    = (*env)->NewGlobalRef(env, paramArray);
+    self->parameters    = pyembed_new_global_ref(env, JEP_REF_PYJMETHOD, paramArray);
     self->lenParameters = (*env)->GetArrayLength(env, paramArray);
     
     // ------------------------------ get isStatic
@@ -323,11 +329,10 @@ static void pyjmethod_dealloc(PyJmethod_Object *self) {
 #if USE_DEALLOC
     JNIEnv *env  = pyembed_get_env();
     if(env) {
-        if(self->parameters)
-            (*env)->DeleteGlobalRef(env, self->parameters);
-        if(self->rmethod)
-            (*env)->DeleteGlobalRef(env, self->rmethod);
+        pyembed_delete_global_ref(env, JEP_REF_PYJMETHOD, self->parameters);
+        pyembed_delete_global_ref(env, JEP_REF_PYJMETHOD, self->rmethod);
     }
+    JEP_LIVE(JEP_LIVE_PYJMETHODS, -1);
 
     Py_CLEAR(self->pyMethodName);
     
@@ -354,12 +359,15 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                                   PyJobject_Object *instance,
                                   PyObject *args) {
     PyObject      *result     = NULL;
-    const char    *str        = NULL;
     JNIEnv        *env        = NULL;
     int            pos        = 0;
     jvalue        *jargs      = NULL;
     int            foundArray = 0;   /* if params includes pyjarray instance */
     PyThreadState *_save;
+    JepCallProfile *profile   = NULL;
+    jeplong        callStart  = 0;
+    jeplong        argsDone   = 0;
+    jeplong        javaDone   = 0;
     
     env = pyembed_get_env();
     
@@ -386,6 +394,16 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
         return NULL;
     }
 
+    JEP_STAT(JEP_STAT_JAVA_CALLS, 1);
+    if(pyembedProfileEnabled) {
+        profile = pyembed_profile_get(env,
+                                      &self->profileRef,
+                                      instance->clazz,
+                                      self->methodId,
+                                      self->isStatic == JNI_TRUE);
+        JEP_PROFILE_MARK(profile, callStart);
+    }
+
     jargs = (jvalue *) PyMem_Malloc(sizeof(jvalue) * self->lenParameters);
     
     // ------------------------------ build jargs off python values
@@ -420,6 +438,8 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
     } // for parameters
 
     
+    JEP_PROFILE_MARK(profile, argsDone);
+
     // ------------------------------ call based off return type
 
     switch(self->returnTypeId) {
@@ -450,12 +470,10 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                     jargs);
         }
         
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         if(!process_java_exception(env) && jstr != NULL) {
-            str    = (*env)->GetStringUTFChars(env, jstr, 0);
-            result = PyString_FromString(str);
-            
-            (*env)->ReleaseStringUTFChars(env, jstr, str);
+            result = jstring_topystring(env, jstr);
             (*env)->DeleteLocalRef(env, jstr);
         }
         
@@ -487,6 +505,7 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                     jargs);
         }
         
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         if(!process_java_exception(env) && obj != NULL)
             result = pyjarray_new(env, obj);
@@ -517,6 +536,7 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                                                 jargs);
         }
         
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         if(!process_java_exception(env) && obj != NULL)
             result = pyjobject_new_class(env, obj);
@@ -547,6 +567,7 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                                                 jargs);
         }
 
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         if(!process_java_exception(env) && obj != NULL) {
             result = pyjobject_new(env, obj);
@@ -578,6 +599,7 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                                              jargs);
         }
         
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         if(!process_java_exception(env))
             result = Py_BuildValue("i", ret);
@@ -608,6 +630,7 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                                               jargs);
         }
         
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         if(!process_java_exception(env))
             result = Py_BuildValue("i", ret);
@@ -639,6 +662,7 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                                               jargs);
         }
         
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         if(!process_java_exception(env)) {
             val[0] = (char) ret;
@@ -671,6 +695,7 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                                                jargs);
         }
         
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         if(!process_java_exception(env))
             result = Py_BuildValue("i", (int) ret);
@@ -701,6 +726,7 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                                                 jargs);
         }
         
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         if(!process_java_exception(env))
             result = PyFloat_FromDouble(ret);
@@ -731,6 +757,7 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                                                jargs);
         }
         
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         if(!process_java_exception(env))
             result = PyFloat_FromDouble((double) ret);
@@ -761,6 +788,7 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                                               jargs);
         }
         
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         if(!process_java_exception(env))
             result = PyLong_FromLongLong(ret);
@@ -791,6 +819,7 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                                                  jargs);
         }
         
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         if(!process_java_exception(env))
             result = Py_BuildValue("i", ret);
@@ -813,6 +842,7 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
                                     self->methodId,
                                     jargs);
 
+        JEP_PROFILE_MARK(profile, javaDone);
         Py_BLOCK_THREADS;
         process_java_exception(env);
         break;
@@ -820,6 +850,13 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
     
     PyMem_Free(jargs);
     (*env)->PopLocalFrame(env, NULL);
+
+    if(profile)
+        pyembed_profile_record(profile,
+                               callStart,
+                               argsDone,
+                               javaDone,
+                               PyErr_Occurred() != NULL);
     
     if(PyErr_Occurred())
         return NULL;
@@ -842,6 +879,8 @@ PyObject* pyjmethod_call_internal(PyJmethod_Object *self,
 EXIT_ERROR:
    PyMem_Free(jargs);
    (*env)->PopLocalFrame(env, NULL);
+   if(profile)
+       pyembed_profile_record(profile, callStart, argsDone, javaDone, 1);
    return NULL;
 }
 
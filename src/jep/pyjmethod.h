@@ -37,6 +37,7 @@
 #ifndef _Included_pyjmethod
 #define _Included_pyjmethod
 
+#include "pyembed.h"
 #include "pyjobject.h"
 #include "pyjclass.h"
 
@@ -55,6 +56,7 @@ typedef struct {
     jobjectArray      parameters;          /* array of jclass parameter types */
     int               lenParameters;       /* length of parameters above */
     int               isStatic;            /* if method is static */
+    JepProfileRef     profileRef;          /* when profiling calls */
 } PyJmethod_Object;
 
 PyJmethod_Object* pyjmethod_new(JNIEnv*,
@@ -68,7 +68,9 @@
 #include "pyjlist.h"
 #include "pyjmap.h"
 
+static PyObject* pyjobject_new_internal(JNIEnv*, jobject, int);
 static int pyjobject_init(JNIEnv *env, PyJobject_Object*);
+static int pyjobject_init_lazy(PyJobject_Object*);
 static void pyjobject_addmethod(PyJobject_Object*, PyObject*);
 static void pyjobject_init_subtypes(void);
 static int  subtypes_initialized = 0;
@@ -129,6 +131,21 @@ static void pyjobject_init_subtypes(void) {
 
 // called internally to make new PyJobject_Object instances
 PyObject* pyjobject_new(JNIEnv *env, jobject obj) {
+    return pyjobject_new_internal(env, obj, 0);
+}
+
+
+/*
+ * Makes a pyjobject that doesn't look up the Java methods and fields until
+ * an attribute is used.  Good for objects that usually aren't touched, like
+ * exceptions that are only caught by type.
+ */
+PyObject* pyjobject_new_lazy(JNIEnv *env, jobject obj) {
+    return pyjobject_new_internal(env, obj, 1);
+}
+
+
+static PyObject* pyjobject_new_internal(JNIEnv *env, jobject obj, int lazy) {
     PyJobject_Object *pyjob;
     jclass            objClz;
     int               jtype;
@@ -192,15 +209,23 @@ PyObject* pyjobject_new(JNIEnv *env, jobject obj) {
     }
 
 
-    pyjob->object      = (*env)->NewGlobalRef(env, obj);
-    pyjob->clazz       = (*env)->NewGlobalRef(env, (*env)->GetObjectClass(env, obj));
-    pyjob->attr        = PyList_New(0);
-    pyjob->methods     = PyList_New(0);
-    pyjob->fields      = PyList_New(0);
-    pyjob->finishAttr  = 0;
+    pyjob->object        = pyembed_new_global_ref(env, JEP_REF_PYJOBJECT, obj);
+    pyjob->clazz         = pyembed_new_global_ref(env, JEP_REF_PYJOBJECT, objClz);
+    pyjob->attr          = PyList_New(0);
+    pyjob->methods       = PyList_New(0);
+    pyjob->fields        = PyList_New(0);
+    pyjob->finishAttr    = 0;
+    pyjob->lazyInit      = lazy;
+    pyjob->javaClassName = NULL;
+    (*env)->DeleteLocalRef(env, objClz);
+
+    JEP_LIVE(JEP_LIVE_PYJOBJECTS, 1);
+    JEP_STAT(JEP_STAT_OBJECTS_CREATED, 1);
 
-    if(pyjobject_init(env, pyjob))
+    if(lazy || pyjobject_init(env, pyjob))
         return (PyObject *) pyjob;
+    if(PyErr_Occurred()) // java exceptions translated by this time
+        pyjobject_dealloc(pyjob);
     return NULL;
 }
 
@@ -223,15 +248,22 @@ PyObject* pyjobject_new_class(JNIEnv *env, jclass clazz) {
     pyjclass           = PyObject_NEW(PyJclass_Object, &PyJclass_Type);
     pyjob              = (PyJobject_Object*) pyjclass;
     pyjob->object      = NULL;
-    pyjob->clazz       = (*env)->NewGlobalRef(env, clazz);
+    pyjob->clazz       = pyembed_new_global_ref(env, JEP_REF_PYJOBJECT, clazz);
     pyjob->attr        = PyList_New(0);
     pyjob->methods     = PyList_New(0);
     pyjob->fields      = PyList_New(0);
     pyjob->finishAttr  = 0;
+    pyjob->lazyInit    = 0;
+    pyjob->javaClassName = NULL;
+
+    JEP_LIVE(JEP_LIVE_PYJOBJECTS, 1);
+    JEP_STAT(JEP_STAT_OBJECTS_CREATED, 1);
 
     if(pyjclass_init(env, (PyObject *) pyjob)) {
         if(pyjobject_init(env, pyjob))
             return (PyObject *) pyjob;
+        if(PyErr_Occurred())
+            Py_TYPE(pyjclass)->tp_dealloc((PyObject *) pyjclass);
     }
     return NULL;
 }
@@ -455,25 +487,34 @@ static int pyjobject_init(JNIEnv *env, PyJobject_Object *pyjob) {
     
 EXIT_ERROR:
     (*env)->PopLocalFrame(env, NULL);
-    
-    if(PyErr_Occurred()) { // java exceptions translated by this time
-        if(pyjob)
-            pyjobject_dealloc(pyjob);
-    }
-
     return 0;
 }
 
 
+// finish a pyjobject from pyjobject_new_lazy. returns 0 on error.
+static int pyjobject_init_lazy(PyJobject_Object *pyjob) {
+    if(!pyjob->lazyInit)
+        return 1;
+
+    pyjob->lazyInit = 0;
+    if(!pyjobject_init(pyembed_get_env(), pyjob)) {
+        if(!PyErr_Occurred())
+            PyErr_SetString(PyExc_RuntimeError,
+                            "Couldn't initialize Java object.");
+        return 0;
+    }
+    return 1;
+}
+
+
 void pyjobject_dealloc(PyJobject_Object *self) {
 #if USE_DEALLOC
     JNIEnv *env = pyembed_get_env();
     if(env) {
-        if(self->object)
-            (*env)->DeleteGlobalRef(env, self->object);
-        if(self->clazz)
-            (*env)->DeleteGlobalRef(env, self->clazz);
+        pyembed_delete_global_ref(env, JEP_REF_PYJOBJECT, self->object);
+        pyembed_delete_global_ref(env, JEP_REF_PYJOBJECT, self->clazz);
     }
+    JEP_LIVE(JEP_LIVE_PYJOBJECTS, -1);
 
     Py_CLEAR(self->attr);
     Py_CLEAR(self->methods);
@@ -683,6 +724,9 @@ EXIT_ERROR:
 PyObject* pyjobject_find_method(PyJobject_Object *self,
                                 PyObject *methodName,
                                 PyObject *args) {
+    if(!pyjobject_init_lazy(self))
+        return NULL;
+
     // util method does this for us
     return find_method(pyembed_get_env(),
                        self,
@@ -721,6 +765,9 @@ static PyObject* pyjobject_richcompare(PyJobject_Object *self,
                                        int opid) {
     JNIEnv *env;
 
+    if(!pyjobject_init_lazy(self))
+        return NULL;
+
     if(PyType_IsSubtype(Py_TYPE(_other), &PyJobject_Type)) {
         PyJobject_Object *other = (PyJobject_Object *) _other;
         jboolean eq;
@@ -872,6 +919,8 @@ PyObject* pyjobject_getattr(PyJobject_Object *obj,
     if(!name) {
         Py_RETURN_NONE;
     }
+    if(!pyjobject_init_lazy(obj))
+        return NULL;
     pyname  = PyString_FromString(name);
     methods = PyString_FromString("__methods__");
     members = PyString_FromString("__members__");
@@ -942,6 +991,8 @@ int pyjobject_setattr(PyJobject_Object *obj,
         PyErr_Format(PyExc_RuntimeError, "Invalid name: NULL.");
         return -1;
     }
+    if(!pyjobject_init_lazy(obj))
+        return -1;
     
     if(!PyList_Check(obj->attr)) {
         PyErr_Format(PyExc_RuntimeError, "Invalid attr list.");
@@ -1055,6 +1106,9 @@ static PyObject* pyjobject_dir(PyObject *o, PyObject* ignore) {
     PyJobject_Object *self = (PyJobject_Object*) o;
     Py_ssize_t size, i, contains;
 
+    if(!pyjobject_init_lazy(self))
+        return NULL;
+
     attrs = PyList_New(0);
     size = PySequence_Size(self->methods);
     for(i = 0; i < size; i++) {
@@ -51,11 +51,14 @@ typedef struct {
     PyObject        *methods;     /* list of method names */
     PyObject        *fields;      /* list of field names */
     int              finishAttr;  /* true if object attributes are finished */
+    int              lazyInit;    /* true if attributes haven't been made,
+                                     see pyjobject_new_lazy */
     PyObject        *javaClassName; /* string of the fully-qualified name of
                                        the object's Java clazz */
 } PyJobject_Object;
 
 PyObject* pyjobject_new(JNIEnv*, jobject);
+PyObject* pyjobject_new_lazy(JNIEnv*, jobject);
 PyObject* pyjobject_new_class(JNIEnv*, jclass);
 PyObject* pyjobject_find_method(PyJobject_Object*, PyObject*, PyObject*);
 int pyjobject_check(PyObject *obj);
@@ -95,11 +95,11 @@ public class PyObject {
      */
     public void decref() throws JepException {
         isValid();
-        this.decref(this.obj);
+        this.decref(this.tstate, this.obj);
     }
 
 
-    private native void decref(long ptr) throws JepException;
+    private native void decref(long tstate, long ptr) throws JepException;
 
 
     /**
@@ -109,11 +109,25 @@ public class PyObject {
      */
     public void incref() throws JepException {
         isValid();
-        this.incref(this.obj);
+        this.incref(this.tstate, this.obj);
     }
 
 
-    private native void incref(long ptr) throws JepException;
+    private native void incref(long tstate, long ptr) throws JepException;
+
+
+    /**
+     * Gets the pointer to the Python object.
+     *
+     * <b>Internal use only.</b>
+     *
+     * @return a <code>long</code> value
+     * @exception JepException if an error occurs
+     */
+    public long getPointer() throws JepException {
+        isValid();
+        return this.obj;
+    }
 
 
     /**
@@ -446,4 +460,24 @@ public class PyObject {
     protected native Object getValue(long tstate,
                                      long onModule,
                                      String str) throws JepException;
+
+
+    /**
+     * Binds a variable on this object to a {@link PySlot}, see
+     * {@link Jep#slot(String)}.  For a module the slot sets the module's
+     * global, for any other object it sets the attribute.
+     *
+     * @param name a <code>String</code> value
+     * @return a <code>PySlot</code> value
+     * @exception JepException if an error occurs
+     */
+    public PySlot slot(String name) throws JepException {
+        isValid();
+        return jep.trackSlot(new PySlot(this.tstate,
+                                        slot(this.tstate, this.obj, name),
+                                        this.jep));
+    }
+
+    private native long slot(long tstate, long module, String name)
+        throws JepException;
 }
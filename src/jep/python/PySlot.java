@@ -0,0 +1,186 @@
+package jep.python;
+
+import jep.Jep;
+import jep.JepException;
+
+
+/**
+ * <pre>
+ * PySlot.java - a Python variable bound once and set repeatedly
+ *
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ *
+ * </pre>
+ *
+ * <p>
+ * A PySlot holds an interned Python name and the namespace it belongs to so
+ * a variable can be set or read many times without converting the name each
+ * time. Slots are created by {@link Jep#slot(String)} for the
+ * sub-interpreter's globals or {@link PyObject#slot(String)} for a module or
+ * object, and are closed with the Jep that created them.
+ * </p>
+ *
+ * <pre>
+ * <code>
+ * PySlot x = jep.slot("x");
+ * for (int i = 0; i &lt; 1000; i++) {
+ *     x.setInt(i);
+ *     jep.invoke("f");
+ * }
+ * </code>
+ * </pre>
+ *
+ * @version $Id$
+ */
+public class PySlot {
+
+    private final Jep jep;
+
+    private final long tstate;
+
+    // the python tuple of (name, namespace)
+    private long slot;
+
+    /**
+     * Make a new PySlot.
+     *
+     * <b>Internal use only.</b>
+     *
+     * @param tstate a <code>long</code> value
+     * @param slot the pointer returned by the native slot method
+     * @param jep the Jep that owns the slot
+     * @exception JepException if an error occurs
+     */
+    public PySlot(long tstate, long slot, Jep jep) throws JepException {
+        this.tstate = tstate;
+        this.slot   = slot;
+        this.jep    = jep;
+
+        if(slot == 0)
+            throw new JepException("Unable to create slot, NULL.");
+    }
+
+
+    /**
+     * Check if the PySlot is valid
+     *
+     * @throws JepException if the slot was closed or used from another thread
+     */
+    public void isValid() throws JepException {
+        if(slot == 0)
+            throw new JepException("Slot: Invalid pointer.");
+        jep.isValidThread();
+    }
+
+
+    /**
+     * Sets the variable to a Python int.
+     *
+     * @param v an <code>int</code> value
+     * @exception JepException if an error occurs
+     */
+    public void setInt(int v) throws JepException {
+        isValid();
+        setInt(this.tstate, this.slot, v);
+    }
+
+    private native void setInt(long tstate, long slot, int v)
+        throws JepException;
+
+
+    /**
+     * Sets the variable to a Python int.
+     *
+     * @param v a <code>long</code> value
+     * @exception JepException if an error occurs
+     */
+    public void setLong(long v) throws JepException {
+        isValid();
+        setLong(this.tstate, this.slot, v);
+    }
+
+    private native void setLong(long tstate, long slot, long v)
+        throws JepException;
+
+
+    /**
+     * Sets the variable to a Python float.
+     *
+     * @param v a <code>double</code> value
+     * @exception JepException if an error occurs
+     */
+    public void setDouble(double v) throws JepException {
+        isValid();
+        setDouble(this.tstate, this.slot, v);
+    }
+
+    private native void setDouble(long tstate, long slot, double v)
+        throws JepException;
+
+
+    /**
+     * Sets the variable to a Java Object, converted the same as
+     * {@link Jep#set(String, Object)}.
+     *
+     * @param v an <code>Object</code> value
+     * @exception JepException if an error occurs
+     */
+    public void setObject(Object v) throws JepException {
+        isValid();
+        setObject(this.tstate, this.slot, v);
+    }
+
+    private native void setObject(long tstate, long slot, Object v)
+        throws JepException;
+
+
+    /**
+     * Gets the variable's value, converted the same as
+     * {@link Jep#getValue(String)}.
+     *
+     * @return an <code>Object</code> value
+     * @exception JepException if an error occurs or the variable isn't set
+     */
+    public Object get() throws JepException {
+        isValid();
+        return get(this.tstate, this.slot);
+    }
+
+    private native Object get(long tstate, long slot) throws JepException;
+
+
+    /**
+     * Releases the slot.  The variable itself is left alone.
+     */
+    public void close() {
+        if(this.slot == 0)
+            return;
+
+        release(this.tstate, this.slot);
+        this.slot = 0;
+        this.jep.untrackSlot(this);
+    }
+
+    private native void release(long tstate, long slot);
+}
@@ -33,34 +33,52 @@
 /*
  * Class:     jep_python_PyObject
  * Method:    decref
- * Signature: (J)V
+ * Signature: (JJ)V
  */
 JNIEXPORT void JNICALL Java_jep_python_PyObject_decref
-(JNIEnv *env, jobject jobj, jlong ptr) {
-    PyObject *o = (PyObject *) (intptr_t) jobj;
+(JNIEnv *env, jobject jobj, jlong tstate, jlong ptr) {
+    JepThread *jepThread = (JepThread *) (intptr_t) tstate;
+    PyObject  *o         = (PyObject *) (intptr_t) ptr;
+    int        hasGIL;
 
-    if(ptr == 0) {
+    if(ptr == 0 || !jepThread) {
         THROW_JEP(env, "jep_object: Invalid object");
+        return;
     }
-    else
-        Py_DECREF(o);
+
+    // already held when java is called back from python, don't deadlock
+    hasGIL = CURRENT_TSTATE() == jepThread->tstate;
+    if(!hasGIL)
+        pyembed_acquire_thread(jepThread);
+    Py_DECREF(o);
+    if(!hasGIL)
+        pyembed_release_thread(jepThread);
 }
 
 
 /*
  * Class:     jep_python_PyObject
  * Method:    incref
- * Signature: (J)V
+ * Signature: (JJ)V
  */
 JNIEXPORT void JNICALL Java_jep_python_PyObject_incref
-(JNIEnv *env, jobject jobj, jlong ptr) {
-    PyObject *o = (PyObject *) (intptr_t) jobj;
+(JNIEnv *env, jobject jobj, jlong tstate, jlong ptr) {
+    JepThread *jepThread = (JepThread *) (intptr_t) tstate;
+    PyObject  *o         = (PyObject *) (intptr_t) ptr;
+    int        hasGIL;
 
-    if(ptr == 0) {
+    if(ptr == 0 || !jepThread) {
         THROW_JEP(env, "jep_object: Invalid object");
+        return;
     }
-    else
-        Py_INCREF(o);
+
+    // already held when java is called back from python, don't deadlock
+    hasGIL = CURRENT_TSTATE() == jepThread->tstate;
+    if(!hasGIL)
+        pyembed_acquire_thread(jepThread);
+    Py_INCREF(o);
+    if(!hasGIL)
+        pyembed_release_thread(jepThread);
 }
 
 
@@ -304,3 +322,20 @@ JNIEXPORT jobject JNICALL Java_jep_python_PyObject_getValue
     release_utf_char(env, jstr, str);
     return ret;
 }
+
+
+/*
+ * Class:     jep_python_PyObject
+ * Method:    slot
+ * Signature: (JJLjava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_jep_python_PyObject_slot
+(JNIEnv *env, jobject obj, jlong tstate, jlong module, jstring jname) {
+    const char *name;
+    jlong ret;
+
+    name = jstring2char(env, jname);
+    ret  = pyembed_slot_new(env, (intptr_t) tstate, (intptr_t) module, name);
+    release_utf_char(env, jname, name);
+    return ret;
+}
@@ -0,0 +1,97 @@
+/* -*- Mode: C; indent-tabs-mode: nil; c-basic-offset: 4 c-style: "K&R" -*- */
+/* 
+   jep - Java Embedded Python
+
+   Copyright (c) 2015 JEP AUTHORS.
+
+   This file is licenced under the the zlib/libpng License.
+
+   This software is provided 'as-is', without any express or implied
+   warranty. In no event will the authors be held liable for any
+   damages arising from the use of this software.
+   
+   Permission is granted to anyone to use this software for any
+   purpose, including commercial applications, and to alter it and
+   redistribute it freely, subject to the following restrictions:
+
+   1. The origin of this software must not be misrepresented; you
+   must not claim that you wrote the original software. If you use
+   this software in a product, an acknowledgment in the product
+   documentation would be appreciated but is not required.
+
+   2. Altered source versions must be plainly marked as such, and
+   must not be misrepresented as being the original software.
+
+   3. This notice may not be removed or altered from any source
+   distribution.   
+*/
+
+#include "util.h"
+#include "pyembed.h"
+
+
+
+/*
+ * Class:     jep_python_PySlot
+ * Method:    setInt
+ * Signature: (JJI)V
+ */
+JNIEXPORT void JNICALL Java_jep_python_PySlot_setInt
+(JNIEnv *env, jobject obj, jlong tstate, jlong slot, jint jval) {
+    pyembed_slot_set_int(env, (intptr_t) tstate, (intptr_t) slot, (int) jval);
+}
+
+
+/*
+ * Class:     jep_python_PySlot
+ * Method:    setLong
+ * Signature: (JJJ)V
+ */
+JNIEXPORT void JNICALL Java_jep_python_PySlot_setLong
+(JNIEnv *env, jobject obj, jlong tstate, jlong slot, jlong jval) {
+    pyembed_slot_set_long(env, (intptr_t) tstate, (intptr_t) slot, (jeplong) jval);
+}
+
+
+/*
+ * Class:     jep_python_PySlot
+ * Method:    setDouble
+ * Signature: (JJD)V
+ */
+JNIEXPORT void JNICALL Java_jep_python_PySlot_setDouble
+(JNIEnv *env, jobject obj, jlong tstate, jlong slot, jdouble jval) {
+    pyembed_slot_set_double(env, (intptr_t) tstate, (intptr_t) slot, (double) jval);
+}
+
+
+/*
+ * Class:     jep_python_PySlot
+ * Method:    setObject
+ * Signature: (JJLjava/lang/Object;)V
+ */
+JNIEXPORT void JNICALL Java_jep_python_PySlot_setObject
+(JNIEnv *env, jobject obj, jlong tstate, jlong slot, jobject jval) {
+    pyembed_slot_set_object(env, (intptr_t) tstate, (intptr_t) slot, jval);
+}
+
+
+/*
+ * Class:     jep_python_PySlot
+ * Method:    get
+ * Signature: (JJ)Ljava/lang/Object;
+ */
+JNIEXPORT jobject JNICALL Java_jep_python_PySlot_get
+(JNIEnv *env, jobject obj, jlong tstate, jlong slot) {
+    return pyembed_slot_get(env, (intptr_t) tstate, (intptr_t) slot);
+}
+
+
+/*
+ * Class:     jep_python_PySlot
+ * Method:    release
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_jep_python_PySlot_release
+(JNIEnv *env, jobject obj, jlong tstate, jlong slot) {
+    pyembed_slot_release(env, (intptr_t) tstate, (intptr_t) slot);
+}
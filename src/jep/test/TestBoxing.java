@@ -1,5 +1,6 @@
 package jep.test;
 
+import java.nio.ByteBuffer;
 import java.util.List;
 import java.util.Map;
 
@@ -33,7 +34,10 @@ public class TestBoxing {
                 testList(jep);
                 testTuple(jep);
                 testDictionary(jep);
+                testPrimitives(jep);
+                testTypedValues(jep);
             }
+            testLargeList(jep);
         } catch (JepException e) {
             e.printStackTrace();
         } finally {
@@ -92,4 +96,86 @@ public class TestBoxing {
         jep.eval("del x");
         jep.eval("del y");
     }
+
+    public static void testPrimitives(Jep jep) throws Exception {
+        jep.eval("x = 1 << 40");
+        assert jep.getLong("x") == 1L << 40;
+        jep.eval("x = 2.5");
+        assert jep.getDouble("x") == 2.5;
+        assert jep.getDouble("3") == 3.0;
+        assert jep.getBoolean("x > 2");
+        try {
+            jep.getLong("x");
+            assert false;
+        } catch (JepException e) {
+            // floats shouldn't be truncated
+        }
+        try {
+            jep.getBoolean("None");
+            assert false;
+        } catch (JepException e) {
+            // good to reach this
+        }
+        jep.eval("del x");
+    }
+
+    @SuppressWarnings("unchecked")
+    public static void testLargeList(Jep jep) throws Exception {
+        // more items than the default local reference capacity
+        jep.eval("x = [str(i) for i in range(100000)]");
+        jep.eval("y = {str(i): None for i in range(100000)}");
+        List<String> x = (List<String>) jep.getValue("x");
+        assert x.size() == 100000;
+        assert x.get(99999).equals("99999");
+        Map<String, Object> y = (Map<String, Object>) jep.getValue("y");
+        assert y.size() == 100000;
+        assert y.containsKey("99999");
+        assert y.get("99999") == null;
+        jep.eval("del x");
+        jep.eval("del y");
+    }
+
+    public static void testTypedValues(Jep jep) throws Exception {
+        jep.eval("x = [1, 2, 3]");
+        long[] l = jep.getValue("x", long[].class);
+        assert l.length == 3 && l[2] == 3L;
+        double[] d = jep.getValue("x", double[].class);
+        assert d[1] == 2.0;
+        Integer i = jep.getValue("x[0]", Integer.class);
+        assert i == 1;
+        Float f = jep.getValue("1.5", Float.class);
+        assert f == 1.5f;
+        assert jep.getValue("2", float.class) == 2.0f;
+        Short sh = jep.getValue("-300", Short.class);
+        assert sh == -300;
+        Byte by = jep.getValue("x[1]", byte.class);
+        assert by == 2;
+        Character c = jep.getValue("'z'", Character.class);
+        assert c == 'z';
+        assert jep.getValue("65", char.class) == 'A';
+        try {
+            jep.getValue("300", Byte.class);
+            assert false;
+        } catch (JepException e) {
+            // out of range
+        }
+        String[] s = jep.getValue("['a', 'b']", String[].class);
+        assert s[1].equals("b");
+        ByteBuffer b = jep.getValue("b'abc'", ByteBuffer.class);
+        assert b.remaining() == 3 && b.get(0) == 'a';
+        assert jep.getValue("None", String.class) == null;
+        try {
+            jep.getValue("x", String.class);
+            assert false;
+        } catch (JepException e) {
+            // no fallback to str()
+        }
+        try {
+            jep.getValue("[1.5]", long[].class);
+            assert false;
+        } catch (JepException e) {
+            // floats shouldn't be truncated
+        }
+        jep.eval("del x");
+    }
 }
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.test;
+
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+
+/**
+ * Checks Jep.setAll(Map) and Jep.getValues(String...) convert values the same
+ * as set and getValue, including more names than fit the name cache.
+ * 
+ * @version $Id$
+ */
+public class TestBulkValues {
+
+    /**
+     * @param args
+     *            unused
+     * @throws JepException
+     */
+    public static void main(String[] args) throws JepException {
+        Jep jep = new Jep(new JepConfig());
+        try {
+            Map<String, Object> values = new LinkedHashMap<String, Object>();
+            String[] names = new String[100];
+            for (int i = 0; i < names.length; i++) {
+                names[i] = "v" + i;
+                values.put(names[i], Double.valueOf(i));
+            }
+            values.put("s", "abc");
+            values.put("n", null);
+            values.put("f", 1.5f);
+            values.put("sh", (short) 7);
+            values.put("b", (byte) -3);
+
+            jep.setAll(values);
+            Object[] result = jep.getValues("v1", "s", "n", "f", "v1 + 1");
+            assert result[0].equals(1.0);
+            assert result[1].equals("abc");
+            assert result[2] == null;
+            assert result[3].equals(1.5);
+            assert result[4].equals(2.0);
+
+            // Short and Byte become Python ints
+            result = jep.getValues("type(sh).__name__", "sh",
+                    "type(b).__name__", "b");
+            assert result[0].equals("int") : result[0];
+            assert ((Number) result[1]).intValue() == 7;
+            assert result[2].equals("int") : result[2];
+            assert ((Number) result[3]).intValue() == -3;
+
+            // twice through the name cache, repeats included
+            for (int pass = 0; pass < 2; pass++) {
+                result = jep.getValues(names);
+                for (int i = 0; i < names.length; i++)
+                    assert result[i].equals(Double.valueOf(i)) : names[i];
+            }
+            result = jep.getValues("v5", "v5");
+            assert result[0].equals(5.0) && result[1].equals(5.0);
+
+            // new values for the same names replace the old
+            values.put("v5", "five");
+            jep.setAll(values);
+            assert jep.getValues("v5")[0].equals("five");
+
+            try {
+                jep.getValues("v1", "undefined_name");
+                assert false;
+            } catch (JepException e) {
+                // good to reach this
+            }
+        } finally {
+            jep.close();
+        }
+    }
+}
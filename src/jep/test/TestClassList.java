@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.test;
+
+import java.util.Arrays;
+import java.util.List;
+
+import jep.ClassList;
+import jep.JepException;
+
+/**
+ * Checks the packages ClassList finds in its sorted index: a package's own
+ * classes without those of its subpackages, packages that only hold
+ * subpackages, and packages from jars on the classpath.
+ * 
+ * @version $Id$
+ */
+public class TestClassList {
+
+    /**
+     * @param args
+     *            unused
+     * @throws JepException
+     */
+    public static void main(String[] args) throws JepException {
+        ClassList list = ClassList.getInstance();
+        assert list == ClassList.getInstance();
+
+        assert list.contains("java.util");
+        List<String> util = Arrays.asList(list.getClassNames("java.util"));
+        assert util.contains("java.util.ArrayList");
+        assert !util.contains("java.util.concurrent.ConcurrentHashMap");
+        for (String name : util)
+            assert name.indexOf('.', "java.util.".length()) < 0 : name;
+        assert list.contains("java.util.concurrent");
+
+        // only subpackages, but still importable
+        assert list.contains("java");
+        assert list.getClassNames("java").length == 0;
+
+        // from the test jar on the classpath
+        assert Arrays.asList(list.getClassNames("jep.test")).contains(
+                "jep.test.TestClassList");
+
+        assert !list.contains("jep.test.nosuchpackage");
+        assert list.getClassNames("jep.test.nosuchpackage") == null;
+        assert !list.contains("java.util.Arr");
+
+        // callers get a copy of the cached names
+        list.getClassNames("java.util")[0] = null;
+        assert list.getClassNames("java.util")[0] != null;
+    }
+}
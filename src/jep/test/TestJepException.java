@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.test;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+
+/**
+ * Checks a JepException for a Python error builds its message and stack
+ * trace when first asked on the Jep's thread or when the Jep closes, and
+ * that Python still catches Java exceptions by type.
+ * 
+ * @version $Id$
+ */
+public class TestJepException {
+
+    /**
+     * @param args
+     *            unused
+     * @throws Exception
+     */
+    public static void main(String[] args) throws Exception {
+        JepException unread = null;
+        Jep jep = new Jep(new JepConfig());
+        try {
+            jep.eval("from java.lang import Integer");
+            jep.eval("def caught():\n" //
+                    + "    try:\n" //
+                    + "        Integer.parseInt('x')\n" //
+                    + "    except ValueError as e:\n" //
+                    + "        return len(e.args[0].getStackTrace()) > 0\n");
+            assert jep.invoke("caught").equals(true);
+
+            jep.eval("def fail():\n" //
+                    + "    raise ValueError('expected')\n");
+            final JepException e = invokeFail(jep);
+
+            // elsewhere only the type is known, and the details are kept
+            final String[] other = new String[1];
+            Thread t = new Thread() {
+                @Override
+                public void run() {
+                    other[0] = e.getMessage();
+                }
+            };
+            t.start();
+            t.join();
+            assert other[0].contains("ValueError") : other[0];
+            assert !other[0].contains("expected") : other[0];
+
+            assert e.getMessage().contains("ValueError") : e.getMessage();
+            assert e.getMessage().contains("expected") : e.getMessage();
+            boolean found = false;
+            for (StackTraceElement element : e.getStackTrace())
+                found |= "fail".equals(element.getMethodName());
+            assert found;
+
+            unread = invokeFail(jep);
+        } finally {
+            jep.close();
+        }
+
+        // described by close
+        assert unread.getMessage().contains("expected") : unread.getMessage();
+    }
+
+    private static JepException invokeFail(Jep jep) {
+        try {
+            jep.invoke("fail");
+        } catch (JepException e) {
+            return e;
+        }
+        throw new AssertionError("fail() didn't throw");
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.test;
+
+import java.io.PrintWriter;
+import java.io.StringWriter;
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+
+/**
+ * Runs the main method of a test class on a new thread, where the test can
+ * create and close its own Jeps, and keeps any failure for
+ * tests/test_java_api.py to report. Assertions are enabled for the test
+ * class, so it must not have been loaded before.
+ * 
+ * @version $Id$
+ */
+public class TestRunner extends Thread {
+
+    private final String className;
+
+    private volatile Throwable failure = null;
+
+    /**
+     * @param className
+     *            the name of a class with a main method
+     */
+    public TestRunner(String className) {
+        super(className);
+        this.className = className;
+    }
+
+    @Override
+    public void run() {
+        try {
+            ClassLoader cl = TestRunner.class.getClassLoader();
+            cl.setClassAssertionStatus(className, true);
+            Class<?> test = Class.forName(className, true, cl);
+            Method main = test.getMethod("main", String[].class);
+            main.invoke(null, (Object) new String[0]);
+        } catch (InvocationTargetException e) {
+            failure = e.getCause();
+        } catch (Throwable t) {
+            failure = t;
+        }
+    }
+
+    /**
+     * @return the stack trace of the test's failure, or null if it passed or
+     *         hasn't finished
+     */
+    public String getFailure() {
+        if (failure == null)
+            return null;
+        StringWriter out = new StringWriter();
+        failure.printStackTrace(new PrintWriter(out));
+        return out.toString();
+    }
+}
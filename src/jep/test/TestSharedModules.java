@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.test;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+
+/**
+ * Checks a module shared through JepConfig is one module object for every
+ * Jep that shares it, and that Jep.reset() keeps imported modules.
+ * 
+ * @version $Id$
+ */
+public class TestSharedModules {
+
+    /**
+     * @param args
+     *            unused
+     * @throws JepException
+     */
+    public static void main(String[] args) throws JepException {
+        JepConfig shared = new JepConfig().addSharedModules("json");
+
+        Jep jep = new Jep(shared);
+        try {
+            jep.eval("import json");
+            jep.eval("json.jep_test_shared = 42");
+        } finally {
+            jep.close();
+        }
+
+        // the module lives in the top interpreter, past the first Jep
+        jep = new Jep(shared);
+        try {
+            jep.eval("import json");
+            Number n = (Number) jep.getValue("json.jep_test_shared");
+            assert n.intValue() == 42;
+        } finally {
+            jep.close();
+        }
+
+        jep = new Jep(new JepConfig());
+        try {
+            jep.eval("import json");
+            assert jep.getValue("hasattr(json, 'jep_test_shared')").equals(
+                    false);
+
+            jep.snapshot();
+            jep.eval("x = 1");
+            jep.eval("import decimal");
+            jep.reset();
+            assert jep.getValue("'x' in globals()").equals(false);
+            assert jep.getValue("'json' in globals()").equals(true);
+            assert jep.getValue("'decimal' in __import__('sys').modules")
+                    .equals(true);
+
+            jep.reset(true);
+            assert jep.getValue("'decimal' in __import__('sys').modules")
+                    .equals(false);
+        } finally {
+            jep.close();
+        }
+
+        jep = new Jep(shared);
+        try {
+            jep.eval("import json");
+            jep.eval("del json.jep_test_shared");
+        } finally {
+            jep.close();
+        }
+    }
+}
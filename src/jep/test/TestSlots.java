@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.test;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+import jep.python.PyModule;
+import jep.python.PySlot;
+
+/**
+ * Checks PySlot on the globals and on a module, and that a slot can't be
+ * used once it or its Jep is closed.
+ * 
+ * @version $Id$
+ */
+public class TestSlots {
+
+    /**
+     * @param args
+     *            unused
+     * @throws JepException
+     */
+    public static void main(String[] args) throws JepException {
+        PySlot x;
+        Jep jep = new Jep(new JepConfig());
+        try {
+            jep.eval("def f():\n" //
+                    + "    return x + 1\n");
+
+            x = jep.slot("x");
+            x.setInt(41);
+            assert ((Number) jep.invoke("f")).intValue() == 42;
+            x.setDouble(0.5);
+            assert jep.invoke("f").equals(1.5);
+            x.setObject("abc");
+            assert x.get().equals("abc");
+            x.setObject(null);
+            assert x.get() == null;
+
+            PyModule m = jep.createModule("slotmodule");
+            PySlot y = m.slot("y");
+            y.setLong(1L << 40);
+            assert m.getValue("y").equals(1L << 40);
+
+            PySlot unset = jep.slot("not_set");
+            assertThrows(unset);
+
+            // closing a slot leaves the variable alone
+            PySlot z = jep.slot("z");
+            z.setInt(7);
+            z.close();
+            assertThrows(z);
+            z.close();
+            assert ((Number) jep.getValue("z")).intValue() == 7;
+        } finally {
+            jep.close();
+        }
+        assertThrows(x);
+    }
+
+    private static void assertThrows(PySlot slot) {
+        try {
+            slot.get();
+        } catch (JepException e) {
+            return;
+        }
+        throw new AssertionError("get() didn't throw");
+    }
+}
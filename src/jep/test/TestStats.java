@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.test;
+
+import java.lang.management.ManagementFactory;
+import java.util.Arrays;
+
+import javax.management.MBeanServer;
+import javax.management.ObjectName;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+import jep.JepStats;
+
+/**
+ * Checks the runtime counters of a Jep only count while enabled, match
+ * jep.stats() in Python, are registered through JMX while the Jep is open
+ * and keep their final values after it closes.
+ * 
+ * @version $Id$
+ */
+public class TestStats {
+
+    /**
+     * @param args
+     *            unused
+     * @throws Exception
+     */
+    public static void main(String[] args) throws Exception {
+        MBeanServer server = ManagementFactory.getPlatformMBeanServer();
+        ObjectName pattern = new ObjectName("jep:type=JepStats,*");
+        int registered = server.queryNames(pattern, null).size();
+
+        JepStats stats;
+        long[] last;
+        Jep jep = new Jep(new JepConfig());
+        try {
+            assert jep.getStats() == null;
+            jep.eval("from java.lang import Integer");
+            jep.eval("def f(n):\n" //
+                    + "    for i in range(n):\n" //
+                    + "        Integer.valueOf(i)\n");
+
+            jep.setStatsEnabled(true);
+            stats = jep.getStats();
+            assert stats.isEnabled();
+            assert server.queryNames(pattern, null).size() == registered + 1;
+
+            jep.invoke("f", 10);
+            assert stats.getJavaCalls() >= 10;
+            assert stats.getGilAcquires() >= 1;
+
+            try {
+                jep.eval("raise ValueError()");
+                assert false;
+            } catch (JepException e) {
+                // good to reach this
+            }
+            assert stats.getPythonExceptions() >= 1;
+
+            jep.eval("import jep");
+            jep.eval("s = jep.stats()");
+            assert jep.getValue("s['enabled']").equals(Boolean.TRUE);
+            Number calls = (Number) jep.getValue("s['java_calls']");
+            assert calls.longValue() >= 10;
+            // the counters and 'enabled'
+            assert ((Number) jep.getValue("len(s)")).intValue() == stats
+                    .toArray().length + 1;
+            assert jep.getValue("'global_refs' in s").equals(Boolean.FALSE);
+
+            jep.setStatsEnabled(false);
+            last = stats.toArray();
+            jep.invoke("f", 10);
+            assert Arrays.equals(stats.toArray(), last);
+            assert stats.getJavaCalls() == last[0];
+        } finally {
+            jep.close();
+        }
+
+        // nothing counts while disabled, so closing changes nothing
+        assert server.queryNames(pattern, null).size() == registered;
+        assert Arrays.equals(stats.toArray(), last);
+    }
+}
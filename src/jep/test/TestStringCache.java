@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.test;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepException;
+
+/**
+ * Checks the string cache of a Jep shares the Python strings of repeated
+ * short Java Strings, leaves long Strings alone and counts its hits and
+ * misses.
+ * 
+ * @version $Id$
+ */
+public class TestStringCache {
+
+    /**
+     * @param args
+     *            unused
+     * @throws JepException
+     */
+    public static void main(String[] args) throws JepException {
+        Jep jep = new Jep(new JepConfig());
+        try {
+            jep.eval("from java.lang import String");
+            jep.eval("from java.util import HashMap");
+            jep.eval("s = String('customer_id')");
+
+            // separate strs without the cache
+            jep.eval("same = s.toString() is s.toString()");
+            assert jep.getValue("same").equals(Boolean.FALSE);
+            assert jep.getStringCacheHits() == 0;
+
+            jep.setStringCacheSize(1000);
+            jep.eval("same = s.toString() is s.toString()");
+            assert jep.getValue("same").equals(Boolean.TRUE);
+            assert jep.getStringCacheMisses() >= 1;
+            assert jep.getStringCacheHits() >= 1;
+
+            // map keys converted twice are the same strs
+            jep.eval("m = HashMap()");
+            jep.eval("for i in range(100):\n" //
+                    + "    m.put('column_%d' % i, i)\n");
+            jep.eval("first = [k for k in m]");
+            jep.eval("same = all(a is b for a, b in zip(first, m))");
+            assert jep.getValue("same").equals(Boolean.TRUE);
+
+            // long strings aren't cached
+            long hits = jep.getStringCacheHits();
+            jep.eval("t = String('x' * 100)");
+            jep.eval("same = t.toString() is t.toString()");
+            assert jep.getValue("same").equals(Boolean.FALSE);
+            assert jep.getStringCacheHits() == hits;
+
+            jep.eval("import jep");
+            jep.eval("c = jep.stringCacheStats()");
+            assert ((Number) jep.getValue("c['size']")).longValue() == 1024;
+            assert ((Number) jep.getValue("c['hit_rate']")).doubleValue() > 0;
+
+            jep.setStringCacheSize(0);
+            assert jep.getStringCacheHits() == 0;
+            jep.eval("same = s.toString() is s.toString()");
+            assert jep.getValue("same").equals(Boolean.FALSE);
+        } finally {
+            jep.close();
+        }
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2015 JEP AUTHORS.
+ *
+ * This file is licenced under the the zlib/libpng License.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any
+ * damages arising from the use of this software.
+ * 
+ * Permission is granted to anyone to use this software for any
+ * purpose, including commercial applications, and to alter it and
+ * redistribute it freely, subject to the following restrictions:
+ * 
+ *     1. The origin of this software must not be misrepresented; you
+ *     must not claim that you wrote the original software. If you use
+ *     this software in a product, an acknowledgment in the product
+ *     documentation would be appreciated but is not required.
+ * 
+ *     2. Altered source versions must be plainly marked as such, and
+ *     must not be misrepresented as being the original software.
+ * 
+ *     3. This notice may not be removed or altered from any source
+ *     distribution.
+ */
+package jep.test;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import jep.Jep;
+import jep.JepConfig;
+import jep.JepStats;
+
+/**
+ * Checks several threads each owning a Jep can run Python, call Java and
+ * block in Java at the same time, each counting its own GIL acquires, and
+ * that closing them leaves no global references behind.
+ * 
+ * @version $Id$
+ */
+public class TestThreads {
+
+    private static final int THREADS = 4;
+
+    private static final int CALLS = 200;
+
+    /**
+     * A thread with its own Jep calling each kind of work in turn.
+     */
+    static class Worker extends Thread {
+
+        long gilAcquires = 0;
+
+        Throwable error = null;
+
+        @Override
+        public void run() {
+            Jep jep = null;
+            try {
+                jep = new Jep(new JepConfig());
+                jep.eval("from java.lang import StringBuilder, Thread");
+                jep.eval("def work(i):\n" //
+                        + "    if i % 3 == 0:\n" //
+                        + "        return sum(j * j for j in range(2000))\n" //
+                        + "    if i % 3 == 1:\n" //
+                        + "        sb = StringBuilder()\n" //
+                        + "        for j in range(100):\n" //
+                        + "            sb.append(j)\n" //
+                        + "        return sb.length()\n" //
+                        + "    Thread.sleep(1)\n");
+                jep.setStatsEnabled(true);
+                JepStats stats = jep.getStats();
+                for (int i = 0; i < CALLS; i++)
+                    jep.invoke("work", i);
+                gilAcquires = stats.getGilAcquires();
+            } catch (Throwable t) {
+                error = t;
+            } finally {
+                if (jep != null)
+                    jep.close();
+            }
+        }
+    }
+
+    private static void runWorkers() throws Throwable {
+        List<Worker> workers = new ArrayList<Worker>();
+        for (int i = 0; i < THREADS; i++) {
+            Worker w = new Worker();
+            workers.add(w);
+            w.start();
+        }
+        for (Worker w : workers) {
+            w.join();
+            if (w.error != null)
+                throw w.error;
+            assert w.gilAcquires >= CALLS : w.gilAcquires;
+        }
+    }
+
+    /**
+     * @param args
+     *            unused
+     * @throws Throwable
+     */
+    public static void main(String[] args) throws Throwable {
+        // the first round loads whatever is only loaded once per process
+        runWorkers();
+        long refs = Jep.getLiveCounts().getGlobalRefs();
+        runWorkers();
+        assert Jep.getLiveCounts().getGlobalRefs() == refs : Jep
+                .getLiveCounts().getGlobalRefs() + " != " + refs;
+    }
+}
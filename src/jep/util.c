@@ -79,7 +79,6 @@ static void init_numpy(void);
 #endif
 static int  numpyInitialized = 0;
 static PyObject* convert_jprimitivearray_pyndarray(JNIEnv*, jobject, int, npy_intp*);
-static jarray convert_pyndarray_jprimitivearray(JNIEnv*, PyObject*, jclass);
 #endif
 
 static PyObject* match_exception_type(JNIEnv*, jthrowable);
@@ -101,7 +100,6 @@ jclass JCHAR_TYPE    = NULL;
 jclass JBYTE_TYPE    = NULL;
 jclass JCLASS_TYPE   = NULL;
 
-#if USE_NUMPY
 jclass JBOOLEAN_ARRAY_TYPE = NULL;
 jclass JBYTE_ARRAY_TYPE    = NULL;
 jclass JSHORT_ARRAY_TYPE   = NULL;
@@ -109,7 +107,6 @@ jclass JINT_ARRAY_TYPE     = NULL;
 jclass JLONG_ARRAY_TYPE    = NULL;
 jclass JFLOAT_ARRAY_TYPE   = NULL;
 jclass JDOUBLE_ARRAY_TYPE  = NULL;
-#endif
 
 // more cached types
 jclass JLIST_TYPE       = NULL;
@@ -117,6 +114,18 @@ jclass JMAP_TYPE        = NULL;
 jclass JITERABLE_TYPE   = NULL;
 jclass JITERATOR_TYPE   = NULL;
 jclass JCOLLECTION_TYPE = NULL;
+jclass JBOOLEAN_OBJ_TYPE = NULL;
+jclass JINTEGER_OBJ_TYPE = NULL;
+jclass JLONG_OBJ_TYPE    = NULL;
+jclass JDOUBLE_OBJ_TYPE  = NULL;
+jclass JARRAYLIST_TYPE   = NULL;
+jclass JHASHMAP_TYPE     = NULL;
+jclass JCOLLECTIONS_TYPE = NULL;
+jclass JBYTEBUFFER_TYPE  = NULL;
+jclass JSHORT_OBJ_TYPE   = NULL;
+jclass JFLOAT_OBJ_TYPE   = NULL;
+jclass JBYTE_OBJ_TYPE    = NULL;
+jclass JCHAR_OBJ_TYPE    = NULL;
 #if USE_NUMPY
 jclass JEP_NDARRAY_TYPE = NULL;
 #endif
@@ -138,6 +147,8 @@ jmethodID jepExcInitStr = NULL;
 jmethodID jepExcInitStrThrow = NULL;
 jmethodID stackTraceElemInit = NULL;
 jmethodID setStackTrace = NULL;
+jmethodID jepExcInitLazy = NULL;
+jmethodID jepTrackException = NULL;
 
 #if USE_NUMPY
 jmethodID ndarrayInit    = NULL;
@@ -267,10 +278,365 @@ char* pyunicode_to_utf8(PyObject *unicode) {
 
 
 
+/*
+ * Makes the message for a python exception, "type: value".  If the value is
+ * a java exception from process_java_exception, its message is used for the
+ * value.  Returns new reference, NULL on error.
+ */
+static PyObject* pyerr_message(JNIEnv *env, PyObject *ptype, PyObject *pvalue) {
+    PyObject *message, *v = NULL;
+
+    message = PyObject_Str(ptype);
+    if(!message || !pvalue)
+        return message;
+
+    if(pyjobject_check(pvalue)) {
+        // it's a java exception that came from process_java_exception
+        jmethodID getMessage;
+        PyJobject_Object *jexc = (PyJobject_Object*) pvalue;
+        getMessage = (*env)->GetMethodID(env, jexc->clazz,
+                "getLocalizedMessage", "()Ljava/lang/String;");
+        if(getMessage != NULL) {
+            jstring jmessage;
+            jmessage = (*env)->CallObjectMethod(env, jexc->object,
+                    getMessage);
+            if(jmessage != NULL) {
+                const char* charMessage;
+                charMessage = jstring2char(env, jmessage);
+                if(charMessage != NULL) {
+                    v = PyString_FromString(charMessage);
+                    release_utf_char(env, jmessage, charMessage);
+                }
+                (*env)->DeleteLocalRef(env, jmessage);
+            }
+        } else {
+            printf(
+                    "Error getting method getLocalizedMessage() on java exception\n");
+        }
+    }
+
+    if(v == NULL) {
+        // unsure of what we got, treat it as a string
+        v = PyObject_Str(pvalue);
+    }
+
+    if(v != NULL && PyString_Check(v)) {
+        PyObject *t;
+#if PY_MAJOR_VERSION >= 3
+        t = PyUnicode_FromFormat("%U: %U", message, v);
+#else
+        t = PyString_FromFormat("%s: %s", PyString_AsString(message), PyString_AsString(v));
+#endif
+        Py_DECREF(message);
+        message = t;
+    }
+    Py_XDECREF(v);
+    return message;
+}
+
+
+/*
+ * Converts a python traceback to a java.lang.StackTraceElement[] with the
+ * most recent call first, like a java stack trace.  Returns NULL with a
+ * python error set if it fails.
+ */
+static jobjectArray pyerr_stacktrace(JNIEnv *env, PyObject *ptrace) {
+    PyObject *modTB, *extract = NULL, *pystack = NULL;
+    Py_ssize_t stackSize, i, count, index;
+    jobjectArray stackArray, reverse;
+    jclass stackTraceElemClazz;
+
+    modTB = PyImport_ImportModule("traceback");
+    if(modTB == NULL) {
+        printf("Error importing python traceback module\n");
+    }
+    extract = PyString_FromString("extract_tb");
+    if(extract == NULL) {
+        printf("Error making PyString 'extract_tb'\n");
+    }
+    if(modTB != NULL && extract != NULL) {
+        pystack = PyObject_CallMethodObjArgs(modTB, extract, ptrace,
+                NULL);
+    }
+    Py_XDECREF(modTB);
+    Py_XDECREF(extract);
+    if(pystack == NULL)
+        return NULL;
+
+    stackTraceElemClazz = (*env)->FindClass(env,
+            "Ljava/lang/StackTraceElement;");
+    if(stackTraceElemInit == NULL) {
+        stackTraceElemInit =
+                (*env)->GetMethodID(env, stackTraceElemClazz,
+                        "<init>",
+                        "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)V");
+    }
+
+    stackSize = PyList_Size(pystack);
+    stackArray = (*env)->NewObjectArray(env, (jsize) stackSize,
+            stackTraceElemClazz, NULL);
+    if((*env)->ExceptionCheck(env) || !stackArray) {
+        PyErr_Format(PyExc_RuntimeError,
+                "creating java.lang.StackTraceElement[] failed.");
+        Py_DECREF(pystack);
+        return NULL;
+    }
+
+    count = 0;
+    for (i = 0; i < stackSize; i++) {
+        PyObject *stackEntry, *pyLine;
+        char *charPyFile, *charPyFunc = NULL;
+        int pyLineNum;
+
+        stackEntry = PyList_GetItem(pystack, i);
+        // java order is classname, methodname, filename, lineNumber
+        // python order is filename, line number, function name, line
+        charPyFile = PyString_AsString(
+                PySequence_GetItem(stackEntry, 0));
+        pyLineNum = (int) PyInt_AsLong(
+                PySequence_GetItem(stackEntry, 1));
+        charPyFunc = PyString_AsString(
+                PySequence_GetItem(stackEntry, 2));
+        pyLine = PySequence_GetItem(stackEntry, 3);
+
+        /*
+         * if pyLine is None, this seems to imply it was an eval,
+         * making the stack element fairly useless, so we will
+         * skip it
+         */
+        if(pyLine != Py_None) {
+            char *charPyFileNoExt, *lastDot;
+            char *charPyFileNoDir, *lastBackslash;
+            int namelen;
+            jobject element;
+            jstring pyFileNoDir, pyFileNoExt, pyFunc;
+
+            // remove the .py to look more like a Java StackTraceElement
+            namelen = (int) strlen(charPyFile);
+            charPyFileNoExt = malloc(sizeof(char) * (namelen + 1));
+            strcpy(charPyFileNoExt, charPyFile);
+            lastDot = strrchr(charPyFileNoExt, '.');
+            if(lastDot != NULL) {
+                *lastDot = '\0';
+            }
+
+            // remove the dir path to look more like a Java StackTraceElement
+            charPyFileNoDir = malloc(sizeof(char) * (namelen + 1));
+            lastBackslash = strrchr(charPyFile, FILE_SEP);
+            if(lastBackslash != NULL) {
+                strcpy(charPyFileNoDir, lastBackslash + 1);
+            } else {
+                strcpy(charPyFileNoDir, charPyFile);
+            }
+
+            pyFileNoDir = (*env)->NewStringUTF(env,
+                    (const char *) charPyFileNoDir);
+            pyFileNoExt = (*env)->NewStringUTF(env,
+                    (const char *) charPyFileNoExt);
+            pyFunc = (*env)->NewStringUTF(env,
+                    (const char *) charPyFunc);
+
+            /*
+             * Make the stack trace element from python look like a normal
+             * java stack trace element.  The order may seem wrong but
+             * this makes it look best.
+             */
+            element = (*env)->NewObject(env, stackTraceElemClazz,
+                    stackTraceElemInit, pyFileNoExt, pyFunc, pyFileNoDir,
+                    pyLineNum);
+            free(charPyFileNoDir);
+            free(charPyFileNoExt);
+            (*env)->DeleteLocalRef(env, pyFileNoDir);
+            (*env)->DeleteLocalRef(env, pyFileNoExt);
+            (*env)->DeleteLocalRef(env, pyFunc);
+            if((*env)->ExceptionCheck(env) || !element) {
+                PyErr_Format(PyExc_RuntimeError,
+                        "failed to create java.lang.StackTraceElement for python %s:%i.",
+                        charPyFile, pyLineNum);
+                Py_DECREF(pystack);
+                return NULL;
+            }
+            (*env)->SetObjectArrayElement(env, stackArray, (jsize) i,
+                    element);
+            count++;
+            (*env)->DeleteLocalRef(env, element);
+        }
+    } // end of stack for loop
+    Py_DECREF(pystack);
+
+    /*
+     * reverse order of stack and ensure no null elements so it will
+     * appear like a java stacktrace
+     */
+    reverse = (*env)->NewObjectArray(env, (jsize) count,
+            stackTraceElemClazz, NULL);
+    if((*env)->ExceptionCheck(env) || !reverse) {
+        PyErr_Format(PyExc_RuntimeError,
+                "creating reverse java.lang.StackTraceElement[] failed.");
+        return NULL;
+    }
+
+    index = 0;
+    for (i = stackSize - 1; i > -1; i--) {
+        jobject element;
+        element = (*env)->GetObjectArrayElement(env, stackArray, (jsize) i);
+        if(element != NULL) {
+            (*env)->SetObjectArrayElement(env, reverse, (jsize) index,
+                    element);
+            (*env)->DeleteLocalRef(env, element);
+            index++;
+        }
+    }
+    (*env)->DeleteLocalRef(env, stackArray);
+    (*env)->DeleteLocalRef(env, stackTraceElemClazz);
+    return reverse;
+}
+
+
+/*
+ * Makes the message and stack trace for a python exception saved by
+ * process_py_exception, a tuple of (type, value, traceback).  Returns a java
+ * Object[] of { String message, StackTraceElement[] stack }, the stack is
+ * null if there's no traceback.  NULL on error with a python error set.
+ */
+jobjectArray describe_py_exception(JNIEnv *env, PyObject *pyException) {
+    PyObject     *ptype, *pvalue, *ptrace, *message;
+    jobjectArray  result, stack = NULL;
+    jstring       jmsg;
+
+    ptype  = PyTuple_GET_ITEM(pyException, 0);
+    pvalue = PyTuple_GET_ITEM(pyException, 1);
+    ptrace = PyTuple_GET_ITEM(pyException, 2);
+
+    message = pyerr_message(env, ptype, pvalue == Py_None ? NULL : pvalue);
+    if(!message)
+        return NULL;
+
+    if(ptrace != Py_None) {
+        stack = pyerr_stacktrace(env, ptrace);
+        if(!stack) {
+            /*
+             * well this isn't good, we got an error while we're trying
+             * to process errors, let's just print it out
+             */
+            PyErr_Print();
+        }
+    }
+
+    jmsg = (*env)->NewStringUTF(env, PyString_AsString(message));
+    Py_DECREF(message);
+
+    result = (*env)->NewObjectArray(env, 2, JOBJECT_TYPE, NULL);
+    if((*env)->ExceptionCheck(env) || !result) {
+        PyErr_Format(PyExc_RuntimeError, "creating exception details failed.");
+        return NULL;
+    }
+    (*env)->SetObjectArrayElement(env, result, 0, jmsg);
+    (*env)->SetObjectArrayElement(env, result, 1, stack);
+    (*env)->DeleteLocalRef(env, jmsg);
+    if(stack)
+        (*env)->DeleteLocalRef(env, stack);
+    return result;
+}
+
+
+/*
+ * Makes a JepException that holds on to the python exception and only builds
+ * the message and stack trace if they're asked for, see
+ * describe_py_exception.  Steals the references.  Returns NULL on failure,
+ * leaving the references alone.
+ */
+static jobject pyerr_lazy_exception(JNIEnv *env,
+                                    JepThread *jepThread,
+                                    PyObject *ptype,
+                                    PyObject *pvalue,
+                                    PyObject *ptrace) {
+    PyObject    *pyException;
+    jclass       jepExcClazz;
+    jobject      jepException;
+    jobject      cause = NULL;
+    jstring      typeName;
+    jlongArray   released;
+
+    jepExcClazz = (*env)->FindClass(env, JEPEXCEPTION);
+    if(!jepExcClazz)
+        return NULL;
+    if(jepExcInitLazy == NULL) {
+        // constructor JepException(String, Throwable, Jep, long)
+        jepExcInitLazy = (*env)->GetMethodID(env, jepExcClazz, "<init>",
+                "(Ljava/lang/String;Ljava/lang/Throwable;Ljep/Jep;J)V");
+        if(!jepExcInitLazy) {
+            (*env)->ExceptionClear(env);
+            return NULL;
+        }
+    }
+    if(jepTrackException == NULL) {
+        jclass jepClazz = (*env)->GetObjectClass(env, jepThread->caller);
+        jepTrackException = (*env)->GetMethodID(env, jepClazz,
+                "trackException", "(Ljep/JepException;J)[J");
+        (*env)->DeleteLocalRef(env, jepClazz);
+        if(!jepTrackException) {
+            (*env)->ExceptionClear(env);
+            return NULL;
+        }
+    }
+
+    pyException = PyTuple_New(3);
+    if(!pyException) {
+        PyErr_Clear();
+        return NULL;
+    }
+    if(pvalue && pyjobject_check(pvalue))
+        cause = ((PyJobject_Object*) pvalue)->object;
+
+    // used as the message if the details can't be made later
+    typeName = (*env)->NewStringUTF(env, PyExceptionClass_Check(ptype) ?
+            PyExceptionClass_Name(ptype) : "Exception");
+    jepException = (*env)->NewObject(env, jepExcClazz, jepExcInitLazy,
+            typeName, cause, jepThread->caller, (jlong) (intptr_t) pyException);
+    (*env)->DeleteLocalRef(env, typeName);
+    (*env)->DeleteLocalRef(env, jepExcClazz);
+    if((*env)->ExceptionCheck(env) || !jepException) {
+        (*env)->ExceptionClear(env);
+        Py_DECREF(pyException);
+        return NULL;
+    }
+
+    if(!pvalue) {
+        Py_INCREF(Py_None);
+        pvalue = Py_None;
+    }
+    if(!ptrace) {
+        Py_INCREF(Py_None);
+        ptrace = Py_None;
+    }
+    PyTuple_SET_ITEM(pyException, 0, ptype);
+    PyTuple_SET_ITEM(pyException, 1, pvalue);
+    PyTuple_SET_ITEM(pyException, 2, ptrace);
+
+    // the Jep hands back exceptions that were garbage collected
+    released = (jlongArray) (*env)->CallObjectMethod(env, jepThread->caller,
+            jepTrackException, jepException, (jlong) (intptr_t) pyException);
+    if((*env)->ExceptionCheck(env)) {
+        (*env)->ExceptionClear(env);
+    } else if(released) {
+        jsize  i, len = (*env)->GetArrayLength(env, released);
+        jlong *ptrs   = (*env)->GetLongArrayElements(env, released, NULL);
+        for(i = 0; i < len; i++) {
+            PyObject *old = (PyObject*) (intptr_t) ptrs[i];
+            Py_DECREF(old);
+        }
+        (*env)->ReleaseLongArrayElements(env, released, ptrs, JNI_ABORT);
+        (*env)->DeleteLocalRef(env, released);
+    }
+    return jepException;
+}
+
+
 // convert python exception to java.
 int process_py_exception(JNIEnv *env, int printTrace) {
     JepThread *jepThread;
-    PyObject *ptype, *pvalue, *ptrace, *pystack = NULL;
+    PyObject *ptype, *pvalue, *ptrace;
     PyObject *message = NULL;
     char *m = NULL;
     PyJobject_Object *jexc = NULL;
@@ -301,59 +667,34 @@ int process_py_exception(JNIEnv *env, int printTrace) {
     if(!jepThread) {
         printf("Error while processing a Python exception, "
                 "invalid JepThread.\n");
-        if(jepThread->printStack) {
-            PyErr_Print();
-            if(!PyErr_Occurred())
-                return 0;
+    } else
+        JEP_THREAD_STAT(jepThread, JEP_STAT_PYTHON_EXCEPTIONS, 1);
+
+    if(ptype && pvalue && jepThread && jepThread->caller) {
+        /*
+         * Callers often catch and drop the JepException, so don't spend
+         * time on the message and stack trace until they're used.
+         */
+        jepException = pyerr_lazy_exception(env, jepThread, ptype, pvalue,
+                ptrace);
+        if(jepException) {
+            THROW_JEP_EXC(env, jepException);
+            return 1;
         }
     }
 
     if(ptype) {
-        message = PyObject_Str(ptype);
-
         if(pvalue) {
-            PyObject *v = NULL;
-            if(pyjobject_check(pvalue)) {
-                // it's a java exception that came from process_java_exception
-                jmethodID getMessage;
-                jexc = (PyJobject_Object*) pvalue;
-                getMessage = (*env)->GetMethodID(env, jexc->clazz,
-                        "getLocalizedMessage", "()Ljava/lang/String;");
-                if(getMessage != NULL) {
-                    jstring jmessage;
-                    jmessage = (*env)->CallObjectMethod(env, jexc->object,
-                            getMessage);
-                    if(jmessage != NULL) {
-                        const char* charMessage;
-                        charMessage = jstring2char(env, jmessage);
-                        if(charMessage != NULL) {
-                            v = PyString_FromString(charMessage);
-                            release_utf_char(env, jmessage, charMessage);
-                        }
-                    }
-                } else {
-                    printf(
-                            "Error getting method getLocalizedMessage() on java exception\n");
-                }
-            }
-
-            if(v == NULL) {
-                // unsure of what we got, treat it as a string
-                v = PyObject_Str(pvalue);
-            }
+            jobjectArray stack = NULL;
 
-            if(v != NULL && PyString_Check(v)) {
-                PyObject *t;
-#if PY_MAJOR_VERSION >= 3
-                t = PyUnicode_FromFormat("%U: %U", message, v);
-#else
-                t = PyString_FromFormat("%s: %s", PyString_AsString(message), PyString_AsString(v));
-#endif
-                Py_DECREF(v);
-                Py_DECREF(message);
-                message = t;
+            message = pyerr_message(env, ptype, pvalue);
+            if(!message) {
+                PyErr_Clear();
+                message = PyObject_Str(ptype);
             }
             m = PyString_AsString(message);
+            if(pyjobject_check(pvalue))
+                jexc = (PyJobject_Object*) pvalue;
 
             // make a JepException
             jmsg = (*env)->NewStringUTF(env, (const char *) m);
@@ -384,180 +725,28 @@ int process_py_exception(JNIEnv *env, int printTrace) {
             }
 
             if(ptrace) {
-                PyObject *modTB, *extract = NULL;
-                modTB = PyImport_ImportModule("traceback");
-                if(modTB == NULL) {
-                    printf("Error importing python traceback module\n");
-                }
-                extract = PyString_FromString("extract_tb");
-                if(extract == NULL) {
-                    printf("Error making PyString 'extract_tb'\n");
-                }
-                if(modTB != NULL && extract != NULL) {
-                    pystack = PyObject_CallMethodObjArgs(modTB, extract, ptrace,
-                            NULL);
-                }
-                if(PyErr_Occurred()) {
+                stack = pyerr_stacktrace(env, ptrace);
+                if(!stack && PyErr_Occurred()) {
                   /*
                    * well this isn't good, we got an error while we're trying
                    * to process errors, let's just print it out
                    */
                   PyErr_Print();
                 }
-                Py_XDECREF(modTB);
-                Py_XDECREF(extract);
             }
 
-            /*
-             * this could go in the above if statement but I got tired of
-             * incrementing so far to the right
-             */
-            if(pystack != NULL) {
-                Py_ssize_t stackSize, i, count, index;
-                jobjectArray stackArray, reverse;
-                jclass stackTraceElemClazz;
-
-                stackTraceElemClazz = (*env)->FindClass(env,
-                        "Ljava/lang/StackTraceElement;");
-                if(stackTraceElemInit == NULL) {
-                    stackTraceElemInit =
-                            (*env)->GetMethodID(env, stackTraceElemClazz,
-                                    "<init>",
-                                    "(Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;I)V");
+            if(stack != NULL) {
+                if(setStackTrace == NULL) {
+                    setStackTrace = (*env)->GetMethodID(env, jepExcClazz,
+                            "setStackTrace",
+                            "([Ljava/lang/StackTraceElement;)V");
                 }
-
-                stackSize = PyList_Size(pystack);
-                stackArray = (*env)->NewObjectArray(env, (jsize) stackSize,
-                        stackTraceElemClazz, NULL);
-                if((*env)->ExceptionCheck(env) || !stackArray) {
-                    PyErr_Format(PyExc_RuntimeError,
-                            "creating java.lang.StackTraceElement[] failed.");
-                    Py_DECREF(pystack);
-                    return 1;
-                }
-
-                count = 0;
-                for (i = 0; i < stackSize; i++) {
-                    PyObject *stackEntry, *pyLine;
-                    char *charPyFile, *charPyFunc = NULL;
-                    int pyLineNum;
-
-                    stackEntry = PyList_GetItem(pystack, i);
-                    // java order is classname, methodname, filename, lineNumber
-                    // python order is filename, line number, function name, line
-                    charPyFile = PyString_AsString(
-                            PySequence_GetItem(stackEntry, 0));
-                    pyLineNum = (int) PyInt_AsLong(
-                            PySequence_GetItem(stackEntry, 1));
-                    charPyFunc = PyString_AsString(
-                            PySequence_GetItem(stackEntry, 2));
-                    pyLine = PySequence_GetItem(stackEntry, 3);
-
-                    /*
-                     * if pyLine is None, this seems to imply it was an eval,
-                     * making the stack element fairly useless, so we will
-                     * skip it
-                     */
-                    if(pyLine != Py_None) {
-                        char *charPyFileNoExt, *lastDot;
-                        char *charPyFileNoDir, *lastBackslash;
-                        int namelen;
-                        jobject element;
-                        jstring pyFileNoDir, pyFileNoExt, pyFunc;
-
-                        // remove the .py to look more like a Java StackTraceElement
-                        namelen = (int) strlen(charPyFile);
-                        charPyFileNoExt = malloc(sizeof(char) * (namelen + 1));
-                        strcpy(charPyFileNoExt, charPyFile);
-                        lastDot = strrchr(charPyFileNoExt, '.');
-                        if(lastDot != NULL) {
-                            *lastDot = '\0';
-                        }
-
-                        // remove the dir path to look more like a Java StackTraceElement
-                        charPyFileNoDir = malloc(sizeof(char) * (namelen + 1));
-                        lastBackslash = strrchr(charPyFile, FILE_SEP);
-                        if(lastBackslash != NULL) {
-                            strcpy(charPyFileNoDir, lastBackslash + 1);
-                        } else {
-                            strcpy(charPyFileNoDir, charPyFile);
-                        }
-
-                        pyFileNoDir = (*env)->NewStringUTF(env,
-                                (const char *) charPyFileNoDir);
-                        pyFileNoExt = (*env)->NewStringUTF(env,
-                                (const char *) charPyFileNoExt);
-                        pyFunc = (*env)->NewStringUTF(env,
-                                (const char *) charPyFunc);
-
-                        /*
-                         * Make the stack trace element from python look like a normal
-                         * java stack trace element.  The order may seem wrong but
-                         * this makes it look best.
-                         */
-                        element = (*env)->NewObject(env, stackTraceElemClazz,
-                                stackTraceElemInit, pyFileNoExt, pyFunc, pyFileNoDir,
-                                pyLineNum);
-                        if((*env)->ExceptionCheck(env) || !element) {
-                            PyErr_Format(PyExc_RuntimeError,
-                                    "failed to create java.lang.StackTraceElement for python %s:%i.",
-                                    charPyFile, pyLineNum);
-                            release_utf_char(env, pyFileNoDir, charPyFileNoDir);
-                            release_utf_char(env, pyFileNoExt, charPyFileNoExt);
-                            free(charPyFileNoDir);
-                            free(charPyFileNoExt);
-                            release_utf_char(env, pyFunc, charPyFunc);
-                            Py_DECREF(pystack);
-                            return 1;
-                        }
-                        (*env)->SetObjectArrayElement(env, stackArray, (jsize) i,
-                                element);
-                        count++;
-                        free(charPyFileNoDir);
-                        free(charPyFileNoExt);
-                        (*env)->DeleteLocalRef(env, pyFileNoDir);
-                        (*env)->DeleteLocalRef(env, pyFileNoExt);
-                        (*env)->DeleteLocalRef(env, pyFunc);
-                        (*env)->DeleteLocalRef(env, element);
-                    }
-                } // end of stack for loop
-                Py_DECREF(pystack);
-
-                /*
-                 * reverse order of stack and ensure no null elements so it will
-                 * appear like a java stacktrace
-                 */
-                reverse = (*env)->NewObjectArray(env, (jsize) count,
-                        stackTraceElemClazz, NULL);
-                if((*env)->ExceptionCheck(env) || !reverse) {
-                    PyErr_Format(PyExc_RuntimeError,
-                            "creating reverse java.lang.StackTraceElement[] failed.");
-                    return 1;
-                }
-
-                index = 0;
-                for (i = stackSize - 1; i > -1; i--) {
-                    jobject element;
-                    element = (*env)->GetObjectArrayElement(env, stackArray, (jsize) i);
-                    if(element != NULL) {
-                        (*env)->SetObjectArrayElement(env, reverse, (jsize) index,
-                                element);
-                        index++;
-                    }
-                }
-                (*env)->DeleteLocalRef(env, stackArray);
-
-                if(jepException != NULL) {
-                    if(setStackTrace == NULL) {
-                        setStackTrace = (*env)->GetMethodID(env, jepExcClazz,
-                                "setStackTrace",
-                                "([Ljava/lang/StackTraceElement;)V");
-                    }
-                    (*env)->CallObjectMethod(env, jepException, setStackTrace,
-                            reverse);
-                }
-                (*env)->DeleteLocalRef(env, reverse);
+                (*env)->CallVoidMethod(env, jepException, setStackTrace,
+                        stack);
+                (*env)->DeleteLocalRef(env, stack);
             }
+        } else {
+            message = PyObject_Str(ptype);
         }
     }
 
@@ -566,7 +755,7 @@ int process_py_exception(JNIEnv *env, int printTrace) {
     Py_XDECREF(ptrace);
 
     if(jepException != NULL) {
-        Py_DECREF(message);
+        Py_XDECREF(message);
         THROW_JEP_EXC(env, jepException);
     } else if(message && PyString_Check(message)) {
         // should only get here if there was a ptype but no pvalue
@@ -634,12 +823,9 @@ int process_import_exception(JNIEnv *env) {
 // true (1) if an exception was processed.
 int process_java_exception(JNIEnv *env) {
     jthrowable exception = NULL;
-    jclass clazz;
     PyObject *pyException = PyExc_RuntimeError;
     PyObject *jpyExc;
     JepThread *jepThread;
-    jmethodID fillInStacktrace;
-    jobjectArray stack;
 
     if(!(*env)->ExceptionCheck(env))
         return 0;
@@ -654,26 +840,21 @@ int process_java_exception(JNIEnv *env) {
         return 1;
     }
 
+    JEP_THREAD_STAT(jepThread, JEP_STAT_JAVA_EXCEPTIONS, 1);
+
     if(jepThread->printStack)
         (*env)->ExceptionDescribe(env);
 
     // we're already processing this one, clear the old
     (*env)->ExceptionClear(env);
 
-    clazz = (*env)->GetObjectClass(env, exception);
-    if((*env)->ExceptionCheck(env) || !clazz) {
-        (*env)->ExceptionDescribe(env);
-        return 1;
-    }
-
-    // fill in the stack trace here to make sure we don't lose it
-    fillInStacktrace = (*env)->GetMethodID(env, clazz, "getStackTrace",
-            "()[Ljava/lang/StackTraceElement;");
-    stack = (*env)->CallObjectMethod(env, exception, fillInStacktrace);
-    (*env)->DeleteLocalRef(env, stack);
-
-    // turn the java exception into a pyjobject so the interpreter can handle it
-    jpyExc = pyjobject_new(env, exception);
+    /*
+     * turn the java exception into a pyjobject so the interpreter can handle
+     * it. most exceptions are only caught by type, so don't reflect on it
+     * unless it's used. the stack trace was captured when it was thrown and
+     * is only turned into StackTraceElements if something asks for it.
+     */
+    jpyExc = pyjobject_new_lazy(env, exception);
     if((*env)->ExceptionCheck(env) || !jpyExc) {
         PyErr_Format(PyExc_RuntimeError,
                 "wrapping java exception in pyjobject failed.");
@@ -683,93 +864,62 @@ int process_java_exception(JNIEnv *env) {
     pyException = match_exception_type(env, exception);
     PyErr_SetObject(pyException, jpyExc);
     Py_DECREF(jpyExc);
-    (*env)->DeleteLocalRef(env, clazz);
     (*env)->DeleteLocalRef(env, exception);
     return 1;
 }
 
 /*
- * Matches a jthrowable to an equivalent built-in python exception type.  This
- * is to enable more precise except/catch blocks in python for Java exceptions.
- * This method intentionally does not call process_java_exception as it is only
- * called when processing java exceptions, and we don't want to infinitely recurse.
- *
+ * Java exceptions that map to built-in python exceptions. The classes are
+ * looked up the first time they're needed and kept as global refs.
  */
-static PyObject* match_exception_type(JNIEnv *env, jthrowable exception) {
-    jclass classNotFound, indexBounds, io, classCast;
-    jclass illegalArg, arithmetic, memory, assertion;
+typedef struct {
+    const char *className;
+    PyObject  **pyExcType;
+    jclass      clazz;
+} ExceptionMapping;
 
+static ExceptionMapping exceptionMappings[] = {
     // map ClassNotFoundException to ImportError
-    classNotFound = (*env)->FindClass(env, "java/lang/ClassNotFoundException");
-    if((*env)->ExceptionOccurred(env) || !classNotFound) {
-        goto EXIT_ERROR;
-    }
-    if((*env)->IsInstanceOf(env, exception, classNotFound)) {
-        return PyExc_ImportError;
-    }
-
+    { "java/lang/ClassNotFoundException", &PyExc_ImportError, NULL },
     // map IndexOutOfBoundsException exception to IndexError
-    indexBounds = (*env)->FindClass(env, "java/lang/IndexOutOfBoundsException");
-    if((*env)->ExceptionOccurred(env) || !indexBounds) {
-        goto EXIT_ERROR;
-    }
-    if((*env)->IsInstanceOf(env, exception, indexBounds)) {
-        return PyExc_IndexError;
-    }
-
+    { "java/lang/IndexOutOfBoundsException", &PyExc_IndexError, NULL },
     // map IOException to IOError
-    io = (*env)->FindClass(env, "java/io/IOException");
-    if((*env)->ExceptionOccurred(env) || !io) {
-        goto EXIT_ERROR;
-    }
-    if((*env)->IsInstanceOf(env, exception, io)) {
-        return PyExc_IOError;
-    }
-
+    { "java/io/IOException", &PyExc_IOError, NULL },
     // map ClassCastException to TypeError
-    classCast = (*env)->FindClass(env, "java/lang/ClassCastException");
-    if((*env)->ExceptionOccurred(env) || !classCast) {
-        goto EXIT_ERROR;
-    }
-    if((*env)->IsInstanceOf(env, exception, classCast)) {
-        return PyExc_TypeError;
-    }
-
+    { "java/lang/ClassCastException", &PyExc_TypeError, NULL },
     // map IllegalArgumentException to ValueError
-    illegalArg = (*env)->FindClass(env, "java/lang/IllegalArgumentException");
-    if((*env)->ExceptionOccurred(env) || !illegalArg) {
-        goto EXIT_ERROR;
-    }
-    if((*env)->IsInstanceOf(env, exception, illegalArg)) {
-        return PyExc_ValueError;
-    }
-
+    { "java/lang/IllegalArgumentException", &PyExc_ValueError, NULL },
     // map ArithmeticException to ArithmeticError
-    arithmetic = (*env)->FindClass(env, "java/lang/ArithmeticException");
-    if((*env)->ExceptionOccurred(env) || !arithmetic) {
-        goto EXIT_ERROR;
-    }
-    if((*env)->IsInstanceOf(env, exception, arithmetic)) {
-        return PyExc_ArithmeticError;
-    }
-
+    { "java/lang/ArithmeticException", &PyExc_ArithmeticError, NULL },
     // map OutOfMemoryError to MemoryError
-    memory = (*env)->FindClass(env, "java/lang/OutOfMemoryError");
-    if((*env)->ExceptionOccurred(env) || !memory) {
-        goto EXIT_ERROR;
-    }
-    if((*env)->IsInstanceOf(env, exception, memory)) {
-        // honestly if you hit this you're probably screwed
-        return PyExc_MemoryError;
-    }
-
+    // honestly if you hit this you're probably screwed
+    { "java/lang/OutOfMemoryError", &PyExc_MemoryError, NULL },
     // map AssertionError to AssertionError
-    assertion = (*env)->FindClass(env, "java/lang/AssertionError");
-    if((*env)->ExceptionOccurred(env) || !assertion) {
-        goto EXIT_ERROR;
-    }
-    if((*env)->IsInstanceOf(env, exception, assertion)) {
-        return PyExc_AssertionError;
+    { "java/lang/AssertionError", &PyExc_AssertionError, NULL },
+    { NULL, NULL, NULL }
+};
+
+/*
+ * Matches a jthrowable to an equivalent built-in python exception type.  This
+ * is to enable more precise except/catch blocks in python for Java exceptions.
+ * This method intentionally does not call process_java_exception as it is only
+ * called when processing java exceptions, and we don't want to infinitely recurse.
+ *
+ */
+static PyObject* match_exception_type(JNIEnv *env, jthrowable exception) {
+    ExceptionMapping *mapping;
+
+    for(mapping = exceptionMappings; mapping->className; mapping++) {
+        if(!mapping->clazz) {
+            jclass clazz = (*env)->FindClass(env, mapping->className);
+            if((*env)->ExceptionOccurred(env) || !clazz)
+                goto EXIT_ERROR;
+            mapping->clazz = (*env)->NewGlobalRef(env, clazz);
+            (*env)->DeleteLocalRef(env, clazz);
+        }
+
+        if((*env)->IsInstanceOf(env, exception, mapping->clazz))
+            return *mapping->pyExcType;
     }
 
     // default
@@ -832,6 +982,193 @@ void release_utf_char(JNIEnv *env, jstring str, const char *v) {
 }
 
 
+/*
+ * Java strings up to this many chars are copied onto the stack with
+ * GetStringRegion, longer ones are read in place with GetStringCritical.
+ */
+#define JSTRING_STACK_CHARS 256
+
+#if PY_MAJOR_VERSION >= 3 && PY_MINOR_VERSION >= 3
+// makes a compact str of the narrowest kind that holds the UTF-16 chars
+PyObject* utf16_topystring(const jchar *chars, jsize len) {
+    PyObject  *result;
+    jchar      max = 0;
+    jsize      i;
+
+    for(i = 0; i < len; i++) {
+        if(chars[i] > max)
+            max = chars[i];
+    }
+
+    if(max >= 0xD800) {
+        for(i = 0; i < len; i++) {
+            if(chars[i] >= 0xD800 && chars[i] <= 0xDFFF) {
+                // combine surrogate pairs, keeping any that are unpaired
+                int byteorder = PY_LITTLE_ENDIAN ? -1 : 1;
+#if PY_MINOR_VERSION >= 4
+                const char *errors = "surrogatepass";
+#else
+                const char *errors = NULL;
+#endif
+                return PyUnicode_DecodeUTF16((const char *) chars,
+                                             (Py_ssize_t) len * 2,
+                                             errors,
+                                             &byteorder);
+            }
+        }
+    }
+
+    result = PyUnicode_New((Py_ssize_t) len, (Py_UCS4) max);
+    if(!result)
+        return NULL;
+    if(PyUnicode_KIND(result) == PyUnicode_1BYTE_KIND) {
+        Py_UCS1 *data = PyUnicode_1BYTE_DATA(result);
+        for(i = 0; i < len; i++)
+            data[i] = (Py_UCS1) chars[i];
+    } else {
+        memcpy(PyUnicode_2BYTE_DATA(result), chars, sizeof(jchar) * len);
+    }
+    return result;
+}
+#endif
+
+
+// java String to python str.  Copies the UTF-16 straight into a compact
+// str where the python version has them.  NULL on error, None for null.
+// returns new reference.
+PyObject* jstring_topystring(JNIEnv *env, jstring jstr) {
+#if PY_MAJOR_VERSION >= 3 && PY_MINOR_VERSION >= 3
+    jchar        buf[JSTRING_STACK_CHARS];
+    const jchar *chars;
+    PyObject    *result;
+    jsize        len;
+
+    if(jstr == NULL)
+        Py_RETURN_NONE;
+
+    len = (*env)->GetStringLength(env, jstr);
+    if(len <= JSTRING_STACK_CHARS) {
+        (*env)->GetStringRegion(env, jstr, 0, len, buf);
+        if(process_java_exception(env))
+            return NULL;
+        if(pyembedStringCaches && len <= JEP_STRING_CACHE_MAX_CHARS)
+            return pyembed_cached_pystring(buf, len);
+        return utf16_topystring(buf, len);
+    }
+
+    // no jni calls until it's released
+    chars = (*env)->GetStringCritical(env, jstr, NULL);
+    if(!chars) {
+        if(!process_java_exception(env))
+            PyErr_NoMemory();
+        return NULL;
+    }
+    result = utf16_topystring(chars, len);
+    (*env)->ReleaseStringCritical(env, jstr, chars);
+    return result;
+#else
+    const char *str;
+    PyObject   *result;
+
+    if(jstr == NULL)
+        Py_RETURN_NONE;
+
+    str = (*env)->GetStringUTFChars(env, jstr, 0);
+    if(!str) {
+        process_java_exception(env);
+        return NULL;
+    }
+    result = PyString_FromString(str);
+    (*env)->ReleaseStringUTFChars(env, jstr, str);
+    return result;
+#endif
+}
+
+
+// python str to java String through UTF-16.  on error returns NULL with
+// either a python error or a java exception set.
+// returns local reference.
+jstring pystring_tojstring(JNIEnv *env, PyObject *str) {
+#if PY_MAJOR_VERSION >= 3 && PY_MINOR_VERSION >= 3
+    jchar       buf[JSTRING_STACK_CHARS];
+    jchar      *chars = buf;
+    jstring     jstr;
+    Py_ssize_t  len, jlen, i, j;
+    int         kind;
+
+#if PY_VERSION_HEX < 0x030C0000
+    if(PyUnicode_READY(str) < 0)
+        return NULL;
+#endif
+    len  = PyUnicode_GET_LENGTH(str);
+    kind = PyUnicode_KIND(str);
+
+    // the chars are already UTF-16
+    if(kind == PyUnicode_2BYTE_KIND) {
+        if(len > INT_MAX) {
+            PyErr_SetString(PyExc_OverflowError, "String too long for Java.");
+            return NULL;
+        }
+        return (*env)->NewString(env,
+                                 (const jchar *) PyUnicode_2BYTE_DATA(str),
+                                 (jsize) len);
+    }
+
+    // characters above the BMP take a surrogate pair
+    jlen = len;
+    if(kind == PyUnicode_4BYTE_KIND) {
+        Py_UCS4 *data = PyUnicode_4BYTE_DATA(str);
+        for(i = 0; i < len; i++) {
+            if(data[i] > 0xFFFF)
+                jlen++;
+        }
+    }
+    if(jlen > INT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "String too long for Java.");
+        return NULL;
+    }
+
+    if(jlen > JSTRING_STACK_CHARS) {
+        chars = (jchar *) PyMem_Malloc(sizeof(jchar) * jlen);
+        if(!chars) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+    }
+
+    if(kind == PyUnicode_1BYTE_KIND) {
+        Py_UCS1 *data = PyUnicode_1BYTE_DATA(str);
+        for(i = 0; i < len; i++)
+            chars[i] = (jchar) data[i];
+    } else {
+        Py_UCS4 *data = PyUnicode_4BYTE_DATA(str);
+        for(i = 0, j = 0; i < len; i++) {
+            Py_UCS4 c = data[i];
+            if(c > 0xFFFF) {
+                c -= 0x10000;
+                chars[j++] = (jchar) (0xD800 + (c >> 10));
+                chars[j++] = (jchar) (0xDC00 + (c & 0x3FF));
+            } else {
+                chars[j++] = (jchar) c;
+            }
+        }
+    }
+
+    jstr = (*env)->NewString(env, chars, (jsize) jlen);
+    if(chars != buf)
+        PyMem_Free(chars);
+    return jstr;
+#else
+    char *val;
+
+    val = PyString_AsString(str);
+    if(!val)
+        return NULL;
+    return (*env)->NewStringUTF(env, (const char *) val);
+#endif
+}
+
+
 // in order to call methods that return primitives,
 // we have to know they're return type. that's easy,
 // i'm simply using the reflection api to call getReturnType().
@@ -1092,7 +1429,6 @@ int cache_primitive_classes(JNIEnv *env) {
         (*env)->DeleteLocalRef(env, clazz);
     }
 
-#if USE_NUMPY
     if(JBOOLEAN_ARRAY_TYPE == NULL) {
         clazz = (*env)->FindClass(env, "[Z");
         if((*env)->ExceptionOccurred(env))
@@ -1155,7 +1491,6 @@ int cache_primitive_classes(JNIEnv *env) {
         JDOUBLE_ARRAY_TYPE = (*env)->NewGlobalRef(env, clazz);
         (*env)->DeleteLocalRef(env, clazz);
     }
-#endif
 
     return 1;
 }
@@ -1212,7 +1547,6 @@ void unref_cache_primitive_classes(JNIEnv *env) {
         JCLASS_TYPE = NULL;
     }
 
-#if USE_NUMPY
     if(JBOOLEAN_ARRAY_TYPE != NULL) {
         (*env)->DeleteGlobalRef(env, JBOOLEAN_ARRAY_TYPE);
         JBOOLEAN_ARRAY_TYPE = NULL;
@@ -1241,7 +1575,6 @@ void unref_cache_primitive_classes(JNIEnv *env) {
         (*env)->DeleteGlobalRef(env, JDOUBLE_ARRAY_TYPE);
         JDOUBLE_ARRAY_TYPE = NULL;
     }
-#endif
 }
 
 int cache_frequent_classes(JNIEnv *env) {
@@ -1304,11 +1637,114 @@ int cache_frequent_classes(JNIEnv *env) {
     }
 #endif
 
-    /*
-     * TODO cache the jclass objects used in pyembed_box_py and jep exception
-     * handling, though those methods are less frequently used and will not
-     * result in as noticeable a speedup
-     */
+    // used by pyembed_box_py
+    if(JBOOLEAN_OBJ_TYPE == NULL) {
+        clazz = (*env)->FindClass(env, "java/lang/Boolean");
+        if((*env)->ExceptionOccurred(env))
+            return 0;
+
+        JBOOLEAN_OBJ_TYPE = (*env)->NewGlobalRef(env, clazz);
+        (*env)->DeleteLocalRef(env, clazz);
+    }
+
+    if(JINTEGER_OBJ_TYPE == NULL) {
+        clazz = (*env)->FindClass(env, "java/lang/Integer");
+        if((*env)->ExceptionOccurred(env))
+            return 0;
+
+        JINTEGER_OBJ_TYPE = (*env)->NewGlobalRef(env, clazz);
+        (*env)->DeleteLocalRef(env, clazz);
+    }
+
+    if(JLONG_OBJ_TYPE == NULL) {
+        clazz = (*env)->FindClass(env, "java/lang/Long");
+        if((*env)->ExceptionOccurred(env))
+            return 0;
+
+        JLONG_OBJ_TYPE = (*env)->NewGlobalRef(env, clazz);
+        (*env)->DeleteLocalRef(env, clazz);
+    }
+
+    if(JDOUBLE_OBJ_TYPE == NULL) {
+        clazz = (*env)->FindClass(env, "java/lang/Double");
+        if((*env)->ExceptionOccurred(env))
+            return 0;
+
+        JDOUBLE_OBJ_TYPE = (*env)->NewGlobalRef(env, clazz);
+        (*env)->DeleteLocalRef(env, clazz);
+    }
+
+    if(JARRAYLIST_TYPE == NULL) {
+        clazz = (*env)->FindClass(env, "java/util/ArrayList");
+        if((*env)->ExceptionOccurred(env))
+            return 0;
+
+        JARRAYLIST_TYPE = (*env)->NewGlobalRef(env, clazz);
+        (*env)->DeleteLocalRef(env, clazz);
+    }
+
+    if(JHASHMAP_TYPE == NULL) {
+        clazz = (*env)->FindClass(env, "java/util/HashMap");
+        if((*env)->ExceptionOccurred(env))
+            return 0;
+
+        JHASHMAP_TYPE = (*env)->NewGlobalRef(env, clazz);
+        (*env)->DeleteLocalRef(env, clazz);
+    }
+
+    if(JCOLLECTIONS_TYPE == NULL) {
+        clazz = (*env)->FindClass(env, "java/util/Collections");
+        if((*env)->ExceptionOccurred(env))
+            return 0;
+
+        JCOLLECTIONS_TYPE = (*env)->NewGlobalRef(env, clazz);
+        (*env)->DeleteLocalRef(env, clazz);
+    }
+
+    if(JBYTEBUFFER_TYPE == NULL) {
+        clazz = (*env)->FindClass(env, "java/nio/ByteBuffer");
+        if((*env)->ExceptionOccurred(env))
+            return 0;
+
+        JBYTEBUFFER_TYPE = (*env)->NewGlobalRef(env, clazz);
+        (*env)->DeleteLocalRef(env, clazz);
+    }
+
+    if(JSHORT_OBJ_TYPE == NULL) {
+        clazz = (*env)->FindClass(env, "java/lang/Short");
+        if((*env)->ExceptionOccurred(env))
+            return 0;
+
+        JSHORT_OBJ_TYPE = (*env)->NewGlobalRef(env, clazz);
+        (*env)->DeleteLocalRef(env, clazz);
+    }
+
+    if(JFLOAT_OBJ_TYPE == NULL) {
+        clazz = (*env)->FindClass(env, "java/lang/Float");
+        if((*env)->ExceptionOccurred(env))
+            return 0;
+
+        JFLOAT_OBJ_TYPE = (*env)->NewGlobalRef(env, clazz);
+        (*env)->DeleteLocalRef(env, clazz);
+    }
+
+    if(JBYTE_OBJ_TYPE == NULL) {
+        clazz = (*env)->FindClass(env, "java/lang/Byte");
+        if((*env)->ExceptionOccurred(env))
+            return 0;
+
+        JBYTE_OBJ_TYPE = (*env)->NewGlobalRef(env, clazz);
+        (*env)->DeleteLocalRef(env, clazz);
+    }
+
+    if(JCHAR_OBJ_TYPE == NULL) {
+        clazz = (*env)->FindClass(env, "java/lang/Character");
+        if((*env)->ExceptionOccurred(env))
+            return 0;
+
+        JCHAR_OBJ_TYPE = (*env)->NewGlobalRef(env, clazz);
+        (*env)->DeleteLocalRef(env, clazz);
+    }
 
     return 1;
 
@@ -1341,6 +1777,66 @@ void unref_cache_frequent_classes(JNIEnv *env) {
         JCOLLECTION_TYPE = NULL;
     }
 
+    if(JBOOLEAN_OBJ_TYPE != NULL) {
+        (*env)->DeleteGlobalRef(env, JBOOLEAN_OBJ_TYPE);
+        JBOOLEAN_OBJ_TYPE = NULL;
+    }
+
+    if(JINTEGER_OBJ_TYPE != NULL) {
+        (*env)->DeleteGlobalRef(env, JINTEGER_OBJ_TYPE);
+        JINTEGER_OBJ_TYPE = NULL;
+    }
+
+    if(JLONG_OBJ_TYPE != NULL) {
+        (*env)->DeleteGlobalRef(env, JLONG_OBJ_TYPE);
+        JLONG_OBJ_TYPE = NULL;
+    }
+
+    if(JDOUBLE_OBJ_TYPE != NULL) {
+        (*env)->DeleteGlobalRef(env, JDOUBLE_OBJ_TYPE);
+        JDOUBLE_OBJ_TYPE = NULL;
+    }
+
+    if(JARRAYLIST_TYPE != NULL) {
+        (*env)->DeleteGlobalRef(env, JARRAYLIST_TYPE);
+        JARRAYLIST_TYPE = NULL;
+    }
+
+    if(JHASHMAP_TYPE != NULL) {
+        (*env)->DeleteGlobalRef(env, JHASHMAP_TYPE);
+        JHASHMAP_TYPE = NULL;
+    }
+
+    if(JCOLLECTIONS_TYPE != NULL) {
+        (*env)->DeleteGlobalRef(env, JCOLLECTIONS_TYPE);
+        JCOLLECTIONS_TYPE = NULL;
+    }
+
+    if(JBYTEBUFFER_TYPE != NULL) {
+        (*env)->DeleteGlobalRef(env, JBYTEBUFFER_TYPE);
+        JBYTEBUFFER_TYPE = NULL;
+    }
+
+    if(JSHORT_OBJ_TYPE != NULL) {
+        (*env)->DeleteGlobalRef(env, JSHORT_OBJ_TYPE);
+        JSHORT_OBJ_TYPE = NULL;
+    }
+
+    if(JFLOAT_OBJ_TYPE != NULL) {
+        (*env)->DeleteGlobalRef(env, JFLOAT_OBJ_TYPE);
+        JFLOAT_OBJ_TYPE = NULL;
+    }
+
+    if(JBYTE_OBJ_TYPE != NULL) {
+        (*env)->DeleteGlobalRef(env, JBYTE_OBJ_TYPE);
+        JBYTE_OBJ_TYPE = NULL;
+    }
+
+    if(JCHAR_OBJ_TYPE != NULL) {
+        (*env)->DeleteGlobalRef(env, JCHAR_OBJ_TYPE);
+        JCHAR_OBJ_TYPE = NULL;
+    }
+
 #if USE_NUMPY
     if(JEP_NDARRAY_TYPE != NULL) {
         (*env)->DeleteGlobalRef(env, JEP_NDARRAY_TYPE);
@@ -1358,6 +1854,8 @@ int get_jtype(JNIEnv *env, jclass clazz) {
     jboolean equals = JNI_FALSE;
     jboolean array  = JNI_FALSE;
 
+    JEP_STAT(JEP_STAT_TYPE_LOOKUPS, 1);
+
     // have to find Class.isArray() method
     if(objectIsArray == 0) {
         objectIsArray = (*env)->GetMethodID(env,
@@ -1542,6 +2040,11 @@ int pyarg_matches_jtype(JNIEnv *env,
                                         paramType))
                 return 1;
         }
+
+        // a python function for an interface like Runnable
+        if(!pyjobject_check(param) && PyCallable_Check(param) &&
+           pyembed_is_functional(env, paramType))
+            return 1;
         
         break;
 
@@ -1621,16 +2124,9 @@ PyObject* convert_jobject(JNIEnv *env, jobject val, int typeid) {
     case JARRAY_ID:
         return (PyObject *) pyjarray_new(env, val);
 
-    case JSTRING_ID: {
-        const char *str;
-        PyObject *ret;
-
-        str = jstring2char(env, val);
-        ret = PyString_FromString(str);
-        release_utf_char(env, val, str);
-
-        return ret;
-    }
+    case JSTRING_ID:
+        // the caller owns val
+        return jstring_topystring(env, val);
 
     case JCLASS_ID:
         return (PyObject *) pyjobject_new_class(env, val);
@@ -1685,7 +2181,7 @@ PyObject* convert_jobject(JNIEnv *env, jobject val, int typeid) {
         if((*env)->ExceptionOccurred(env))
             return NULL;
 
-        return Py_BuildValue("i", b);
+        return PyLong_FromLongLong(b);
     }
 
     case JDOUBLE_ID: {
@@ -1802,7 +2298,6 @@ jvalue convert_pyarg_jvalue(JNIEnv *env,
 
     case JSTRING_ID: {
         jstring   jstr;
-        char     *val;
             
         // none is okay, we'll set a null
         if(param == Py_None) {
@@ -1830,8 +2325,7 @@ jvalue convert_pyarg_jvalue(JNIEnv *env,
                 return ret;
             }
                 
-            val   = PyString_AsString(param);
-            jstr  = (*env)->NewStringUTF(env, (const char *) val);
+            jstr  = pystring_tojstring(env, param);
             
             ret.l = jstr;
         }
@@ -1927,8 +2421,6 @@ jvalue convert_pyarg_jvalue(JNIEnv *env,
         if(param == Py_None) {
             ;
         } else if(PyString_Check(param)) {
-            char *val;
-
             // strings count as objects here
             if(!(*env)->IsAssignableFrom(env,
                                          JSTRING_TYPE,
@@ -1940,8 +2432,7 @@ jvalue convert_pyarg_jvalue(JNIEnv *env,
                 return ret;
             }
 
-            val = PyString_AsString(param);
-            obj = (*env)->NewStringUTF(env, (const char *) val);
+            obj = pystring_tojstring(env, param);
         }
 #if USE_NUMPY
         else if(npy_array_check(param)) {
@@ -1949,6 +2440,17 @@ jvalue convert_pyarg_jvalue(JNIEnv *env,
             return ret;
         }
 #endif
+        else if(!pyjobject_check(param) && PyCallable_Check(param)) {
+            // wrapped in a proxy for an interface like Runnable
+            obj = pyembed_callable_proxy(env, param, paramType);
+            if(!obj) {
+                if(!PyErr_Occurred())
+                    PyErr_Format(PyExc_TypeError,
+                                 "Expected object parameter at %i.",
+                                 pos + 1);
+                return ret;
+            }
+        }
         else {
             if(!pyjobject_check(param)) {
                 PyErr_Format(PyExc_TypeError,
@@ -2248,6 +2750,8 @@ jarray convert_pyndarray_jprimitivearray(JNIEnv* env,
         (*env)->SetDoubleArrayRegion(env, arr, 0, sz, (const jdouble *) PyArray_DATA(copy));
     }
 
+    JEP_STAT(JEP_STAT_BYTES_CONVERTED,
+             (jeplong) PyArray_NBYTES((PyArrayObject *) copy));
     Py_XDECREF(copy);
 
     if(process_java_exception(env)) {
@@ -2390,6 +2894,9 @@ PyObject* convert_jprimitivearray_pyndarray(JNIEnv *env,
         (*env)->ReleaseDoubleArrayElements(env, jo, dataDouble, JNI_ABORT);
     }
 
+    if(pyob)
+        JEP_STAT(JEP_STAT_BYTES_CONVERTED,
+                 (jeplong) PyArray_NBYTES((PyArrayObject *) pyob));
     return pyob;
 }
 
@@ -45,6 +45,7 @@
 
 #define PyString_FromString(str)          PyUnicode_FromString(str)
 #define PyString_Check(str)               PyUnicode_Check(str)
+#define PyString_InternFromString(str)    PyUnicode_InternFromString(str)
 #define PyString_FromFormat(fmt, ...)     PyUnicode_FromFormat(fmt, ##__VA_ARGS__)
 // more string macros are defined for python 3 compatibility farther down...
 
@@ -103,6 +104,22 @@ typedef long long jeplong;
 # define PyDoc_STRVAR(name, str) PyDoc_VAR(name) = PyDoc_STR(str)
 #endif
 
+/*
+ * the thread state that holds the GIL, or NULL. can be used without the GIL
+ * to check if this thread already has it.
+ */
+#if PY_MAJOR_VERSION < 3
+ #define CURRENT_TSTATE()  _PyThreadState_Current
+#elif PY_VERSION_HEX >= 0x030D0000
+ #define CURRENT_TSTATE()  PyThreadState_GetUnchecked()
+#elif PY_VERSION_HEX >= 0x03050200
+ #define CURRENT_TSTATE()  _PyThreadState_UncheckedGet()
+#elif PY_VERSION_HEX >= 0x03030000
+ #define CURRENT_TSTATE()  ((PyThreadState*) _Py_atomic_load_relaxed(&_PyThreadState_Current))
+#else
+ #define CURRENT_TSTATE()  _PyThreadState_Current
+#endif
+
 // this function exists solely to support python 3.2
 char* pyunicode_to_utf8(PyObject *unicode);
 
@@ -140,10 +157,27 @@ const char* jstring2char(JNIEnv*, jstring);
 // release memory allocated by jstring2char
 void release_utf_char(JNIEnv*, jstring, const char*);
 
+// java String to python str through UTF-16, None for null.
+// returns new reference.
+PyObject* jstring_topystring(JNIEnv*, jstring);
+
+// python str to java String through UTF-16, NULL on error.
+// returns local reference.
+jstring pystring_tojstring(JNIEnv*, PyObject*);
+
+#if PY_MAJOR_VERSION >= 3 && PY_MINOR_VERSION >= 3
+// a compact str of UTF-16 chars.  returns new reference.
+PyObject* utf16_topystring(const jchar*, jsize);
+#endif
+
 // convert pyerr to java exception.
 // int param is printTrace, send traceback to stderr
 int process_py_exception(JNIEnv*, int);
 
+// message and stack trace of a python exception from process_py_exception,
+// as a java Object[] of { String, StackTraceElement[] }
+jobjectArray describe_py_exception(JNIEnv*, PyObject*);
+
 // convert java exception to pyerr.
 // true (1) if an exception was processed.
 int process_java_exception(JNIEnv*);
@@ -170,6 +204,7 @@ PyObject* tuplelist_getitem(PyObject*, PyObject*);
 int npy_array_check(PyObject*);
 int jndarray_check(JNIEnv*, jobject);
 jobject convert_pyndarray_jndarray(JNIEnv*, PyObject*);
+jarray convert_pyndarray_jprimitivearray(JNIEnv*, PyObject*, jclass);
 PyObject* convert_jndarray_pyndarray(JNIEnv*, jobject);
 #endif
 
@@ -187,6 +222,9 @@ PyObject* convert_jndarray_pyndarray(JNIEnv*, jobject);
 #define JBYTE_ID    11
 #define JCLASS_ID   12
 
+// an argument type only known from the argument itself, see pyembed_invoke
+#define JDYNAMIC_ID -2
+
 extern jclass JINT_TYPE;
 extern jclass JLONG_TYPE;
 extern jclass JOBJECT_TYPE;
@@ -200,7 +238,6 @@ extern jclass JCHAR_TYPE;
 extern jclass JBYTE_TYPE;
 extern jclass JCLASS_TYPE;
 
-#if USE_NUMPY
 extern jclass JBOOLEAN_ARRAY_TYPE;
 extern jclass JBYTE_ARRAY_TYPE;
 extern jclass JSHORT_ARRAY_TYPE;
@@ -208,7 +245,6 @@ extern jclass JINT_ARRAY_TYPE;
 extern jclass JLONG_ARRAY_TYPE;
 extern jclass JFLOAT_ARRAY_TYPE;
 extern jclass JDOUBLE_ARRAY_TYPE;
-#endif
 
 // cache some frequently looked up classes
 extern jclass JLIST_TYPE;
@@ -216,6 +252,18 @@ extern jclass JMAP_TYPE;
 extern jclass JITERABLE_TYPE;
 extern jclass JITERATOR_TYPE;
 extern jclass JCOLLECTION_TYPE;
+extern jclass JBOOLEAN_OBJ_TYPE;
+extern jclass JINTEGER_OBJ_TYPE;
+extern jclass JLONG_OBJ_TYPE;
+extern jclass JDOUBLE_OBJ_TYPE;
+extern jclass JARRAYLIST_TYPE;
+extern jclass JHASHMAP_TYPE;
+extern jclass JCOLLECTIONS_TYPE;
+extern jclass JBYTEBUFFER_TYPE;
+extern jclass JSHORT_OBJ_TYPE;
+extern jclass JFLOAT_OBJ_TYPE;
+extern jclass JBYTE_OBJ_TYPE;
+extern jclass JCHAR_OBJ_TYPE;
 #if USE_NUMPY
 extern jclass JEP_NDARRAY_TYPE;
 #endif
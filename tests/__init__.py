@@ -11,4 +11,5 @@ from .test_compare import *
 from .test_dir import *
 from .test_numpy import *
 from .test_method_memory import *
+from .test_java_api import *
 
@@ -0,0 +1,519 @@
+# Microbenchmarks of the hot paths between Python and Java: attribute access,
+# method dispatch, constructors, fields, java.util collections, pyjarrays,
+# strings, exceptions and JDBC.  Reports the time per operation along with the
+# Python memory blocks and Java heap bytes allocated per operation.
+#
+# Run it the same way as the tests, from the top of the source tree after
+# building, with the test jar and sqlitejdbc on the CLASSPATH:
+#
+#   python setup.py benchmark
+#   python setup.py benchmark --args="dispatch --json build/bench.json"
+#
+# or directly with jep:
+#
+#   jep tests/benchmark.py [name filter] [--json file] [--quick]
+
+from __future__ import print_function
+
+import json
+import sys
+import time
+
+import jep
+from jep import jarray, JINT_ID
+
+try:
+    timer = time.perf_counter
+except AttributeError:
+    timer = time.time
+
+# the time to aim for per measurement, and how many measurements to take
+TARGET_SECONDS = 0.2
+REPEATS = 5
+
+benchmarks = []
+
+
+def benchmark(name):
+    """Registers a function that returns the operation to time, the setup
+    happens when the function is called and isn't timed."""
+    def register(f):
+        benchmarks.append((name, f))
+        return f
+    return register
+
+
+# ------------------------------------------------------- allocations
+
+try:
+    getallocatedblocks = sys.getallocatedblocks
+except AttributeError:
+    getallocatedblocks = None
+
+_threadBean = None
+
+
+def java_allocated_bytes():
+    """Bytes the current thread allocated on the Java heap, or None if the
+    JVM can't tell."""
+    global _threadBean
+    if _threadBean is None:
+        try:
+            from java.lang.management import ManagementFactory
+            from java.lang import Thread
+            bean = ManagementFactory.getThreadMXBean()
+            bean.getThreadAllocatedBytes(Thread.currentThread().getId())
+            _threadBean = bean
+        except Exception:
+            _threadBean = False
+    if not _threadBean:
+        return None
+    from java.lang import Thread
+    return _threadBean.getThreadAllocatedBytes(Thread.currentThread().getId())
+
+
+# ------------------------------------------------------- the runner
+
+def loop(op, n):
+    for _ in range(n):
+        op()
+
+
+def calibrate(op):
+    n = 1
+    while True:
+        start = timer()
+        loop(op, n)
+        elapsed = timer() - start
+        if elapsed >= TARGET_SECONDS / 10:
+            return max(1, int(n * TARGET_SECONDS / elapsed))
+        n *= 10
+
+
+def measure(op):
+    n = calibrate(op)
+    best = None
+    for _ in range(REPEATS):
+        start = timer()
+        loop(op, n)
+        elapsed = timer() - start
+        if best is None or elapsed < best:
+            best = elapsed
+
+    # allocations are counted in a separate pass so the counting isn't timed
+    blocks = javaBytes = None
+    if getallocatedblocks:
+        before = getallocatedblocks()
+        loop(op, n)
+        blocks = float(getallocatedblocks() - before) / n
+    before = java_allocated_bytes()
+    if before is not None:
+        loop(op, n)
+        javaBytes = float(java_allocated_bytes() - before) / n
+
+    return {'ns_per_op': best * 1e9 / n,
+            'ops': n,
+            'py_blocks_per_op': blocks,
+            'java_bytes_per_op': javaBytes}
+
+
+def fmt(value, spec):
+    return 'n/a' if value is None else spec % value
+
+
+def run(filters, quick=False):
+    global TARGET_SECONDS, REPEATS
+    if quick:
+        TARGET_SECONDS = 0.02
+        REPEATS = 2
+
+    results = []
+    print('%-40s %12s %14s %14s' % ('benchmark', 'ns/op', 'py blocks/op',
+                                    'java bytes/op'))
+    for name, make in benchmarks:
+        if filters and not any(f in name for f in filters):
+            continue
+        try:
+            op = make()
+            op()
+        except Exception as e:
+            print('%-40s skipped: %s' % (name, e))
+            continue
+        result = measure(op)
+        result['name'] = name
+        results.append(result)
+        print('%-40s %12.1f %14s %14s' % (
+            name, result['ns_per_op'],
+            fmt(result['py_blocks_per_op'], '%.2f'),
+            fmt(result['java_bytes_per_op'], '%.1f')))
+        sys.stdout.flush()
+    return results
+
+
+# ------------------------------------------------------- attributes
+
+@benchmark('attribute.method_lookup')
+def attribute_method_lookup():
+    # jep.test.Test has dozens of methods and fields
+    Test = jep.findClass('jep.test.Test')
+    t = Test()
+    return lambda: t.getString
+
+
+@benchmark('attribute.method_call')
+def attribute_method_call():
+    Test = jep.findClass('jep.test.Test')
+    t = Test()
+    return lambda: t.getString()
+
+
+@benchmark('attribute.static_lookup')
+def attribute_static_lookup():
+    from java.lang import Integer
+    return lambda: Integer.valueOf
+
+
+# ------------------------------------------------------- dispatch
+
+@benchmark('dispatch.overloaded_int')
+def dispatch_overloaded_int():
+    from java.lang import StringBuilder
+    sb = StringBuilder()
+    return lambda: sb.append(1).setLength(0)
+
+
+@benchmark('dispatch.overloaded_str')
+def dispatch_overloaded_str():
+    from java.lang import StringBuilder
+    sb = StringBuilder()
+    return lambda: sb.append('a').setLength(0)
+
+
+@benchmark('dispatch.overloaded_float')
+def dispatch_overloaded_float():
+    from java.lang import StringBuilder
+    sb = StringBuilder()
+    return lambda: sb.append(1.5).setLength(0)
+
+
+@benchmark('dispatch.static_max')
+def dispatch_static_max():
+    from java.lang import Math
+    return lambda: Math.max(1, 2)
+
+
+@benchmark('dispatch.no_args')
+def dispatch_no_args():
+    from java.lang import Object
+    o = Object()
+    return lambda: o.hashCode()
+
+
+# ------------------------------------------------------- constructors
+
+@benchmark('constructor.no_args')
+def constructor_no_args():
+    from java.util import ArrayList
+    return lambda: ArrayList()
+
+
+@benchmark('constructor.overloaded')
+def constructor_overloaded():
+    from java.lang import StringBuilder
+    return lambda: StringBuilder('abc')
+
+
+# ------------------------------------------------------- fields
+
+@benchmark('field.get_int')
+def field_get_int():
+    Test = jep.findClass('jep.test.Test')
+    t = Test()
+    return lambda: t.intField
+
+
+@benchmark('field.set_int')
+def field_set_int():
+    Test = jep.findClass('jep.test.Test')
+    t = Test()
+
+    def op():
+        t.intField = 7
+    return op
+
+
+@benchmark('field.get_string')
+def field_get_string():
+    Test = jep.findClass('jep.test.Test')
+    t = Test()
+    return lambda: t.stringField
+
+
+@benchmark('field.get_static')
+def field_get_static():
+    from java.lang import Integer
+    return lambda: Integer.MAX_VALUE
+
+
+# ------------------------------------------------------- java.util
+
+def make_list(n):
+    from java.util import ArrayList
+    values = ArrayList()
+    for i in range(n):
+        values.add(i)
+    return values
+
+
+def make_map(n):
+    from java.util import HashMap
+    values = HashMap()
+    for i in range(n):
+        values.put(str(i), i)
+    return values
+
+
+@benchmark('list.iterate_1000')
+def list_iterate():
+    values = make_list(1000)
+
+    def op():
+        for v in values:
+            pass
+    return op
+
+
+@benchmark('list.index')
+def list_index():
+    values = make_list(1000)
+    return lambda: values[500]
+
+
+@benchmark('list.len')
+def list_len():
+    values = make_list(1000)
+    return lambda: len(values)
+
+
+@benchmark('list.slice_100')
+def list_slice():
+    values = make_list(1000)
+    return lambda: values[100:200]
+
+
+@benchmark('map.iterate_1000')
+def map_iterate():
+    values = make_map(1000)
+
+    def op():
+        for k in values:
+            pass
+    return op
+
+
+@benchmark('map.getitem')
+def map_getitem():
+    values = make_map(1000)
+    return lambda: values['500']
+
+
+@benchmark('map.contains')
+def map_contains():
+    values = make_map(1000)
+    return lambda: '500' in values
+
+
+# ------------------------------------------------------- pyjarray
+
+@benchmark('jarray.getitem')
+def jarray_getitem():
+    ar = jarray(1000, JINT_ID, 0)
+    return lambda: ar[500]
+
+
+@benchmark('jarray.setitem')
+def jarray_setitem():
+    ar = jarray(1000, JINT_ID, 0)
+
+    def op():
+        ar[500] = 7
+    return op
+
+
+@benchmark('jarray.slice_100')
+def jarray_slice():
+    ar = jarray(1000, JINT_ID, 0)
+    return lambda: ar[100:200]
+
+
+@benchmark('jarray.iterate_1000')
+def jarray_iterate():
+    ar = jarray(1000, JINT_ID, 0)
+
+    def op():
+        for v in ar:
+            pass
+    return op
+
+
+# ------------------------------------------------------- strings
+
+# a multi-megabyte document of mostly ascii and of mostly CJK text, the two
+# compact str kinds java chars fit in
+DOCUMENT_CHARS = 4 * 1024 * 1024
+
+
+def document(char):
+    line = (char * 63) + '\n'
+    return line * (DOCUMENT_CHARS // len(line))
+
+
+@benchmark('string.to_python_key')
+def string_to_python_key():
+    from java.lang import String
+    key = String('customer_id')
+    return lambda: key.toString()
+
+
+@benchmark('string.to_java_key')
+def string_to_java_key():
+    from java.lang import System
+    return lambda: System.identityHashCode('customer_id')
+
+
+@benchmark('string.to_python_4m_ascii')
+def string_to_python_ascii():
+    from java.lang import String
+    doc = String(document('a')).toString
+    return lambda: doc()
+
+
+@benchmark('string.to_python_4m_cjk')
+def string_to_python_cjk():
+    from java.lang import String
+    doc = String(document(u'\u4e2d')).toString
+    return lambda: doc()
+
+
+@benchmark('string.to_java_4m_ascii')
+def string_to_java_ascii():
+    from java.lang import System
+    doc = document('a')
+    return lambda: System.identityHashCode(doc)
+
+
+@benchmark('string.to_java_4m_cjk')
+def string_to_java_cjk():
+    from java.lang import System
+    doc = document(u'\u4e2d')
+    return lambda: System.identityHashCode(doc)
+
+
+# ------------------------------------------------------- exceptions
+
+@benchmark('exception.java_to_python')
+def exception_java_to_python():
+    from java.lang import Integer
+
+    def op():
+        try:
+            Integer.parseInt('not a number')
+        except Exception:
+            pass
+    return op
+
+
+@benchmark('exception.python_only')
+def exception_python_only():
+    # for comparison with the round trip above
+    def op():
+        try:
+            int('not a number')
+        except Exception:
+            pass
+    return op
+
+
+# ------------------------------------------------------- jdbc
+
+def sqlite(rows):
+    from jep.jdbc import connect
+    from jep import findClass
+    findClass('org.sqlite.JDBC')
+    conn = connect('jdbc:sqlite::memory:')
+    cursor = conn.cursor()
+    cursor.execute('create table bench (id integer, name text, value real)')
+    cursor.executemany('insert into bench values (?, ?, ?)',
+                       [(i, 'row %d' % i, i * 1.5) for i in range(rows)])
+    return conn
+
+
+@benchmark('jdbc.fetchall_1000')
+def jdbc_fetchall():
+    conn = sqlite(1000)
+
+    def op():
+        cursor = conn.cursor()
+        cursor.execute('select id, name, value from bench')
+        cursor.fetchall()
+        cursor.close()
+    return op
+
+
+@benchmark('jdbc.fetchone')
+def jdbc_fetchone():
+    conn = sqlite(10)
+
+    def op():
+        cursor = conn.cursor()
+        cursor.execute('select id, name, value from bench where id = ?', 5)
+        cursor.fetchone()
+        cursor.close()
+    return op
+
+
+@benchmark('jdbc.resultset_1000')
+def jdbc_resultset():
+    # the java.sql api directly, without jep.jdbc
+    from java.sql import DriverManager
+    from jep import findClass
+    findClass('org.sqlite.JDBC')
+    conn = DriverManager.getConnection('jdbc:sqlite::memory:')
+    stmt = conn.createStatement()
+    stmt.executeUpdate('create table bench (id integer, name text)')
+    for i in range(1000):
+        stmt.executeUpdate("insert into bench values (%d, 'row %d')" % (i, i))
+
+    def op():
+        rs = stmt.executeQuery('select id, name from bench')
+        while rs.next():
+            rs.getInt(1)
+            rs.getString(2)
+        rs.close()
+    return op
+
+
+def main(args):
+    filters = []
+    jsonFile = None
+    quick = False
+    i = 0
+    while i < len(args):
+        if args[i] == '--json':
+            jsonFile = args[i + 1]
+            i += 1
+        elif args[i] == '--quick':
+            quick = True
+        else:
+            filters.append(args[i])
+        i += 1
+
+    results = run(filters, quick)
+    if jsonFile:
+        with open(jsonFile, 'w') as f:
+            json.dump({'python': sys.version.split()[0],
+                       'results': results}, f, indent=2)
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
@@ -28,3 +28,31 @@ def test_leak(testCase, callable, msg):
     end_memory = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
     percent = end_memory*100/start_memory - 100
     testCase.assertLess(end_memory, start_memory*failure_threshold, msg + ' resulted in %d%% increase over %d iterations' % (percent, iterations)) 
+
+
+# The live counts are exact, so far fewer iterations prove there is no leak
+# of java wrappers or global references.
+count_iterations = 5000
+
+
+def live_counts():
+    import gc
+    from jep import liveCounts
+    gc.collect()
+    counts = liveCounts()
+    refs = dict((site, c['live']) for site, c in counts['global_refs'].items())
+    return counts['objects'], refs
+
+
+def test_live_counts(testCase, callable, msg):
+    # the first calls may fill caches that are kept
+    for _ in range(10):
+        callable()
+    start_objects, start_refs = live_counts()
+    for _ in itertools.repeat(None, count_iterations):
+        callable()
+    end_objects, end_refs = live_counts()
+    testCase.assertEqual(start_objects, end_objects,
+                         msg + ' changed the live java wrappers over %d iterations' % count_iterations)
+    testCase.assertEqual(start_refs, end_refs,
+                         msg + ' changed the live global refs over %d iterations' % count_iterations)
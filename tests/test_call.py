@@ -72,3 +72,108 @@ class TestTypes(unittest.TestCase):
 
         self.assertEqual(String, String)
         self.assertNotEqual(String, Integer)
+
+    def test_constructor_dispatch(self):
+        from java.lang import StringBuilder
+        for i in range(3):
+            # same arg types in a different order each pass
+            self.assertEqual('', StringBuilder(16).toString())
+            self.assertEqual('ab', StringBuilder('ab').toString())
+            self.assertEqual('c', StringBuilder('c').toString())
+            self.assertEqual('', StringBuilder().toString())
+
+    def test_proxy_dispatch(self):
+        from java.util import ArrayList, Collections
+
+        class Reverse(object):
+            def compare(self, a, b):
+                return b - a
+
+        comparator = jep.jproxy(Reverse(), ['java.util.Comparator'])
+        values = ArrayList()
+        for i in [3, 1, 2, 5, 4]:
+            values.add(i)
+        for i in range(2):
+            # second pass uses the cached method
+            Collections.sort(values, comparator)
+            self.assertEqual([5, 4, 3, 2, 1], list(values))
+            self.assertEqual(-1, comparator.compare(1, 2))
+
+    def test_proxy_primitives(self):
+        from java.lang import StringBuilder
+        from java.lang.reflect import Proxy
+
+        class Letters(object):
+            def __init__(self, text):
+                self.text = text
+
+            def length(self):
+                return len(self.text)
+
+            def charAt(self, index):
+                return self.text[index]
+
+            def subSequence(self, start, end):
+                return self.text[start:end]
+
+        seq = jep.jproxy(Letters('abc'), ['java.lang.CharSequence'])
+        # generated, not a java.lang.reflect.Proxy
+        self.assertFalse(Proxy.isProxyClass(seq.getClass()))
+        self.assertEqual(3, seq.length())
+        self.assertEqual('b', seq.charAt(1))
+        self.assertEqual('bc', str(seq.subSequence(1, 3)))
+        # java calling int length() and char charAt(int)
+        self.assertEqual('abc', StringBuilder(seq).toString())
+
+    def test_callable_as_interface(self):
+        from java.util import ArrayList, Collections, TreeMap
+
+        def reverse(a, b):
+            return b - a
+
+        values = ArrayList()
+        for i in [3, 1, 2, 5, 4]:
+            values.add(i)
+        Collections.sort(values, reverse)
+        self.assertEqual([5, 4, 3, 2, 1], list(values))
+        Collections.sort(values, lambda a, b: a - b)
+        self.assertEqual([1, 2, 3, 4, 5], list(values))
+
+        # the same function gets the same proxy
+        first = TreeMap(reverse).comparator()
+        self.assertTrue(first.equals(TreeMap(reverse).comparator()))
+
+    def test_profile(self):
+        import json
+        import jep.profile
+        from java.lang import Integer, StringBuilder
+
+        jep.resetProfile()
+        jep.setProfiling(True)
+        try:
+            for i in range(10):
+                Integer.valueOf(i)
+            sb = StringBuilder('abc')
+            try:
+                Integer.parseInt('abc')
+            except Exception:
+                pass
+        finally:
+            jep.setProfiling(False)
+
+        methods = dict((m['method'], m) for m in jep.profile.summary())
+        valueOf = methods['java.lang.Integer.valueOf(int)']
+        self.assertEqual(10, valueOf['calls'])
+        self.assertEqual(0, valueOf['errors'])
+        self.assertEqual(10, sum(c for l, h, c in valueOf['java']['histogram']))
+        self.assertEqual(1, methods['java.lang.Integer.parseInt(java.lang.String)']['errors'])
+        self.assertIn('java.lang.StringBuilder(java.lang.String)', methods)
+
+        # nothing is added while not profiling
+        Integer.valueOf(1)
+        self.assertEqual(10, dict((m['method'], m) for m in jep.profile.summary())
+                         ['java.lang.Integer.valueOf(int)']['calls'])
+        self.assertEqual(len(methods), len(json.loads(jep.profile.dump('json'))))
+        self.assertIn('java.lang.Integer.valueOf(int);java ', jep.profile.dump('folded'))
+        jep.resetProfile()
+        self.assertEqual([], jep.profileData())
@@ -74,6 +74,15 @@ class TestExceptions(unittest.TestCase):
         except ArithmeticError as ex:
             pass
         
+    def test_java_exception_attributes(self):
+        try:
+            Integer.parseInt('asdf')
+        except ValueError as ex:
+            jex = ex.args[0]
+            self.assertIn('asdf', jex.getMessage())
+            self.assertTrue(len(jex.getStackTrace()) > 0)
+            self.assertEqual('java.lang.NumberFormatException', jex.java_name)
+
     # TODO come up with a way to test MemoryError and AssertionError given
     # I coded support for that.
 
@@ -37,3 +37,11 @@ class TestImport(unittest.TestCase):
 
         from java.lang import System
         System.out.print('')  # should still work
+
+    def test_class_cache(self):
+        self.assertIs(findClass('java.lang.Integer'),
+                      findClass('java.lang.Integer'))
+        from java.util import ArrayList
+        import java.util
+        self.assertIs(ArrayList, java.util.ArrayList)
+        self.assertIn('HashMap', dir(java.util))
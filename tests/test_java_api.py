@@ -0,0 +1,43 @@
+import time
+import unittest
+
+import jep
+TestRunner = jep.findClass('jep.test.TestRunner')
+
+
+class TestJavaApi(unittest.TestCase):
+    """Runs the Java tests in src/jep/test that create their own Jeps."""
+
+    def run_java_test(self, name):
+        runner = TestRunner('jep.test.' + name)
+        runner.start()
+        # calls into Java keep the GIL, sleeping lets the test's Jeps run
+        while runner.isAlive():
+            time.sleep(0.01)
+        failure = runner.getFailure()
+        if failure is not None:
+            self.fail(failure)
+
+    def test_shared_modules(self):
+        self.run_java_test('TestSharedModules')
+
+    def test_class_list(self):
+        self.run_java_test('TestClassList')
+
+    def test_jep_exception(self):
+        self.run_java_test('TestJepException')
+
+    def test_bulk_values(self):
+        self.run_java_test('TestBulkValues')
+
+    def test_slots(self):
+        self.run_java_test('TestSlots')
+
+    def test_stats(self):
+        self.run_java_test('TestStats')
+
+    def test_threads(self):
+        self.run_java_test('TestThreads')
+
+    def test_string_cache(self):
+        self.run_java_test('TestStringCache')
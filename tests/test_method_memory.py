@@ -1,7 +1,7 @@
 # This test case attempts to verify that pyjmethods are correctly managing their refcounts.
 
 import unittest
-from .leak_tool import test_leak
+from .leak_tool import test_leak, test_live_counts
 
 class TestMethodMemory(unittest.TestCase):
 
@@ -18,4 +18,18 @@ class TestMethodMemory(unittest.TestCase):
 
     def test_access_no_call(self):
         test_leak(self, lambda:self.obj.hashCode, "Access method")
- 
+
+    def test_live_counts_call(self):
+        test_live_counts(self, lambda:self.obj.hashCode(), "Access and call method")
+
+    def test_live_counts_objects(self):
+        from java.util import ArrayList
+        def make():
+            x = ArrayList()
+            x.add(self.obj)
+            x.get(0)
+        test_live_counts(self, make, "Making and using objects")
+
+    def test_live_counts_arrays(self):
+        from jep import jarray, JINT_ID
+        test_live_counts(self, lambda:jarray(10, JINT_ID, 0)[0:5], "Making and slicing arrays")
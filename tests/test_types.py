@@ -1,3 +1,4 @@
+import sys
 import unittest
 
 import jep
@@ -13,6 +14,17 @@ class TestFields(unittest.TestCase):
         self.test.stringField = 'asdf'
         self.assertEqual('asdf', self.test.stringField)
         
+    @unittest.skipIf(sys.version_info < (3, 3), 'Requires compact unicode')
+    def test_unicode_string(self):
+        from java.lang import String
+        for s in (u'caf\xe9', u'\u4e2d\u6587', u'smile \U0001f600 ok',
+                  u'x' * 1000 + u'\xff', u'\u4e2d' * 1000 + u'\U0001f600'):
+            self.test.stringField = s
+            self.assertEqual(s, self.test.stringField)
+            self.assertEqual(len(s.encode('utf-16-le')) // 2,
+                             String(s).length())
+        self.assertEqual(2, String(u'\U0001f600').length())
+
     def test_boolean_field(self):
         self.assertEqual(True, self.test.booleanField)
         self.assertEqual(True, self.test.isBooleanField())
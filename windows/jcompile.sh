@@ -145,10 +145,12 @@ else
     pushd python
     run $JAVAC -classpath $SUBCLASSPATH $JAVACOPT *.java
     run $JAVAH -o jep_object.h -classpath $SUBCLASSPATH jep.python.PyObject
+    run $JAVAH -o jep_slot.h -classpath $SUBCLASSPATH jep.python.PySlot
     popd
 
     run $JAVAH -o jep.h -classpath ../ jep.Jep
     run $JAVAH -o invocationhandler.h -classpath ../ jep.InvocationHandler
+    run $JAVAH -o generatedproxy.h -classpath ../ jep.GeneratedProxy
 
     pushd $TOPDIR
     run ./makejar.sh jep/ jep.jar